@@ -0,0 +1,67 @@
+/*
+
+        FileName :                    AddressTable.cc
+        Content :                     uHAL address table resolved to absolute addresses, for the board emulator
+        Version :                     1.0
+
+ */
+
+#include "AddressTable.h"
+#include "../Utils/Exception.h"
+#include "../Utils/Utilities.h"
+
+using namespace Ph2_HwInterface;
+
+namespace Ph2_Emulator {
+
+    AddressTable::AddressTable ( const std::string& pFilename )
+    {
+        std::string cFilename = pFilename;
+
+        if ( cFilename.compare ( 0, 7, "file://" ) == 0 ) cFilename = cFilename.substr ( 7 );
+
+        pugi::xml_document cDoc;
+        pugi::xml_parse_result cResult = cDoc.load_file ( cFilename.c_str() );
+
+        if ( !cResult )
+            throw Exception ( ( "AddressTable: can not parse " + cFilename + ": " + cResult.description() ).c_str() );
+
+        // the id of the top node is not part of the paths
+        pugi::xml_node cTop = cDoc.child ( "node" );
+
+        for ( pugi::xml_node cChild = cTop.child ( "node" ); cChild; cChild = cChild.next_sibling ( "node" ) )
+            parseNode ( cChild, "", 0 );
+    }
+
+    const AddressEntry& AddressTable::getNode ( const std::string& pPath ) const
+    {
+        auto cNode = fNodes.find ( pPath );
+
+        if ( cNode == fNodes.end() )
+            throw Exception ( ( "AddressTable: no node " + pPath ).c_str() );
+
+        return cNode->second;
+    }
+
+    void AddressTable::parseNode ( const pugi::xml_node& pNode, const std::string& pPath, uint32_t pBaseAddress )
+    {
+        std::string cPath = pPath.empty() ? pNode.attribute ( "id" ).value() : pPath + "." + pNode.attribute ( "id" ).value();
+
+        AddressEntry cEntry;
+        cEntry.fAddress = pBaseAddress;
+
+        if ( pNode.attribute ( "address" ) )
+            cEntry.fAddress += convertAnyInt ( pNode.attribute ( "address" ).value() );
+
+        if ( pNode.attribute ( "mask" ) )
+            cEntry.fMask = convertAnyInt ( pNode.attribute ( "mask" ).value() );
+
+        if ( pNode.attribute ( "size" ) )
+            cEntry.fSize = convertAnyInt ( pNode.attribute ( "size" ).value() );
+
+        fNodes[cPath] = cEntry;
+
+        for ( pugi::xml_node cChild = pNode.child ( "node" ); cChild; cChild = cChild.next_sibling ( "node" ) )
+            parseNode ( cChild, cPath, cEntry.fAddress );
+    }
+}
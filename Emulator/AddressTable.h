@@ -0,0 +1,74 @@
+/*!
+
+        \file                   AddressTable.h
+        \brief                  uHAL address table resolved to absolute addresses, for the board emulator
+        \version                1.0
+
+ */
+
+#ifndef __ADDRESSTABLE_H__
+#define __ADDRESSTABLE_H__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include "../Utils/pugixml.hpp"
+
+/*!
+ * \namespace Ph2_Emulator
+ * \brief Namespace regrouping the software emulation of the boards
+ */
+namespace Ph2_Emulator {
+
+    /*!
+     * \struct AddressEntry
+     * \brief Absolute address and mask of one node of the address table
+     */
+    struct AddressEntry
+    {
+        uint32_t fAddress = 0;
+        uint32_t fMask = 0xFFFFFFFF;
+        uint32_t fSize = 1;             /*!< number of words of a block or FIFO node */
+
+        /*!
+         * \brief Position of the lowest bit of the mask
+         */
+        uint32_t Shift() const
+        {
+            return fMask ? __builtin_ctz ( fMask ) : 0;
+        }
+    };
+
+    /*!
+     * \class AddressTable
+     * \brief Reads a uHAL address table and maps the dotted node paths, as used with RegManager, to addresses and masks
+     */
+    class AddressTable
+    {
+      public:
+        /*!
+         * \brief Parse pFilename, a "file://" prefix as in the connection nodes is accepted
+         */
+        AddressTable ( const std::string& pFilename );
+
+        bool hasNode ( const std::string& pPath ) const
+        {
+            return fNodes.find ( pPath ) != fNodes.end();
+        }
+        /*!
+         * \brief Entry of node pPath, throws an Exception if the table does not have it
+         */
+        const AddressEntry& getNode ( const std::string& pPath ) const;
+        const std::map<std::string, AddressEntry>& getNodes() const
+        {
+            return fNodes;
+        }
+
+      private:
+        std::map<std::string, AddressEntry> fNodes;
+
+        void parseNode ( const pugi::xml_node& pNode, const std::string& pPath, uint32_t pBaseAddress );
+    };
+}
+
+#endif
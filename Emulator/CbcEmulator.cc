@@ -0,0 +1,147 @@
+/*
+
+        FileName :                    CbcEmulator.cc
+        Content :                     Register model and hit generation of an emulated CBC2
+        Version :                     1.0
+
+ */
+
+#include "CbcEmulator.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "../Utils/Exception.h"
+#include "../Utils/easylogging++.h"
+
+using namespace Ph2_HwInterface;
+
+namespace Ph2_Emulator {
+
+    // register addresses on page 0, channel offsets are on page 1 at the channel number (1 to 254)
+    static const uint8_t cFrontEndControl = 0x00;
+    static const uint8_t cTriggerLatency = 0x01;
+    static const uint8_t cVplus = 0x0B;
+    static const uint8_t cVCth = 0x0C;
+    static const uint8_t cTestPulsePot = 0x0D;
+    static const uint8_t cTestPulseGroup = 0x0E;
+    static const uint8_t cTestPulseCtrl = 0x0F;
+
+    // level of a channel at offset 0x50 and at the Vplus of the default files
+    static const double cBaseLevel = 0x78;
+    static const double cOffsetSlope = 0.5;
+    static const double cVplusSlope = 0.5;
+
+    CbcEmulator::CbcEmulator ( uint8_t pCbcId, const EmulatorSettings& pSettings ) :
+        fCbcId ( pCbcId ),
+        fSettings ( pSettings ),
+        fDirty ( true )
+    {
+        std::memset ( fRegs, 0, sizeof ( fRegs ) );
+        std::memset ( fDefaults, 0, sizeof ( fDefaults ) );
+
+        // the pedestal spread is a property of the chip, so it only depends on the seed and the CBC Id
+        std::mt19937_64 cRandom ( pSettings.fSeed * 1000 + pCbcId );
+        std::normal_distribution<double> cSpread ( 0, pSettings.fPedestalSpread );
+
+        for ( auto& cPedestal : fPedestal )
+            cPedestal = cBaseLevel + cSpread ( cRandom );
+    }
+
+    void CbcEmulator::LoadDefaults ( const std::string& pFilename )
+    {
+        std::ifstream cFile ( pFilename );
+
+        if ( !cFile.good() )
+            throw Exception ( ( "CbcEmulator: can not open " + pFilename ).c_str() );
+
+        std::string cLine;
+
+        while ( std::getline ( cFile, cLine ) )
+        {
+            if ( cLine.empty() || cLine[0] == '*' || cLine[0] == '#' ) continue;
+
+            std::istringstream cStream ( cLine );
+            std::string cName, cPage, cAddress, cDefault, cValue;
+
+            if ( ! ( cStream >> cName >> cPage >> cAddress >> cDefault >> cValue ) ) continue;
+
+            fDefaults[std::stoul ( cPage, 0, 16 ) & 0x1][std::stoul ( cAddress, 0, 16 ) & 0xFF] = std::stoul ( cValue, 0, 16 );
+        }
+
+        HardReset();
+    }
+
+    void CbcEmulator::HardReset()
+    {
+        std::memcpy ( fRegs, fDefaults, sizeof ( fRegs ) );
+        fDirty = true;
+    }
+
+    void CbcEmulator::WriteReg ( uint8_t pPage, uint8_t pAddress, uint8_t pValue )
+    {
+        fRegs[pPage & 0x1][pAddress] = pValue;
+        fDirty = true;
+    }
+
+    double CbcEmulator::probability ( uint32_t pChannel, double pCharge ) const
+    {
+        if ( masked ( pChannel ) ) return 0;
+
+        bool cElectrons = ( fRegs[0][cFrontEndControl] >> 6 ) & 0x1;
+        double cOffset = fRegs[1][pChannel + 1];
+        double cVplusShift = cElectrons ? - ( fRegs[0][cVplus] - 0x6F ) : fRegs[0][cVplus] - 0x5B;
+        double cLevel = fPedestal[pChannel] + cOffsetSlope * ( cOffset - 0x50 ) + cVplusSlope * cVplusShift;
+
+        // distance to the level in the direction in which the comparator fires, the test pulse charge pushes towards firing
+        double cMargin = ( cElectrons ? fRegs[0][cVCth] - cLevel : cLevel - fRegs[0][cVCth] ) + pCharge;
+        double cProbability = 0.5 * std::erfc ( -cMargin / ( std::sqrt ( 2. ) * fSettings.fNoise ) );
+        cProbability += ( 1 - cProbability ) * fSettings.fOccupancy;
+
+        // far from the level no random number is drawn at all
+        if ( cProbability < 1e-9 ) return 0;
+
+        return ( cProbability > 1 - 1e-9 ) ? 1 : cProbability;
+    }
+
+    void CbcEmulator::update()
+    {
+        double cCharge = 0.25 * fRegs[0][cTestPulsePot];
+
+        for ( uint32_t cChannel = 0; cChannel < NCHANNELS; cChannel++ )
+        {
+            fProbability[cChannel] = probability ( cChannel, 0 );
+            fPulseProbability[cChannel] = probability ( cChannel, cCharge );
+        }
+
+        fDirty = false;
+    }
+
+    void CbcEmulator::FillEvent ( uint32_t* pWords, uint8_t pPipeline, int pTestPulseDelay, std::mt19937_64& pRandom )
+    {
+        if ( fDirty ) update();
+
+        std::memset ( pWords, 0, CBC_EVENT_SIZE_32 * sizeof ( uint32_t ) );
+        // 2 error bits, then the pipeline address, MSB first
+        pWords[0] = uint32_t ( pPipeline ) << 22;
+
+        // the group is the bit reversed lower 3 bits, see PulseShape::to_reg; group g holds the channels 16 * i + 2 * g and 16 * i + 2 * g + 1
+        bool cPulse = pTestPulseDelay >= 0 && ( ( fRegs[0][cTestPulseCtrl] >> 6 ) & 0x1 ) && pTestPulseDelay == fRegs[0][cTriggerLatency];
+        uint8_t cGroupBits = fRegs[0][cTestPulseGroup] & 0x7;
+        uint32_t cGroup = ( ( cGroupBits & 0x1 ) << 2 ) | ( cGroupBits & 0x2 ) | ( ( cGroupBits >> 2 ) & 0x1 );
+        std::uniform_real_distribution<double> cUniform ( 0, 1 );
+
+        for ( uint32_t cChannel = 0; cChannel < NCHANNELS; cChannel++ )
+        {
+            bool cInGroup = cPulse && ( ( cChannel % 16 ) / 2 == cGroup );
+            double cProbability = cInGroup ? fPulseProbability[cChannel] : fProbability[cChannel];
+
+            if ( cProbability <= 0 ) continue;
+
+            if ( cProbability < 1 && cUniform ( pRandom ) >= cProbability ) continue;
+
+            uint32_t cBit = OFFSET_CBCDATA + cChannel;
+            pWords[cBit / 32] |= 1u << ( 31 - cBit % 32 );
+        }
+    }
+}
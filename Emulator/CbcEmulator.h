@@ -0,0 +1,96 @@
+/*!
+
+        \file                   CbcEmulator.h
+        \brief                  Register model and hit generation of an emulated CBC2
+        \version                1.0
+
+ */
+
+#ifndef __CBCEMULATOR_H__
+#define __CBCEMULATOR_H__
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "../HWDescription/Definition.h"
+
+namespace Ph2_Emulator {
+
+    /*!
+     * \struct EmulatorSettings
+     * \brief Parameters of the emulated board and of its CBCs
+     */
+    struct EmulatorSettings
+    {
+        uint32_t fNCbc = 2;                 /*!< CBCs on FMC 1, the only FMC with CBCs */
+        double fTriggerRate = 1e5;          /*!< internal trigger rate in Hz while the DAQ runs, 0 fills a packet as soon as it is polled */
+        double fNoise = 2.;                 /*!< comparator noise in VCth units */
+        double fPedestalSpread = 3.;        /*!< channel to channel spread of the pedestal in VCth units */
+        double fOccupancy = 0.;             /*!< extra hit probability of unmasked channels, on top of the threshold model */
+        uint64_t fSeed = 1;                 /*!< seed of the pedestal spread and of the hits */
+        std::string fCbcFile = "settings/Cbc_default_hole.txt";   /*!< register defaults after a hard reset */
+    };
+
+    /*!
+     * \class CbcEmulator
+     * \brief One CBC2: its 2 pages of 256 registers and the comparator model deciding the hits
+     *
+     * Each channel has a level in VCth units that moves with its offset and with Vplus. In hole mode
+     * (FrontEndControl bit 6 cleared, as in Cbc_default_hole.txt) a channel fires when VCth is below its
+     * level, in electron mode when VCth is above it. Offsets of 0x00 (holes) or 0xFF (electrons) switch a
+     * channel off, as the calibration expects. The hit probability is the normal CDF of the distance to the
+     * level over the noise.
+     *
+     * A test pulse of 0.25 * TestPulsePot VCth units is added to the channels of the selected test group
+     * when the pulse is enabled in MiscTestPulseCtrl&AnalogMux and the FW sends one before the trigger.
+     */
+    class CbcEmulator
+    {
+      public:
+        CbcEmulator ( uint8_t pCbcId, const EmulatorSettings& pSettings );
+
+        /*!
+         * \brief Read the register defaults from a CBC configuration file (name page address default value)
+         */
+        void LoadDefaults ( const std::string& pFilename );
+        /*!
+         * \brief Load the defaults into the registers
+         */
+        void HardReset();
+
+        uint8_t ReadReg ( uint8_t pPage, uint8_t pAddress ) const
+        {
+            return fRegs[pPage & 0x1][pAddress];
+        }
+        void WriteReg ( uint8_t pPage, uint8_t pAddress, uint8_t pValue );
+
+        /*!
+         * \brief Write the CBC_EVENT_SIZE_32 words of one event of this CBC
+         * \param pWords : destination, CBC_EVENT_SIZE_32 words
+         * \param pPipeline : pipeline address to put in the event
+         * \param pTestPulseDelay : clock cycles from the test pulse to the trigger, negative if there was no test pulse
+         * \param pRandom : random source of the event
+         */
+        void FillEvent ( uint32_t* pWords, uint8_t pPipeline, int pTestPulseDelay, std::mt19937_64& pRandom );
+
+      private:
+        uint8_t fCbcId;
+        const EmulatorSettings& fSettings;
+        uint8_t fRegs[2][256];
+        uint8_t fDefaults[2][256];
+        std::array<double, NCHANNELS> fPedestal;        /*!< level of each channel at offset 0x50 and the reference Vplus */
+        std::array<double, NCHANNELS> fProbability;     /*!< hit probability without the test pulse */
+        std::array<double, NCHANNELS> fPulseProbability;   /*!< hit probability of the channels of the test group with the test pulse */
+        bool fDirty;                                    /*!< registers changed since the probabilities were computed */
+
+        void update();
+        double probability ( uint32_t pChannel, double pCharge ) const;
+        bool masked ( uint32_t pChannel ) const
+        {
+            return ! ( ( fRegs[0][0x20 + pChannel / 8] >> ( pChannel % 8 ) ) & 0x1 );
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,332 @@
+/*
+
+        FileName :                    ICBoardEmulator.cc
+        Content :                     Register space of a GLIB/FC7 running the IC firmware, with emulated CBCs behind it
+        Version :                     1.0
+
+ */
+
+#include "ICBoardEmulator.h"
+#include <algorithm>
+#include <cmath>
+#include "../Utils/Exception.h"
+#include "../Utils/easylogging++.h"
+
+using namespace Ph2_HwInterface;
+
+namespace Ph2_Emulator {
+
+    // daq_ctrl bits, the counter reset is 0x800 in ICGlibFWInterface and 0x8000 in the address table
+    static const uint32_t cDaqReset = 0x1;
+    static const uint32_t cDaqStart = 0x2;
+    static const uint32_t cDaqStop = 0x4;
+    static const uint32_t cCounterReset = 0x8800;
+    static const uint32_t cTriggerStart = 0x2000;
+    static const uint32_t cTriggerStop = 0x4000;
+
+    ICBoardEmulator::ICBoardEmulator ( const AddressTable& pTable, const EmulatorSettings& pSettings ) :
+        fTable ( pTable ),
+        fSettings ( pSettings ),
+        fRunning ( false ),
+        fTriggerEnabled ( false ),
+        fLastUpdate ( std::chrono::steady_clock::now() ),
+        fTriggerCarry ( 0 ),
+        fNAvailable ( 0 ),
+        fNLost ( 0 ),
+        fNL1a ( 0 ),
+        fEventCounter ( 0 ),
+        fEventWord ( 0 ),
+        fRandom ( pSettings.fSeed )
+    {
+        if ( fSettings.fNCbc == 0 || fSettings.fNCbc > 8 )
+            throw Exception ( "ICBoardEmulator: the IC firmware handles 1 to 8 CBCs per FMC" );
+
+        fDaqCtrl = fTable.getNode ( "cbc_daq_ctrl.daq_ctrl" ).fAddress;
+        fCbcCtrl = fTable.getNode ( "cbc_daq_ctrl.cbc_ctrl" ).fAddress;
+        fI2cCtrl = fTable.getNode ( "cbc_daq_ctrl.cbc_i2c_ctrl" ).fAddress;
+        fI2cCommand = fTable.getNode ( "cbc_i2c_command" ).fAddress;
+        fReply[0] = fTable.getNode ( "cbc_i2c_reply.fmc1" ).fAddress;
+        fReply[1] = fTable.getNode ( "cbc_i2c_reply.fmc2" ).fAddress;
+        fReplyStatus[0] = fTable.getNode ( "cbc_daq_ctrl.i2c_reply_fifo_fmc1_status" ).fAddress;
+        fReplyStatus[1] = fTable.getNode ( "cbc_daq_ctrl.i2c_reply_fifo_fmc2_status" ).fAddress;
+        fDataBuf = fTable.getNode ( "data_buf" ).fAddress;
+        fDataBufStatus = fTable.getNode ( "cbc_daq_ctrl.event_data_buf_status" ).fAddress;
+        fNEventsLost = fTable.getNode ( "cbc_daq_ctrl.event_data_buf_nevents_lost" ).fAddress;
+        fCntrL1a = fTable.getNode ( "cbc_daq_ctrl.cntr_l1a" ).fAddress;
+        fCntrCbcL1a = fTable.getNode ( "cbc_daq_ctrl.cntr_cbc_l1a" ).fAddress;
+        fCntrCbcEvent = fTable.getNode ( "cbc_daq_ctrl.cntr_cbcevent" ).fAddress;
+        fCapacity = std::max<uint64_t> ( fTable.getNode ( "data_buf" ).fSize / getEventSize32(), 1 );
+
+        // what ConfigureBoard reads to learn the configuration
+        setField ( "sys_regs.board_id", ( 'E' << 24 ) | ( 'M' << 16 ) | ( 'U' << 8 ) | 'L' );
+        setField ( "user_stat.version.ver_major", 1 );
+        setField ( "user_stat.version.ver_minor", 0 );
+        setField ( "user_stat.fw_cnfg.fmc_cnfg.ncbc_per_fmc", fSettings.fNCbc );
+        setField ( "user_stat.fw_cnfg.fmc_cnfg.fmc1_cbc_en", ( 1 << fSettings.fNCbc ) - 1 );
+        setField ( "user_stat.fw_cnfg.data_size32.evt_header", EVENT_HEADER_SIZE_32 );
+        setField ( "user_stat.fw_cnfg.data_size32.evt_trailer", 1 );
+        setField ( "user_stat.fw_cnfg.data_size32.evt_cbcdata_perfmc", fSettings.fNCbc * CBC_EVENT_SIZE_32 );
+        setField ( "user_stat.fw_cnfg.data_size32.evt_total", getEventSize32() );
+        setField ( "cbc_daq_ctrl.nevents_per_pcdaq", 100 );
+
+        fCbcs.reserve ( fSettings.fNCbc );
+
+        for ( uint32_t cCbcId = 0; cCbcId < fSettings.fNCbc; cCbcId++ )
+        {
+            fCbcs.emplace_back ( cCbcId, fSettings );
+            fCbcs.back().LoadDefaults ( fSettings.fCbcFile );
+        }
+    }
+
+    uint32_t ICBoardEmulator::getField ( const std::string& pPath ) const
+    {
+        const AddressEntry& cEntry = fTable.getNode ( pPath );
+        auto cWord = fMemory.find ( cEntry.fAddress );
+        uint32_t cValue = ( cWord != fMemory.end() ) ? cWord->second : 0;
+        return ( cValue & cEntry.fMask ) >> cEntry.Shift();
+    }
+
+    void ICBoardEmulator::setField ( const std::string& pPath, uint32_t pValue )
+    {
+        const AddressEntry& cEntry = fTable.getNode ( pPath );
+        uint32_t& cWord = fMemory[cEntry.fAddress];
+        cWord = ( cWord & ~cEntry.fMask ) | ( ( pValue << cEntry.Shift() ) & cEntry.fMask );
+    }
+
+    uint32_t ICBoardEmulator::nEventsPerPacket() const
+    {
+        auto cWord = fMemory.find ( fTable.getNode ( "cbc_daq_ctrl.nevents_per_pcdaq" ).fAddress );
+        return ( cWord != fMemory.end() && cWord->second > 0 ) ? cWord->second : 1;
+    }
+
+    uint32_t ICBoardEmulator::Read ( uint32_t pAddress )
+    {
+        advanceTriggers();
+
+        if ( pAddress == fDataBuf )
+        {
+            if ( fEventWord >= fEvent.size() ) nextEvent();
+
+            return fEvent[fEventWord++];
+        }
+
+        for ( int cFmc = 0; cFmc < 2; cFmc++ )
+        {
+            if ( pAddress == fReply[cFmc] )
+            {
+                if ( fReplies[cFmc].empty() ) return 0;
+
+                uint32_t cReply = fReplies[cFmc].front();
+                fReplies[cFmc].pop_front();
+                return cReply;
+            }
+            else if ( pAddress == fReplyStatus[cFmc] )
+            {
+                uint32_t cNReplies = std::min<size_t> ( fReplies[cFmc].size(), 0x7FF );
+                return ( cNReplies << 8 ) | ( fReplies[cFmc].empty() ? 0x1 : 0x0 );
+            }
+        }
+
+        if ( pAddress == fDataBufStatus )
+        {
+            uint32_t cNEvents = nEventsPerPacket();
+            bool cReady = fNAvailable >= cNEvents;
+            return ( cReady ? 0x1 : 0x0 ) | ( fNAvailable >= fCapacity ? 0x4 : 0x0 ) | ( std::min<uint64_t> ( fNAvailable, 0xFFFF ) << 16 );
+        }
+        else if ( pAddress == fNEventsLost ) return fNLost;
+        else if ( pAddress == fCntrL1a || pAddress == fCntrCbcL1a ) return fNL1a;
+        else if ( pAddress == fCntrCbcEvent ) return fEventCounter;
+
+        auto cWord = fMemory.find ( pAddress );
+        return ( cWord != fMemory.end() ) ? cWord->second : 0;
+    }
+
+    void ICBoardEmulator::Write ( uint32_t pAddress, uint32_t pValue )
+    {
+        advanceTriggers();
+
+        // the control registers are auto clearing
+        if ( pAddress == fDaqCtrl ) daqCommand ( pValue );
+        else if ( pAddress == fCbcCtrl ) cbcCommand ( pValue );
+        else if ( pAddress == fI2cCtrl ) i2cControl ( pValue );
+        else if ( pAddress == fI2cCommand ) i2cCommand ( pValue );
+        else fMemory[pAddress] = pValue;
+    }
+
+    void ICBoardEmulator::advanceTriggers()
+    {
+        auto cNow = std::chrono::steady_clock::now();
+
+        if ( fRunning && fTriggerEnabled )
+        {
+            if ( fSettings.fTriggerRate <= 0 )
+            {
+                // unlimited rate: the buffer is full whenever someone looks
+                if ( fNAvailable < fCapacity ) addTriggers ( fCapacity - fNAvailable );
+            }
+            else
+            {
+                double cTriggers = std::chrono::duration<double> ( cNow - fLastUpdate ).count() * fSettings.fTriggerRate + fTriggerCarry;
+                double cWhole = std::floor ( cTriggers );
+                fTriggerCarry = cTriggers - cWhole;
+                addTriggers ( static_cast<uint64_t> ( cWhole ) );
+            }
+        }
+
+        fLastUpdate = cNow;
+    }
+
+    void ICBoardEmulator::addTriggers ( uint64_t pNTriggers )
+    {
+        fNL1a += pNTriggers;
+        fNAvailable += pNTriggers;
+
+        if ( fNAvailable > fCapacity )
+        {
+            fNLost += fNAvailable - fCapacity;
+            fNAvailable = fCapacity;
+        }
+    }
+
+    void ICBoardEmulator::nextEvent()
+    {
+        if ( fNAvailable > 0 ) fNAvailable--;
+
+        fEvent.assign ( getEventSize32(), 0 );
+        fEventWord = 0;
+
+        uint32_t cCount = fEventCounter & 0x00FFFFFF;
+        fEvent[0] = static_cast<uint32_t> ( fNL1a * 3564 ) & 0x00FFFFFF;     // bunch
+        fEvent[1] = static_cast<uint32_t> ( fNL1a / 3564 ) & 0x00FFFFFF;     // orbit
+        fEvent[2] = 0;                                                      // lumi
+        fEvent[3] = cCount;
+        fEvent[4] = cCount;
+
+        // the pulse reaches the CBC pipeline l1a_trigger_count - test_pulse_count - 1 clocks before the trigger
+        int cTestPulseDelay = -1;
+
+        if ( getField ( "cbc_daq_ctrl.commissioning_cycle.mode_flags.test_pulse_enable" ) )
+        {
+            int cDelay = int ( getField ( "cbc_daq_ctrl.commissioning_cycle.l1a_trigger_count" ) ) - int ( getField ( "cbc_daq_ctrl.commissioning_cycle.test_pulse_count" ) ) - 1;
+
+            if ( cDelay >= 0 ) cTestPulseDelay = cDelay;
+        }
+
+        for ( uint32_t cCbcId = 0; cCbcId < fCbcs.size(); cCbcId++ )
+            fCbcs[cCbcId].FillEvent ( &fEvent[EVENT_HEADER_SIZE_32 + cCbcId * CBC_EVENT_SIZE_32], fEventCounter & 0xFF, cTestPulseDelay, fRandom );
+
+        fEvent.back() = fRandom() & 0x7;        // TDC phase
+        fEventCounter++;
+    }
+
+    void ICBoardEmulator::daqCommand ( uint32_t pBits )
+    {
+        if ( pBits & cDaqReset )
+        {
+            fRunning = false;
+            fNAvailable = 0;
+            fNLost = 0;
+            fEvent.clear();
+            fEventWord = 0;
+            fTriggerCarry = 0;
+        }
+
+        if ( pBits & cCounterReset )
+        {
+            fNL1a = 0;
+            fEventCounter = 0;
+        }
+
+        if ( pBits & cDaqStart )
+        {
+            fRunning = true;
+            fTriggerEnabled = true;
+            fTriggerCarry = 0;
+        }
+
+        if ( pBits & cTriggerStart ) fTriggerEnabled = true;
+
+        if ( pBits & cTriggerStop ) fTriggerEnabled = false;
+
+        if ( pBits & cDaqStop )
+        {
+            // a partly filled packet is dropped, complete packets can still be read
+            fRunning = false;
+            fNAvailable -= fNAvailable % nEventsPerPacket();
+        }
+
+        LOG (DEBUG) << "ICBoardEmulator: daq_ctrl 0x" << std::hex << pBits << std::dec << ", running " << fRunning << ", " << fNAvailable << " events buffered" ;
+    }
+
+    void ICBoardEmulator::cbcCommand ( uint32_t pBits )
+    {
+        if ( pBits & 0x1 )
+        {
+            for ( auto& cCbc : fCbcs )
+                cCbc.HardReset();
+        }
+
+        // single L1A
+        if ( pBits & 0x10 ) addTriggers ( 1 );
+    }
+
+    void ICBoardEmulator::i2cControl ( uint32_t pBits )
+    {
+        if ( pBits & 0x3 )
+        {
+            fReplies[0].clear();
+            fReplies[1].clear();
+        }
+
+        // after an I2C reset every CBC answers with its I2C address, which ConfigureBoard takes as a ping
+        if ( pBits & 0x1 )
+        {
+            for ( uint32_t cCbcId = 0; cCbcId < fCbcs.size(); cCbcId++ )
+                fReplies[0].push_back ( ( cCbcId << 24 ) | ( 0x41 + cCbcId ) );
+        }
+    }
+
+    void ICBoardEmulator::i2cCommand ( uint32_t pWord )
+    {
+        // same layout as ICGlibFWInterface::EncodeReg
+        uint32_t cFmc = ( pWord >> 28 ) & 0xF;
+        uint32_t cCbcId = ( pWord >> 24 ) & 0xF;
+        bool cRead = ( pWord >> 21 ) & 0x1;
+        bool cWrite = ( pWord >> 20 ) & 0x1;
+        uint8_t cPage = ( pWord >> 16 ) & 0x1;
+        uint8_t cAddress = ( pWord >> 8 ) & 0xFF;
+        uint8_t cValue = pWord & 0xFF;
+        std::deque<uint32_t>& cReplies = fReplies[ ( cFmc == 2 ) ? 1 : 0];
+        uint32_t cItem = ( cPage << 16 ) | ( cAddress << 8 );
+
+        // the CBC Id equal to the number of CBCs is the broadcast address
+        uint32_t cFirst = cCbcId, cLast = cCbcId + 1;
+
+        if ( cCbcId == fCbcs.size() )
+        {
+            cFirst = 0;
+            cLast = fCbcs.size();
+        }
+
+        if ( cFmc != 1 || cLast > fCbcs.size() || ( !cRead && !cWrite ) )
+        {
+            // nobody acknowledges
+            cReplies.push_back ( ( cCbcId << 24 ) | ( 1 << 20 ) | cItem | cValue );
+            return;
+        }
+
+        for ( uint32_t cId = cFirst; cId < cLast; cId++ )
+        {
+            CbcEmulator& cCbc = fCbcs[cId];
+
+            if ( cWrite )
+            {
+                cCbc.WriteReg ( cPage, cAddress, cValue );
+                cReplies.push_back ( ( cId << 24 ) | cItem | cValue );
+            }
+
+            if ( cRead )
+                cReplies.push_back ( ( cId << 24 ) | ( 1 << 17 ) | cItem | cCbc.ReadReg ( cPage, cAddress ) );
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*!
+
+        \file                   ICBoardEmulator.h
+        \brief                  Register space of a GLIB/FC7 running the IC firmware, with emulated CBCs behind it
+        \version                1.0
+
+ */
+
+#ifndef __ICBOARDEMULATOR_H__
+#define __ICBOARDEMULATOR_H__
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "AddressTable.h"
+#include "CbcEmulator.h"
+
+namespace Ph2_Emulator {
+
+    /*!
+     * \class ICBoardEmulator
+     * \brief Answers the register accesses of ICGlibFWInterface and ICFc7FWInterface like the IC firmware
+     *
+     * Plain registers are kept in memory. The following nodes of the address table behave like the FW:
+     * - cbc_daq_ctrl.daq_ctrl: reset, start, stop, counter reset, trigger start/stop of the DAQ.
+     *   While the DAQ runs, triggers arrive at the configured rate.
+     * - cbc_daq_ctrl.event_data_buf_status.data_ready: set once nevents_per_pcdaq events are buffered.
+     * - data_buf: FIFO of the buffered events, they are generated by the CBCs when they are read.
+     * - cbc_i2c_command: executes I2C commands on the CBCs.
+     * - cbc_i2c_reply.fmcN and cbc_daq_ctrl.i2c_reply_fifo_fmcN_status: reply FIFOs with their fill level.
+     * - cbc_daq_ctrl.cbc_i2c_ctrl: reset of the I2C, which makes every CBC answer a ping, and of the reply FIFOs.
+     * - cbc_daq_ctrl.cbc_ctrl: CBC hard reset and single L1A.
+     * The user_stat.fw_cnfg and version registers describe the emulated configuration.
+     */
+    class ICBoardEmulator
+    {
+      public:
+        ICBoardEmulator ( const AddressTable& pTable, const EmulatorSettings& pSettings );
+
+        uint32_t Read ( uint32_t pAddress );
+        void Write ( uint32_t pAddress, uint32_t pValue );
+
+        /*!
+         * \brief 32 bit words of one event: header, CBC_EVENT_SIZE_32 per CBC and the TDC word
+         */
+        uint32_t getEventSize32() const
+        {
+            return EVENT_HEADER_SIZE_32 + fSettings.fNCbc * CBC_EVENT_SIZE_32 + 1;
+        }
+        uint64_t getNTriggers() const
+        {
+            return fNL1a;
+        }
+
+      private:
+        const AddressTable& fTable;
+        EmulatorSettings fSettings;
+        std::vector<CbcEmulator> fCbcs;
+        std::unordered_map<uint32_t, uint32_t> fMemory;
+
+        // addresses with a FW behaviour
+        uint32_t fDaqCtrl;
+        uint32_t fCbcCtrl;
+        uint32_t fI2cCtrl;
+        uint32_t fI2cCommand;
+        uint32_t fReply[2];
+        uint32_t fReplyStatus[2];
+        uint32_t fDataBuf;
+        uint32_t fDataBufStatus;
+        uint32_t fNEventsLost;
+        uint32_t fCntrL1a;
+        uint32_t fCntrCbcL1a;
+        uint32_t fCntrCbcEvent;
+
+        std::deque<uint32_t> fReplies[2];       /*!< I2C reply FIFOs of FMC 1 and 2 */
+
+        bool fRunning;
+        bool fTriggerEnabled;
+        std::chrono::steady_clock::time_point fLastUpdate;
+        double fTriggerCarry;                   /*!< fraction of a trigger left over by the last update */
+        uint64_t fNAvailable;                   /*!< events buffered and not read yet */
+        uint64_t fNLost;
+        uint64_t fNL1a;
+        uint32_t fEventCounter;
+        uint64_t fCapacity;                     /*!< events that fit into data_buf */
+        std::vector<uint32_t> fEvent;           /*!< event being read from data_buf */
+        size_t fEventWord;                      /*!< next word of fEvent to read */
+        std::mt19937_64 fRandom;
+
+        uint32_t getField ( const std::string& pPath ) const;
+        void setField ( const std::string& pPath, uint32_t pValue );
+        uint32_t nEventsPerPacket() const;
+        /*!
+         * \brief Account the triggers that arrived since the last access
+         */
+        void advanceTriggers();
+        void addTriggers ( uint64_t pNTriggers );
+        void nextEvent();
+        void daqCommand ( uint32_t pBits );
+        void cbcCommand ( uint32_t pBits );
+        void i2cControl ( uint32_t pBits );
+        void i2cCommand ( uint32_t pWord );
+    };
+}
+
+#endif
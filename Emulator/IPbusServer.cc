@@ -0,0 +1,305 @@
+/*
+
+        FileName :                    IPbusServer.cc
+        Content :                     IPbus 2.0 UDP endpoint in front of the board emulator
+        Version :                     1.0
+
+ */
+
+#include "IPbusServer.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../Utils/Exception.h"
+#include "../Utils/easylogging++.h"
+
+using namespace Ph2_HwInterface;
+
+namespace Ph2_Emulator {
+
+    // IPbus 2.0 packet types
+    static const uint32_t cControlPacket = 0x0;
+    static const uint32_t cStatusPacket = 0x1;
+    static const uint32_t cResendPacket = 0x2;
+
+    // IPbus 2.0 transaction types
+    static const uint32_t cRead = 0x0;
+    static const uint32_t cWrite = 0x1;
+    static const uint32_t cNonIncrementalRead = 0x2;
+    static const uint32_t cNonIncrementalWrite = 0x3;
+    static const uint32_t cRMWBits = 0x4;
+    static const uint32_t cRMWSum = 0x5;
+    static const uint32_t cConfigRead = 0x6;
+
+    // transaction info codes
+    static const uint32_t cSuccess = 0x0;
+    static const uint32_t cBadHeader = 0x1;
+    static const uint32_t cRequest = 0xF;
+
+    static bool isPacketHeader ( uint32_t pWord )
+    {
+        return ( pWord >> 28 ) == 2 && ( ( pWord >> 4 ) & 0xF ) == 0xF;
+    }
+
+    IPbusServer::IPbusServer ( ICBoardEmulator& pBoard, uint16_t pPort ) :
+        fBoard ( pBoard ),
+        fSocket ( -1 ),
+        fNextId ( 1 ),
+        fNPackets ( 0 ),
+        fNTransactions ( 0 )
+    {
+        fSocket = socket ( AF_INET, SOCK_DGRAM, 0 );
+
+        if ( fSocket < 0 )
+            throw Exception ( ( std::string ( "IPbusServer: can not create the socket: " ) + strerror ( errno ) ).c_str() );
+
+        sockaddr_in cAddress;
+        memset ( &cAddress, 0, sizeof ( cAddress ) );
+        cAddress.sin_family = AF_INET;
+        cAddress.sin_addr.s_addr = htonl ( INADDR_ANY );
+        cAddress.sin_port = htons ( pPort );
+
+        if ( bind ( fSocket, reinterpret_cast<sockaddr*> ( &cAddress ), sizeof ( cAddress ) ) < 0 )
+        {
+            std::string cError = "IPbusServer: can not bind port " + std::to_string ( pPort ) + ": " + strerror ( errno );
+            close ( fSocket );
+            throw Exception ( cError.c_str() );
+        }
+    }
+
+    IPbusServer::~IPbusServer()
+    {
+        if ( fSocket >= 0 ) close ( fSocket );
+    }
+
+    void IPbusServer::Run ( const std::atomic<bool>& pStop )
+    {
+        std::vector<uint32_t> cBuffer ( 16384 );
+        std::vector<uint32_t> cRequest;
+
+        while ( !pStop.load() )
+        {
+            pollfd cPoll = { fSocket, POLLIN, 0 };
+            int cReady = poll ( &cPoll, 1, 100 );
+
+            if ( cReady < 0 && errno != EINTR )
+                throw Exception ( ( std::string ( "IPbusServer: poll failed: " ) + strerror ( errno ) ).c_str() );
+
+            if ( cReady <= 0 ) continue;
+
+            sockaddr_in cClient;
+            socklen_t cClientSize = sizeof ( cClient );
+            ssize_t cNBytes = recvfrom ( fSocket, cBuffer.data(), cBuffer.size() * sizeof ( uint32_t ), 0, reinterpret_cast<sockaddr*> ( &cClient ), &cClientSize );
+
+            if ( cNBytes < 0 )
+            {
+                if ( errno == EINTR ) continue;
+
+                throw Exception ( ( std::string ( "IPbusServer: receive failed: " ) + strerror ( errno ) ).c_str() );
+            }
+
+            cRequest.assign ( cBuffer.begin(), cBuffer.begin() + cNBytes / sizeof ( uint32_t ) );
+            std::vector<uint32_t> cReply = HandlePacket ( cRequest );
+
+            if ( !cReply.empty() )
+                sendto ( fSocket, cReply.data(), cReply.size() * sizeof ( uint32_t ), 0, reinterpret_cast<sockaddr*> ( &cClient ), cClientSize );
+        }
+    }
+
+    std::vector<uint32_t> IPbusServer::HandlePacket ( const std::vector<uint32_t>& pRequest )
+    {
+        if ( pRequest.empty() ) return std::vector<uint32_t>();
+
+        // the byte order qualifier of the packet header tells whether the client uses the other byte order
+        bool cSwap = !isPacketHeader ( pRequest.front() );
+
+        if ( cSwap && !isPacketHeader ( __builtin_bswap32 ( pRequest.front() ) ) )
+        {
+            LOG (DEBUG) << "IPbusServer: dropping a packet with the header 0x" << std::hex << pRequest.front() << std::dec ;
+            return std::vector<uint32_t>();
+        }
+
+        std::vector<uint32_t> cRequest = pRequest;
+
+        if ( cSwap )
+        {
+            for ( auto& cWord : cRequest )
+                cWord = __builtin_bswap32 ( cWord );
+        }
+
+        uint32_t cHeader = cRequest.front();
+        uint16_t cId = ( cHeader >> 8 ) & 0xFFFF;
+        std::vector<uint32_t> cReply;
+        fNPackets++;
+
+        switch ( cHeader & 0xF )
+        {
+            case cControlPacket:
+
+                // ID 0 is outside of the reliability mechanism
+                if ( cId == 0 ) cReply = control ( cRequest );
+                else if ( cId == fNextId )
+                {
+                    cReply = control ( cRequest );
+                    fReplies[cId] = cReply;
+                    fReplyIds.push_back ( cId );
+
+                    if ( fReplyIds.size() > fNBuffers )
+                    {
+                        fReplies.erase ( fReplyIds.front() );
+                        fReplyIds.pop_front();
+                    }
+
+                    fNextId = ( fNextId == 0xFFFF ) ? 1 : fNextId + 1;
+                }
+                else
+                {
+                    // a duplicate is answered from the buffer, anything else is dropped
+                    auto cBuffered = fReplies.find ( cId );
+
+                    if ( cBuffered != fReplies.end() ) cReply = cBuffered->second;
+                }
+
+                break;
+
+            case cStatusPacket:
+                cReply = status ( cRequest );
+                break;
+
+            case cResendPacket:
+            {
+                auto cBuffered = fReplies.find ( cId );
+
+                if ( cBuffered != fReplies.end() ) cReply = cBuffered->second;
+
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if ( cSwap )
+        {
+            for ( auto& cWord : cReply )
+                cWord = __builtin_bswap32 ( cWord );
+        }
+
+        return cReply;
+    }
+
+    std::vector<uint32_t> IPbusServer::control ( const std::vector<uint32_t>& pRequest )
+    {
+        std::vector<uint32_t> cReply;
+        cReply.push_back ( pRequest.front() );
+        size_t cIndex = 1;
+
+        while ( cIndex < pRequest.size() )
+            cIndex = transaction ( pRequest, cIndex, cReply );
+
+        return cReply;
+    }
+
+    std::vector<uint32_t> IPbusServer::status ( const std::vector<uint32_t>& pRequest ) const
+    {
+        // header, MTU, number of buffers, next expected header, then the traffic history which is not kept
+        std::vector<uint32_t> cReply ( 16, 0 );
+        cReply[0] = pRequest.front();
+        cReply[1] = fMTU;
+        cReply[2] = fNBuffers;
+        cReply[3] = ( 2 << 28 ) | ( uint32_t ( fNextId ) << 8 ) | 0xF0;
+        return cReply;
+    }
+
+    size_t IPbusServer::transaction ( const std::vector<uint32_t>& pRequest, size_t pIndex, std::vector<uint32_t>& pReply )
+    {
+        uint32_t cHeader = pRequest.at ( pIndex );
+        uint32_t cNWords = ( cHeader >> 8 ) & 0xFF;
+        uint32_t cType = ( cHeader >> 4 ) & 0xF;
+        uint32_t cReplyHeader = cHeader & 0xFFFFFFF0;
+        size_t cSize = pRequest.size();
+
+        // the number of words that follow the header
+        size_t cNBody = 0;
+
+        switch ( cType )
+        {
+            case cRead:
+            case cNonIncrementalRead:
+            case cConfigRead:
+                cNBody = 1;
+                break;
+
+            case cWrite:
+            case cNonIncrementalWrite:
+                cNBody = 1 + cNWords;
+                break;
+
+            case cRMWBits:
+                cNBody = 3;
+                break;
+
+            case cRMWSum:
+                cNBody = 2;
+                break;
+
+            default:
+                cNBody = cSize;
+                break;
+        }
+
+        if ( ( cHeader >> 28 ) != 2 || ( cHeader & 0xF ) != cRequest || pIndex + 1 + cNBody > cSize )
+        {
+            // the rest of the packet can not be trusted
+            pReply.push_back ( cReplyHeader | cBadHeader );
+            return cSize;
+        }
+
+        fNTransactions++;
+        uint32_t cAddress = pRequest[pIndex + 1];
+        pReply.push_back ( cReplyHeader | cSuccess );
+
+        switch ( cType )
+        {
+            case cRead:
+            case cNonIncrementalRead:
+                for ( uint32_t cWord = 0; cWord < cNWords; cWord++ )
+                    pReply.push_back ( fBoard.Read ( ( cType == cRead ) ? cAddress + cWord : cAddress ) );
+
+                break;
+
+            case cWrite:
+            case cNonIncrementalWrite:
+                for ( uint32_t cWord = 0; cWord < cNWords; cWord++ )
+                    fBoard.Write ( ( cType == cWrite ) ? cAddress + cWord : cAddress, pRequest[pIndex + 2 + cWord] );
+
+                break;
+
+            case cRMWBits:
+            {
+                uint32_t cValue = fBoard.Read ( cAddress );
+                fBoard.Write ( cAddress, ( cValue & pRequest[pIndex + 2] ) | pRequest[pIndex + 3] );
+                pReply.push_back ( cValue );
+                break;
+            }
+
+            case cRMWSum:
+            {
+                uint32_t cValue = fBoard.Read ( cAddress );
+                fBoard.Write ( cAddress, cValue + pRequest[pIndex + 2] );
+                pReply.push_back ( cValue );
+                break;
+            }
+
+            case cConfigRead:
+                pReply.insert ( pReply.end(), cNWords, 0 );
+                break;
+        }
+
+        return pIndex + 1 + cNBody;
+    }
+}
@@ -0,0 +1,81 @@
+/*!
+
+        \file                   IPbusServer.h
+        \brief                  IPbus 2.0 UDP endpoint in front of the board emulator
+        \version                1.0
+
+ */
+
+#ifndef __IPBUSSERVER_H__
+#define __IPBUSSERVER_H__
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+#include "ICBoardEmulator.h"
+
+namespace Ph2_Emulator {
+
+    /*!
+     * \class IPbusServer
+     * \brief Serves the IPbus 2.0 UDP protocol of uHAL (ipbusudp-2.0://) on top of an ICBoardEmulator
+     *
+     * Control packets carry read, write, non-incremental read/write and read-modify-write transactions,
+     * status packets report the next expected packet ID and resend requests repeat one of the last
+     * fNBuffers replies, so uHAL's packet loss recovery works. The byte order of every packet is taken
+     * from its header and used for the reply. One thread serves one client at a time.
+     */
+    class IPbusServer
+    {
+      public:
+        /*!
+         * \brief Bind a UDP socket on pPort of all interfaces, throws an Exception if that fails
+         */
+        IPbusServer ( ICBoardEmulator& pBoard, uint16_t pPort );
+        ~IPbusServer();
+        IPbusServer ( const IPbusServer& ) = delete;
+        IPbusServer& operator= ( const IPbusServer& ) = delete;
+
+        /*!
+         * \brief Serve packets until pStop becomes true, it is checked every 100 ms
+         */
+        void Run ( const std::atomic<bool>& pStop );
+        /*!
+         * \brief Answer one request packet, the reply is empty if nothing has to be sent back
+         */
+        std::vector<uint32_t> HandlePacket ( const std::vector<uint32_t>& pRequest );
+
+        uint64_t getNPackets() const
+        {
+            return fNPackets;
+        }
+        uint64_t getNTransactions() const
+        {
+            return fNTransactions;
+        }
+
+      private:
+        static const uint32_t fNBuffers = 16;      /*!< replies kept for resend requests */
+        static const uint32_t fMTU = 1500;
+
+        ICBoardEmulator& fBoard;
+        int fSocket;
+        uint16_t fNextId;                          /*!< packet ID expected next, 0 is never used */
+        std::map<uint16_t, std::vector<uint32_t>> fReplies;   /*!< last replies by packet ID */
+        std::deque<uint16_t> fReplyIds;            /*!< IDs of fReplies, oldest first */
+        uint64_t fNPackets;
+        uint64_t fNTransactions;
+
+        std::vector<uint32_t> control ( const std::vector<uint32_t>& pRequest );
+        std::vector<uint32_t> status ( const std::vector<uint32_t>& pRequest ) const;
+        /*!
+         * \brief Execute the transaction starting at word pIndex of pRequest and append its reply
+         * \return the index of the next transaction, pRequest.size() to stop
+         */
+        size_t transaction ( const std::vector<uint32_t>& pRequest, size_t pIndex, std::vector<uint32_t>& pReply );
+    };
+}
+
+#endif
@@ -16,14 +16,22 @@
 #include <iostream>
 #include <string.h>
 #include <iomanip>
+#include <algorithm>
 #include "Definition.h"
 
 
 namespace Ph2_HwDescription {
+    const uint16_t Cbc::cHwUnknown;
+
     // C'tors with object FE Description
 
     Cbc::Cbc ( const FrontEndDescription& pFeDesc, uint8_t pCbcId, const std::string& filename ) : FrontEndDescription ( pFeDesc ),
-        fCbcId ( pCbcId )
+        fCbcId ( pCbcId ),
+        fRegTable ( CbcReg::NRegisters ),
+        fRegLoaded ( CbcReg::NRegisters, false ),
+        fNRegs ( 0 ),
+        fHwRegTable ( CbcReg::NRegisters, cHwUnknown ),
+        fStagedRegs ( CbcReg::NRegisters, false )
 
     {
         loadfRegMap ( filename );
@@ -31,7 +39,12 @@ namespace Ph2_HwDescription {
 
     // C'tors which take BeId, FMCId, FeID, CbcId
 
-    Cbc::Cbc ( uint8_t pBeId, uint8_t pFMCId, uint8_t pFeId, uint8_t pCbcId, const std::string& filename ) : FrontEndDescription ( pBeId, pFMCId, pFeId ), fCbcId ( pCbcId )
+    Cbc::Cbc ( uint8_t pBeId, uint8_t pFMCId, uint8_t pFeId, uint8_t pCbcId, const std::string& filename ) : FrontEndDescription ( pBeId, pFMCId, pFeId ), fCbcId ( pCbcId ),
+        fRegTable ( CbcReg::NRegisters ),
+        fRegLoaded ( CbcReg::NRegisters, false ),
+        fNRegs ( 0 ),
+        fHwRegTable ( CbcReg::NRegisters, cHwUnknown ),
+        fStagedRegs ( CbcReg::NRegisters, false )
 
     {
         loadfRegMap ( filename );
@@ -41,7 +54,11 @@ namespace Ph2_HwDescription {
 
     Cbc::Cbc ( const Cbc& cbcobj ) : FrontEndDescription ( cbcobj ),
         fCbcId ( cbcobj.fCbcId ),
-        fRegMap ( cbcobj.fRegMap )
+        fRegTable ( cbcobj.fRegTable ),
+        fRegLoaded ( cbcobj.fRegLoaded ),
+        fNRegs ( cbcobj.fNRegs ),
+        fHwRegTable ( cbcobj.fHwRegTable ),
+        fStagedRegs ( cbcobj.fStagedRegs )
     {
     }
 
@@ -78,7 +95,18 @@ namespace Ph2_HwDescription {
                 fRegItem.fDefValue = strtoul ( fDefValue_str.c_str(), 0, 16 );
                 fRegItem.fValue = strtoul ( fValue_str.c_str(), 0, 16 );
 
-                fRegMap[fName] = fRegItem;
+                uint16_t cRegId = CbcReg::Id ( fName );
+
+                if ( cRegId == CbcReg::NRegisters )
+                {
+                    LOG (ERROR) << "The CBC Settings File " << filename << " contains the unknown register " << fName << ", ignoring it!" ;
+                    continue;
+                }
+
+                if ( !fRegLoaded[cRegId] ) fNRegs++;
+
+                fRegTable[cRegId] = fRegItem;
+                fRegLoaded[cRegId] = true;
             }
 
             file.close();
@@ -91,44 +119,91 @@ namespace Ph2_HwDescription {
     }
 
 
-    uint8_t Cbc::getReg ( const std::string& pReg ) const
+    uint8_t Cbc::missingReg ( uint16_t pRegId ) const
+    {
+        if ( pRegId < CbcReg::NRegisters )
+            LOG (INFO) << "The Cbc object: " << +fCbcId << " doesn't have " << CbcReg::Name ( pRegId ) ;
+        else
+            LOG (INFO) << "The Cbc object: " << +fCbcId << " doesn't have the requested register" ;
+
+        return 0;
+    }
+
+    void Cbc::setAllHwRegs() const
+    {
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+            fHwRegTable[cRegId] = fRegTable[cRegId].fValue;
+
+        std::fill ( fStagedRegs.begin(), fStagedRegs.end(), false );
+    }
+
+    void Cbc::clearHwRegs() const
+    {
+        std::fill ( fHwRegTable.begin(), fHwRegTable.end(), cHwUnknown );
+    }
+
+    CbcRegIdVector Cbc::getDirtyRegs() const
     {
-        CbcRegMap::const_iterator i = fRegMap.find ( pReg );
+        CbcRegIdVector cDirty;
 
-        if ( i == fRegMap.end() )
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
         {
-            LOG (INFO) << "The Cbc object: " << +fCbcId << " doesn't have " << pReg ;
-            return 0;
+            if ( fRegLoaded[cRegId] && fHwRegTable[cRegId] != fRegTable[cRegId].fValue )
+                cDirty.push_back ( {cRegId, fRegTable[cRegId].fValue} );
         }
-        else
-            return i->second.fValue;
-    }
 
+        return cDirty;
+    }
 
-    void Cbc::setReg ( const std::string& pReg, uint8_t psetValue )
+    uint16_t Cbc::clearStagedRegs() const
     {
-        CbcRegMap::iterator i = fRegMap.find ( pReg );
+        uint16_t cNUnchanged = 0;
 
-        if ( i == fRegMap.end() )
-            LOG (INFO) << "The Cbc object: " << +fCbcId << " doesn't have " << pReg ;
-        else
-            i->second.fValue = psetValue;
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+        {
+            if ( fStagedRegs[cRegId] && !isDirty ( cRegId ) ) cNUnchanged++;
+
+            fStagedRegs[cRegId] = false;
+        }
+
+        return cNUnchanged;
     }
 
     CbcRegItem Cbc::getRegItem ( const std::string& pReg )
     {
-        CbcRegItem cItem;
-        CbcRegMap::iterator i = fRegMap.find ( pReg );
+        uint16_t cRegId = CbcReg::Id ( pReg );
 
-        if ( i != std::end ( fRegMap ) ) return ( i->second );
+        if ( hasReg ( cRegId ) ) return fRegTable[cRegId];
         else
         {
             LOG (ERROR) << "Error, no Register " << pReg << " found in the RegisterMap of CBC " << +fCbcId << "!" ;
             throw Exception ( "Cbc: no matching register found" );
-            return cItem;
         }
     }
 
+    const CbcRegItem& Cbc::getRegItem ( uint16_t pRegId ) const
+    {
+        if ( hasReg ( pRegId ) ) return fRegTable[pRegId];
+        else
+        {
+            LOG (ERROR) << "Error, no Register " << CbcReg::Name ( pRegId ) << " found in the RegisterMap of CBC " << +fCbcId << "!" ;
+            throw Exception ( "Cbc: no matching register found" );
+        }
+    }
+
+    CbcRegMap Cbc::getRegMap() const
+    {
+        CbcRegMap cRegMap;
+
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+        {
+            if ( fRegLoaded[cRegId] )
+                cRegMap[CbcReg::Name ( cRegId )] = fRegTable[cRegId];
+        }
+
+        return cRegMap;
+    }
+
 
     //Write RegValues in a file
 
@@ -151,8 +226,11 @@ namespace Ph2_HwDescription {
 
             std::set<CbcRegPair, RegItemComparer> fSetRegItem;
 
-            for ( auto& it : fRegMap )
-                fSetRegItem.insert ( {it.first, it.second} );
+            for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+            {
+                if ( fRegLoaded[cRegId] )
+                    fSetRegItem.insert ( {CbcReg::Name ( cRegId ), fRegTable[cRegId]} );
+            }
 
             for ( const auto& v : fSetRegItem )
             {
@@ -15,6 +15,7 @@
 
 #include "FrontEndDescription.h"
 #include "CbcRegItem.h"
+#include "CbcRegisters.h"
 #include "../Utils/Visitor.h"
 #include "../Utils/Exception.h"
 #include "../Utils/easylogging++.h"
@@ -24,6 +25,7 @@
 #include <stdint.h>
 #include <utility>
 #include <set>
+#include <vector>
 
 // Cbc2 Chip HW Description Class
 
@@ -36,6 +38,7 @@ namespace Ph2_HwDescription {
 
     using CbcRegMap = std::map < std::string, CbcRegItem >;
     using CbcRegPair = std::pair <std::string, CbcRegItem>;
+    using CbcRegIdVector = std::vector< std::pair<uint16_t, uint8_t> >;    /*!< pairs of register ID (see CbcRegisters.h) and value */
 
     /*!
      * \class Cbc
@@ -83,13 +86,101 @@ namespace Ph2_HwDescription {
         * \param pReg
         * \return The value of the register
         */
-        uint8_t getReg ( const std::string& pReg ) const;
+        uint8_t getReg ( const std::string& pReg ) const
+        {
+            return getReg ( CbcReg::Id ( pReg ) );
+        }
+        /*!
+        * \brief Get a register by its ID from CbcRegisters.h, without any string lookup
+        * \param pRegId
+        * \return The value of the register
+        */
+        uint8_t getReg ( uint16_t pRegId ) const
+        {
+            return hasReg ( pRegId ) ? fRegTable[pRegId].fValue : missingReg ( pRegId );
+        }
         /*!
         * \brief Set any register of the Map
         * \param pReg
         * \param psetValue
         */
-        void setReg ( const std::string& pReg, uint8_t psetValue );
+        void setReg ( const std::string& pReg, uint8_t psetValue )
+        {
+            setReg ( CbcReg::Id ( pReg ), psetValue );
+        }
+        /*!
+        * \brief Set a register by its ID from CbcRegisters.h
+        * \param pRegId
+        * \param psetValue
+        */
+        void setReg ( uint16_t pRegId, uint8_t psetValue )
+        {
+            if ( hasReg ( pRegId ) )
+            {
+                fRegTable[pRegId].fValue = psetValue;
+                fStagedRegs[pRegId] = true;
+            }
+            else missingReg ( pRegId );
+        }
+        /*!
+        * \brief true if the register was loaded from the register file
+        * \param pRegId
+        */
+        bool hasReg ( uint16_t pRegId ) const
+        {
+            return pRegId < CbcReg::NRegisters && fRegLoaded[pRegId];
+        }
+        /*!
+        * \brief Record the value a register holds in the chip, after a successful write or a read
+        * The value in the Map is set as well.
+        * \param pRegId
+        * \param pValue
+        */
+        void setHwReg ( uint16_t pRegId, uint8_t pValue )
+        {
+            if ( hasReg ( pRegId ) )
+            {
+                fRegTable[pRegId].fValue = pValue;
+                fHwRegTable[pRegId] = pValue;
+                fStagedRegs[pRegId] = false;
+            }
+            else missingReg ( pRegId );
+        }
+        void setHwReg ( const std::string& pReg, uint8_t pValue )
+        {
+            setHwReg ( CbcReg::Id ( pReg ), pValue );
+        }
+        /*!
+        * \brief Mark every register of the Map as confirmed in the chip with its current value
+        * The shadow is a cache of the chip state, so it can be updated through a const Cbc.
+        */
+        void setAllHwRegs() const;
+        /*!
+        * \brief Forget the shadow values, e.g. after a hard reset or a failed configuration
+        */
+        void clearHwRegs() const;
+        /*!
+        * \brief true if the value in the Map differs from the last value confirmed in the chip or no value is known
+        * \param pRegId
+        */
+        bool isDirty ( uint16_t pRegId ) const
+        {
+            return hasReg ( pRegId ) && fHwRegTable[pRegId] != fRegTable[pRegId].fValue;
+        }
+        bool isDirty ( const std::string& pReg ) const
+        {
+            return isDirty ( CbcReg::Id ( pReg ) );
+        }
+        /*!
+        * \brief Registers whose value in the Map is not confirmed in the chip
+        * \return pairs of register ID and value to write
+        */
+        CbcRegIdVector getDirtyRegs() const;
+        /*!
+        * \brief Forget which registers were set with setReg since they were last confirmed in the chip
+        * \return the number of those that hold the value confirmed in the chip, i.e. whose write can be skipped
+        */
+        uint16_t clearStagedRegs() const;
         /*!
         * \brief Get any registeritem of the Map
         * \param pReg
@@ -97,22 +188,35 @@ namespace Ph2_HwDescription {
         */
         CbcRegItem getRegItem ( const std::string& pReg );
         /*!
+        * \brief Get the registeritem of a register ID from CbcRegisters.h, throws if the register was not loaded
+        * \param pRegId
+        * \return  RegItem
+        */
+        const CbcRegItem& getRegItem ( uint16_t pRegId ) const;
+        /*!
         * \brief Write the registers of the Map in a file
         * \param filename
         */
         void saveRegMap ( const std::string& filename );
 
         /*!
-        * \brief Get the Map of the registers
+        * \brief Get a copy of the registers as a Map of register name vs. RegItem
         * \return The map of register
         */
-        CbcRegMap& getRegMap()
+        CbcRegMap getRegMap() const;
+        /*!
+        * \brief Get the registers indexed by their ID from CbcRegisters.h, check hasReg() for the entries not loaded
+        */
+        const std::vector<CbcRegItem>& getRegTable() const
         {
-            return fRegMap;
+            return fRegTable;
         }
-        const CbcRegMap& getRegMap() const
+        /*!
+        * \brief Number of registers loaded from the register file
+        */
+        uint16_t getNRegs() const
         {
-            return fRegMap;
+            return fNRegs;
         }
         /*!
         * \brief Get the Cbc Id
@@ -136,8 +240,21 @@ namespace Ph2_HwDescription {
 
         uint8_t fCbcId;
 
-        // Map of Register Name vs. RegisterItem that contains: Page, Address, Default Value, Value
-        CbcRegMap fRegMap;
+        // Table of RegisterItems that contain: Page, Address, Default Value, Value, indexed by the register ID
+        std::vector<CbcRegItem> fRegTable;
+        std::vector<bool> fRegLoaded;
+        uint16_t fNRegs;
+
+        // Value last written to or read from the chip per register ID, cHwUnknown if there is none
+        mutable std::vector<uint16_t> fHwRegTable;
+        // Registers set with setReg since they were last confirmed in the chip
+        mutable std::vector<bool> fStagedRegs;
+        static const uint16_t cHwUnknown = 0x100;
+
+        /*!
+        * \brief Log a register that is not in the table, returns 0 as its value
+        */
+        uint8_t missingReg ( uint16_t pRegId ) const;
 
     };
 
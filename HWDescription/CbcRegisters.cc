@@ -0,0 +1,79 @@
+/*!
+
+        Filename :                      CbcRegisters.cc
+        Content :                       Compile-time index of the CBC2 registers, as listed in the Cbc_default_*.txt files
+        Version :                       1.0
+
+ */
+
+#include "CbcRegisters.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+namespace Ph2_HwDescription {
+    namespace CbcReg {
+
+        namespace {
+            std::vector<std::string> makeNames()
+            {
+                std::vector<std::string> cNames =
+                {
+                    "FrontEndControl", "TriggerLatency", "HitDetectSLVS", "Ipre1", "Ipre2", "Ipsf", "Ipa", "Ipaos", "Vpafb", "Icomp",
+                    "Vpc", "Vplus", "VCth", "TestPulsePot", "SelTestPulseDel&ChanGroup", "MiscTestPulseCtrl&AnalogMux",
+                    "TestPulseChargePumpCurrent", "TestPulseChargeMirrCascodeVolt", "CwdWindow&Coincid", "MiscStubLogic"
+                };
+                char cName[64];
+
+                for ( int cIndex = 0; cIndex <= MaskChannelLast - MaskChannelFirst; cIndex++ )
+                {
+                    // the last mask register only covers the channels up to 254
+                    snprintf ( cName, sizeof ( cName ), "MaskChannelFrom%03ddownto%03d", std::min ( 8 * cIndex + 8, 254 ), 8 * cIndex + 1 );
+                    cNames.push_back ( cName );
+                }
+
+                for ( int cChannel = 1; cChannel <= ChannelLast - ChannelFirst + 1; cChannel++ )
+                {
+                    snprintf ( cName, sizeof ( cName ), "Channel%03d", cChannel );
+                    cNames.push_back ( cName );
+                }
+
+                cNames.push_back ( "ChannelDummy" );
+                return cNames;
+            }
+
+            const std::vector<std::string>& names()
+            {
+                static const std::vector<std::string> cNames = makeNames();
+                return cNames;
+            }
+
+            const std::unordered_map<std::string, uint16_t>& ids()
+            {
+                static const std::unordered_map<std::string, uint16_t> cIds = []
+                {
+                    std::unordered_map<std::string, uint16_t> cMap;
+
+                    for ( uint16_t cId = 0; cId < NRegisters; cId++ )
+                        cMap[names()[cId]] = cId;
+
+                    return cMap;
+                }();
+                return cIds;
+            }
+        }
+
+        const std::string& Name ( uint16_t pId )
+        {
+            static const std::string cUnknown;
+            return ( pId < NRegisters ) ? names()[pId] : cUnknown;
+        }
+
+        uint16_t Id ( const std::string& pName )
+        {
+            auto cId = ids().find ( pName );
+            return ( cId != ids().end() ) ? cId->second : uint16_t ( NRegisters );
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*!
+
+        \file                   CbcRegisters.h
+        \brief                  Compile-time index of the CBC2 registers, as listed in the Cbc_default_*.txt files
+        \version                1.0
+
+ */
+
+#ifndef __CBCREGISTERS_H__
+#define __CBCREGISTERS_H__
+
+#include <stdint.h>
+#include <string>
+
+namespace Ph2_HwDescription {
+
+    /*!
+     * \namespace CbcReg
+     * \brief Dense register IDs, in the order of the register files: global registers, channel masks, channel offsets
+     * The channel registers are not listed one by one: use MaskReg() and ChannelReg() to get their ID.
+     */
+    namespace CbcReg {
+
+        enum CbcRegId : uint16_t
+        {
+            FrontEndControl,
+            TriggerLatency,
+            HitDetectSLVS,
+            Ipre1,
+            Ipre2,
+            Ipsf,
+            Ipa,
+            Ipaos,
+            Vpafb,
+            Icomp,
+            Vpc,
+            Vplus,
+            VCth,
+            TestPulsePot,
+            SelTestPulseDelChanGroup,           /*!< SelTestPulseDel&ChanGroup */
+            MiscTestPulseCtrlAnalogMux,         /*!< MiscTestPulseCtrl&AnalogMux */
+            TestPulseChargePumpCurrent,
+            TestPulseChargeMirrCascodeVolt,
+            CwdWindowCoincid,                   /*!< CwdWindow&Coincid */
+            MiscStubLogic,
+            MaskChannelFirst,                                   /*!< MaskChannelFrom008downto001 */
+            MaskChannelLast = MaskChannelFirst + 31,            /*!< MaskChannelFrom254downto249 */
+            ChannelFirst,                                       /*!< Channel001 */
+            ChannelLast = ChannelFirst + 253,                   /*!< Channel254 */
+            ChannelDummy,
+            NRegisters
+        };
+
+        /*!
+         * \brief ID of the offset register of a channel
+         * \param pChannel : channel number as in the register name, from 1 (Channel001) to 254
+         */
+        constexpr uint16_t ChannelReg ( uint16_t pChannel )
+        {
+            return ChannelFirst + pChannel - 1;
+        }
+        /*!
+         * \brief ID of a mask register
+         * \param pIndex : from 0 (MaskChannelFrom008downto001) to 31 (MaskChannelFrom254downto249)
+         */
+        constexpr uint16_t MaskReg ( uint16_t pIndex )
+        {
+            return MaskChannelFirst + pIndex;
+        }
+        /*!
+         * \brief Name of a register as written in the register files
+         */
+        const std::string& Name ( uint16_t pId );
+        /*!
+         * \brief ID of the register called pName in the register files, NRegisters if there is no such register
+         */
+        uint16_t Id ( const std::string& pName );
+    }
+}
+
+#endif
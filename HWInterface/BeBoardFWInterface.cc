@@ -16,14 +16,25 @@
 
 namespace Ph2_HwInterface {
 
+    // the interface whose acquisitionLoop runs in this thread, if any
+    static thread_local const BeBoardFWInterface* tAcquiringInterface = nullptr;
+
     //Constructor, makes the board map
     BeBoardFWInterface::BeBoardFWInterface ( const char* puHalConfigFileName, uint32_t pBoardId ) :
         RegManager ( puHalConfigFileName, pBoardId ),
         //runningAcquisition ( false ),
         numAcq ( 0 ),
         fSaveToFile ( false ),
-        fFileHandler ( nullptr )
+        fFileHandler ( nullptr ),
+        fAcquisitionRunning ( false ),
+        fStopAcquisition ( false ),
+        fMonitorPrescale ( 1 ),
+        fMonitorCountdown ( 0 ),
+        fMonitorNEvents ( 0 ),
+        fMonitorDropped ( 0 ),
+        fEventRing ( nullptr )
     {
+        fHandshakePolling.SetTimeout ( 10000 );
     }
 
     //Constructor, makes the board map
@@ -32,8 +43,16 @@ namespace Ph2_HwInterface {
         //runningAcquisition ( false ),
         numAcq ( 0 ),
         fSaveToFile ( false ),
-        fFileHandler ( nullptr )
+        fFileHandler ( nullptr ),
+        fAcquisitionRunning ( false ),
+        fStopAcquisition ( false ),
+        fMonitorPrescale ( 1 ),
+        fMonitorCountdown ( 0 ),
+        fMonitorNEvents ( 0 ),
+        fMonitorDropped ( 0 ),
+        fEventRing ( nullptr )
     {
+        fHandshakePolling.SetTimeout ( 10000 );
     }
 
     std::string BeBoardFWInterface::readBoardType()
@@ -58,6 +77,237 @@ namespace Ph2_HwInterface {
 
     }
 
+    void BeBoardFWInterface::ReadBlockRegIntoBuffer ( const std::string& pRegNode, const uint32_t& pBlocksize, std::vector<uint32_t>& pBuffer )
+    {
+        uhal::ValVector<uint32_t> cBlock = ReadBlockReg ( pRegNode, pBlocksize );
+        pBuffer.insert ( pBuffer.end(), cBlock.begin(), cBlock.end() );
+    }
+
+    void BeBoardFWInterface::ReadBlockRegIntoBuffer ( RegHandle pNode, uint32_t pBlocksize, std::vector<uint32_t>& pBuffer )
+    {
+        uhal::ValVector<uint32_t> cBlock = ReadBlockReg ( pNode, pBlocksize );
+        pBuffer.insert ( pBuffer.end(), cBlock.begin(), cBlock.end() );
+    }
+
+    void BeBoardFWInterface::SetPacket ( const BeBoard* pBoard, Data*& pData, uint32_t pNevents, bool pSwapBits, FileHandler* pFileHandler )
+    {
+        // the raw words have to go to file before they are decoded in place, the copy is queued for the writer thread
+        if ( fSaveToFile && pFileHandler != nullptr && pNevents > 0 )
+            pFileHandler->write ( fPacketBuffer );
+
+        if ( fMonitorQueue && pNevents > 0 ) monitorPacket ( pNevents, pSwapBits );
+
+        // a packet too large for the ring is reported by Push and not retried
+        if ( fEventRing && pNevents > 0 )
+        {
+            while ( !fEventRing->Push ( fPacketBuffer.data(), fPacketBuffer.size(), pNevents, pSwapBits, 100 )
+                    && fEventRing->Fits ( fPacketBuffer.size() ) && !fStopAcquisition );
+        }
+
+        // in the acquisition thread the packet goes to the consumer undecoded, pData belongs to the consumer
+        if ( inAcquisitionThread() )
+        {
+            if ( pNevents > 0 )
+            {
+                RawPacket cPacket;
+                cPacket.fWords.swap ( fPacketBuffer );
+                cPacket.fNevents = pNevents;
+                cPacket.fSwapBits = pSwapBits;
+
+                // the queue is bounded: wait for the consumer rather than dropping packets
+                while ( !fPacketQueue->Push ( std::move ( cPacket ) ) && !fStopAcquisition )
+                    std::this_thread::sleep_for ( std::chrono::microseconds ( 100 ) );
+
+                // continue in the storage of a packet the consumer is done with, if there is one
+                fFreeBuffers->Pop ( fPacketBuffer );
+            }
+
+            fPacketBuffer.clear();
+            return;
+        }
+
+        if ( pData == nullptr ) pData = new Data();
+
+        // Data adopts the packet and hands its previous storage back, so the next block read reuses that capacity
+        if ( pNevents > 0 ) pData->Set ( pBoard, std::move ( fPacketBuffer ), pNevents, pSwapBits );
+        else pData->Reset();
+
+        fPacketBuffer.clear();
+    }
+
+    void BeBoardFWInterface::monitorPacket ( uint32_t pNevents, bool pSwapBits )
+    {
+        uint64_t cFirstEvent = fMonitorNEvents;
+        fMonitorNEvents += pNevents;
+
+        if ( fMonitorCountdown > 0 )
+        {
+            fMonitorCountdown--;
+            return;
+        }
+
+        fMonitorCountdown = fMonitorPrescale - 1;
+
+        // test before copying, a full queue only means the monitor is behind and the copy would be thrown away
+        if ( fMonitorQueue->Size() >= fMonitorQueue->Capacity() )
+        {
+            fMonitorDropped++;
+            return;
+        }
+
+        RawPacket cPacket;
+        fMonitorFreeBuffers->Pop ( cPacket.fWords );
+        cPacket.fWords.assign ( fPacketBuffer.begin(), fPacketBuffer.end() );
+        cPacket.fNevents = pNevents;
+        cPacket.fSwapBits = pSwapBits;
+        cPacket.fFirstEvent = cFirstEvent;
+
+        if ( !fMonitorQueue->Push ( std::move ( cPacket ) ) ) fMonitorDropped++;
+    }
+
+    void BeBoardFWInterface::AttachMonitor ( uint32_t pPrescale, uint32_t pQueueSize )
+    {
+        if ( fAcquisitionThread.joinable() )
+            throw Exception ( "BeBoardFWInterface::AttachMonitor: the acquisition thread is running" );
+
+        fMonitorQueue.reset ( new SpscQueue<RawPacket> ( pQueueSize ) );
+        fMonitorFreeBuffers.reset ( new SpscQueue<std::vector<uint32_t>> ( pQueueSize ) );
+        fMonitorPrescale = ( pPrescale > 0 ) ? pPrescale : 1;
+        fMonitorCountdown = 0;
+        fMonitorNEvents = 0;
+        fMonitorDropped = 0;
+    }
+
+    void BeBoardFWInterface::DetachMonitor()
+    {
+        if ( fAcquisitionThread.joinable() )
+            throw Exception ( "BeBoardFWInterface::DetachMonitor: the acquisition thread is running" );
+
+        fMonitorQueue.reset();
+        fMonitorFreeBuffers.reset();
+    }
+
+    bool BeBoardFWInterface::PopMonitorPacket ( RawPacket& pPacket )
+    {
+        return fMonitorQueue && fMonitorQueue->Pop ( pPacket );
+    }
+
+    void BeBoardFWInterface::RecycleMonitorBuffer ( std::vector<uint32_t>&& pBuffer )
+    {
+        if ( fMonitorFreeBuffers )
+        {
+            pBuffer.clear();
+            fMonitorFreeBuffers->Push ( std::move ( pBuffer ) );
+        }
+    }
+
+    void BeBoardFWInterface::StartAcquisitionThread ( BeBoard* pBoard, uint32_t pQueueSize )
+    {
+        if ( fAcquisitionThread.joinable() )
+        {
+            LOG (INFO) << "Acquisition thread already running" ;
+            return;
+        }
+
+        fPacketQueue.reset ( new SpscQueue<RawPacket> ( pQueueSize ) );
+        fFreeBuffers.reset ( new SpscQueue<std::vector<uint32_t>> ( pQueueSize ) );
+        fPacketBuffer.clear();
+        fStopAcquisition = false;
+        fAcquisitionRunning = true;
+
+        Start();
+        fAcquisitionThread = std::thread ( &BeBoardFWInterface::acquisitionLoop, this, pBoard );
+    }
+
+    void BeBoardFWInterface::StopAcquisitionThread()
+    {
+        if ( !fAcquisitionThread.joinable() ) return;
+
+        // ReadData returns within one polling interval once this is set
+        fStopAcquisition = true;
+        fAcquisitionThread.join();
+        fAcquisitionRunning = false;
+
+        Stop();
+        fStopAcquisition = false;
+    }
+
+    bool BeBoardFWInterface::inAcquisitionThread() const
+    {
+        return tAcquiringInterface == this;
+    }
+
+    void BeBoardFWInterface::acquisitionLoop ( BeBoard* pBoard )
+    {
+        // set by the thread itself: fAcquisitionThread may still be being assigned by StartAcquisitionThread
+        tAcquiringInterface = this;
+
+        try
+        {
+            while ( !fStopAcquisition )
+                ReadData ( pBoard, false );
+        }
+        catch ( std::exception& e )
+        {
+            LOG (ERROR) << "Acquisition thread stopped: " << e.what() ;
+        }
+
+        tAcquiringInterface = nullptr;
+        fAcquisitionRunning = false;
+    }
+
+    bool BeBoardFWInterface::PopPacket ( RawPacket& pPacket, uint32_t pTimeoutMs )
+    {
+        if ( !fPacketQueue ) return false;
+
+        auto cDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds ( pTimeoutMs );
+
+        while ( !fPacketQueue->Pop ( pPacket ) )
+        {
+            // a packet may have been queued just before the thread stopped or the time ran out
+            if ( !fAcquisitionRunning || std::chrono::steady_clock::now() >= cDeadline )
+                return fPacketQueue->Pop ( pPacket );
+
+            std::this_thread::sleep_for ( std::chrono::microseconds ( 100 ) );
+        }
+
+        return true;
+    }
+
+    void BeBoardFWInterface::RecycleBuffer ( std::vector<uint32_t>&& pBuffer )
+    {
+        // if the free list is full the buffer is simply released
+        if ( fFreeBuffers )
+        {
+            pBuffer.clear();
+            fFreeBuffers->Push ( std::move ( pBuffer ) );
+        }
+    }
+
+    uint32_t BeBoardFWInterface::DecodePacket ( const BeBoard* pBoard, Data*& pData, uint32_t pTimeoutMs )
+    {
+        RawPacket cPacket;
+
+        if ( !PopPacket ( cPacket, pTimeoutMs ) ) return 0;
+
+        if ( pData == nullptr ) pData = new Data();
+
+        // Data adopts the packet and hands its previous storage back, which goes back to the readout thread
+        pData->Set ( pBoard, std::move ( cPacket.fWords ), cPacket.fNevents, cPacket.fSwapBits );
+        RecycleBuffer ( std::move ( cPacket.fWords ) );
+
+        return cPacket.fNevents;
+    }
+
+    std::vector<bool> BeBoardFWInterface::WriteCbcBatchReg ( std::vector<uint32_t>& pVecReq, bool pReadback )
+    {
+        uint8_t cWriteAttempts = 0;
+        size_t cNWords = pVecReq.size();
+        bool cSuccess = WriteCbcBlockReg ( pVecReq, cWriteAttempts, pReadback );
+
+        return std::vector<bool> ( cNWords, cSuccess );
+    }
+
     //void BeBoardFWInterface::getBoardInfo()
     //{
     //LOG(INFO) << "FMC1 present : " << ReadReg( "status.fmc1_present" ) ;
@@ -13,7 +13,13 @@
 
 #include <boost/thread.hpp>
 #include <uhal/uhal.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include "RegManager.h"
+#include "PollingStrategy.h"
+#include "../Utils/SpscQueue.h"
+#include "../Utils/EventRing.h"
 #include "../Utils/Event.h"
 #include "../Utils/FileHandler.h"
 #include "../Utils/Data.h"
@@ -45,6 +51,18 @@ class FileHandler;
 namespace Ph2_HwInterface {
     class FpgaConfig;
 
+    /*!
+     * \struct RawPacket
+     * \brief Packet as read from the board by the acquisition thread, not decoded yet
+     */
+    struct RawPacket
+    {
+        std::vector<uint32_t> fWords;   /*!< raw 32 bit words of the packet */
+        uint32_t fNevents = 0;          /*!< number of events in the packet */
+        bool fSwapBits = false;         /*!< the CBC data needs the Imperial FW bit reversal */
+        uint64_t fFirstEvent = 0;       /*!< index in the acquisition of the first event, only set on monitor packets */
+    };
+
     /*!
      * \class BeBoardFWInterface
      * \brief Class separating board system FW interface from uHal wrapper
@@ -81,7 +99,15 @@ namespace Ph2_HwInterface {
         /*!
         * \brief Destructor of the BeBoardFWInterface class
         */
-        virtual ~BeBoardFWInterface() {}
+        virtual ~BeBoardFWInterface()
+        {
+            // StopAcquisitionThread has to be called while the derived object still exists, this only avoids std::terminate
+            if ( fAcquisitionThread.joinable() )
+            {
+                fStopAcquisition = true;
+                fAcquisitionThread.join();
+            }
+        }
         /*!
         * \brief Get the board type
         */
@@ -165,6 +191,14 @@ namespace Ph2_HwInterface {
         */
         virtual void ReadCbcBlockReg (  std::vector<uint32_t>& pVecReq ) = 0;
         /*!
+        * \brief Write the registers of any number of Cbcs of this board with as few I2C transactions as possible
+        * The default writes everything with one WriteCbcBlockReg and reports its result for every word.
+        * \param pVecReq : encoded words of all Cbcs, replaced by the replies in the same order (the read back values if pReadback)
+        * \param pReadback : read back and compare every register
+        * \return one flag per word, true if that register was written (and read back) correctly
+        */
+        virtual std::vector<bool> WriteCbcBatchReg ( std::vector<uint32_t>& pVecReq, bool pReadback );
+        /*!
         * \brief Configure the board with its Config File
         * \param pBoard
         */
@@ -194,6 +228,93 @@ namespace Ph2_HwInterface {
         //{
         //return runningAcquisition;
         //}
+        /*!
+         * \brief Start a DAQ and run ReadData in a dedicated thread that queues the raw packets
+         * While the thread runs, ReadData/ReadNEvents must not be called from other threads; packets are consumed with ReadPacket or PopPacket.
+         * \param pBoard : Board running the acquisition
+         * \param pQueueSize : number of packets that can wait for the consumer before the readout blocks
+         */
+        void StartAcquisitionThread ( BeBoard* pBoard, uint32_t pQueueSize );
+        /*!
+         * \brief Stop the acquisition thread and the DAQ, packets still in the queue can be consumed afterwards
+         */
+        void StopAcquisitionThread();
+        /*!
+         * \brief Is the acquisition thread reading packets?
+         */
+        bool IsAcquisitionThreadRunning() const
+        {
+            return fAcquisitionRunning;
+        }
+        /*!
+         * \brief Take the next raw packet of the acquisition thread, only one consumer thread at a time
+         * \param pPacket : packet to move the data into
+         * \param pTimeoutMs : maximum time to wait for a packet
+         * \return false if no packet arrived in time or the acquisition thread stopped and the queue is empty
+         */
+        bool PopPacket ( RawPacket& pPacket, uint32_t pTimeoutMs );
+        /*!
+         * \brief Give the storage of a consumed packet back to the acquisition thread for the next block read
+         */
+        void RecycleBuffer ( std::vector<uint32_t>&& pBuffer );
+        /*!
+         * \brief Take the next packet of the acquisition thread and decode it, the events are then available through GetEvents
+         * \param pBoard : Board running the acquisition
+         * \param pTimeoutMs : maximum time to wait for a packet
+         * \return the number of events, 0 if no packet arrived in time
+         */
+        virtual uint32_t ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs ) = 0;
+        /*!
+         * \brief Attach a monitor that gets a copy of every pPrescale-th packet read, e.g. for an online DQM
+         * The copy is offered without waiting: if the monitor queue is full the packet is not copied and counted as dropped,
+         * so a slow monitor never holds up the readout. Attach and detach while no acquisition thread is running.
+         * \param pPrescale : 1 to monitor every packet
+         * \param pQueueSize : number of copies that can wait for the monitor
+         */
+        void AttachMonitor ( uint32_t pPrescale, uint32_t pQueueSize );
+        /*!
+         * \brief Stop copying packets to the monitor, the copies still queued are released
+         */
+        void DetachMonitor();
+        /*!
+         * \brief Take the next monitor packet without waiting, only one monitor thread at a time
+         * \return false if no copy is waiting or no monitor is attached
+         */
+        bool PopMonitorPacket ( RawPacket& pPacket );
+        /*!
+         * \brief Give the storage of a monitor packet back for the next copy
+         */
+        void RecycleMonitorBuffer ( std::vector<uint32_t>&& pBuffer );
+        /*!
+         * \brief Number of packets that were due for the monitor but not copied since its queue was full
+         */
+        uint64_t GetMonitorDropped() const
+        {
+            return fMonitorDropped;
+        }
+        /*!
+         * \brief Publish every packet read into a shared memory ring for consumers in other processes, nullptr to stop
+         * A lossless consumer of the ring holds the readout back like the consumer of the packet queue does.
+         * Set it while no acquisition thread is running, the ring has to outlive the acquisition.
+         */
+        void SetEventRing ( EventRingWriter* pRing )
+        {
+            fEventRing = pRing;
+        }
+        /*!
+         * \brief Polling of the data ready / SRAM full condition, to tune it or read its statistics
+         */
+        PollingStrategy& GetDataPolling()
+        {
+            return fDataPolling;
+        }
+        /*!
+         * \brief Polling of the short FW handshakes (start acknowledge, end of readout)
+         */
+        PollingStrategy& GetHandshakePolling()
+        {
+            return fHandshakePolling;
+        }
         /*!
          * \brief Start a DAQ
          */
@@ -232,6 +353,14 @@ namespace Ph2_HwInterface {
         virtual const std::vector<Event*>& GetEvents ( const BeBoard* pBoard ) const = 0;
 
         virtual std::vector<uint32_t> ReadBlockRegValue ( const std::string& pRegNode, const uint32_t& pBlocksize ) = 0;
+        /*!
+         * \brief Read a block of values and append it to pBuffer, the only copy after leaving uHAL
+         * \param pRegNode : Node of the block to read
+         * \param pBlocksize : number of 32 bit words to read
+         * \param pBuffer : buffer to append to, its capacity is reused between calls
+         */
+        virtual void ReadBlockRegIntoBuffer ( const std::string& pRegNode, const uint32_t& pBlocksize, std::vector<uint32_t>& pBuffer );
+        void ReadBlockRegIntoBuffer ( RegHandle pNode, uint32_t pBlocksize, std::vector<uint32_t>& pBuffer );
 
         virtual BoardType getBoardType() const = 0;
         /*! \brief Reboot the board */
@@ -244,6 +373,51 @@ namespace Ph2_HwInterface {
         //bool runningAcquisition;
         uint32_t fBlockSize, fNPackets, numAcq, nbMaxAcq;
         //boost::thread thrAcq;
+        std::vector<uint32_t> fPacketBuffer; /*!< raw packet being read, swapped with the storage of the Data object on SetPacket*/
+
+        std::thread fAcquisitionThread;                                     /*!< readout thread started by StartAcquisitionThread */
+        std::atomic<bool> fAcquisitionRunning;                              /*!< the readout thread is still reading packets */
+        std::atomic<bool> fStopAcquisition;                                 /*!< set to make ReadData return without waiting for data */
+        std::unique_ptr<SpscQueue<RawPacket>> fPacketQueue;                 /*!< packets from the readout thread to the consumer */
+        std::unique_ptr<SpscQueue<std::vector<uint32_t>>> fFreeBuffers;     /*!< consumed packet storage going back to the readout thread */
+
+        std::unique_ptr<SpscQueue<RawPacket>> fMonitorQueue;                /*!< copies of the prescaled packets for the monitor */
+        std::unique_ptr<SpscQueue<std::vector<uint32_t>>> fMonitorFreeBuffers;  /*!< monitor packet storage going back to the reader */
+        uint32_t fMonitorPrescale;
+        uint32_t fMonitorCountdown;                                         /*!< packets still to skip before the next copy */
+        uint64_t fMonitorNEvents;                                           /*!< events read since the monitor was attached */
+        std::atomic<uint64_t> fMonitorDropped;
+        EventRingWriter* fEventRing;                                        /*!< shared memory export of the packets, not owned */
+
+        PollingStrategy fDataPolling;                                       /*!< waits for a packet, aborted by fStopAcquisition */
+        PollingStrategy fHandshakePolling;                                  /*!< waits for FW acknowledges, which never take long */
+
+        /*!
+         * \brief Body of the acquisition thread
+         */
+        void acquisitionLoop ( BeBoard* pBoard );
+        /*!
+         * \brief Is this the acquisition thread? SetPacket then queues the packet instead of decoding it
+         */
+        bool inAcquisitionThread() const;
+        /*!
+         * \brief Pop the next queued packet and decode it into pData, used by the ReadPacket implementations
+         */
+        uint32_t DecodePacket ( const BeBoard* pBoard, Data*& pData, uint32_t pTimeoutMs );
+        /*!
+         * \brief Offer a copy of the raw packet in fPacketBuffer to the monitor, if one is attached and the packet is due
+         */
+        void monitorPacket ( uint32_t pNevents, bool pSwapBits );
+
+        /*!
+         * \brief Hand the raw packet in fPacketBuffer over to pData, which decodes it in place
+         * \param pBoard : the BeBoard the packet was read from
+         * \param pData : Data object of the FW interface, created with it; not touched in the acquisition thread
+         * \param pNevents : number of events in the packet, pData is only reset if 0
+         * \param pSwapBits : reverse the bit order of the CBC data (Imperial FW)
+         * \param pFileHandler : if not null and saving is enabled, the raw packet is written to it before decoding
+         */
+        void SetPacket ( const BeBoard* pBoard, Data*& pData, uint32_t pNevents, bool pSwapBits, FileHandler* pFileHandler );
 
         //template to return a vector of all mismatched elements in two vectors using std::mismatch for readback value comparison
 
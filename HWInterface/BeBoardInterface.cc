@@ -187,6 +187,54 @@ namespace Ph2_HwInterface {
         fBoardFW->ReadNEvents ( pBoard, pNEvents );
     }
 
+    void BeBoardInterface::StartAcquisitionThread ( BeBoard* pBoard, uint32_t pQueueSize )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        fBoardFW->StartAcquisitionThread ( pBoard, pQueueSize );
+    }
+
+    void BeBoardInterface::StopAcquisitionThread ( BeBoard* pBoard )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        fBoardFW->StopAcquisitionThread();
+    }
+
+    bool BeBoardInterface::IsAcquisitionThreadRunning ( BeBoard* pBoard )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        return fBoardFW->IsAcquisitionThreadRunning();
+    }
+
+    uint32_t BeBoardInterface::ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        return fBoardFW->ReadPacket ( pBoard, pTimeoutMs );
+    }
+
+    bool BeBoardInterface::PopPacket ( BeBoard* pBoard, RawPacket& pPacket, uint32_t pTimeoutMs )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        return fBoardFW->PopPacket ( pPacket, pTimeoutMs );
+    }
+
+    void BeBoardInterface::RecycleBuffer ( BeBoard* pBoard, std::vector<uint32_t>&& pBuffer )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        fBoardFW->RecycleBuffer ( std::move ( pBuffer ) );
+    }
+
+    PollingStrategy& BeBoardInterface::GetDataPolling ( const BeBoard* pBoard )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        return fBoardFW->GetDataPolling();
+    }
+
+    RegStatistics BeBoardInterface::GetRegStatistics ( const BeBoard* pBoard )
+    {
+        setBoard ( pBoard->getBeBoardIdentifier() );
+        return fBoardFW->GetRegStatistics();
+    }
+
     void BeBoardInterface::CbcFastReset ( const BeBoard* pBoard )
     {
         setBoard ( pBoard->getBeBoardIdentifier() );
@@ -197,6 +245,13 @@ namespace Ph2_HwInterface {
     {
         setBoard ( pBoard->getBeBoardIdentifier() );
         fBoardFW->CbcHardReset();
+
+        // the registers are back to their power-up values, the shadows of the Cbc objects are outdated
+        for ( const auto& cFe : pBoard->fModuleVector )
+        {
+            for ( const auto& cCbc : cFe->fCbcVector )
+                cCbc->clearHwRegs();
+        }
     }
 
     const Event* BeBoardInterface::GetNextEvent ( const BeBoard* pBoard )
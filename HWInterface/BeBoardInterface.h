@@ -158,6 +158,49 @@ namespace Ph2_HwInterface {
         //int getNumAcqThread( BeBoard* pBoard );
         //[>! \brief Is a parallel acquisition running ? <]
         //bool isRunningThread( BeBoard* pBoard );
+        /*!
+         * \brief Start a DAQ whose readout runs in a dedicated thread for this board, the packets are queued for ReadPacket/PopPacket
+         * ReadData and ReadNEvents must not be used for this board until StopAcquisitionThread
+         * \param pBoard : Board running the acquisition
+         * \param pQueueSize : number of packets that can wait for the consumer before the readout blocks
+         */
+        void StartAcquisitionThread ( BeBoard* pBoard, uint32_t pQueueSize = 16 );
+        /*!
+         * \brief Stop the acquisition thread and the DAQ of this board, packets still queued can be consumed afterwards
+         * \param pBoard : Board running the acquisition
+         */
+        void StopAcquisitionThread ( BeBoard* pBoard );
+        /*!
+         * \brief Is the acquisition thread of this board still reading packets?
+         */
+        bool IsAcquisitionThreadRunning ( BeBoard* pBoard );
+        /*!
+         * \brief Decode the next packet of the acquisition thread, its events are then available through GetEvents
+         * \param pBoard : Board running the acquisition
+         * \param pTimeoutMs : maximum time to wait for a packet
+         * \return the number of events, 0 if no packet arrived in time or the thread stopped and the queue is empty
+         */
+        uint32_t ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs = 1000 );
+        /*!
+         * \brief Take the next raw packet of the acquisition thread, for consumers that do not need the decoded events
+         * \param pBoard : Board running the acquisition
+         * \param pPacket : packet to move the data into, hand pPacket.fWords back with RecycleBuffer when done
+         * \param pTimeoutMs : maximum time to wait for a packet
+         * \return false if no packet arrived in time or the thread stopped and the queue is empty
+         */
+        bool PopPacket ( BeBoard* pBoard, RawPacket& pPacket, uint32_t pTimeoutMs = 1000 );
+        /*!
+         * \brief Give the storage of a packet obtained with PopPacket back to the acquisition thread
+         */
+        void RecycleBuffer ( BeBoard* pBoard, std::vector<uint32_t>&& pBuffer );
+        /*!
+         * \brief Polling of the data ready condition of this board, to tune it or read its statistics
+         */
+        PollingStrategy& GetDataPolling ( const BeBoard* pBoard );
+        /*!
+         * \brief Snapshot of the register access statistics of this board, see RegManager::GetRegStatistics
+         */
+        RegStatistics GetRegStatistics ( const BeBoard* pBoard );
 
         /*!
          * \brief Hard reset of all Cbc
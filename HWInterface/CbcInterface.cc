@@ -22,7 +22,9 @@ namespace Ph2_HwInterface {
         fBoardFW ( nullptr ),
         prevBoardIdentifier ( 65535 ),
         fRegisterCount ( 0 ),
-        fTransactionCount ( 0 )
+        fTransactionCount ( 0 ),
+        fNFlushedWrites ( 0 ),
+        fNSkippedWrites ( 0 )
     {
 #ifdef COUNT_FLAG
         LOG (DEBUG) << "Counting number of Transactions!" ;
@@ -62,99 +64,302 @@ namespace Ph2_HwInterface {
         //first, identify the correct BeBoardFWInterface
         setBoard ( pCbc->getBeBoardIdentifier() );
 
-        //vector to encode all the registers into
-        std::vector<uint32_t> cVec;
+        //encode the registers straight from the register table of the Cbc
+        fCmdBuffer.clear();
+        encodeCbc ( pCbc, fCmdBuffer, pVerifLoop, true );
 
-        //Deal with the CbcRegItems and encode them
+        // write the registers, the answer will be in the same vector
+        // the number of times the write operation has been attempted is given by cWriteAttempts
+        uint8_t cWriteAttempts = 0 ;
+        bool cSuccess = fBoardFW->WriteCbcBlockReg ( fCmdBuffer, cWriteAttempts , pVerifLoop);
+
+#ifdef COUNT_FLAG
+        fTransactionCount++;
+#endif
+
+        // after a failed configuration the state of the chip is unknown, the next Flush writes everything
+        if ( cSuccess ) pCbc->setAllHwRegs();
+        else pCbc->clearHwRegs();
+
+        return cSuccess;
+    }
+
+    bool CbcInterface::ConfigureModule ( const Module* pModule, bool pVerifLoop )
+    {
+        if ( pModule->fCbcVector.empty() ) return true;
+
+        setBoard ( pModule->getBeBoardIdentifier() );
+
+        fCmdBuffer.clear();
+
+        for ( const auto& cCbc : pModule->fCbcVector )
+            encodeCbc ( cCbc, fCmdBuffer, pVerifLoop, true );
+
+        std::vector<bool> cGood = fBoardFW->WriteCbcBatchReg ( fCmdBuffer, pVerifLoop );
+
+#ifdef COUNT_FLAG
+        fTransactionCount++;
+#endif
+
+        return confirmModule ( pModule, cGood, nullptr );
+    }
+
+    bool CbcInterface::ConfigureModuleBroadcast ( const Module* pModule, bool pVerifLoop )
+    {
+        const std::vector<Cbc*>& cCbcVector = pModule->fCbcVector;
+        bool cBroadcast = cCbcVector.size() > 1;
+
+        //the broadcast reaches the Cbcs 0 to N-1 of the FE
+        for ( size_t cIndex = 0; cIndex < cCbcVector.size() && cBroadcast; cIndex++ )
+            cBroadcast = ( cCbcVector.at ( cIndex )->getCbcId() == cIndex );
+
+        if ( !cBroadcast ) return ConfigureModule ( pModule, pVerifLoop );
+
+        setBoard ( pModule->getBeBoardIdentifier() );
 
-        CbcRegMap cCbcRegMap = pCbc->getRegMap();
+        //registers loaded with the same value in every Cbc
+        std::vector<bool> cCommon ( CbcReg::NRegisters, false );
+        const Cbc* cFirstCbc = cCbcVector.front();
+        size_t cNCommon = 0;
+        fCmdBuffer.clear();
 
-        for ( auto& cRegItem : cCbcRegMap )
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
         {
-            fBoardFW->EncodeReg (cRegItem.second, pCbc->getCbcId(), cVec, pVerifLoop, true);
+            bool cSame = true;
+
+            for ( const auto& cCbc : cCbcVector )
+            {
+                if ( !cCbc->hasReg ( cRegId ) || cCbc->getReg ( cRegId ) != cFirstCbc->getReg ( cRegId ) )
+                {
+                    cSame = false;
+                    break;
+                }
+            }
+
+            if ( !cSame ) continue;
+
+            cCommon[cRegId] = true;
+            cNCommon++;
+            fBoardFW->BCEncodeReg ( cFirstCbc->getRegItem ( cRegId ), cCbcVector.size(), fCmdBuffer, false, true );
 #ifdef COUNT_FLAG
             fRegisterCount++;
 #endif
         }
 
-        // write the registers, the answer will be in the same cVec
-        // the number of times the write operation has been attempted is given by cWriteAttempts
-        uint8_t cWriteAttempts = 0 ;
-        bool cSuccess = fBoardFW->WriteCbcBlockReg ( cVec, cWriteAttempts , pVerifLoop);
+        if ( !fCmdBuffer.empty() && !fBoardFW->BCWriteCbcBlockReg ( fCmdBuffer, true ) )
+        {
+            LOG (ERROR) << "Broadcast configuration of FE " << +pModule->getFeId() << " failed, writing the CBCs one by one" ;
+            return ConfigureModule ( pModule, pVerifLoop );
+        }
 
 #ifdef COUNT_FLAG
         fTransactionCount++;
 #endif
 
-        return cSuccess;
+        //the remaining registers chip by chip
+        fCmdBuffer.clear();
+
+        for ( const auto& cCbc : cCbcVector )
+        {
+            const std::vector<CbcRegItem>& cRegTable = cCbc->getRegTable();
+
+            for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+            {
+                if ( !cCbc->hasReg ( cRegId ) || cCommon[cRegId] ) continue;
+
+                fBoardFW->EncodeReg ( cRegTable[cRegId], cCbc->getCbcId(), fCmdBuffer, pVerifLoop, true );
+#ifdef COUNT_FLAG
+                fRegisterCount++;
+#endif
+            }
+        }
+
+        LOG (DEBUG) << "FE " << +pModule->getFeId() << ": broadcast " << cNCommon << " registers, " << fCmdBuffer.size() << " written to single CBCs" ;
+
+        std::vector<bool> cGood;
+
+        if ( !fCmdBuffer.empty() )
+        {
+            cGood = fBoardFW->WriteCbcBatchReg ( fCmdBuffer, pVerifLoop );
+#ifdef COUNT_FLAG
+            fTransactionCount++;
+#endif
+        }
+
+        return confirmModule ( pModule, cGood, &cCommon );
     }
 
+    bool CbcInterface::confirmModule ( const Module* pModule, const std::vector<bool>& pGood, const std::vector<bool>* pSkip )
+    {
+        //the words are in the order of encodeCbc: Cbc by Cbc, then by register ID
+        bool cAllGood = true;
+        size_t cIndex = 0;
+
+        for ( const auto& cCbc : pModule->fCbcVector )
+        {
+            bool cCbcGood = true;
+
+            for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+            {
+                if ( !cCbc->hasReg ( cRegId ) || ( pSkip && pSkip->at ( cRegId ) ) ) continue;
+
+                if ( !pGood.at ( cIndex++ ) ) cCbcGood = false;
+            }
+
+            if ( cCbcGood ) cCbc->setAllHwRegs();
+            else
+            {
+                cCbc->clearHwRegs();
+                cAllGood = false;
+                LOG (ERROR) << "Configuration of CBC " << +cCbc->getCbcId() << " on FE " << +cCbc->getFeId() << " failed!" ;
+            }
+        }
+
+        return cAllGood;
+    }
 
     void CbcInterface::ReadCbc ( Cbc* pCbc )
     {
         //first, identify the correct BeBoardFWInterface
         setBoard ( pCbc->getBeBoardIdentifier() );
 
-        //vector to encode all the registers into
-        std::vector<uint32_t> cVec;
-        //helper vector to store the register names in the same order as the RegItems
-        std::vector<std::string> cNameVec;
+        fCmdBuffer.clear();
+        encodeCbc ( pCbc, fCmdBuffer, true, false );
 
-        //Deal with the CbcRegItems and encode them
+        // write the registers, the answer will be in the same vector
+        fBoardFW->ReadCbcBlockReg ( fCmdBuffer );
 
-        CbcRegMap cCbcRegMap = pCbc->getRegMap();
+#ifdef COUNT_FLAG
+        fTransactionCount++;
+#endif
+
+        //update the HWDescription object with the value I just read
+        size_t cIndex = 0;
+        decodeCbc ( pCbc, fCmdBuffer, cIndex, true );
+    }
+
+    void CbcInterface::ReadModule ( const Module* pModule )
+    {
+        if ( pModule->fCbcVector.empty() ) return;
+
+        setBoard ( pModule->getBeBoardIdentifier() );
+
+        fCmdBuffer.clear();
+
+        for ( const auto& cCbc : pModule->fCbcVector )
+            encodeCbc ( cCbc, fCmdBuffer, true, false );
+
+        fBoardFW->ReadCbcBlockReg ( fCmdBuffer );
 
-        for ( auto& cRegItem : cCbcRegMap )
-        {
-            cRegItem.second.fValue = 0x00;
-            fBoardFW->EncodeReg (cRegItem.second, pCbc->getCbcId(), cVec, true, false);
-            //push back the names in cNameVec for latercReg
-            cNameVec.push_back (cRegItem.first);
 #ifdef COUNT_FLAG
-            fRegisterCount++;
+        fTransactionCount++;
 #endif
+
+        size_t cIndex = 0;
+
+        for ( const auto& cCbc : pModule->fCbcVector )
+        {
+            uint32_t cNFailed = decodeCbc ( cCbc, fCmdBuffer, cIndex, false );
+
+            if ( cNFailed )
+                LOG (ERROR) << "Could not read " << cNFailed << " registers of CBC " << +cCbc->getCbcId() << " on FE " << +cCbc->getFeId() ;
         }
+    }
 
-        // write the registers, the answer will be in the same cVec
-        //bool cSuccess = fBoardFW->WriteCbcBlockReg ( cVec, pVerifLoop);
+    void CbcInterface::encodeCbc ( const Cbc* pCbc, std::vector<uint32_t>& pVec, bool pRead, bool pWrite )
+    {
+        const std::vector<CbcRegItem>& cRegTable = pCbc->getRegTable();
+        CbcRegItem cReadItem;
 
-        // write the registers, the answer will be in the same cVec
-        fBoardFW->ReadCbcBlockReg ( cVec);
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
+        {
+            if ( !pCbc->hasReg ( cRegId ) ) continue;
+
+            if ( pWrite )
+                fBoardFW->EncodeReg ( cRegTable[cRegId], pCbc->getCbcId(), pVec, pRead, pWrite );
+            else
+            {
+                cReadItem = cRegTable[cRegId];
+                cReadItem.fValue = 0x00;
+                fBoardFW->EncodeReg ( cReadItem, pCbc->getCbcId(), pVec, pRead, pWrite );
+            }
 
 #ifdef COUNT_FLAG
-        fTransactionCount++;
+            fRegisterCount++;
 #endif
+        }
+    }
 
+    uint32_t CbcInterface::decodeCbc ( Cbc* pCbc, const std::vector<uint32_t>& pVec, size_t& pIndex, bool pPrint )
+    {
         bool cFailed = false;
         bool cRead;
         uint8_t cCbcId;
-        //update the HWDescription object with the value I just read
-        uint32_t idxReadWord = 0;
+        uint32_t cNFailed = 0;
+        CbcRegItem cRegItem;
 
-        //for ( const auto& cReg : cVec )
-        for ( const auto& cReadWord : cVec )
+        for ( uint16_t cRegId = 0; cRegId < CbcReg::NRegisters; cRegId++ )
         {
-            CbcRegItem cRegItem;
-            std::string cName = cNameVec[idxReadWord++];
-            fBoardFW->DecodeReg ( cRegItem, cCbcId, cReadWord, cRead, cFailed );
+            if ( !pCbc->hasReg ( cRegId ) ) continue;
+
+            //a short reply leaves the remaining registers as they are
+            if ( pIndex >= pVec.size() )
+            {
+                cNFailed++;
+                continue;
+            }
+
+            fBoardFW->DecodeReg ( cRegItem, cCbcId, pVec[pIndex++], cRead, cFailed );
 
-            // here I need to find the string matching to the reg item!
             if (!cFailed)
-                pCbc->setReg ( cName, cRegItem.fValue );
+                pCbc->setHwReg ( cRegId, cRegItem.fValue );
+            else
+                cNFailed++;
 
-            LOG (INFO) << "CBC " << +pCbc->getCbcId() << " " << cName << ": 0x" << std::hex << +cRegItem.fValue << std::dec ;
+            if ( pPrint )
+                LOG (INFO) << "CBC " << +pCbc->getCbcId() << " " << CbcReg::Name ( cRegId ) << ": 0x" << std::hex << +cRegItem.fValue << std::dec ;
         }
 
+        return cNFailed;
     }
 
 
+    uint16_t CbcInterface::regId ( const std::string& pRegNode )
+    {
+        uint16_t cRegId = CbcReg::Id ( pRegNode );
+
+        if ( cRegId == CbcReg::NRegisters )
+        {
+            LOG (ERROR) << "Error, no Register " << pRegNode << " known for the CBC!" ;
+            throw Exception ( "Cbc: no matching register found" );
+        }
+
+        return cRegId;
+    }
+
+    CbcRegIdVector CbcInterface::regIds ( const std::vector< std::pair<std::string, uint8_t> >& pVecReq )
+    {
+        CbcRegIdVector cVecReq;
+        cVecReq.reserve ( pVecReq.size() );
+
+        for ( const auto& cReg : pVecReq )
+            cVecReq.push_back ( {regId ( cReg.first ), cReg.second} );
+
+        return cVecReq;
+    }
+
     bool CbcInterface::WriteCbcReg ( Cbc* pCbc, const std::string& pRegNode, uint8_t pValue, bool pVerifLoop )
+    {
+        return WriteCbcReg ( pCbc, regId ( pRegNode ), pValue, pVerifLoop );
+    }
+
+    bool CbcInterface::WriteCbcReg ( Cbc* pCbc, uint16_t pRegId, uint8_t pValue, bool pVerifLoop )
     {
         //first, identify the correct BeBoardFWInterface
         setBoard ( pCbc->getBeBoardIdentifier() );
 
         //next, get the reg item
-        CbcRegItem cRegItem = pCbc->getRegItem ( pRegNode );
+        CbcRegItem cRegItem = pCbc->getRegItem ( pRegId );
         cRegItem.fValue = pValue;
 
         //vector for transaction
@@ -169,7 +374,7 @@ namespace Ph2_HwInterface {
 
         //update the HWDescription object
         if (cSuccess)
-            pCbc->setReg ( pRegNode, pValue );
+            pCbc->setHwReg ( pRegId, pValue );
 
 #ifdef COUNT_FLAG
         fRegisterCount++;
@@ -180,11 +385,17 @@ namespace Ph2_HwInterface {
     }
 
     bool CbcInterface::WriteCbcMultReg ( Cbc* pCbc, const std::vector< std::pair<std::string, uint8_t> >& pVecReq, bool pVerifLoop )
+    {
+        return WriteCbcMultReg ( pCbc, regIds ( pVecReq ), pVerifLoop );
+    }
+
+    bool CbcInterface::WriteCbcMultReg ( Cbc* pCbc, const CbcRegIdVector& pVecReq, bool pVerifLoop )
     {
         //first, identify the correct BeBoardFWInterface
         setBoard ( pCbc->getBeBoardIdentifier() );
 
         std::vector<uint32_t> cVec;
+        cVec.reserve ( pVecReq.size() );
 
         //Deal with the CbcRegItems and encode them
         CbcRegItem cRegItem;
@@ -213,22 +424,200 @@ namespace Ph2_HwInterface {
         if (cSuccess)
         {
             for ( const auto& cReg : pVecReq )
+                pCbc->setHwReg ( cReg.first, cReg.second );
+        }
+
+        return cSuccess;
+    }
+
+    std::map<Cbc*, bool> CbcInterface::WriteTransaction ( const CbcRegTransaction& pTransaction, bool pVerifLoop )
+    {
+        std::map<Cbc*, bool> cResult;
+        //the writes grouped by board, in the order they were queued
+        std::map<uint16_t, std::vector<const CbcRegTransaction::RegWrite*>> cBoardWrites;
+
+        for ( const auto& cWrite : pTransaction.fWrites )
+        {
+            cBoardWrites[cWrite.fCbc->getBeBoardIdentifier()].push_back ( &cWrite );
+            cResult[cWrite.fCbc] = true;
+        }
+
+        for ( const auto& cBoard : cBoardWrites )
+        {
+            setBoard ( cBoard.first );
+
+            std::vector<uint32_t> cVec;
+
+            for ( const auto& cWrite : cBoard.second )
             {
-                cRegItem = pCbc->getRegItem ( cReg.first );
-                pCbc->setReg ( cReg.first, cReg.second );
+                CbcRegItem cRegItem = cWrite->fCbc->getRegItem ( cWrite->fRegId );
+                cRegItem.fValue = cWrite->fValue;
+                fBoardFW->EncodeReg ( cRegItem, cWrite->fCbc->getCbcId(), cVec, pVerifLoop, true );
+#ifdef COUNT_FLAG
+                fRegisterCount++;
+#endif
             }
+
+            std::vector<bool> cGood = fBoardFW->WriteCbcBatchReg ( cVec, pVerifLoop );
+
+#ifdef COUNT_FLAG
+            fTransactionCount++;
+#endif
+
+            for ( size_t cIndex = 0; cIndex < cBoard.second.size(); cIndex++ )
+            {
+                const CbcRegTransaction::RegWrite* cWrite = cBoard.second.at ( cIndex );
+
+                if ( cGood.at ( cIndex ) )
+                    cWrite->fCbc->setHwReg ( cWrite->fRegId, cWrite->fValue );
+                else
+                    cResult[cWrite->fCbc] = false;
+            }
+        }
+
+        return cResult;
+    }
+
+    bool CbcInterface::Flush ( Cbc* pCbc, bool pVerifLoop )
+    {
+        CbcRegIdVector cDirty = pCbc->getDirtyRegs();
+
+        fNSkippedWrites += pCbc->clearStagedRegs();
+
+        if ( cDirty.empty() ) return true;
+
+        fNFlushedWrites += cDirty.size();
+        return WriteCbcMultReg ( pCbc, cDirty, pVerifLoop );
+    }
+
+    bool CbcInterface::Flush ( const Module* pModule, bool pVerifLoop )
+    {
+        CbcRegTransaction cTransaction;
+        bool cSuccess = stageModule ( pModule, cTransaction );
+
+        if ( !cTransaction.empty() )
+        {
+            for ( const auto& cResult : WriteTransaction ( cTransaction, pVerifLoop ) )
+                cSuccess = cSuccess && cResult.second;
         }
 
         return cSuccess;
     }
 
+    bool CbcInterface::Flush ( const std::vector<BeBoard*>& pBoards, bool pVerifLoop )
+    {
+        CbcRegTransaction cTransaction;
+        bool cSuccess = true;
 
+        for ( const auto& cBoard : pBoards )
+        {
+            for ( const auto& cFe : cBoard->fModuleVector )
+                cSuccess = stageModule ( cFe, cTransaction ) && cSuccess;
+        }
+
+        if ( !cTransaction.empty() )
+        {
+            for ( const auto& cResult : WriteTransaction ( cTransaction, pVerifLoop ) )
+                cSuccess = cSuccess && cResult.second;
+        }
+
+        return cSuccess;
+    }
+
+    bool CbcInterface::canBroadcast ( const Module* pModule )
+    {
+        const std::vector<Cbc*>& cCbcVector = pModule->fCbcVector;
+
+        if ( cCbcVector.size() < 2 ) return false;
+
+        // only the IC firmware reads the broadcast words back, CTA rejects them
+        setBoard ( pModule->getBeBoardIdentifier() );
+        BoardType cType = fBoardFW->getBoardType();
+
+        if ( cType != BoardType::ICGLIB && cType != BoardType::ICFC7 ) return false;
+
+        //the broadcast reaches the Cbcs 0 to N-1 of the FE
+        for ( size_t cIndex = 0; cIndex < cCbcVector.size(); cIndex++ )
+        {
+            if ( cCbcVector.at ( cIndex )->getCbcId() != cIndex ) return false;
+        }
+
+        return true;
+    }
+
+    bool CbcInterface::stageModule ( const Module* pModule, CbcRegTransaction& pTransaction )
+    {
+        if ( pModule->fCbcVector.empty() ) return true;
+
+        // a register that is dirty with the same value on every Cbc of the module is broadcast
+        CbcRegIdVector cBroadcast;
+        std::vector<bool> cBroadcastIds ( CbcReg::NRegisters, false );
+        const Cbc* cFirst = pModule->fCbcVector.at ( 0 );
+
+        if ( canBroadcast ( pModule ) )
+        {
+            for ( const auto& cReg : cFirst->getDirtyRegs() )
+            {
+                bool cShared = true;
+
+                for ( const auto& cCbc : pModule->fCbcVector )
+                {
+                    if ( !cCbc->isDirty ( cReg.first ) || cCbc->getReg ( cReg.first ) != cReg.second )
+                    {
+                        cShared = false;
+                        break;
+                    }
+                }
+
+                if ( cShared )
+                {
+                    cBroadcast.push_back ( cReg );
+                    cBroadcastIds[cReg.first] = true;
+                }
+            }
+        }
+
+        // everything else is queued in the transaction
+        size_t cNQueued = pTransaction.size();
+
+        for ( const auto& cCbc : pModule->fCbcVector )
+        {
+            CbcRegIdVector cDirty = cCbc->getDirtyRegs();
+
+            for ( const auto& cReg : cDirty )
+            {
+                if ( !cBroadcastIds[cReg.first] )
+                    pTransaction.Add ( cCbc, cReg.first, cReg.second );
+            }
+
+            fNSkippedWrites += cCbc->clearStagedRegs();
+        }
+
+        fNFlushedWrites += cBroadcast.size() + pTransaction.size() - cNQueued;
+        bool cSuccess = true;
+
+        if ( !cBroadcast.empty() )
+        {
+            WriteBroadcastMultReg ( pModule, cBroadcast );
+
+            // the broadcast does not report a result, a register still dirty was not written
+            for ( const auto& cReg : cBroadcast )
+                cSuccess = cSuccess && !cFirst->isDirty ( cReg.first );
+        }
+
+        return cSuccess;
+    }
 
     uint8_t CbcInterface::ReadCbcReg ( Cbc* pCbc, const std::string& pRegNode )
+    {
+        return ReadCbcReg ( pCbc, regId ( pRegNode ) );
+    }
+
+    uint8_t CbcInterface::ReadCbcReg ( Cbc* pCbc, uint16_t pRegId )
     {
         setBoard ( pCbc->getBeBoardIdentifier() );
 
-        CbcRegItem cRegItem = pCbc->getRegItem ( pRegNode );
+        CbcRegItem cRegItem = pCbc->getRegItem ( pRegId );
 
         std::vector<uint32_t> cVecReq;
 
@@ -241,18 +630,30 @@ namespace Ph2_HwInterface {
         uint8_t cCbcId;
         fBoardFW->DecodeReg ( cRegItem, cCbcId, cVecReq[0], cRead, cFailed );
 
-        if (!cFailed) pCbc->setReg ( pRegNode, cRegItem.fValue );
+        if (!cFailed) pCbc->setHwReg ( pRegId, cRegItem.fValue );
 
         return cRegItem.fValue;
     }
 
 
     void CbcInterface::ReadCbcMultReg ( Cbc* pCbc, const std::vector<std::string>& pVecReg )
+    {
+        std::vector<uint16_t> cVecReg;
+        cVecReg.reserve ( pVecReg.size() );
+
+        for ( const auto& cReg : pVecReg )
+            cVecReg.push_back ( regId ( cReg ) );
+
+        ReadCbcMultReg ( pCbc, cVecReg );
+    }
+
+    void CbcInterface::ReadCbcMultReg ( Cbc* pCbc, const std::vector<uint16_t>& pVecReg )
     {
         //first, identify the correct BeBoardFWInterface
         setBoard ( pCbc->getBeBoardIdentifier() );
 
         std::vector<uint32_t> cVec;
+        cVec.reserve ( pVecReg.size() );
 
         //Deal with the CbcRegItems and encode them
         CbcRegItem cRegItem;
@@ -281,14 +682,12 @@ namespace Ph2_HwInterface {
         uint32_t idxReadWord = 0;
 
         for ( const auto& cReg : pVecReg )
-            //for ( const auto& cReadWord : cVec )
         {
             uint32_t cReadWord = cVec[idxReadWord++];
             fBoardFW->DecodeReg ( cRegItem, cCbcId, cReadWord, cRead, cFailed );
 
-            // here I need to find the string matching to the reg item!
             if (!cFailed)
-                pCbc->setReg ( cReg, cRegItem.fValue );
+                pCbc->setHwReg ( cReg, cRegItem.fValue );
         }
     }
 
@@ -340,11 +739,16 @@ namespace Ph2_HwInterface {
 
 
     void CbcInterface::WriteBroadcast ( const Module* pModule, const std::string& pRegNode, uint32_t pValue )
+    {
+        WriteBroadcast ( pModule, regId ( pRegNode ), pValue );
+    }
+
+    void CbcInterface::WriteBroadcast ( const Module* pModule, uint16_t pRegId, uint32_t pValue )
     {
         //first set the correct BeBoard
         setBoard ( pModule->getBeBoardIdentifier() );
 
-        CbcRegItem cRegItem = pModule->fCbcVector.at (0)->getRegItem ( pRegNode );
+        CbcRegItem cRegItem = pModule->fCbcVector.at (0)->getRegItem ( pRegId );
         cRegItem.fValue = pValue;
 
         //vector for transaction
@@ -366,15 +770,21 @@ namespace Ph2_HwInterface {
         //update the HWDescription object -- not sure if the transaction was successfull
         if (cSuccess)
             for (auto& cCbc : pModule->fCbcVector)
-                cCbc->setReg ( pRegNode, pValue );
+                cCbc->setHwReg ( pRegId, pValue );
     }
 
     void CbcInterface::WriteBroadcastMultReg (const Module* pModule, const std::vector<std::pair<std::string, uint8_t>> pVecReg)
+    {
+        WriteBroadcastMultReg ( pModule, regIds ( pVecReg ) );
+    }
+
+    void CbcInterface::WriteBroadcastMultReg ( const Module* pModule, const CbcRegIdVector& pVecReg )
     {
         //first set the correct BeBoard
         setBoard ( pModule->getBeBoardIdentifier() );
 
         std::vector<uint32_t> cVec;
+        cVec.reserve ( pVecReg.size() );
 
         //Deal with the CbcRegItems and encode them
         CbcRegItem cRegItem;
@@ -400,9 +810,6 @@ namespace Ph2_HwInterface {
         if (cSuccess)
             for (auto& cCbc : pModule->fCbcVector)
                 for (auto& cReg : pVecReg)
-                {
-                    cRegItem = cCbc->getRegItem ( cReg.first );
-                    cCbc->setReg ( cReg.first, cReg.second );
-                }
+                    cCbc->setHwReg ( cReg.first, cReg.second );
     }
 }
@@ -28,6 +28,70 @@ namespace Ph2_HwInterface {
 
     using BeBoardFWMap = std::map<uint16_t, BeBoardFWInterface*>;    /*!< Map of Board connected */
 
+    /*!
+     * \class CbcRegTransaction
+     * \brief Register writes for any number of Cbcs (and boards), collected to be sent at once by CbcInterface::WriteTransaction
+     */
+    class CbcRegTransaction
+    {
+      public:
+        /*!
+         * \brief Queue a register write
+         * \param pCbc
+         * \param pRegNode : Node of the register to write
+         * \param pValue : Value to write
+         */
+        void Add ( Cbc* pCbc, const std::string& pRegNode, uint8_t pValue )
+        {
+            fWrites.push_back ( {pCbc, CbcReg::Id ( pRegNode ), pValue} );
+        }
+        /*!
+         * \brief Queue a register write by register ID, see CbcRegisters.h
+         */
+        void Add ( Cbc* pCbc, uint16_t pRegId, uint8_t pValue )
+        {
+            fWrites.push_back ( {pCbc, pRegId, pValue} );
+        }
+        /*!
+         * \brief Queue several register writes for the same Cbc
+         * \param pCbc
+         * \param pVecReq : Vector of pair: Node of the register to write versus value to write
+         */
+        void Add ( Cbc* pCbc, const std::vector< std::pair<std::string, uint8_t> >& pVecReq )
+        {
+            for ( const auto& cReg : pVecReq )
+                fWrites.push_back ( {pCbc, CbcReg::Id ( cReg.first ), cReg.second} );
+        }
+        void Add ( Cbc* pCbc, const CbcRegIdVector& pVecReq )
+        {
+            for ( const auto& cReg : pVecReq )
+                fWrites.push_back ( {pCbc, cReg.first, cReg.second} );
+        }
+        void Clear()
+        {
+            fWrites.clear();
+        }
+        size_t size() const
+        {
+            return fWrites.size();
+        }
+        bool empty() const
+        {
+            return fWrites.empty();
+        }
+
+      private:
+        friend class CbcInterface;
+
+        struct RegWrite
+        {
+            Cbc* fCbc;
+            uint16_t fRegId;
+            uint8_t fValue;
+        };
+        std::vector<RegWrite> fWrites;
+    };
+
     /*!
      * \class CbcInterface
      * \brief Class representing the User Interface to the Cbc on different boards
@@ -42,6 +106,9 @@ namespace Ph2_HwInterface {
 
         uint16_t fRegisterCount;                                /*!< Counter for the number of Registers written */
         uint16_t fTransactionCount;         /*!< Counter for the number of Transactions */
+        uint64_t fNFlushedWrites;           /*!< Registers written by Flush because they were dirty */
+        uint64_t fNSkippedWrites;           /*!< Registers staged with the value the chip already holds, skipped by Flush */
+        std::vector<uint32_t> fCmdBuffer;   /*!< I2C words of ConfigureCbc/ReadCbc and the module versions, reused to keep its allocation */
 
 
       private:
@@ -50,6 +117,36 @@ namespace Ph2_HwInterface {
          * \param pBoardId
          */
         void setBoard ( uint16_t pBoardIdentifier );
+        /*!
+         * \brief ID of a register name, throws if the CBC has no such register
+         */
+        static uint16_t regId ( const std::string& pRegNode );
+        static CbcRegIdVector regIds ( const std::vector< std::pair<std::string, uint8_t> >& pVecReq );
+        /*!
+         * \brief Append the I2C words of all registers loaded in the Cbc to pVec, in register ID order
+         * \param pRead, pWrite : as for EncodeReg, a read only word is encoded with a value of 0
+         */
+        void encodeCbc ( const Cbc* pCbc, std::vector<uint32_t>& pVec, bool pRead, bool pWrite );
+        /*!
+         * \brief Decode the replies of a read of all registers of the Cbc, starting at pVec[pIndex]
+         * \return the number of registers that could not be read
+         */
+        uint32_t decodeCbc ( Cbc* pCbc, const std::vector<uint32_t>& pVec, size_t& pIndex, bool pPrint );
+        /*!
+         * \brief Mark every Cbc of the module whose words in pGood are all true as in sync with the chip, the others as unknown
+         * \param pSkip : registers that have no word in pGood, can be null
+         * \return true if all Cbcs were written correctly
+         */
+        bool confirmModule ( const Module* pModule, const std::vector<bool>& pGood, const std::vector<bool>* pSkip );
+        /*!
+         * \brief true if the registers of the module can be broadcast: IC firmware and Cbc Ids 0 to N-1
+         */
+        bool canBroadcast ( const Module* pModule );
+        /*!
+         * \brief Broadcast the registers of the module that are dirty with the same value on every Cbc and queue the other dirty ones
+         * \return false if a broadcast register was not written
+         */
+        bool stageModule ( const Module* pModule, CbcRegTransaction& pTransaction );
 
       public:
         /*!
@@ -73,6 +170,29 @@ namespace Ph2_HwInterface {
          * \param pCbc: pointer to CBC object
          */
         void ReadCbc ( Cbc* pCbc );
+        /*!
+         * \brief Configure all Cbcs of a module with one batch of I2C words, sent in blocks the size of the reply FIFO
+         * Cbcs that were configured correctly are marked as in sync with the chip, the others as unknown.
+         * \param pModule : Module containing vector of Cbcs
+         * \param pVerifLoop : read back and compare every register
+         * \return true if the registers of all Cbcs were written correctly
+         */
+        bool ConfigureModule ( const Module* pModule, bool pVerifLoop = true );
+        /*!
+         * \brief Configure all Cbcs of a module, broadcasting the registers that have the same value in every Cbc
+         * The registers that differ are written chip by chip as in ConfigureModule. The broadcast words are only
+         * checked for the acknowledge of every Cbc, if one is missing the whole module is written chip by chip.
+         * Falls back to ConfigureModule if the module has a single Cbc or its Cbc Ids are not 0 to N-1.
+         * \param pModule : Module containing vector of Cbcs
+         * \param pVerifLoop : read back and compare the registers written chip by chip
+         * \return true if the registers of all Cbcs were written correctly
+         */
+        bool ConfigureModuleBroadcast ( const Module* pModule, bool pVerifLoop = true );
+        /*!
+         * \brief Read all the I2C parameters of all Cbcs of a module with one batch of I2C words
+         * \param pModule : Module containing vector of Cbcs
+         */
+        void ReadModule ( const Module* pModule );
         /*!
          * \brief Write the designated register in both Cbc and Cbc Config File
          * \param pCbc
@@ -86,6 +206,10 @@ namespace Ph2_HwInterface {
          * \param pValue : Value to write
          */
         bool WriteCbcReg ( Cbc* pCbc, const std::string& pRegNode, uint8_t pValue, bool pVerifLoop = true );
+        /*!
+         * \brief Write a register by its ID from CbcRegisters.h, without any string handling
+         */
+        bool WriteCbcReg ( Cbc* pCbc, uint16_t pRegId, uint8_t pValue, bool pVerifLoop = true );
 
         /*!
          * \brief Write several registers in both Cbc and Cbc Config File
@@ -93,6 +217,59 @@ namespace Ph2_HwInterface {
          * \param pVecReq : Vector of pair: Node of the register to write versus value to write
          */
         bool WriteCbcMultReg ( Cbc* pCbc, const std::vector< std::pair<std::string, uint8_t> >& pVecReq, bool pVerifLoop = true );
+        /*!
+         * \brief Write several registers by their ID from CbcRegisters.h
+         */
+        bool WriteCbcMultReg ( Cbc* pCbc, const CbcRegIdVector& pVecReq, bool pVerifLoop = true );
+        /*!
+         * \brief Write all registers of a CbcRegTransaction, one batch per board, and update the Cbc objects with the registers written correctly
+         * \param pTransaction : the queued writes, they can belong to Cbcs of several boards
+         * \param pVerifLoop : read back and compare every register
+         * \return true for every Cbc of the transaction whose registers were all written correctly
+         */
+        std::map<Cbc*, bool> WriteTransaction ( const CbcRegTransaction& pTransaction, bool pVerifLoop = true );
+        /*!
+         * \brief Write only the registers of the Cbc whose value differs from the one confirmed in the chip
+         * \param pCbc
+         * \param pVerifLoop : read back and compare every register
+         * \return true if nothing had to be written or the write succeeded
+         */
+        bool Flush ( Cbc* pCbc, bool pVerifLoop = true );
+        /*!
+         * \brief Write the dirty registers of all Cbcs of a module
+         * On the IC firmware the registers dirty with the same value on every Cbc are broadcast, the others are written
+         * with WriteTransaction.
+         * \param pModule : Module containing vector of Cbcs
+         * \param pVerifLoop : read back and compare the registers that are not broadcast
+         * \return true if all dirty registers were written
+         */
+        bool Flush ( const Module* pModule, bool pVerifLoop = true );
+        /*!
+         * \brief Write the dirty registers of all Cbcs of several boards as Flush ( const Module* ), with one transaction for all of them
+         * \param pBoards : Boards containing vector of Modules
+         * \param pVerifLoop : read back and compare the registers that are not broadcast
+         * \return true if all dirty registers were written
+         */
+        bool Flush ( const std::vector<BeBoard*>& pBoards, bool pVerifLoop = true );
+        /*!
+         * \brief Number of registers written by Flush
+         */
+        uint64_t GetFlushedWrites() const
+        {
+            return fNFlushedWrites;
+        }
+        /*!
+         * \brief Number of registers set with Cbc::setReg to the value the chip already held, which Flush did not write
+         */
+        uint64_t GetSkippedWrites() const
+        {
+            return fNSkippedWrites;
+        }
+        void ResetFlushCounters()
+        {
+            fNFlushedWrites = 0;
+            fNSkippedWrites = 0;
+        }
         /*!
          * \brief Write same register in all Cbcs and then UpdateCbc
          * \param pModule : Module containing vector of Cbcs
@@ -100,6 +277,7 @@ namespace Ph2_HwInterface {
          * \param pValue : Value to write
          */
         void WriteBroadcast ( const Module* pModule, const std::string& pRegNode, uint32_t pValue );
+        void WriteBroadcast ( const Module* pModule, uint16_t pRegId, uint32_t pValue );
         /*!
          * \brief Write same register in all Cbcs and then UpdateCbc
          * \param pModule : Module containing vector of Cbcs
@@ -107,18 +285,21 @@ namespace Ph2_HwInterface {
          * \param pValue : Value to write
          */
         void WriteBroadcastMultReg ( const Module* pModule, const std::vector<std::pair<std::string, uint8_t>> pVecReg );
+        void WriteBroadcastMultReg ( const Module* pModule, const CbcRegIdVector& pVecReg );
         /*!
          * \brief Read the designated register in the Cbc
          * \param pCbc
          * \param pRegNode : Node of the register to read
          */
         uint8_t ReadCbcReg ( Cbc* pCbc, const std::string& pRegNode );
+        uint8_t ReadCbcReg ( Cbc* pCbc, uint16_t pRegId );
         /*!
          * \brief Read several register in the Cbc
          * \param pCbc
          * \param pVecReg : Vector of the nodes of the register to read
          */
         void ReadCbcMultReg ( Cbc* pCbc, const std::vector<std::string>& pVecReg );
+        void ReadCbcMultReg ( Cbc* pCbc, const std::vector<uint16_t>& pVecReg );
         /*!
          * \brief Read all register in all Cbcs and then UpdateCbc
          * \param pModule : Module containing vector of Cbcs
@@ -27,7 +27,7 @@ namespace Ph2_HwInterface {
         //fNthAcq (0)
     {
         fpgaConfig = nullptr;
-        fData = nullptr;
+        fData = new Data();
         fNthAcq = 0;
     }
 
@@ -37,7 +37,7 @@ namespace Ph2_HwInterface {
                                      FileHandler* pFileHandler ) :
         BeBoardFWInterface ( puHalConfigFileName, pBoardId ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fFileHandler ( pFileHandler ),
         fNthAcq (0)
     {
@@ -50,7 +50,7 @@ namespace Ph2_HwInterface {
                                      const char* pAddressTable ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fNthAcq (0)
     {
     }
@@ -62,7 +62,7 @@ namespace Ph2_HwInterface {
                                      FileHandler* pFileHandler ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fFileHandler ( pFileHandler ),
         fNthAcq (0)
     {
@@ -158,6 +158,7 @@ namespace Ph2_HwInterface {
         fNthAcq = 0;
         // Since the Number of  Packets is a FW register, it should be read from the Settings Table which is one less than is actually read
         fNpackets = ReadReg ( "pc_commands.CBC_DATA_PACKET_NUMBER" ) + 1 ;
+        setPollingPrediction();
         //fBlockSize = 0;
         //Wait for start acknowledge
         uhal::ValWord<uint32_t> cVal;
@@ -212,8 +213,6 @@ namespace Ph2_HwInterface {
     {
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
 
-        uhal::ValWord<uint32_t> cVal;
-
         //Select SRAM
         SelectDaqSRAM();
         //Stop the DAQ
@@ -232,25 +231,21 @@ namespace Ph2_HwInterface {
         if ( pBoard )
             fBlockSize = computeBlockSize ( pBoard );
 
-        do  //Wait for the SRAM full condition.
+        //Wait for the SRAM full condition, the triggers are stopped so this is only the FW flushing
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( fStrFull );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( fStrFull ) != 0;
+        }, "SRAM full" );
 
         uint32_t nbEvtPacket = fNpackets;
         uint32_t nbBlockSize = fBlockSize;
-        std::vector<uint32_t> cData;
 
         nbEvtPacket = fNpackets - ReadReg (fStrEvtCounter);
         nbBlockSize = fBlockSize / fNpackets * nbEvtPacket;
 
         //Read SRAM
         if (nbBlockSize > 0)
-            cData =  ReadBlockRegValue ( fStrSram, nbBlockSize );
+            ReadBlockRegIntoBuffer ( fStrSram, nbBlockSize, fPacketBuffer );
 
         std::this_thread::sleep_for ( 10 * cWait );
         WriteReg ( fStrReadout, 1 );
@@ -260,21 +255,8 @@ namespace Ph2_HwInterface {
         //now I did an acquistion, so I need to increment the counter
         fNthAcq++;
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
-
-        fData = new Data();
-
-        if (nbEvtPacket > 0)       // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        {
-            fData->Set ( pBoard, cData , nbEvtPacket, false );
-
-            if ( fSaveToFile )
-            {
-                fFileHandler->set ( cData );
-                fFileHandler->writeFile();
-            }
-        }
+        // hand the packet over to fData which decodes it in place, an empty packet just resets it
+        SetPacket ( pBoard, fData, nbEvtPacket, false, fFileHandler );
 
         //WriteReg ( fStrReadout, 0 );
         WriteReg ("pc_commands.SRAM1_end_readout", 0);
@@ -306,8 +288,6 @@ namespace Ph2_HwInterface {
         //Readout settings
         std::chrono::milliseconds cWait ( 1 );
 
-        uhal::ValWord<uint32_t> cVal;
-
         if ( pBoard )
             fBlockSize = computeBlockSize ( pBoard );
 
@@ -316,21 +296,20 @@ namespace Ph2_HwInterface {
         SelectDaqSRAM();
 
 
-        do  //Wait for the SRAM full condition.
+        //Wait for the SRAM full condition.
+        auto cSramFull = [this]()
         {
-            cVal = ReadReg ( fStrFull );
+            return ReadReg ( fStrFull ) != 0;
+        };
 
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+        // the acquisition thread is being stopped, there is no packet to read
+        if ( !fDataPolling.Poll ( cSramFull, "SRAM full", &fStopAcquisition ) ) return 0;
 
         //break trigger
         if ( pBreakTrigger ) WriteReg ( "break_trigger", 1 );
 
         uint32_t nbEvtPacket = fNpackets;
         uint32_t nbBlockSize = fBlockSize;
-        std::vector<uint32_t> cData;
 
         if (fJustPaused)
         {
@@ -344,7 +323,7 @@ namespace Ph2_HwInterface {
 
         //Read SRAM
         if (nbBlockSize > 0)
-            cData =  ReadBlockRegValue ( fStrSram, nbBlockSize );
+            ReadBlockRegIntoBuffer ( fStrSram, nbBlockSize, fPacketBuffer );
 
         std::this_thread::sleep_for ( 10 * cWait );
         //WriteReg ( fStrSramUserLogic, 1 );
@@ -354,38 +333,19 @@ namespace Ph2_HwInterface {
         //now I did an acquistion, so I need to increment the counter
         fNthAcq++;
 
-        //Wait for the non SRAM full condition starts,
-        do
+        //Wait for the non SRAM full condition
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( fStrFull );
-
-            if ( cVal == 1 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 1 );
-
-        //Wait for the non SRAM full condition ends.
+            return ReadReg ( fStrFull ) != 1;
+        }, "SRAM readout end" );
 
         WriteReg ( fStrReadout, 0 );
         WriteReg ( "pc_commands.force_BG0_start", 0 );
 
         if ( pBreakTrigger ) WriteReg ( "break_trigger", 0 );
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
-
-        fData = new Data();
-
-        if (nbEvtPacket > 0)       // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        {
-            fData->Set ( pBoard, cData , nbEvtPacket, false );
-
-            if ( fSaveToFile )
-            {
-                fFileHandler->set ( cData );
-                fFileHandler->writeFile();
-            }
-        }
+        // hand the packet over to fData which decodes it in place, an empty packet just resets it
+        SetPacket ( pBoard, fData, nbEvtPacket, false, fFileHandler );
 
         return nbEvtPacket;
     }
@@ -395,6 +355,7 @@ namespace Ph2_HwInterface {
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
 
         fNpackets = pNEvents;
+        setPollingPrediction();
         //Starting the DAQ
         cVecReg.push_back ( {"pc_commands.CBC_DATA_PACKET_NUMBER", pNEvents - 1} );
         cVecReg.push_back ( {"break_trigger", 0} );
@@ -406,17 +367,10 @@ namespace Ph2_HwInterface {
 
 
         //Wait for start acknowledge
-        uhal::ValWord<uint32_t> cVal;
-        std::chrono::milliseconds cWait ( 100 );
-
-        do
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( "status_flags.CMD_START_VALID" );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( "status_flags.CMD_START_VALID" ) != 0;
+        }, "CMD_START_VALID" );
 
         if ( pBoard )
             fBlockSize = computeBlockSize ( pBoard );
@@ -425,16 +379,10 @@ namespace Ph2_HwInterface {
         SelectDaqSRAM();
 
         //Wait for the SRAM full condition.
-        cVal = ReadReg ( fStrFull );
-
-        do
+        fDataPolling.Poll ( [this]()
         {
-            cVal = ReadReg ( fStrFull );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( fStrFull ) != 0;
+        }, "SRAM full" );
 
         //break trigger
         cVecReg.push_back ({ "break_trigger", 0 } );
@@ -447,31 +395,29 @@ namespace Ph2_HwInterface {
         //WriteReg ( fStrSramUserLogic, 0 );
 
         //Read SRAM
-        std::vector<uint32_t> cData =  ReadBlockRegValue ( fStrSram, fBlockSize );
+        ReadBlockRegIntoBuffer ( fStrSram, fBlockSize, fPacketBuffer );
 
         //WriteReg ( fStrSramUserLogic, 1 );
 
         //need to increment the internal Acquisition counter
         fNthAcq++;
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
-
-        fData = new Data();
-
-        // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        fData->Set ( pBoard, cData , fNpackets, false );
-
-        if ( fSaveToFile )
-        {
-            fFileHandler->set ( cData );
-            fFileHandler->writeFile();
-        }
+        // hand the packet over to fData which decodes it in place; getting the correct sizes happens in Set()
+        SetPacket ( pBoard, fData, fNpackets, false, fFileHandler );
 
         WriteReg ( "pc_commands.PC_config_ok", 0 );
     }
 
 
+    void CtaFWInterface::setPollingPrediction()
+    {
+        // INT_TRIGGER_FREQ n means 2^n Hz; with external triggers the rate is unknown and the polling learns it
+        uint32_t cTriggerSel = ReadReg ( "pc_commands.TRIGGER_SEL" );
+        uint32_t cTriggerFreq = ReadReg ( "pc_commands.INT_TRIGGER_FREQ" );
+        fDataPolling.SetTriggerRate ( ( cTriggerSel == 0 ) ? double ( 1u << cTriggerFreq ) : 0 );
+        fDataPolling.SetEventsPerPacket ( fNpackets );
+    }
+
     /** compute the block size according to the number of CBC's on this board
      * this will have to change with a more generic FW */
     uint32_t CtaFWInterface::computeBlockSize ( BeBoard* pBoard )
@@ -667,6 +613,7 @@ namespace Ph2_HwInterface {
 
     void CtaFWInterface::WriteI2C ( std::vector<uint32_t>& pVecReq, bool pWrite )
     {
+        RegOpScope cScope ( RegOp::I2cCommand );
         //pVecReq.push_back ( 0xFFFFFFFF );
 
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
@@ -689,6 +636,7 @@ namespace Ph2_HwInterface {
 
     void CtaFWInterface::ReadI2C ( std::vector<uint32_t>& pVecReq )
     {
+        RegOpScope cScope ( RegOp::I2cCommand );
         //WriteReg ( "ctrl_sram.sram1_user_logic", 0 );
         pVecReq = ReadBlockRegValue ( "cbc_config_fifo_rx_FE0", pVecReq.size() );
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
@@ -168,6 +168,11 @@ namespace Ph2_HwInterface {
             return fData->GetEvents ( pBoard );
         }
 
+        uint32_t ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs ) override
+        {
+            return DecodePacket ( pBoard, fData, pTimeoutMs );
+        }
+
         //void StartThread (BeBoard* pBoard, uint32_t uNbAcq, HwInterfaceVisitor* visitor) override;
         //void threadAcquisitionLoop (BeBoard* pBoard, HwInterfaceVisitor* visitor);
 
@@ -204,6 +209,8 @@ namespace Ph2_HwInterface {
         /*! Compute the size of an acquisition data block
          * \return Number of 32-bit words to be read at each iteration */
         uint32_t computeBlockSize (BeBoard* pBoard);
+        /*! Tell the data polling how long fNpackets events take, if the internal trigger is used */
+        void setPollingPrediction();
 
 
       public:
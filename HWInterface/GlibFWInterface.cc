@@ -21,7 +21,7 @@ namespace Ph2_HwInterface {
                                        uint32_t pBoardId ) :
         BeBoardFWInterface ( puHalConfigFileName, pBoardId ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fNthAcq (0) 
     {
     }
@@ -32,7 +32,7 @@ namespace Ph2_HwInterface {
                                        FileHandler* pFileHandler ) :
         BeBoardFWInterface ( puHalConfigFileName, pBoardId ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fFileHandler ( pFileHandler ),
         fNthAcq (0)
     {
@@ -45,7 +45,7 @@ namespace Ph2_HwInterface {
                                        const char* pAddressTable ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fNthAcq (0)
     {
     }
@@ -57,7 +57,7 @@ namespace Ph2_HwInterface {
                                        FileHandler* pFileHandler ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fFileHandler ( pFileHandler ),
         fNthAcq (0)
     {
@@ -160,19 +160,13 @@ namespace Ph2_HwInterface {
         fNthAcq = 0;
         // Since the Number of  Packets is a FW register, it should be read from the Settings Table which is one less than is actually read
         fNpackets = ReadReg ( "pc_commands.CBC_DATA_PACKET_NUMBER" ) + 1 ;
+        setPollingPrediction();
 
         //Wait for start acknowledge
-        uhal::ValWord<uint32_t> cVal;
-        std::chrono::milliseconds cWait ( 100 );
-
-        do
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( "status_flags.CMD_START_VALID" );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( "status_flags.CMD_START_VALID" ) != 0;
+        }, "CMD_START_VALID" );
     }
 
     void GlibFWInterface::Stop()
@@ -220,11 +214,6 @@ namespace Ph2_HwInterface {
 
     uint32_t GlibFWInterface::ReadData ( BeBoard* pBoard,  bool pBreakTrigger )
     {
-        //Readout settings
-        std::chrono::milliseconds cWait ( 1 );
-
-        uhal::ValWord<uint32_t> cVal;
-
         if ( pBoard )
             fBlockSize = computeBlockSize ( pBoard );
 
@@ -233,61 +222,44 @@ namespace Ph2_HwInterface {
         SelectDaqSRAM();
 
         //Wait for the SRAM full condition.
-        cVal = ReadReg ( fStrFull );
-
-        do
+        auto cSramFull = [this]()
         {
-            cVal = ReadReg ( fStrFull );
+            return ReadReg ( fStrFull ) != 0;
+        };
 
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+        // the acquisition thread is being stopped, there is no packet to read
+        if ( !fDataPolling.Poll ( cSramFull, "SRAM full", &fStopAcquisition ) ) return 0;
 
-        //break trigger
-        if ( pBreakTrigger ) WriteReg ( "break_trigger", 1 );
+        //break trigger, queued to go out with the SRAM read
+        if ( pBreakTrigger ) QueueWrite ( "break_trigger", 1 );
 
         //Set read mode to SRAM
-        WriteReg ( fStrSramUserLogic, 0 );
+        QueueWrite ( fStrSramUserLogic, 0 );
 
         //Read SRAM
-        std::vector<uint32_t> cData =  ReadBlockRegValue ( fStrSram, fBlockSize );
+        ReadBlockRegIntoBuffer ( fStrSram, fBlockSize, fPacketBuffer );
 
-        WriteReg ( fStrSramUserLogic, 1 );
-        WriteReg ( fStrReadout, 1 );
+        QueueWrite ( fStrSramUserLogic, 1 );
+        QueueWrite ( fStrReadout, 1 );
+        Flush();
 
         //now I did an acquistion, so I need to increment the counter
         fNthAcq++;
 
-        //Wait for the non SRAM full condition starts,
-        do
+        //Wait for the non SRAM full condition
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( fStrFull );
+            return ReadReg ( fStrFull ) != 1;
+        }, "SRAM readout end" );
 
-            if ( cVal == 1 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 1 );
-
-        //Wait for the non SRAM full condition ends.
-
-        WriteReg ( fStrReadout, 0 );
+        QueueWrite ( fStrReadout, 0 );
 
-        if ( pBreakTrigger ) WriteReg ( "break_trigger", 0 );
+        if ( pBreakTrigger ) QueueWrite ( "break_trigger", 0 );
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
+        Flush();
 
-        fData = new Data();
-
-        // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        fData->Set ( pBoard, cData , fNpackets, false );
-
-        if ( fSaveToFile )
-        {
-            fFileHandler->set ( cData );
-            fFileHandler->writeFile();
-        }
+        // hand the packet over to fData which decodes it in place; getting the correct sizes happens in Set()
+        SetPacket ( pBoard, fData, fNpackets, false, fFileHandler );
 
         return fNpackets;
     }
@@ -297,6 +269,7 @@ namespace Ph2_HwInterface {
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
 
         fNpackets = pNEvents;
+        setPollingPrediction();
         //Starting the DAQ
         cVecReg.push_back ( {"pc_commands.CBC_DATA_PACKET_NUMBER", pNEvents - 1} );
         cVecReg.push_back ( {"break_trigger", 0} );
@@ -308,17 +281,10 @@ namespace Ph2_HwInterface {
 
 
         //Wait for start acknowledge
-        uhal::ValWord<uint32_t> cVal;
-        std::chrono::milliseconds cWait ( 100 );
-
-        do
+        fHandshakePolling.Poll ( [this]()
         {
-            cVal = ReadReg ( "status_flags.CMD_START_VALID" );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( "status_flags.CMD_START_VALID" ) != 0;
+        }, "CMD_START_VALID" );
 
         if ( pBoard )
             fBlockSize = computeBlockSize ( pBoard );
@@ -327,16 +293,10 @@ namespace Ph2_HwInterface {
         SelectDaqSRAM();
 
         //Wait for the SRAM full condition.
-        cVal = ReadReg ( fStrFull );
-
-        do
+        fDataPolling.Poll ( [this]()
         {
-            cVal = ReadReg ( fStrFull );
-
-            if ( cVal == 0 )
-                std::this_thread::sleep_for ( cWait );
-        }
-        while ( cVal == 0 );
+            return ReadReg ( fStrFull ) != 0;
+        }, "SRAM full" );
 
         //break trigger
         cVecReg.push_back ({ "break_trigger", 1 } );
@@ -349,31 +309,29 @@ namespace Ph2_HwInterface {
         WriteReg ( fStrSramUserLogic, 0 );
 
         //Read SRAM
-        std::vector<uint32_t> cData =  ReadBlockRegValue ( fStrSram, fBlockSize );
+        ReadBlockRegIntoBuffer ( fStrSram, fBlockSize, fPacketBuffer );
 
         WriteReg ( fStrSramUserLogic, 1 );
 
         //need to increment the internal Acquisition counter
         fNthAcq++;
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
-
-        fData = new Data();
-
-        // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        fData->Set ( pBoard, cData , fNpackets, false );
-
-        if ( fSaveToFile )
-        {
-            fFileHandler->set ( cData );
-            fFileHandler->writeFile();
-        }
+        // hand the packet over to fData which decodes it in place; getting the correct sizes happens in Set()
+        SetPacket ( pBoard, fData, fNpackets, false, fFileHandler );
 
         WriteReg ( "pc_commands.PC_config_ok", 0 );
     }
 
 
+    void GlibFWInterface::setPollingPrediction()
+    {
+        // INT_TRIGGER_FREQ n means 2^n Hz; with external triggers the rate is unknown and the polling learns it
+        uint32_t cTriggerSel = ReadReg ( "pc_commands.TRIGGER_SEL" );
+        uint32_t cTriggerFreq = ReadReg ( "pc_commands.INT_TRIGGER_FREQ" );
+        fDataPolling.SetTriggerRate ( ( cTriggerSel == 0 ) ? double ( 1u << cTriggerFreq ) : 0 );
+        fDataPolling.SetEventsPerPacket ( fNpackets );
+    }
+
     /** compute the block size according to the number of CBC's on this board
      * this will have to change with a more generic FW */
     uint32_t GlibFWInterface::computeBlockSize ( BeBoard* pBoard )
@@ -420,6 +378,21 @@ namespace Ph2_HwInterface {
         return vBlock;
     }
 
+    void GlibFWInterface::ReadBlockRegIntoBuffer ( const std::string& pRegNode, const uint32_t& pBlocksize, std::vector<uint32_t>& pBuffer )
+    {
+        size_t cStart = pBuffer.size();
+        std::future<uint32_t> cWord256;
+
+        // To avoid the IPBUS bug, the 256th word of this block is read separately, in the same dispatch as the block
+        if ( pBlocksize > 255 )
+            cWord256 = QueueRead ( pRegNode + "_256" );
+
+        BeBoardFWInterface::ReadBlockRegIntoBuffer ( pRegNode, pBlocksize, pBuffer );
+
+        if ( pBlocksize > 255 )
+            pBuffer[cStart + 255] = cWord256.get();
+    }
+
     bool GlibFWInterface::WriteBlockReg ( const std::string& pRegNode, const std::vector< uint32_t >& pValues )
     {
         bool cWriteCorr = RegManager::WriteBlockReg ( pRegNode, pValues );
@@ -568,6 +541,7 @@ namespace Ph2_HwInterface {
 
     void GlibFWInterface::WriteI2C ( std::vector<uint32_t>& pVecReq, bool pWrite )
     {
+        RegOpScope cScope ( RegOp::I2cCommand );
         pVecReq.push_back ( 0xFFFFFFFF );
 
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
@@ -595,6 +569,7 @@ namespace Ph2_HwInterface {
 
     void GlibFWInterface::ReadI2C ( std::vector<uint32_t>& pVecReq )
     {
+        RegOpScope cScope ( RegOp::I2cCommand );
         //Read Size + 1 to have the ffffffff word
         uint32_t pVecReqSize = pVecReq.size() + 1;
         pVecReq.clear();
@@ -92,6 +92,7 @@ namespace Ph2_HwInterface {
          * \return Vector of validated 32-bit values
          */
         std::vector<uint32_t> ReadBlockRegValue ( const std::string& pRegNode, const uint32_t& pBlocksize ) override;
+        void ReadBlockRegIntoBuffer ( const std::string& pRegNode, const uint32_t& pBlocksize, std::vector<uint32_t>& pBuffer ) override;
 
         bool WriteBlockReg ( const std::string& pRegNode, const std::vector< uint32_t >& pValues ) override;
 
@@ -158,6 +159,11 @@ namespace Ph2_HwInterface {
             return fData->GetEvents ( pBoard );
         }
 
+        uint32_t ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs ) override
+        {
+            return DecodePacket ( pBoard, fData, pTimeoutMs );
+        }
+
         //void StartThread (BeBoard* pBoard, uint32_t uNbAcq, HwInterfaceVisitor* visitor) override;
         //void threadAcquisitionLoop (BeBoard* pBoard, HwInterfaceVisitor* visitor);
 
@@ -195,6 +201,8 @@ namespace Ph2_HwInterface {
         /*! Compute the size of an acquisition data block
          * \return Number of 32-bit words to be read at each iteration */
         uint32_t computeBlockSize (BeBoard* pBoard);
+        /*! Tell the data polling how long fNpackets events take, if the internal trigger is used */
+        void setPollingPrediction();
 
 
       public:
@@ -23,11 +23,13 @@ namespace Ph2_HwInterface {
                                          uint32_t pBoardId ) :
         BeBoardFWInterface ( puHalConfigFileName, pBoardId ),
         fpgaConfig (nullptr),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fBroadcastCbcId (0),
         fReplyBufferSize (1024),
         fFMCId (1) 
-    {}
+    {
+        resolveNodes();
+    }
 
 
     ICFc7FWInterface::ICFc7FWInterface ( const char* puHalConfigFileName,
@@ -35,7 +37,7 @@ namespace Ph2_HwInterface {
                                          FileHandler* pFileHandler ) :
         BeBoardFWInterface ( puHalConfigFileName, pBoardId ),
         fpgaConfig (nullptr),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fBroadcastCbcId (0),
         fReplyBufferSize (1024),
         fFileHandler ( pFileHandler ),
@@ -43,6 +45,8 @@ namespace Ph2_HwInterface {
     {
         if ( fFileHandler == nullptr ) fSaveToFile = false;
         else fSaveToFile = true;
+
+        resolveNodes();
     }
 
     ICFc7FWInterface::ICFc7FWInterface ( const char* pId,
@@ -50,11 +54,13 @@ namespace Ph2_HwInterface {
                                          const char* pAddressTable ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fBroadcastCbcId (0),
         fReplyBufferSize (1024),
         fFMCId (1)
-    {}
+    {
+        resolveNodes();
+    }
 
 
     ICFc7FWInterface::ICFc7FWInterface ( const char* pId,
@@ -63,7 +69,7 @@ namespace Ph2_HwInterface {
                                          FileHandler* pFileHandler ) :
         BeBoardFWInterface ( pId, pUri, pAddressTable ),
         fpgaConfig ( nullptr ),
-        fData ( nullptr ),
+        fData ( new Data() ),
         fBroadcastCbcId (0),
         fReplyBufferSize (1024),
         fFileHandler ( pFileHandler ),
@@ -71,6 +77,8 @@ namespace Ph2_HwInterface {
     {
         if ( fFileHandler == nullptr ) fSaveToFile = false;
         else fSaveToFile = true;
+
+        resolveNodes();
     }
 
     void ICFc7FWInterface::setFileHandler (FileHandler* pHandler)
@@ -112,6 +120,21 @@ namespace Ph2_HwInterface {
         return cVersionWord;
     }
 
+    void ICFc7FWInterface::resolveNodes()
+    {
+        char tmp[256];
+        fDaqCtrlNode = GetRegHandle ( "cbc_daq_ctrl.daq_ctrl" );
+        fNEventsNode = GetRegHandle ( "cbc_daq_ctrl.nevents_per_pcdaq" );
+        fDataReadyNode = GetRegHandle ( "cbc_daq_ctrl.event_data_buf_status.data_ready" );
+        fDataBufNode = GetRegHandle ( "data_buf" );
+        fI2cCommandNode = GetRegHandle ( "cbc_i2c_command" );
+        fI2cCtrlNode = GetRegHandle ( "cbc_daq_ctrl.cbc_i2c_ctrl" );
+        sprintf ( tmp, "cbc_daq_ctrl.i2c_reply_fifo_fmc%d_status.nwdata", fFMCId );
+        fI2cNRepliesNode = GetRegHandle ( tmp );
+        sprintf ( tmp, "cbc_i2c_reply.fmc%d", fFMCId );
+        fI2cReplyNode = GetRegHandle ( tmp );
+    }
+
     void ICFc7FWInterface::ConfigureBoard ( const BeBoard* pBoard )
     {
         std::vector< std::pair<std::string, uint32_t> > cVecReg;
@@ -151,6 +174,9 @@ namespace Ph2_HwInterface {
             }
         }
 
+        // the I2C reply FIFO depends on the FMC found above
+        resolveNodes();
+
         bool cVal = (fBroadcastCbcId == 2) ? 0 : 1;
         cVecReg.push_back ({"cbc_daq_ctrl.general.fmc_wrong_pol", static_cast<uint32_t> (cVal) });
         cVecReg.push_back ({"cbc_daq_ctrl.general.fmc_pc045c_4hybrid", static_cast<uint32_t> (cVal) });
@@ -219,54 +245,43 @@ namespace Ph2_HwInterface {
 
     void ICFc7FWInterface::Stop()
     {
-        WriteReg ( "cbc_daq_ctrl.daq_ctrl", STOP );
+        WriteReg ( fDaqCtrlNode, STOP );
     }
 
 
     void ICFc7FWInterface::Pause()
     {
         //this should just brake triggers
-        WriteReg ( "cbc_daq_ctrl.daq_ctrl", 0x4000 );
+        WriteReg ( fDaqCtrlNode, 0x4000 );
     }
 
 
     void ICFc7FWInterface::Resume()
     {
-        WriteReg ( "cbc_daq_ctrl.daq_ctrl", 0x2000 );
+        WriteReg ( fDaqCtrlNode, 0x2000 );
     }
 
     uint32_t ICFc7FWInterface::ReadData ( BeBoard* pBoard, bool pBreakTrigger )
     {
-        std::chrono::milliseconds cWait ( 1 );
         //first, read how many Events per Acquisition
-        fNEventsperAcquistion = ReadReg ("cbc_daq_ctrl.nevents_per_pcdaq");
+        fNEventsperAcquistion = ReadReg ( fNEventsNode );
         //the size of the packet to read then is fNEventsperAcquistion * fDataSizeperEvent32
+        fDataPolling.SetEventsPerPacket ( fNEventsperAcquistion );
 
         //first, poll if the packet is ready
-        uint32_t cVal = 0;
-
-        while (cVal == 0)
+        auto cDataReady = [this]()
         {
-            cVal = ReadReg ("cbc_daq_ctrl.event_data_buf_status.data_ready" ) & 0x1;
-            std::this_thread::sleep_for ( cWait );
-        }
-
-        //ok, packet complete, now let's read
-        std::vector<uint32_t> cData =  ReadBlockRegValue ( "data_buf", fNEventsperAcquistion * fDataSizeperEvent32 );
+            return ReadReg ( fDataReadyNode ) & 0x1;
+        };
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
+        // the acquisition thread is being stopped, there is no packet to read
+        if ( !fDataPolling.Poll ( cDataReady, "data_ready", &fStopAcquisition ) ) return 0;
 
-        fData = new Data();
+        //ok, packet complete, now let's read it straight into the packet buffer
+        ReadBlockRegIntoBuffer ( fDataBufNode, fNEventsperAcquistion * fDataSizeperEvent32, fPacketBuffer );
 
-        // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        fData->Set ( pBoard, cData , fNEventsperAcquistion, true );
-
-        if ( fSaveToFile )
-        {
-            fFileHandler->set ( cData );
-            fFileHandler->writeFile();
-        }
+        // hand the packet over to fData which decodes it in place; getting the correct sizes happens in Set()
+        SetPacket ( pBoard, fData, fNEventsperAcquistion, true, fFileHandler );
 
         return fNEventsperAcquistion;
     }
@@ -306,7 +321,9 @@ namespace Ph2_HwInterface {
 
         //here I optimize for speed during calibration, so I explicitly set the nevents_per_pcdaq to the event number I desire
         fNEventsperAcquistion = cNEvents;
-        std::vector<uint32_t> cData;
+        fDataPolling.SetEventsPerPacket ( cNEvents );
+        fPacketBuffer.clear();
+        fPacketBuffer.reserve ( cNCycles * fNEventsperAcquistion * fDataSizeperEvent32 );
 
         // I have to do cNCycles with cNEvents
         for (uint32_t cIndex = 0; cIndex < cNCycles; cIndex++)
@@ -317,38 +334,20 @@ namespace Ph2_HwInterface {
             WriteStackReg ( cVecReg );
             cVecReg.clear();
             //now poll for data to be ready
-            std::chrono::milliseconds cWait ( 1 );
-
-            //first, poll if the packet is ready
-            uint32_t cVal = 0;
-
-            while (cVal == 0)
+            fDataPolling.Poll ( [this]()
             {
-                cVal = ReadReg ("cbc_daq_ctrl.event_data_buf_status.data_ready" ) & 0x1;
-                std::this_thread::sleep_for ( cWait );
-            }
+                return ReadReg ( fDataReadyNode ) & 0x1;
+            }, "data_ready" );
 
-            //now stop triggers & DAQ
-            WriteReg ( "cbc_daq_ctrl.daq_ctrl", STOP );
+            //now stop triggers & DAQ, in the same dispatch as the data read
+            QueueWrite ( fDaqCtrlNode, STOP );
 
-            //ok, packet complete, now let's read and append to cData
-            std::vector<uint32_t> cTmpData =  ReadBlockRegValue ( "data_buf", fNEventsperAcquistion * fDataSizeperEvent32 );
-            cData.insert (cData.end(), std::make_move_iterator (cTmpData.begin() ), std::make_move_iterator (cTmpData.end() ) );
+            //ok, packet complete, now let's read and append to the packet buffer
+            ReadBlockRegIntoBuffer ( fDataBufNode, fNEventsperAcquistion * fDataSizeperEvent32, fPacketBuffer );
         }
 
-        // just creates a new Data object, setting the pointers and getting the correct sizes happens in Set()
-        if ( fData ) delete fData;
-
-        fData = new Data();
-
-        // set the vector<uint32_t> as event buffer and let him know how many packets it contains
-        fData->Set ( pBoard, cData , cNCycles * fNEventsperAcquistion, true );
-
-        if ( fSaveToFile )
-        {
-            fFileHandler->set ( cData );
-            fFileHandler->writeFile();
-        }
+        // hand the packet over to fData which decodes it in place; getting the correct sizes happens in Set()
+        SetPacket ( pBoard, fData, cNCycles * fNEventsperAcquistion, true, fFileHandler );
     }
 
     std::vector<uint32_t> ICFc7FWInterface::ReadBlockRegValue (const std::string& pRegNode, const uint32_t& pBlocksize )
@@ -430,15 +429,13 @@ namespace Ph2_HwInterface {
 
     bool ICFc7FWInterface::ReadI2C (  uint32_t pNReplies, std::vector<uint32_t>& pReplies)
     {
+        RegOpScope cScope ( RegOp::I2cCommand );
         usleep (SINGLE_I2C_WAIT * pNReplies );
 
         bool cFailed (false);
 
         //read the number of received replies from nwdata and use this number to compare with the number of expected replies and to read this number 32-bit words from the reply FIFO
-        char tmp[256];
-        sprintf ( tmp, "cbc_daq_ctrl.i2c_reply_fifo_fmc%d_status.nwdata", fFMCId );
-        std::string cNode (tmp);
-        uint32_t cNReplies = ReadReg (cNode);
+        uint32_t cNReplies = ReadReg ( fI2cNRepliesNode );
 
 
         if (cNReplies != pNReplies)
@@ -447,13 +444,10 @@ namespace Ph2_HwInterface {
             cFailed = true;
         }
 
-        sprintf ( tmp, "cbc_i2c_reply.fmc%d", fFMCId );
-        cNode = tmp;
-
         //not sure if necessary
         try
         {
-            pReplies = ReadBlockRegValue ( cNode, cNReplies );
+            pReplies = ReadBlockReg ( fI2cReplyNode, cNReplies ).value();
         }
         catch ( Exception& except )
         {
@@ -465,8 +459,8 @@ namespace Ph2_HwInterface {
         uint8_t cCbcId;
         bool cRead;
 
-        //explicitly reset the nwdata word
-        WriteReg ("cbc_daq_ctrl.cbc_i2c_ctrl", 0x2);
+        //explicitly reset the nwdata word, queued so that it goes out with the next I2C command block
+        QueueWrite ( fI2cCtrlNode, 0x2 );
 
         return cFailed;
     }
@@ -486,9 +480,11 @@ namespace Ph2_HwInterface {
 
         if ( ( cDivNM == 1 && cRemNM == 0 ) || ( cDivNM == 0 && cRemNM != 0 ) )
         {
+            RegOpScope cScope ( RegOp::I2cCommand );
+
             try
             {
-                WriteBlockReg ( "cbc_i2c_command", pVecSend );
+                WriteBlockReg ( fI2cCommandNode, pVecSend );
             }
             catch ( Exception& except )
             {
@@ -603,46 +599,126 @@ namespace Ph2_HwInterface {
     bool ICFc7FWInterface::BCWriteCbcBlockReg ( std::vector<uint32_t>& pVecReg, bool pReadback)
     {
         std::vector<uint32_t> cReplies;
-        bool cSuccess = !WriteI2C ( pVecReg, cReplies, false, true );
+        bool cSuccess = true;
+        //every Cbc replies to a broadcast word, and ReadI2C overwrites its reply vector: send as many words at a time as the reply FIFO can answer
+        uint32_t cBlockSize = std::max<uint32_t> ( fReplyBufferSize / std::max<uint32_t> ( fBroadcastCbcId, 1 ), 1 );
+        std::vector<uint32_t> cCommandBlock;
+        std::vector<uint32_t> cBlockReplies;
+
+        for ( size_t cFirst = 0; cFirst < pVecReg.size(); cFirst += cBlockSize )
+        {
+            size_t cLast = std::min<size_t> ( cFirst + cBlockSize, pVecReg.size() );
+            cCommandBlock.assign ( pVecReg.begin() + cFirst, pVecReg.begin() + cLast );
+
+            if ( WriteI2C ( cCommandBlock, cBlockReplies, false, true ) ) cSuccess = false;
+
+            cReplies.insert ( cReplies.end(), cBlockReplies.begin(), cBlockReplies.end() );
+        }
 
-        //just as above, I can check the replies - there will be NCbc * pVecReg.size() write replies and also read replies if I chose to enable readback
-        //this needs to be adapted
+        //just as above, I can check the replies - there will be NCbc * pVecReg.size() write replies
         if (pReadback)
         {
-            //TODO: actually, i just need to check the read write and the info bit in each reply - if all info bits are 0, this is as good as it gets, else collect the replies that faild for decoding - potentially no iterative retrying
             //TODO: maybe I can do something with readback here - think about it
             for (auto& cWord : cReplies)
             {
-                //it was a write transaction!
-                if ( ( (cWord >> 17) & 0x1) == 0)
-                {
-                    // infor bit is 0 which means that the transaction was acknowledged by the CBC
-                    if ( ( (cWord >> 20) & 0x1) == 0)
-                        cSuccess = true;
-                    else cSuccess == false;
-                }
-                else
+                //it was a write transaction and the info bit is 0, which means that the transaction was acknowledged by the CBC
+                //a single failed reply fails the whole broadcast
+                if ( ( (cWord >> 17) & 0x1) != 0 || ( (cWord >> 20) & 0x1) != 0 )
                     cSuccess = false;
 
                 //LOG(INFO) << std::bitset<32>(cWord) ;
             }
 
-            //cWriteAgain = get_mismatches (pVecReg.begin(), pVecReg.end(), cReplies.begin(), ICFc7FWInterface::cmd_reply_ack);
-            pVecReg.clear();
-            pVecReg = cReplies;
-
+            pVecReg.swap ( cReplies );
         }
 
         return cSuccess;
     }
 
+    std::vector<bool> ICFc7FWInterface::WriteCbcBatchReg ( std::vector<uint32_t>& pVecReg, bool pReadback )
+    {
+        uint8_t cMaxWriteAttempts = 5;
+        //the reply FIFO holds a write and a read reply per word with readback
+        uint32_t cRepliesPerWord = pReadback ? 2 : 1;
+        uint32_t cBlockSize = fReplyBufferSize / cRepliesPerWord;
+
+        std::vector<bool> cGood ( pVecReg.size(), false );
+        std::vector<uint32_t> cReplies ( pVecReg.size(), 0 );
+        //indices into pVecReg of the words still to be written
+        std::vector<size_t> cPending ( pVecReg.size() );
+
+        for ( size_t cIndex = 0; cIndex < cPending.size(); cIndex++ )
+            cPending[cIndex] = cIndex;
+
+        for ( uint8_t cAttempt = 0; cAttempt < cMaxWriteAttempts && !cPending.empty(); cAttempt++ )
+        {
+            std::vector<size_t> cFailed;
+
+            for ( size_t cFirst = 0; cFirst < cPending.size(); cFirst += cBlockSize )
+            {
+                size_t cLast = std::min<size_t> ( cFirst + cBlockSize, cPending.size() );
+                std::vector<uint32_t> cCommandBlock;
+
+                for ( size_t cIndex = cFirst; cIndex < cLast; cIndex++ )
+                    cCommandBlock.push_back ( pVecReg.at ( cPending[cIndex] ) );
+
+                {
+                    RegOpScope cScope ( RegOp::I2cCommand );
+                    WriteBlockReg ( fI2cCommandNode, cCommandBlock );
+                }
+
+                std::vector<uint32_t> cBlockReplies;
+                ReadI2C ( cCommandBlock.size() * cRepliesPerWord, cBlockReplies );
+
+                //with readback the odd replies carry the read back value, else the write acknowledge is checked
+                for ( size_t cWord = 0; cWord < cCommandBlock.size(); cWord++ )
+                {
+                    size_t cIndex = cPending[cFirst + cWord];
+                    size_t cReply = cWord * cRepliesPerWord + cRepliesPerWord - 1;
+                    bool cOk = false;
+
+                    if ( cReply < cBlockReplies.size() )
+                    {
+                        cReplies[cIndex] = cBlockReplies[cReply];
+                        cOk = pReadback ? cmd_reply_comp ( cCommandBlock[cWord], cBlockReplies[cReply] ) : cmd_reply_ack ( cCommandBlock[cWord], cBlockReplies[cReply] );
+                    }
+
+                    if ( cOk ) cGood[cIndex] = true;
+                    else cFailed.push_back ( cIndex );
+                }
+            }
+
+            // as for the block writes, that many errors means the I2C bus is not working at all
+            if ( cFailed.size() >= 100 ) throw Exception ( "Too many CBC readback errors - no functional I2C communication. Check the Setup" );
+
+            if ( !cFailed.empty() && cAttempt + 1 < cMaxWriteAttempts )
+                LOG (INFO) << BOLDRED <<  "(WRITE#"  << std::to_string (cAttempt) << ") There were " << cFailed.size() << ( pReadback ? " Readback Errors" : " CBC CMD acknowledge bits missing" ) << " -trying again!" << RESET ;
+
+            cPending.swap ( cFailed );
+        }
+
+        pVecReg = cReplies;
+        return cGood;
+    }
+
     void ICFc7FWInterface::ReadCbcBlockReg (  std::vector<uint32_t>& pVecReg )
     {
         std::vector<uint32_t> cReplies;
-        //it sounds weird, but ReadI2C is called inside writeI2c, therefore here I have to write and disable the readback. The actual read command is in the words of the vector, no broadcast, maybe I can get rid of it
-        WriteI2C ( pVecReg, cReplies, false, false);
-        pVecReg.clear();
-        pVecReg = cReplies;
+        cReplies.reserve ( pVecReg.size() );
+        //ReadI2C overwrites its reply vector, so blocks larger than the reply FIFO are sent one FIFO at a time and the replies appended
+        std::vector<uint32_t> cCommandBlock;
+        std::vector<uint32_t> cBlockReplies;
+
+        for ( size_t cFirst = 0; cFirst < pVecReg.size(); cFirst += fReplyBufferSize )
+        {
+            size_t cLast = std::min<size_t> ( cFirst + fReplyBufferSize, pVecReg.size() );
+            cCommandBlock.assign ( pVecReg.begin() + cFirst, pVecReg.begin() + cLast );
+            //it sounds weird, but ReadI2C is called inside writeI2c, therefore here I have to write and disable the readback. The actual read command is in the words of the vector, no broadcast, maybe I can get rid of it
+            WriteI2C ( cCommandBlock, cBlockReplies, false, false);
+            cReplies.insert ( cReplies.end(), cBlockReplies.begin(), cBlockReplies.end() );
+        }
+
+        pVecReg.swap ( cReplies );
     }
 
     void ICFc7FWInterface::CbcFastReset()
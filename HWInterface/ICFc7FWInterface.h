@@ -49,6 +49,21 @@ namespace Ph2_HwInterface {
         uint32_t fNEventsperAcquistion;
         uint32_t fDataSizeperEvent32;
         uint32_t fFMCId;
+
+        // nodes of the registers used for every event packet and I2C transaction, resolved by resolveNodes
+        RegHandle fDaqCtrlNode;
+        RegHandle fNEventsNode;
+        RegHandle fDataReadyNode;
+        RegHandle fDataBufNode;
+        RegHandle fI2cCommandNode;
+        RegHandle fI2cCtrlNode;
+        RegHandle fI2cNRepliesNode;     /*!< number of words in the I2C reply FIFO of fFMCId */
+        RegHandle fI2cReplyNode;        /*!< I2C reply FIFO of fFMCId */
+
+        /*!
+         * \brief Resolve the node handles above, again whenever fFMCId changes
+         */
+        void resolveNodes();
         
         const uint32_t SINGLE_I2C_WAIT = 70; //usec for 1MHz I2C
         //  const uint32_t SINGLE_I2C_WAIT = 700; //usec for 100 kHz I2C
@@ -103,6 +118,7 @@ namespace Ph2_HwInterface {
         std::vector<uint32_t> ReadBlockRegValue ( const std::string& pRegNode, const uint32_t& pBlocksize ) override;
 
         bool WriteBlockReg ( const std::string& pRegNode, const std::vector< uint32_t >& pValues ) override;
+        using BeBoardFWInterface::WriteBlockReg;
         /*!
          * \brief Get the FW info
          */
@@ -166,6 +182,11 @@ namespace Ph2_HwInterface {
             return fData->GetEvents ( pBoard );
         }
 
+        uint32_t ReadPacket ( BeBoard* pBoard, uint32_t pTimeoutMs ) override
+        {
+            return DecodePacket ( pBoard, fData, pTimeoutMs );
+        }
+
       private:
 
         //I2C command sending implementation
@@ -233,6 +254,11 @@ namespace Ph2_HwInterface {
 
         bool WriteCbcBlockReg ( std::vector<uint32_t>& pVecReg, uint8_t& pWriteAttempts, bool pReadback) override;
         bool BCWriteCbcBlockReg ( std::vector<uint32_t>& pVecReg, bool pReadback) override;
+        /*!
+        * \brief Fill the command FIFO with as many words as the reply buffer can answer, check every reply and rewrite only the failed registers
+        * Throws if 100 or more registers fail in one pass, like WriteCbcBlockReg
+        */
+        std::vector<bool> WriteCbcBatchReg ( std::vector<uint32_t>& pVecReg, bool pReadback ) override;
         void ReadCbcBlockReg (  std::vector<uint32_t>& pVecReg );
 
         void CbcHardReset();
@@ -0,0 +1,108 @@
+/*
+
+        FileName :                    PollingStrategy.cc
+        Content :                     Adaptive polling of FW status registers
+        Version :                     1.0
+
+ */
+
+#include "PollingStrategy.h"
+#include <sstream>
+
+namespace Ph2_HwInterface {
+
+    PollingStrategy::PollingStrategy() :
+        fSpinPolls ( 20 ),
+        fMinSleepUs ( 20 ),
+        fMaxSleepUs ( 1000 ),
+        fTimeoutMs ( 0 ),
+        fLeadFraction ( 0.8 ),
+        fTriggerRateHz ( 0 ),
+        fEventsPerPacket ( 0 ),
+        fLearnedWaitUs ( 0 ),
+        fLastCompletion ( std::chrono::steady_clock::now() )
+    {
+    }
+
+    void PollingStrategy::SetBackoff ( uint32_t pMinSleepUs, uint32_t pMaxSleepUs )
+    {
+        fMinSleepUs = ( pMinSleepUs > 0 ) ? pMinSleepUs : 1;
+        fMaxSleepUs = ( pMaxSleepUs > fMinSleepUs ) ? pMaxSleepUs : fMinSleepUs;
+    }
+
+    void PollingStrategy::SetLeadFraction ( double pFraction )
+    {
+        fLeadFraction = ( pFraction < 0 ) ? 0 : ( pFraction > 1 ) ? 1 : pFraction;
+    }
+
+    double PollingStrategy::ExpectedWaitUs() const
+    {
+        if ( fTriggerRateHz > 0 && fEventsPerPacket > 0 )
+        {
+            double cPredictedUs = 1e6 * fEventsPerPacket / fTriggerRateHz;
+            double cSinceLastUs = std::chrono::duration<double, std::micro> ( std::chrono::steady_clock::now() - fLastCompletion ).count();
+            return ( cPredictedUs > cSinceLastUs ) ? cPredictedUs - cSinceLastUs : 0;
+        }
+
+        return fLearnedWaitUs * eventsPerWait();
+    }
+
+    void PollingStrategy::checkTimeout ( std::chrono::steady_clock::time_point pStart, uint32_t pPolls, const char* pWhat )
+    {
+        if ( fTimeoutMs == 0 || std::chrono::steady_clock::now() - pStart < std::chrono::milliseconds ( fTimeoutMs ) )
+            return;
+
+        {
+            std::lock_guard<std::mutex> cLock ( fStatMutex );
+            fStatistics.fNTimeouts++;
+        }
+
+        // the learned time may be what made us wait too long, start over on the next wait
+        fLearnedWaitUs = 0;
+
+        std::ostringstream cMsg;
+        cMsg << "PollingStrategy: timeout after " << fTimeoutMs << " ms and " << pPolls << " reads waiting for " << pWhat;
+        throw Exception ( cMsg.str().c_str() );
+    }
+
+    void PollingStrategy::record ( std::chrono::steady_clock::time_point pStart, uint32_t pPolls )
+    {
+        fLastCompletion = std::chrono::steady_clock::now();
+        double cWaitUs = std::chrono::duration<double, std::micro> ( fLastCompletion - pStart ).count();
+
+        // exponential moving average per event, so that a change of the packet size does not spoil it
+        double cWaitPerEventUs = cWaitUs / eventsPerWait();
+        fLearnedWaitUs = ( fLearnedWaitUs > 0 ) ? 0.75 * fLearnedWaitUs + 0.25 * cWaitPerEventUs : cWaitPerEventUs;
+
+        std::lock_guard<std::mutex> cLock ( fStatMutex );
+        fStatistics.fNWaits++;
+        fStatistics.fNPolls += pPolls;
+        fStatistics.fTotalWaitUs += cWaitUs;
+
+        if ( pPolls > fStatistics.fMaxPolls ) fStatistics.fMaxPolls = pPolls;
+
+        if ( cWaitUs > fStatistics.fMaxWaitUs ) fStatistics.fMaxWaitUs = cWaitUs;
+    }
+
+    PollingStatistics PollingStrategy::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> cLock ( fStatMutex );
+        return fStatistics;
+    }
+
+    void PollingStrategy::ResetStatistics()
+    {
+        std::lock_guard<std::mutex> cLock ( fStatMutex );
+        fStatistics = PollingStatistics();
+    }
+
+    std::string PollingStrategy::StatisticsString() const
+    {
+        PollingStatistics cStat = GetStatistics();
+        std::ostringstream cStream;
+        cStream << cStat.fNWaits << " waits, " << cStat.MeanPolls() << " reads/wait (max " << cStat.fMaxPolls << "), "
+                << cStat.MeanWaitUs() << " us/wait (max " << cStat.fMaxWaitUs << " us), "
+                << cStat.fNTimeouts << " timeouts, " << cStat.fNAborts << " aborts";
+        return cStream.str();
+    }
+}
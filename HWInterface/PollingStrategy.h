@@ -0,0 +1,213 @@
+/*!
+
+        \file                   PollingStrategy.h
+        \brief                  Adaptive polling of FW status registers (data ready, SRAM full, handshakes)
+        \version                1.0
+
+ */
+
+#ifndef __POLLINGSTRATEGY_H__
+#define __POLLINGSTRATEGY_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "RegStatistics.h"
+#include "../Utils/Exception.h"
+
+namespace Ph2_HwInterface {
+
+    /*!
+     * \struct PollingStatistics
+     * \brief Counters of a PollingStrategy, one wait is one call of Poll (usually one packet)
+     */
+    struct PollingStatistics
+    {
+        uint64_t fNWaits = 0;           /*!< number of completed waits */
+        uint64_t fNPolls = 0;           /*!< register reads over all completed waits */
+        uint64_t fNTimeouts = 0;        /*!< waits that ran into the timeout */
+        uint64_t fNAborts = 0;          /*!< waits given up because of the abort flag */
+        uint32_t fMaxPolls = 0;         /*!< most register reads in a single wait */
+        double fTotalWaitUs = 0;        /*!< time spent in completed waits */
+        double fMaxWaitUs = 0;          /*!< longest completed wait */
+
+        double MeanPolls() const
+        {
+            return fNWaits ? double ( fNPolls ) / fNWaits : 0;
+        }
+        double MeanWaitUs() const
+        {
+            return fNWaits ? fTotalWaitUs / fNWaits : 0;
+        }
+    };
+
+    /*!
+     * \class PollingStrategy
+     * \brief Waits for a FW condition without a fixed sleep between register reads
+     * A wait first sleeps through most of the expected completion time, then polls back to back for a few
+     * reads and finally backs off exponentially up to a maximum sleep. The expected time is predicted from
+     * the trigger rate and the events per packet if they are known, otherwise it is learned from previous waits.
+     */
+    class PollingStrategy
+    {
+      public:
+        PollingStrategy();
+
+        /*!
+         * \brief Number of back to back reads before the backoff starts
+         */
+        void SetSpinPolls ( uint32_t pSpinPolls )
+        {
+            fSpinPolls = pSpinPolls;
+        }
+        /*!
+         * \brief First and maximum sleep of the exponential backoff
+         * \param pMinSleepUs : first sleep after the spin reads, in us
+         * \param pMaxSleepUs : upper limit of a sleep between two reads, in us
+         */
+        void SetBackoff ( uint32_t pMinSleepUs, uint32_t pMaxSleepUs );
+        /*!
+         * \brief Time after which Poll throws, 0 waits forever
+         */
+        void SetTimeout ( uint32_t pTimeoutMs )
+        {
+            fTimeoutMs = pTimeoutMs;
+        }
+        uint32_t GetTimeout() const
+        {
+            return fTimeoutMs;
+        }
+        /*!
+         * \brief Fraction of the expected completion time slept before the first read
+         */
+        void SetLeadFraction ( double pFraction );
+        /*!
+         * \brief Trigger rate used to predict the completion time, 0 if unknown (external triggers)
+         */
+        void SetTriggerRate ( double pRateHz )
+        {
+            fTriggerRateHz = pRateHz;
+        }
+        /*!
+         * \brief Number of events the FW has to collect before the condition becomes true
+         */
+        void SetEventsPerPacket ( uint32_t pNEvents )
+        {
+            fEventsPerPacket = pNEvents;
+        }
+        /*!
+         * \brief Forget the completion time learned from previous waits
+         */
+        void ResetPrediction()
+        {
+            fLearnedWaitUs = 0;
+        }
+        /*!
+         * \brief Expected duration of a wait starting now in us, 0 if nothing is known yet
+         * A prediction from the trigger rate counts from the end of the previous wait, since triggers keep
+         * filling the buffer while the previous packet is processed.
+         */
+        double ExpectedWaitUs() const;
+
+        /*!
+         * \brief Read pCondition until it returns true
+         * \param pCondition : callable doing the register read, returns true once the FW is ready
+         * \param pWhat : name of the condition for the timeout error
+         * \param pAbort : if not null, the wait gives up as soon as it is set
+         * \return true if the condition was met, false if aborted
+         */
+        template<typename Condition>
+        bool Poll ( Condition pCondition, const char* pWhat, const std::atomic<bool>* pAbort = nullptr )
+        {
+            const auto cStart = std::chrono::steady_clock::now();
+            uint32_t cPolls = 0;
+            // the register reads of pCondition show up as status polls in the RegManager statistics
+            RegOpScope cScope ( RegOp::StatusPoll );
+
+            // sleep through most of the predicted time without touching the bus, in slices to stay abortable
+            double cLeadUs = fLeadFraction * ExpectedWaitUs();
+
+            while ( cLeadUs > 0 && !aborted ( pAbort ) )
+            {
+                double cSlice = std::min ( cLeadUs, double ( cLeadSliceUs ) );
+                std::this_thread::sleep_for ( std::chrono::microseconds ( uint32_t ( cSlice ) + 1 ) );
+                cLeadUs -= cSlice;
+                checkTimeout ( cStart, cPolls, pWhat );
+            }
+
+            uint32_t cSleepUs = fMinSleepUs;
+
+            while ( !aborted ( pAbort ) )
+            {
+                cPolls++;
+
+                if ( pCondition() )
+                {
+                    record ( cStart, cPolls );
+                    return true;
+                }
+
+                checkTimeout ( cStart, cPolls, pWhat );
+
+                if ( cPolls > fSpinPolls )
+                {
+                    std::this_thread::sleep_for ( std::chrono::microseconds ( cSleepUs ) );
+                    cSleepUs = ( 2 * cSleepUs < fMaxSleepUs ) ? 2 * cSleepUs : fMaxSleepUs;
+                }
+            }
+
+            std::lock_guard<std::mutex> cLock ( fStatMutex );
+            fStatistics.fNAborts++;
+            return false;
+        }
+
+        /*!
+         * \brief Copy of the counters, safe to call while another thread polls
+         */
+        PollingStatistics GetStatistics() const;
+        void ResetStatistics();
+        /*!
+         * \brief One line summary of the statistics for the log
+         */
+        std::string StatisticsString() const;
+
+      private:
+        static const uint32_t cLeadSliceUs = 10000;  /*!< longest sleep of the lead phase, keeps the abort flag responsive */
+
+        uint32_t fSpinPolls;
+        uint32_t fMinSleepUs;
+        uint32_t fMaxSleepUs;
+        uint32_t fTimeoutMs;
+        double fLeadFraction;
+        double fTriggerRateHz;
+        uint32_t fEventsPerPacket;
+        double fLearnedWaitUs;          /*!< moving average of the completed waits, per event if the packet size is known */
+        std::chrono::steady_clock::time_point fLastCompletion;  /*!< end of the previous completed wait */
+
+        mutable std::mutex fStatMutex;
+        PollingStatistics fStatistics;
+
+        double eventsPerWait() const
+        {
+            return ( fEventsPerPacket > 0 ) ? fEventsPerPacket : 1;
+        }
+        static bool aborted ( const std::atomic<bool>* pAbort )
+        {
+            return pAbort && pAbort->load();
+        }
+        /*!
+         * \brief Throw an Exception if the wait started at pStart exceeded the timeout
+         */
+        void checkTimeout ( std::chrono::steady_clock::time_point pStart, uint32_t pPolls, const char* pWhat );
+        /*!
+         * \brief Account a completed wait and update the learned completion time
+         */
+        void record ( std::chrono::steady_clock::time_point pStart, uint32_t pPolls );
+    };
+}
+
+#endif
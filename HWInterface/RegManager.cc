@@ -19,11 +19,9 @@ namespace Ph2_HwInterface {
     std::string RegManager::strDummyXml = "file://HWInterface/dummy.xml";
 
     RegManager::RegManager ( const char* puHalConfigFileName, uint32_t pBoardId ) :
-        fThread ( [ = ]
-    {
-        StackWriteTimeOut();
-    } ),
-    fDeactiveThread ( false )
+        fFlushThreshold ( 64 ),
+        fFlushTimeout ( 1000 ),
+        fStopQueue ( false )
     {
         // Loging settings
         uhal::disableLogging();
@@ -37,16 +35,13 @@ namespace Ph2_HwInterface {
 
         fBoard = new uhal::HwInterface ( cm.getDevice ( ( cBuff ) ) );
 
-        fThread.detach();
-
+        startQueue();
     }
 
     RegManager::RegManager ( const char* pId, const char* pUri, const char* pAddressTable ) :
-        fThread ( [ = ]
-    {
-        StackWriteTimeOut();
-    } ),
-    fDeactiveThread ( false )
+        fFlushThreshold ( 64 ),
+        fFlushTimeout ( 1000 ),
+        fStopQueue ( false )
     {
         // Loging settings
         uhal::disableLogging();
@@ -56,14 +51,29 @@ namespace Ph2_HwInterface {
 
         fBoard = new uhal::HwInterface ( cm.getDevice ( pId, pUri, pAddressTable ) );
 
-        fThread.detach();
-
+        startQueue();
     }
 
 
     RegManager::~RegManager()
     {
-        fDeactiveThread = true;
+        {
+            std::lock_guard<std::mutex> cLock ( fQueueMutex );
+            fStopQueue = true;
+        }
+        fQueueCondition.notify_all();
+
+        if ( fQueueThread.joinable() ) fQueueThread.join();
+
+        // whatever is still queued goes out before the connection is closed
+        try
+        {
+            Flush();
+        }
+        catch ( ... )
+        {
+            LOG (ERROR) << "Failed to dispatch the queued registers while closing the connection" ;
+        }
 
         if ( fBoard ) delete fBoard;
     }
@@ -75,16 +85,13 @@ namespace Ph2_HwInterface {
 
     bool RegManager::WriteReg ( const std::string& pRegNode, const uint32_t& pVal )
     {
-        fBoardMutex.lock();
-        fBoard->getNode ( pRegNode ).write ( pVal );
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        WriteReg ( GetRegHandle ( pRegNode ), pVal );
 
         // Verify if the writing is done correctly
         if ( DEV_FLAG )
         {
             fBoardMutex.lock();
-            uhal::ValWord<uint32_t> reply = fBoard->getNode ( pRegNode ).read();
+            uhal::ValWord<uint32_t> reply = node ( pRegNode )->read();
             fBoard->dispatch();
             fBoardMutex.unlock();
 
@@ -105,30 +112,31 @@ namespace Ph2_HwInterface {
 
     bool RegManager::WriteStackReg ( const std::vector< std::pair<std::string, uint32_t> >& pVecReg )
     {
-
-        fBoardMutex.lock();
-
-        for ( auto const& v : pVecReg )
         {
-            fBoard->getNode ( v.first ).write ( v.second );
-            // LOG(INFO) << v.first << "  :  " << v.second ;
-        }
+            std::lock_guard<std::mutex> cLock ( fBoardMutex );
+            std::vector<QueuedOp> cOps = issueQueue();
+            RegOpTimer cTimer ( fRegStats, RegOp::SingleWrite, pVecReg.size() + cOps.size() );
 
-        try
-        {
-            fBoard->dispatch();
-        }
-        catch (...)
-        {
-            std::cerr << "Error while writing the following parameters: " ;
+            for ( auto const& v : pVecReg )
+            {
+                node ( v.first )->write ( v.second );
+                // LOG(INFO) << v.first << "  :  " << v.second ;
+            }
 
-            for ( auto const& v : pVecReg ) std::cerr << v.first << ", ";
+            try
+            {
+                dispatchQueue ( cOps );
+            }
+            catch (...)
+            {
+                std::cerr << "Error while writing the following parameters: " ;
 
-            std::cerr ;
-            throw ;
-        }
+                for ( auto const& v : pVecReg ) std::cerr << v.first << ", ";
 
-        fBoardMutex.unlock();
+                std::cerr ;
+                throw ;
+            }
+        }
 
         if ( DEV_FLAG )
         {
@@ -138,7 +146,7 @@ namespace Ph2_HwInterface {
             for ( auto const& v : pVecReg )
             {
                 fBoardMutex.lock();
-                uhal::ValWord<uint32_t> reply = fBoard->getNode ( v.first ).read();
+                uhal::ValWord<uint32_t> reply = node ( v.first )->read();
                 fBoard->dispatch();
                 fBoardMutex.unlock();
 
@@ -163,10 +171,7 @@ namespace Ph2_HwInterface {
 
     bool RegManager::WriteBlockReg ( const std::string& pRegNode, const std::vector< uint32_t >& pValues )
     {
-        fBoardMutex.lock();
-        fBoard->getNode ( pRegNode ).writeBlock ( pValues );
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        RegManager::WriteBlockReg ( GetRegHandle ( pRegNode ), pValues );
 
         bool cWriteCorr = true;
 
@@ -176,7 +181,7 @@ namespace Ph2_HwInterface {
             int cErrCount = 0;
 
             fBoardMutex.lock();
-            uhal::ValVector<uint32_t> cBlockRead = fBoard->getNode ( pRegNode ).readBlock ( pValues.size() );
+            uhal::ValVector<uint32_t> cBlockRead = node ( pRegNode )->readBlock ( pValues.size() );
             fBoard->dispatch();
             fBoardMutex.unlock();
 
@@ -198,10 +203,13 @@ namespace Ph2_HwInterface {
 
     bool RegManager::WriteBlockAtAddress ( uint32_t uAddr, const std::vector< uint32_t >& pValues, bool bNonInc )
     {
-        fBoardMutex.lock();
-        fBoard->getClient().writeBlock ( uAddr, pValues, bNonInc ? uhal::defs::NON_INCREMENTAL : uhal::defs::INCREMENTAL );
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        {
+            std::lock_guard<std::mutex> cLock ( fBoardMutex );
+            std::vector<QueuedOp> cOps = issueQueue();
+            RegOpTimer cTimer ( fRegStats, RegOp::BlockWrite, pValues.size() + cOps.size() );
+            fBoard->getClient().writeBlock ( uAddr, pValues, bNonInc ? uhal::defs::NON_INCREMENTAL : uhal::defs::INCREMENTAL );
+            dispatchQueue ( cOps );
+        }
 
         bool cWriteCorr = true;
 
@@ -234,10 +242,7 @@ namespace Ph2_HwInterface {
 
     uhal::ValWord<uint32_t> RegManager::ReadReg ( const std::string& pRegNode )
     {
-        fBoardMutex.lock();
-        uhal::ValWord<uint32_t> cValRead = fBoard->getNode ( pRegNode ).read();
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        uhal::ValWord<uint32_t> cValRead = ReadReg ( GetRegHandle ( pRegNode ) );
 
         if ( DEV_FLAG )
         {
@@ -250,10 +255,17 @@ namespace Ph2_HwInterface {
 
     uhal::ValWord<uint32_t> RegManager::ReadAtAddress ( uint32_t uAddr, uint32_t uMask )
     {
-        fBoardMutex.lock();
-        uhal::ValWord<uint32_t> cValRead = fBoard->getClient().read ( uAddr, uMask );
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        std::unique_lock<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+        uhal::ValWord<uint32_t> cValRead;
+
+        {
+            RegOpTimer cTimer ( fRegStats, RegOp::SingleRead, 1 + cOps.size() );
+            cValRead = fBoard->getClient().read ( uAddr, uMask );
+            dispatchQueue ( cOps );
+        }
+
+        cLock.unlock();
 
         if ( DEV_FLAG )
         {
@@ -267,10 +279,7 @@ namespace Ph2_HwInterface {
 
     uhal::ValVector<uint32_t> RegManager::ReadBlockReg ( const std::string& pRegNode, const uint32_t& pBlockSize )
     {
-        fBoardMutex.lock();
-        uhal::ValVector<uint32_t> cBlockRead = fBoard->getNode ( pRegNode ).readBlock ( pBlockSize );
-        fBoard->dispatch();
-        fBoardMutex.unlock();
+        uhal::ValVector<uint32_t> cBlockRead = ReadBlockReg ( GetRegHandle ( pRegNode ), pBlockSize );
 
         if ( DEV_FLAG )
         {
@@ -288,49 +297,246 @@ namespace Ph2_HwInterface {
     }
 
 
+    RegManager::RegHandle RegManager::GetRegHandle ( const std::string& pRegNode )
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        return node ( pRegNode );
+    }
+
+    RegManager::RegHandle RegManager::node ( const std::string& pRegNode )
+    {
+        auto cNode = fNodeCache.find ( pRegNode );
+
+        if ( cNode != fNodeCache.end() ) return cNode->second;
+
+        RegHandle cHandle = &fBoard->getNode ( pRegNode );
+        fNodeCache.emplace ( pRegNode, cHandle );
+        return cHandle;
+    }
+
+    bool RegManager::WriteReg ( RegHandle pNode, uint32_t pVal )
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+        RegOpTimer cTimer ( fRegStats, RegOp::SingleWrite, 1 + cOps.size() );
+        pNode->write ( pVal );
+        dispatchQueue ( cOps );
+        return true;
+    }
+
+    bool RegManager::WriteBlockReg ( RegHandle pNode, const std::vector< uint32_t >& pValues )
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+        RegOpTimer cTimer ( fRegStats, RegOp::BlockWrite, pValues.size() + cOps.size() );
+        pNode->writeBlock ( pValues );
+        dispatchQueue ( cOps );
+        return true;
+    }
+
+    uhal::ValWord<uint32_t> RegManager::ReadReg ( RegHandle pNode )
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+        RegOpTimer cTimer ( fRegStats, RegOp::SingleRead, 1 + cOps.size() );
+        uhal::ValWord<uint32_t> cValRead = pNode->read();
+        dispatchQueue ( cOps );
+        return cValRead;
+    }
+
+    uhal::ValVector<uint32_t> RegManager::ReadBlockReg ( RegHandle pNode, uint32_t pBlockSize )
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+        RegOpTimer cTimer ( fRegStats, RegOp::BlockRead, pBlockSize + cOps.size() );
+        uhal::ValVector<uint32_t> cBlockRead = pNode->readBlock ( pBlockSize );
+        dispatchQueue ( cOps );
+        return cBlockRead;
+    }
+
     void RegManager::StackReg ( const std::string& pRegNode, const uint32_t& pVal, bool pSend )
     {
+        QueueWrite ( pRegNode, pVal );
+
+        if ( pSend ) Flush();
+    }
+
+    std::future<void> RegManager::QueueWrite ( const std::string& pRegNode, uint32_t pVal )
+    {
+        return QueueWrite ( GetRegHandle ( pRegNode ), pVal );
+    }
+
+    std::future<void> RegManager::QueueWrite ( RegHandle pNode, uint32_t pVal )
+    {
+        std::future<void> cFuture;
+        bool cFull;
+
+        {
+            std::lock_guard<std::mutex> cLock ( fQueueMutex );
+
+            if ( fQueue.empty() ) fOldestQueued = std::chrono::steady_clock::now();
+
+            fQueue.emplace_back();
+            QueuedOp& cOp = fQueue.back();
+            cOp.fNode = pNode;
+            cOp.fValue = pVal;
+            cOp.fIsRead = false;
+            cFuture = cOp.fWritten.get_future();
+            cFull = fQueue.size() >= fFlushThreshold;
+        }
+
+        if ( cFull ) Flush();
+        else fQueueCondition.notify_one();
+
+        return cFuture;
+    }
+
+    std::future<uint32_t> RegManager::QueueRead ( const std::string& pRegNode )
+    {
+        return QueueRead ( GetRegHandle ( pRegNode ) );
+    }
+
+    std::future<uint32_t> RegManager::QueueRead ( RegHandle pNode )
+    {
+        std::future<uint32_t> cFuture;
+        bool cFull;
 
-        for ( std::vector< std::pair<std::string, uint32_t> >::iterator cIt = fStackReg.begin(); cIt != fStackReg.end(); cIt++ )
         {
-            if ( cIt->first == pRegNode )
-                fStackReg.erase ( cIt );
+            std::lock_guard<std::mutex> cLock ( fQueueMutex );
+
+            if ( fQueue.empty() ) fOldestQueued = std::chrono::steady_clock::now();
+
+            fQueue.emplace_back();
+            QueuedOp& cOp = fQueue.back();
+            cOp.fNode = pNode;
+            cOp.fValue = 0;
+            cOp.fIsRead = true;
+            cFuture = cOp.fRead.get_future();
+            cFull = fQueue.size() >= fFlushThreshold;
         }
 
-        std::pair<std::string, uint32_t> cPair ( pRegNode, pVal );
-        fStackReg.push_back ( cPair );
+        if ( cFull ) Flush();
+        else fQueueCondition.notify_one();
 
-        if ( pSend || fStackReg.size() == 100 )
+        return cFuture;
+    }
+
+    void RegManager::Flush()
+    {
+        std::lock_guard<std::mutex> cLock ( fBoardMutex );
+        std::vector<QueuedOp> cOps = issueQueue();
+
+        if ( cOps.empty() ) return;
+
+        RegOpTimer cTimer ( fRegStats, RegOp::QueueFlush, cOps.size() );
+        dispatchQueue ( cOps );
+    }
+
+    void RegManager::SetFlushThreshold ( size_t pNOps )
+    {
+        std::lock_guard<std::mutex> cLock ( fQueueMutex );
+        fFlushThreshold = ( pNOps > 0 ) ? pNOps : 1;
+    }
+
+    void RegManager::SetFlushTimeout ( uint32_t pTimeoutUs )
+    {
         {
-            WriteStackReg ( fStackReg );
-            fStackReg.clear();
+            std::lock_guard<std::mutex> cLock ( fQueueMutex );
+            fFlushTimeout = std::chrono::microseconds ( pTimeoutUs );
         }
+        fQueueCondition.notify_one();
+    }
+
+    void RegManager::startQueue()
+    {
+        fQueueThread = std::thread ( &RegManager::queueLoop, this );
     }
 
+    void RegManager::queueLoop()
+    {
+        std::unique_lock<std::mutex> cLock ( fQueueMutex );
+
+        while ( !fStopQueue )
+        {
+            if ( fQueue.empty() )
+            {
+                fQueueCondition.wait ( cLock, [this] { return fStopQueue || !fQueue.empty(); } );
+                continue;
+            }
+
+            // wake up when the oldest operation is due, unless someone else dispatched the queue in the meantime
+            auto cDeadline = fOldestQueued + fFlushTimeout;
+
+            if ( fQueueCondition.wait_until ( cLock, cDeadline, [this] { return fStopQueue || fQueue.empty(); } ) )
+                continue;
+
+            if ( std::chrono::steady_clock::now() < fOldestQueued + fFlushTimeout ) continue;
+
+            cLock.unlock();
+
+            // the futures of the operations carry the error too, but most callers do not keep them
+            try
+            {
+                Flush();
+            }
+            catch ( std::exception& e )
+            {
+                LOG (ERROR) << "Failed to dispatch the queued registers: " << e.what() ;
+            }
+            catch ( ... )
+            {
+                LOG (ERROR) << "Failed to dispatch the queued registers" ;
+            }
+
+            cLock.lock();
+        }
+    }
 
-    void RegManager::StackWriteTimeOut()
+    std::vector<RegManager::QueuedOp> RegManager::issueQueue()
     {
-        uint32_t i = 0;
+        std::vector<QueuedOp> cOps;
+
+        {
+            std::lock_guard<std::mutex> cLock ( fQueueMutex );
+            cOps.swap ( fQueue );
+        }
 
-        while ( !fDeactiveThread )
+        for ( auto& cOp : cOps )
         {
-            std::this_thread::sleep_for ( std::chrono::seconds ( TIME_OUT ) );
-            //LOG(INFO) << "Ping ! \nThread ID : " << std::this_thread::get_id() << "\n" ;
+            if ( cOp.fIsRead ) cOp.fReply = cOp.fNode->read();
+            else cOp.fNode->write ( cOp.fValue );
+        }
+
+        return cOps;
+    }
 
-            if ( fStackReg.size() != 0 && i == 1 )
+    void RegManager::dispatchQueue ( std::vector<QueuedOp>& pOps )
+    {
+        try
+        {
+            fBoard->dispatch();
+        }
+        catch ( ... )
+        {
+            for ( auto& cOp : pOps )
             {
-                WriteStackReg ( fStackReg );
-                fStackReg.clear();
+                if ( cOp.fIsRead ) cOp.fRead.set_exception ( std::current_exception() );
+                else cOp.fWritten.set_exception ( std::current_exception() );
             }
-            else if ( i == 0 )
-                i = 1;
 
+            throw;
+        }
+
+        for ( auto& cOp : pOps )
+        {
+            if ( cOp.fIsRead ) cOp.fRead.set_value ( cOp.fReply.value() );
+            else cOp.fWritten.set_value();
         }
     }
 
     const uhal::Node& RegManager::getUhalNode ( const std::string& pStrPath )
     {
-        return fBoard->getNode ( pStrPath );
+        return *GetRegHandle ( pStrPath );
     }
 
 }
@@ -13,12 +13,17 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
 #include <uhal/uhal.hpp>
+#include "RegStatistics.h"
 #include "../Utils/easylogging++.h"
 
 /*!
@@ -32,15 +37,64 @@ namespace Ph2_HwInterface {
      */
     class RegManager
     {
+      public:
+        /*!
+         * \brief Resolved uHAL node of a register, see GetRegHandle
+         */
+        using RegHandle = const uhal::Node*;
+
       protected:
         uhal::HwInterface* fBoard;         /*!< Board in use*/
         const char* fUHalConfigFileName;         /*!< path of the uHal Config File*/
-        std::vector< std::pair<std::string, uint32_t> > fStackReg;        /*!< Stack of registers*/
-        std::thread fThread;         /*!< Thread for timeout stack writing*/
-        bool fDeactiveThread;         /*!< Bool to terminate the thread in the destructor*/
         std::mutex fBoardMutex;         /*!< Mutex to avoid conflict btw threads on shared resources*/
         static std::string strDummyXml;
 
+      private:
+        /*!
+         * \struct QueuedOp
+         * \brief A register write or read waiting in the queue for the next dispatch
+         */
+        struct QueuedOp
+        {
+            RegHandle fNode;
+            uint32_t fValue;
+            bool fIsRead;
+            uhal::ValWord<uint32_t> fReply;
+            std::promise<void> fWritten;
+            std::promise<uint32_t> fRead;
+        };
+
+        std::vector<QueuedOp> fQueue;           /*!< operations queued by QueueWrite/QueueRead, in order */
+        std::mutex fQueueMutex;                 /*!< protects the queue, always taken after fBoardMutex */
+        std::condition_variable fQueueCondition;
+        std::chrono::steady_clock::time_point fOldestQueued;    /*!< time the first operation of the queue was added */
+        size_t fFlushThreshold;                 /*!< queue length at which the queue is dispatched right away */
+        std::chrono::microseconds fFlushTimeout;    /*!< longest time an operation waits in the queue */
+        bool fStopQueue;
+        std::thread fQueueThread;               /*!< dispatches the queue once its oldest operation is fFlushTimeout old */
+        std::unordered_map<std::string, RegHandle> fNodeCache;  /*!< nodes resolved so far, protected by fBoardMutex */
+        RegStatCounters fRegStats;              /*!< one record per dispatch, the queued operations count with the access that dispatched them */
+
+        /*!
+         * \brief Node of a register from the cache, resolved by uHAL on the first use, fBoardMutex must be held
+         */
+        RegHandle node ( const std::string& pRegNode );
+
+        /*!
+         * \brief Start the queue thread, called at the end of the constructors
+         */
+        void startQueue();
+        void queueLoop();
+        /*!
+         * \brief Take the queued operations and put them on the uHAL packet without dispatching it, fBoardMutex must be held
+         */
+        std::vector<QueuedOp> issueQueue();
+        /*!
+         * \brief Dispatch the uHAL packet and fulfil the futures of pOps, fBoardMutex must be held
+         * If the dispatch throws, the exception is passed to the futures and rethrown.
+         */
+        void dispatchQueue ( std::vector<QueuedOp>& pOps );
+
       public:
         /*!
         * \brief Write a register
@@ -90,10 +144,57 @@ namespace Ph2_HwInterface {
         */
         virtual uhal::ValVector<uint32_t> ReadBlockReg ( const std::string& pRegNode, const uint32_t& pBlocksize );
         /*!
-        * \brief Time Out for sending the register/value stack in the writting.
-        * \brief It has only to be set in a detached thread from the one you're working on
+        * \brief Resolve the uHAL node of a register once, to access it later without any lookup by name
+        * The handle stays valid for the lifetime of the RegManager. Throws the uHAL exception if there is no such node.
         */
-        void StackWriteTimeOut();
+        RegHandle GetRegHandle ( const std::string& pRegNode );
+        /*!
+        * \brief Register accesses through a handle from GetRegHandle, they behave like the versions taking the node name
+        */
+        bool WriteReg ( RegHandle pNode, uint32_t pVal );
+        bool WriteBlockReg ( RegHandle pNode, const std::vector< uint32_t >& pValues );
+        uhal::ValWord<uint32_t> ReadReg ( RegHandle pNode );
+        uhal::ValVector<uint32_t> ReadBlockReg ( RegHandle pNode, uint32_t pBlocksize );
+        /*!
+        * \brief Queue a register write, it goes out with the next dispatch of this board
+        * The queue is dispatched by Flush, by any direct register access (in the same uHAL packet, before the access),
+        * once it holds the flush threshold of operations or once its oldest operation waited the flush timeout.
+        * \param pRegNode : Node of the register to write
+        * \param pVal : Value to write
+        * \return future that becomes ready once the write was dispatched, it carries the uHAL exception if the dispatch failed
+        */
+        std::future<void> QueueWrite ( const std::string& pRegNode, uint32_t pVal );
+        std::future<void> QueueWrite ( RegHandle pNode, uint32_t pVal );
+        /*!
+        * \brief Queue a register read, see QueueWrite
+        * \return future of the value read
+        */
+        std::future<uint32_t> QueueRead ( const std::string& pRegNode );
+        std::future<uint32_t> QueueRead ( RegHandle pNode );
+        /*!
+        * \brief Dispatch all queued operations in one uHAL packet now
+        */
+        void Flush();
+        /*!
+        * \brief Queue length at which QueueWrite/QueueRead dispatch the queue themselves, default 64
+        */
+        void SetFlushThreshold ( size_t pNOps );
+        /*!
+        * \brief Longest time an operation stays in the queue before the queue thread dispatches it, default 1000 us
+        */
+        void SetFlushTimeout ( uint32_t pTimeoutUs );
+        /*!
+        * \brief Number, size and latency of the dispatches of this board so far, per kind of access
+        * Accesses within a RegOpScope are accounted to the kind of the scope, see RegOp.
+        */
+        RegStatistics GetRegStatistics() const
+        {
+            return fRegStats.Snapshot();
+        }
+        void ResetRegStatistics()
+        {
+            fRegStats.Reset();
+        }
 
       public:
         // Connection w uHal
@@ -116,6 +217,7 @@ namespace Ph2_HwInterface {
         virtual ~RegManager();
         /*!
          * \brief Stack the commands, deliver when full or timeout
+         * Same as QueueWrite, pSend flushes the queue
          * \param pRegNode : Register to write
          * \param pVal : Value to write
          * \param pSend : Send the stack to write or nor (1/0)
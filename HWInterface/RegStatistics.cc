@@ -0,0 +1,187 @@
+/*
+
+        FileName :                    RegStatistics.cc
+        Content :                     Lock-free counters and latency histograms of the register accesses of a board
+        Version :                     1.0
+
+ */
+
+#include "RegStatistics.h"
+#include <sstream>
+
+namespace Ph2_HwInterface {
+
+    thread_local int RegOpScope::fCurrent = -1;
+
+    RegOpScope::RegOpScope ( RegOp pOp ) :
+        fPrevious ( fCurrent )
+    {
+        fCurrent = static_cast<int> ( pOp );
+    }
+
+    RegOpScope::~RegOpScope()
+    {
+        fCurrent = fPrevious;
+    }
+
+    double RegOpStatistics::QuantileUs ( double pFraction ) const
+    {
+        if ( fNCalls == 0 ) return 0;
+
+        uint64_t cRank = static_cast<uint64_t> ( pFraction * fNCalls );
+        uint64_t cSum = 0;
+
+        for ( size_t cBucket = 0; cBucket < cNLatencyBuckets - 1; cBucket++ )
+        {
+            cSum += fLatency[cBucket];
+
+            if ( cSum > cRank ) return double ( 1ull << cBucket );
+        }
+
+        return 1e-3 * fMaxNs;
+    }
+
+    RegOpStatistics& RegOpStatistics::operator+= ( const RegOpStatistics& pOther )
+    {
+        fNCalls += pOther.fNCalls;
+        fNWords += pOther.fNWords;
+        fNErrors += pOther.fNErrors;
+        fTotalNs += pOther.fTotalNs;
+
+        if ( pOther.fMaxNs > fMaxNs ) fMaxNs = pOther.fMaxNs;
+
+        for ( size_t cBucket = 0; cBucket < cNLatencyBuckets; cBucket++ )
+            fLatency[cBucket] += pOther.fLatency[cBucket];
+
+        return *this;
+    }
+
+    RegOpStatistics RegStatistics::Total() const
+    {
+        RegOpStatistics cTotal;
+
+        for ( auto& cOp : fOps )
+            cTotal += cOp;
+
+        return cTotal;
+    }
+
+    std::string RegStatistics::String() const
+    {
+        std::ostringstream cStream;
+        RegOpStatistics cTotal = Total();
+        cStream << cTotal.fNCalls << " dispatches, " << cTotal.Bytes() / 1024. << " kB, " << 1e-6 * cTotal.fTotalNs << " ms";
+
+        for ( size_t cIndex = 0; cIndex < cNRegOps; cIndex++ )
+        {
+            const RegOpStatistics& cStat = fOps[cIndex];
+
+            if ( cStat.fNCalls == 0 ) continue;
+
+            cStream << "\n    " << OpName ( static_cast<RegOp> ( cIndex ) ) << ": " << cStat.fNCalls << " calls, "
+                    << cStat.Bytes() / 1024. << " kB, " << 1e-6 * cStat.fTotalNs << " ms, mean " << cStat.MeanUs()
+                    << " us, p50 < " << cStat.QuantileUs ( 0.5 ) << " us, p99 < " << cStat.QuantileUs ( 0.99 )
+                    << " us, max " << 1e-3 * cStat.fMaxNs << " us";
+
+            if ( cStat.fNErrors ) cStream << ", " << cStat.fNErrors << " errors";
+        }
+
+        return cStream.str();
+    }
+
+    const char* RegStatistics::OpName ( RegOp pOp )
+    {
+        switch ( pOp )
+        {
+            case RegOp::SingleWrite:
+                return "single write";
+
+            case RegOp::SingleRead:
+                return "single read";
+
+            case RegOp::BlockWrite:
+                return "block write";
+
+            case RegOp::BlockRead:
+                return "block read";
+
+            case RegOp::QueueFlush:
+                return "queue flush";
+
+            case RegOp::I2cCommand:
+                return "I2C command";
+
+            case RegOp::StatusPoll:
+                return "status poll";
+        }
+
+        return "unknown";
+    }
+
+    RegStatCounters::RegStatCounters()
+    {
+        Reset();
+    }
+
+    void RegStatCounters::Record ( RegOp pOp, uint64_t pNWords, uint64_t pNs, bool pError )
+    {
+        Counters& cCounters = fOps[static_cast<size_t> ( pOp )];
+        cCounters.fNCalls.fetch_add ( 1, std::memory_order_relaxed );
+        cCounters.fNWords.fetch_add ( pNWords, std::memory_order_relaxed );
+        cCounters.fTotalNs.fetch_add ( pNs, std::memory_order_relaxed );
+        cCounters.fLatency[bucket ( pNs )].fetch_add ( 1, std::memory_order_relaxed );
+
+        if ( pError ) cCounters.fNErrors.fetch_add ( 1, std::memory_order_relaxed );
+
+        uint64_t cMax = cCounters.fMaxNs.load ( std::memory_order_relaxed );
+
+        while ( pNs > cMax && !cCounters.fMaxNs.compare_exchange_weak ( cMax, pNs, std::memory_order_relaxed ) );
+    }
+
+    RegStatistics RegStatCounters::Snapshot() const
+    {
+        RegStatistics cStat;
+
+        for ( size_t cIndex = 0; cIndex < cNRegOps; cIndex++ )
+        {
+            const Counters& cCounters = fOps[cIndex];
+            RegOpStatistics& cOp = cStat.fOps[cIndex];
+            cOp.fNCalls = cCounters.fNCalls.load ( std::memory_order_relaxed );
+            cOp.fNWords = cCounters.fNWords.load ( std::memory_order_relaxed );
+            cOp.fNErrors = cCounters.fNErrors.load ( std::memory_order_relaxed );
+            cOp.fTotalNs = cCounters.fTotalNs.load ( std::memory_order_relaxed );
+            cOp.fMaxNs = cCounters.fMaxNs.load ( std::memory_order_relaxed );
+
+            for ( size_t cBucket = 0; cBucket < cNLatencyBuckets; cBucket++ )
+                cOp.fLatency[cBucket] = cCounters.fLatency[cBucket].load ( std::memory_order_relaxed );
+        }
+
+        return cStat;
+    }
+
+    void RegStatCounters::Reset()
+    {
+        for ( auto& cCounters : fOps )
+        {
+            cCounters.fNCalls.store ( 0, std::memory_order_relaxed );
+            cCounters.fNWords.store ( 0, std::memory_order_relaxed );
+            cCounters.fNErrors.store ( 0, std::memory_order_relaxed );
+            cCounters.fTotalNs.store ( 0, std::memory_order_relaxed );
+            cCounters.fMaxNs.store ( 0, std::memory_order_relaxed );
+
+            for ( auto& cBucket : cCounters.fLatency )
+                cBucket.store ( 0, std::memory_order_relaxed );
+        }
+    }
+
+    size_t RegStatCounters::bucket ( uint64_t pNs )
+    {
+        uint64_t cUs = pNs / 1000;
+
+        if ( cUs == 0 ) return 0;
+
+        // 64 - clz is floor(log2) + 1, so [2^(i-1), 2^i) us lands in bucket i
+        size_t cBucket = 64 - __builtin_clzll ( cUs );
+        return ( cBucket < cNLatencyBuckets ) ? cBucket : cNLatencyBuckets - 1;
+    }
+}
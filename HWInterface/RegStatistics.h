@@ -0,0 +1,183 @@
+/*!
+
+        \file                   RegStatistics.h
+        \brief                  Lock-free counters and latency histograms of the register accesses of a board
+        \version                1.0
+
+ */
+
+#ifndef __REGSTATISTICS_H__
+#define __REGSTATISTICS_H__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+
+namespace Ph2_HwInterface {
+
+    /*!
+     * \brief Kind of a register access, every dispatch to the board is accounted to exactly one of them
+     */
+    enum class RegOp : uint8_t
+    {
+        SingleWrite = 0,        /*!< WriteReg, WriteStackReg */
+        SingleRead,             /*!< ReadReg, ReadAtAddress */
+        BlockWrite,             /*!< WriteBlockReg, WriteBlockAtAddress */
+        BlockRead,              /*!< ReadBlockReg */
+        QueueFlush,             /*!< dispatch of queued operations only, see RegManager::Flush */
+        I2cCommand,             /*!< any access within the scope of a CBC I2C transaction */
+        StatusPoll              /*!< any access within a PollingStrategy wait */
+    };
+
+    const size_t cNRegOps = 7;
+    const size_t cNLatencyBuckets = 24;    /*!< bucket 0 is below 1 us, bucket i covers [2^(i-1), 2^i) us, the last one is open */
+
+    /*!
+     * \struct RegOpStatistics
+     * \brief Snapshot of the counters of one kind of access, one call is one dispatch
+     */
+    struct RegOpStatistics
+    {
+        uint64_t fNCalls = 0;
+        uint64_t fNWords = 0;           /*!< 32 bit words written or read */
+        uint64_t fNErrors = 0;          /*!< calls that threw */
+        uint64_t fTotalNs = 0;
+        uint64_t fMaxNs = 0;
+        std::array<uint64_t, cNLatencyBuckets> fLatency{};
+
+        double MeanUs() const
+        {
+            return fNCalls ? 1e-3 * fTotalNs / fNCalls : 0;
+        }
+        uint64_t Bytes() const
+        {
+            return 4 * fNWords;
+        }
+        /*!
+         * \brief Upper edge in us of the histogram bucket holding the quantile pFraction, good to a factor 2
+         */
+        double QuantileUs ( double pFraction ) const;
+        /*!
+         * \brief Add the counters of pOther, to sum over kinds or boards
+         */
+        RegOpStatistics& operator+= ( const RegOpStatistics& pOther );
+    };
+
+    /*!
+     * \struct RegStatistics
+     * \brief Snapshot of the counters of all kinds of access of a board
+     */
+    struct RegStatistics
+    {
+        std::array<RegOpStatistics, cNRegOps> fOps;
+
+        const RegOpStatistics& operator[] ( RegOp pOp ) const
+        {
+            return fOps[static_cast<size_t> ( pOp )];
+        }
+        RegOpStatistics Total() const;
+        /*!
+         * \brief One line per kind of access that was used, for the log
+         */
+        std::string String() const;
+
+        static const char* OpName ( RegOp pOp );
+    };
+
+    /*!
+     * \class RegStatCounters
+     * \brief The live counters behind RegStatistics, Record only does relaxed atomic additions
+     */
+    class RegStatCounters
+    {
+      public:
+        RegStatCounters();
+        RegStatCounters ( const RegStatCounters& ) = delete;
+        RegStatCounters& operator= ( const RegStatCounters& ) = delete;
+
+        void Record ( RegOp pOp, uint64_t pNWords, uint64_t pNs, bool pError );
+        /*!
+         * \brief Copy of the counters, safe to call while other threads record
+         * The counters are read one by one, so a snapshot taken during an access may be off by that access.
+         */
+        RegStatistics Snapshot() const;
+        void Reset();
+
+      private:
+        struct Counters
+        {
+            std::atomic<uint64_t> fNCalls{0};
+            std::atomic<uint64_t> fNWords{0};
+            std::atomic<uint64_t> fNErrors{0};
+            std::atomic<uint64_t> fTotalNs{0};
+            std::atomic<uint64_t> fMaxNs{0};
+            std::array<std::atomic<uint64_t>, cNLatencyBuckets> fLatency;    /*!< zeroed by Reset in the constructor */
+        };
+
+        std::array<Counters, cNRegOps> fOps;
+
+        static size_t bucket ( uint64_t pNs );
+    };
+
+    /*!
+     * \class RegOpScope
+     * \brief Accounts all register accesses of the current thread to pOp while it lives
+     * Scopes nest, the innermost one wins: a status poll inside an I2C transaction counts as a status poll.
+     */
+    class RegOpScope
+    {
+      public:
+        explicit RegOpScope ( RegOp pOp );
+        ~RegOpScope();
+        RegOpScope ( const RegOpScope& ) = delete;
+        RegOpScope& operator= ( const RegOpScope& ) = delete;
+
+        /*!
+         * \brief Kind of the innermost scope of this thread, pDefault if there is none
+         */
+        static RegOp Current ( RegOp pDefault )
+        {
+            return ( fCurrent >= 0 ) ? static_cast<RegOp> ( fCurrent ) : pDefault;
+        }
+
+      private:
+        int fPrevious;
+        static thread_local int fCurrent;
+    };
+
+    /*!
+     * \class RegOpTimer
+     * \brief Times one register access from its construction to its destruction and records it
+     * An access left through an exception is counted as an error.
+     */
+    class RegOpTimer
+    {
+      public:
+        RegOpTimer ( RegStatCounters& pCounters, RegOp pOp, uint64_t pNWords ) :
+            fCounters ( pCounters ),
+            fOp ( RegOpScope::Current ( pOp ) ),
+            fNWords ( pNWords ),
+            fStart ( std::chrono::steady_clock::now() )
+        {
+        }
+        ~RegOpTimer()
+        {
+            uint64_t cNs = std::chrono::duration_cast<std::chrono::nanoseconds> ( std::chrono::steady_clock::now() - fStart ).count();
+            fCounters.Record ( fOp, fNWords, cNs, std::uncaught_exception() );
+        }
+        RegOpTimer ( const RegOpTimer& ) = delete;
+        RegOpTimer& operator= ( const RegOpTimer& ) = delete;
+
+      private:
+        RegStatCounters& fCounters;
+        RegOp fOp;
+        uint64_t fNWords;
+        std::chrono::steady_clock::time_point fStart;
+    };
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+
+        FileName :                    BoardWorkerPool.cc
+        Content :                     One persistent worker thread per BeBoard to run per board work concurrently
+        Version :                     1.0
+
+ */
+
+#include "BoardWorkerPool.h"
+
+using namespace Ph2_HwInterface;
+
+namespace Ph2_System {
+
+    BoardWorkerPool::BoardWorkerPool ( const BeBoardFWMap& pBoardMap, size_t pNWorkers ) :
+        fRound ( 0 ),
+        fNPending ( 0 ),
+        fStop ( false )
+    {
+        for ( size_t cIndex = 0; cIndex < pNWorkers; cIndex++ )
+        {
+            std::unique_ptr<Worker> cWorker ( new Worker );
+            cWorker->fBeBoardInterface.reset ( new BeBoardInterface ( pBoardMap ) );
+            cWorker->fCbcInterface.reset ( new CbcInterface ( pBoardMap ) );
+            fWorkers.push_back ( std::move ( cWorker ) );
+        }
+
+        // start the threads only once fWorkers does not move anymore
+        for ( auto& cWorker : fWorkers )
+            cWorker->fThread = std::thread ( &BoardWorkerPool::workerLoop, this, cWorker.get() );
+    }
+
+    BoardWorkerPool::~BoardWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> cLock ( fMutex );
+            fStop = true;
+        }
+        fJobCondition.notify_all();
+
+        for ( auto& cWorker : fWorkers )
+        {
+            if ( cWorker->fThread.joinable() )
+                cWorker->fThread.join();
+        }
+    }
+
+    void BoardWorkerPool::Run ( const std::vector<Job>& pJobs )
+    {
+        std::lock_guard<std::mutex> cRunLock ( fRunMutex );
+        std::unique_lock<std::mutex> cLock ( fMutex );
+
+        fNPending = 0;
+
+        for ( size_t cIndex = 0; cIndex < fWorkers.size(); cIndex++ )
+        {
+            Worker* cWorker = fWorkers.at ( cIndex ).get();
+            cWorker->fJob = ( cIndex < pJobs.size() ) ? pJobs.at ( cIndex ) : Job();
+            cWorker->fError = nullptr;
+
+            if ( cWorker->fJob ) fNPending++;
+        }
+
+        if ( fNPending == 0 ) return;
+
+        fRound++;
+        fJobCondition.notify_all();
+        fDoneCondition.wait ( cLock, [this] { return fNPending == 0; } );
+
+        for ( auto& cWorker : fWorkers )
+        {
+            if ( cWorker->fError )
+                std::rethrow_exception ( cWorker->fError );
+        }
+    }
+
+    uint64_t BoardWorkerPool::GetFlushedWrites()
+    {
+        // no job runs while fRunMutex is held
+        std::lock_guard<std::mutex> cRunLock ( fRunMutex );
+        uint64_t cNWrites = 0;
+
+        for ( auto& cWorker : fWorkers )
+            cNWrites += cWorker->fCbcInterface->GetFlushedWrites();
+
+        return cNWrites;
+    }
+
+    uint64_t BoardWorkerPool::GetSkippedWrites()
+    {
+        std::lock_guard<std::mutex> cRunLock ( fRunMutex );
+        uint64_t cNWrites = 0;
+
+        for ( auto& cWorker : fWorkers )
+            cNWrites += cWorker->fCbcInterface->GetSkippedWrites();
+
+        return cNWrites;
+    }
+
+    void BoardWorkerPool::workerLoop ( Worker* pWorker )
+    {
+        uint64_t cSeenRound = 0;
+        std::unique_lock<std::mutex> cLock ( fMutex );
+
+        while ( true )
+        {
+            fJobCondition.wait ( cLock, [&] { return fStop || fRound != cSeenRound; } );
+
+            if ( fStop ) return;
+
+            cSeenRound = fRound;
+
+            if ( !pWorker->fJob ) continue;
+
+            Job cJob;
+            std::swap ( cJob, pWorker->fJob );
+            cLock.unlock();
+
+            std::exception_ptr cError;
+
+            try
+            {
+                cJob ( pWorker->fBeBoardInterface.get(), pWorker->fCbcInterface.get() );
+            }
+            catch ( ... )
+            {
+                cError = std::current_exception();
+            }
+
+            cLock.lock();
+            pWorker->fError = cError;
+
+            if ( --fNPending == 0 )
+                fDoneCondition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*!
+
+        \file                   BoardWorkerPool.h
+        \brief                  One persistent worker thread per BeBoard to run per board work concurrently
+        \version                1.0
+
+ */
+
+#ifndef __BOARDWORKERPOOL_H__
+#define __BOARDWORKERPOOL_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../HWInterface/BeBoardInterface.h"
+#include "../HWInterface/CbcInterface.h"
+
+namespace Ph2_System {
+
+    /*!
+     * \class BoardWorkerPool
+     * \brief Runs one job per board on a dedicated thread and waits for all of them
+     * BeBoardInterface and CbcInterface remember the board they talked to last, so they must not be shared
+     * between threads: every worker owns its own pair of interfaces on top of the common BeBoardFWMap.
+     * Each board is always handled by the same worker, so its FW interface is never used by two workers.
+     */
+    class BoardWorkerPool
+    {
+      public:
+        using Job = std::function<void ( Ph2_HwInterface::BeBoardInterface*, Ph2_HwInterface::CbcInterface* )>;
+
+        /*!
+         * \brief Constructor of the BoardWorkerPool class, starts pNWorkers threads
+         * \param pBoardMap : FW interfaces of all boards, shared by the interfaces of the workers
+         * \param pNWorkers : number of workers, one per board
+         */
+        BoardWorkerPool ( const Ph2_HwInterface::BeBoardFWMap& pBoardMap, size_t pNWorkers );
+        /*!
+         * \brief Destructor of the BoardWorkerPool class, waits for the running jobs and joins the threads
+         */
+        ~BoardWorkerPool();
+
+        BoardWorkerPool ( const BoardWorkerPool& ) = delete;
+        BoardWorkerPool& operator= ( const BoardWorkerPool& ) = delete;
+
+        size_t size() const
+        {
+            return fWorkers.size();
+        }
+        /*!
+         * \brief Run pJobs[i] on worker i and return once all jobs are done
+         * An exception thrown by a job does not stop the others, the one of the lowest worker is rethrown at the end.
+         * \param pJobs : at most one job per worker, empty jobs are skipped
+         */
+        void Run ( const std::vector<Job>& pJobs );
+        /*!
+         * \brief Registers written by Flush through the CbcInterfaces of all workers
+         */
+        uint64_t GetFlushedWrites();
+        /*!
+         * \brief Registers skipped by Flush through the CbcInterfaces of all workers
+         */
+        uint64_t GetSkippedWrites();
+
+      private:
+        struct Worker
+        {
+            std::thread fThread;
+            std::unique_ptr<Ph2_HwInterface::BeBoardInterface> fBeBoardInterface;
+            std::unique_ptr<Ph2_HwInterface::CbcInterface> fCbcInterface;
+            Job fJob;
+            std::exception_ptr fError;
+        };
+
+        std::vector<std::unique_ptr<Worker>> fWorkers;
+        std::mutex fMutex;
+        std::condition_variable fJobCondition;      /*!< signals the workers that a new round of jobs was posted */
+        std::condition_variable fDoneCondition;     /*!< signals Run that a job finished */
+        uint64_t fRound;                            /*!< incremented for every call of Run */
+        size_t fNPending;                           /*!< jobs of the current round not finished yet */
+        bool fStop;
+        std::mutex fRunMutex;                       /*!< serializes concurrent calls of Run */
+
+        void workerLoop ( Worker* pWorker );
+    };
+}
+
+#endif
@@ -34,6 +34,35 @@ namespace Ph2_System {
             delete fFileHandler;
         }
 
+        // acquisition threads must not outlive the interfaces they read from
+        for ( auto& cBoardFW : fBeBoardFWMap )
+        {
+            cBoardFW.second->StopAcquisitionThread();
+
+            if ( cBoardFW.second->GetDataPolling().GetStatistics().fNWaits > 0 )
+                LOG (INFO) << "Data polling of board " << int ( cBoardFW.first ) << ": " << cBoardFW.second->GetDataPolling().StatisticsString() ;
+
+            RegStatistics cRegStat = cBoardFW.second->GetRegStatistics();
+
+            if ( cRegStat.Total().fNCalls > 0 )
+                LOG (INFO) << "Register access of board " << int ( cBoardFW.first ) << ": " << cRegStat.String() ;
+        }
+
+        // the board workers write through their own CbcInterfaces
+        uint64_t cNFlushed = fCbcInterface->GetFlushedWrites();
+        uint64_t cNSkipped = fCbcInterface->GetSkippedWrites();
+
+        if ( fBoardWorkers )
+        {
+            cNFlushed += fBoardWorkers->GetFlushedWrites();
+            cNSkipped += fBoardWorkers->GetSkippedWrites();
+        }
+
+        if ( cNFlushed + cNSkipped > 0 )
+            LOG (INFO) << "Cbc register Flush: " << cNFlushed << " registers written, " << cNSkipped << " unchanged ones skipped" ;
+
+        fBoardWorkers.reset();
+
         delete fBeBoardInterface;
         delete fCbcInterface;
         fBeBoardFWMap.clear();
@@ -100,34 +129,140 @@ namespace Ph2_System {
         }
         else cCheck = false;
 
-        for (auto& cBoard : fBoardVector)
-        {
-            fBeBoardInterface->ConfigureBoard ( cBoard );
-            fBeBoardInterface->CbcHardReset ( cBoard );
+        auto cBroadcastSetting = fSettingsMap.find ( "BroadcastConfig" );
+        bool cBroadcastEnabled = ( cBroadcastSetting == fSettingsMap.end() || cBroadcastSetting->second != 0 );
 
-            if ( cCheck && cBoard->getBoardType() == "GLIB")
-            {
-                fBeBoardInterface->WriteBoardReg ( cBoard, "pc_commands2.negative_logic_CBC", ( ( cHoleMode ) ? 0 : 1 ) );
-                os << GREEN << "Overriding GLIB register values for signal polarity with value from settings node!" << RESET << std::endl;
-            }
+        // the boards are configured concurrently, each one collects its messages to print them in board order
+        std::vector<std::ostringstream> cBoardOutput ( fBoardVector.size() );
+        std::map<BeBoard*, std::ostringstream*> cOutputMap;
 
-            os << GREEN << "Successfully configured Board " << int ( cBoard->getBeId() ) << RESET << std::endl;
+        for ( size_t cIndex = 0; cIndex < fBoardVector.size(); cIndex++ )
+            cOutputMap[fBoardVector.at ( cIndex )] = &cBoardOutput.at ( cIndex );
 
-            for (auto& cFe : cBoard->fModuleVector)
+        try
+        {
+            RunOnBoards ( [&] ( BeBoard * cBoard, BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
             {
-                for (auto& cCbc : cFe->fCbcVector)
+                std::ostream& cOs = *cOutputMap.at ( cBoard );
+                // only the IC firmware acknowledges the broadcast words, the CTA one rejects them and the GLIB one does not read them back
+                bool cBroadcast = cBroadcastEnabled && ( cBoard->getBoardType() == "ICGLIB" || cBoard->getBoardType() == "ICFC7" );
+
+                cBeBoardInterface->ConfigureBoard ( cBoard );
+                configurePolling ( cBoard, cBeBoardInterface );
+                cBeBoardInterface->CbcHardReset ( cBoard );
+
+                if ( cCheck && cBoard->getBoardType() == "GLIB")
+                {
+                    cBeBoardInterface->WriteBoardReg ( cBoard, "pc_commands2.negative_logic_CBC", ( ( cHoleMode ) ? 0 : 1 ) );
+                    cOs << GREEN << "Overriding GLIB register values for signal polarity with value from settings node!" << RESET << std::endl;
+                }
+
+                cOs << GREEN << "Successfully configured Board " << int ( cBoard->getBeId() ) << RESET << std::endl;
+
+                for (auto& cFe : cBoard->fModuleVector)
                 {
-                    if ( !bIgnoreI2c )
+                    if ( bIgnoreI2c ) continue;
+
+                    // registers common to all CBCs of the FE are written once, the rest chip by chip
+                    if ( cBroadcast )
+                    {
+                        if ( cCbcInterface->ConfigureModuleBroadcast ( cFe ) )
+                            cOs << GREEN <<  "Successfully configured " << int ( cFe->getNCbc() ) << " Cbcs of FE " << int ( cFe->getFeId() ) << RESET << std::endl;
+                        else
+                            cOs << RED <<  "Configuration of the Cbcs of FE " << int ( cFe->getFeId() ) << " failed, see the log for the Cbcs concerned" << RESET << std::endl;
+                    }
+                    else
                     {
-                        fCbcInterface->ConfigureCbc ( cCbc );
-                        os << GREEN <<  "Successfully configured Cbc " << int ( cCbc->getCbcId() ) << RESET << std::endl;
+                        for (auto& cCbc : cFe->fCbcVector)
+                        {
+                            cCbcInterface->ConfigureCbc ( cCbc );
+                            cOs << GREEN <<  "Successfully configured Cbc " << int ( cCbc->getCbcId() ) << RESET << std::endl;
+                        }
                     }
                 }
-            }
 
-            //CbcFastReset as per recommendation of Mark Raymond
-            fBeBoardInterface->CbcFastReset ( cBoard );
+                //CbcFastReset as per recommendation of Mark Raymond
+                cBeBoardInterface->CbcFastReset ( cBoard );
+            } );
         }
+        catch ( ... )
+        {
+            for ( auto& cOutput : cBoardOutput )
+                os << cOutput.str();
+
+            throw;
+        }
+
+        for ( auto& cOutput : cBoardOutput )
+            os << cOutput.str();
+    }
+
+    bool SystemController::useBoardWorkers() const
+    {
+        auto cSetting = fSettingsMap.find ( "ParallelBoards" );
+
+        return fBoardVector.size() > 1 && ( cSetting == fSettingsMap.end() || cSetting->second != 0 );
+    }
+
+    void SystemController::RunOnBoards ( const BoardJob& pJob )
+    {
+        if ( !useBoardWorkers() )
+        {
+            for ( BeBoard* cBoard : fBoardVector )
+                pJob ( cBoard, fBeBoardInterface, fCbcInterface );
+
+            return;
+        }
+
+        if ( fBoardWorkers == nullptr || fBoardWorkers->size() != fBoardVector.size() )
+        {
+            fBoardWorkers = std::make_shared<BoardWorkerPool> ( fBeBoardFWMap, fBoardVector.size() );
+        }
+
+        std::vector<BoardWorkerPool::Job> cJobs;
+
+        for ( BeBoard* cBoard : fBoardVector )
+        {
+            cJobs.push_back ( [&pJob, cBoard] ( BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
+            {
+                pJob ( cBoard, cBeBoardInterface, cCbcInterface );
+            } );
+        }
+
+        fBoardWorkers->Run ( cJobs );
+    }
+
+    void SystemController::StartAllBoards()
+    {
+        RunOnBoards ( [] ( BeBoard * cBoard, BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
+        {
+            cBeBoardInterface->Start ( cBoard );
+        } );
+    }
+
+    void SystemController::ReadNEventsAllBoards ( uint32_t pNEvents )
+    {
+        RunOnBoards ( [pNEvents] ( BeBoard * cBoard, BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
+        {
+            cBeBoardInterface->ReadNEvents ( cBoard, pNEvents );
+        } );
+    }
+
+    void SystemController::configurePolling ( BeBoard* pBoard, BeBoardInterface* pBeBoardInterface )
+    {
+        PollingStrategy& cPolling = pBeBoardInterface->GetDataPolling ( pBoard );
+        auto cSpin = fSettingsMap.find ( "PollSpinCount" );
+        auto cMinSleep = fSettingsMap.find ( "PollMinSleepUs" );
+        auto cMaxSleep = fSettingsMap.find ( "PollMaxSleepUs" );
+        auto cTimeout = fSettingsMap.find ( "PollTimeoutMs" );
+
+        if ( cSpin != fSettingsMap.end() ) cPolling.SetSpinPolls ( cSpin->second );
+
+        if ( cMinSleep != fSettingsMap.end() || cMaxSleep != fSettingsMap.end() )
+            cPolling.SetBackoff ( ( cMinSleep != fSettingsMap.end() ) ? cMinSleep->second : 20,
+                                  ( cMaxSleep != fSettingsMap.end() ) ? cMaxSleep->second : 1000 );
+
+        if ( cTimeout != fSettingsMap.end() ) cPolling.SetTimeout ( cTimeout->second );
     }
 
     void SystemController::initializeFileHandler()
@@ -14,6 +14,7 @@
 #define __SYSTEMCONTROLLER_H__
 
 #include "FileParser.h"
+#include "BoardWorkerPool.h"
 #include "../HWInterface/CbcInterface.h"
 #include "../HWInterface/BeBoardInterface.h"
 #include "../HWInterface/BeBoardFWInterface.h"
@@ -30,6 +31,9 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
+#include <functional>
+#include <sstream>
 #include <stdlib.h>
 #include <string.h>
 
@@ -45,6 +49,7 @@ namespace Ph2_System {
 
     using BeBoardVec = std::vector<BeBoard*>;               /*!< Vector of Board pointers */
     using SettingsMap = std::map<std::string, uint32_t>;    /*!< Maps the settings */
+    using BoardJob = std::function<void ( BeBoard*, BeBoardInterface*, CbcInterface* )>;  /*!< Work for one board, with interfaces reserved to the calling thread */
 
     /*!
      * \class SystemController
@@ -63,6 +68,8 @@ namespace Ph2_System {
         //for writing 1 file for each FED
         std::string             fRawFileName;
         bool                    fWriteHandlerEnabled;
+        //one worker thread per board, created on first use with more than one board, shared with the inheriting tools
+        std::shared_ptr<BoardWorkerPool> fBoardWorkers;
 
       private:
         FileParser fParser;
@@ -88,6 +95,7 @@ namespace Ph2_System {
             fBeBoardFWMap = pController->fBeBoardFWMap;
             fSettingsMap = pController->fSettingsMap;
             fFileHandler = pController->fFileHandler;
+            fBoardWorkers = pController->fBoardWorkers;
         }
         /*!
          * \brief Destroy the SystemController object: clear the HWDescription Objects, FWInterface etc.
@@ -110,6 +118,14 @@ namespace Ph2_System {
         * \brief issues a FileHandler for writing files to every BeBoardFWInterface if addFileHandler was called
         */
         void initializeFileHandler ();
+        /*!
+        * \brief apply the optional PollSpinCount, PollMinSleepUs, PollMaxSleepUs and PollTimeoutMs settings to the data polling of a board
+        */
+        void configurePolling ( BeBoard* pBoard, BeBoardInterface* pBeBoardInterface );
+        /*!
+        * \brief true if RunOnBoards should use the worker threads: more than one board and the ParallelBoards setting not 0
+        */
+        bool useBoardWorkers() const;
 
       public:
         /*!
@@ -146,6 +162,22 @@ namespace Ph2_System {
          * \brief Configure the Hardware with XML file indicated values
          */
         void ConfigureHw ( std::ostream& os = std::cout , bool bIgnoreI2c = false );
+        /*!
+         * \brief Run pJob for every board of fBoardVector, concurrently if there is more than one board, and wait for all of them
+         * The interfaces passed to pJob must be used instead of fBeBoardInterface and fCbcInterface, which are not thread safe.
+         * An exception thrown for one board is rethrown once all boards are done.
+         * \param pJob : work for one board
+         */
+        void RunOnBoards ( const BoardJob& pJob );
+        /*!
+         * \brief Start the acquisition of all boards
+         */
+        void StartAllBoards();
+        /*!
+         * \brief Read pNEvents events from every board, the boards take data at the same time
+         * \param pNEvents : number of events per board, fetch them with GetEvents afterwards
+         */
+        void ReadNEventsAllBoards ( uint32_t pNEvents );
         /*!
          * \brief Run a DAQ
          * \param pBeBoard
@@ -12,9 +12,157 @@
 #include "../Utils/Data.h"
 #include <iostream>
 
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#include <immintrin.h>
+#define DATA_X86_SIMD
+#endif
+
 namespace Ph2_HwInterface {
+
+    // batch decode kernels for the Imperial FW bit reversal
+    // each word of an event is decoded with its own set of masks, see Data::computeMasks()
+    namespace {
+
+        inline uint32_t reverse_word ( uint32_t n )
+        {
+            n = ( (n >> 1) & 0x55555555) | ( (n << 1) & 0xaaaaaaaa) ;
+            n = ( (n >> 2) & 0x33333333) | ( (n << 2) & 0xcccccccc) ;
+            n = ( (n >> 4) & 0x0f0f0f0f) | ( (n << 4) & 0xf0f0f0f0) ;
+            return __builtin_bswap32 (n);
+        }
+
+        using DecodeKernel = uint32_t (*) ( uint32_t*, uint32_t, const uint32_t*, const uint32_t*, const uint32_t*, const uint32_t* );
+
+        // decodes words [0, pNWords) and returns the number of words done (all of them)
+        uint32_t decode_scalar ( uint32_t* pWords, uint32_t pNWords, const uint32_t* pKeep, const uint32_t* pRev, const uint32_t* pRevShift, const uint32_t* pShift )
+        {
+            for ( uint32_t i = 0; i < pNWords; i++ )
+            {
+                uint32_t cWord = pWords[i];
+                uint32_t cRev = reverse_word ( cWord );
+                pWords[i] = (cWord & pKeep[i]) | (cRev & pRev[i]) | ( ( (cRev & pRevShift[i]) | (cWord & pShift[i]) ) >> 20 );
+            }
+
+            return pNWords;
+        }
+
+#ifdef DATA_X86_SIMD
+        // bit reversal of each 32 bit word: reverse the bits of every byte with a nibble LUT, then the byte order
+        __attribute__ ( (target ("ssse3") ) )
+        inline __m128i reverse_words_ssse3 ( __m128i v )
+        {
+            const __m128i cLut = _mm_setr_epi8 (0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+            const __m128i cNibble = _mm_set1_epi8 (0x0F);
+            const __m128i cByteSwap = _mm_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            __m128i cLo = _mm_shuffle_epi8 (cLut, _mm_and_si128 (v, cNibble) );
+            __m128i cHi = _mm_shuffle_epi8 (cLut, _mm_and_si128 (_mm_srli_epi16 (v, 4), cNibble) );
+            return _mm_shuffle_epi8 (_mm_or_si128 (_mm_slli_epi16 (cLo, 4), cHi), cByteSwap);
+        }
+
+        __attribute__ ( (target ("ssse3") ) )
+        uint32_t decode_ssse3 ( uint32_t* pWords, uint32_t pNWords, const uint32_t* pKeep, const uint32_t* pRev, const uint32_t* pRevShift, const uint32_t* pShift )
+        {
+            uint32_t i = 0;
+
+            for ( ; i + 4 <= pNWords; i += 4 )
+            {
+                __m128i cWord = _mm_loadu_si128 ( (const __m128i*) (pWords + i) );
+                __m128i cRev = reverse_words_ssse3 (cWord);
+                __m128i cOut = _mm_or_si128 (_mm_and_si128 (cWord, _mm_loadu_si128 ( (const __m128i*) (pKeep + i) ) ),
+                                             _mm_and_si128 (cRev, _mm_loadu_si128 ( (const __m128i*) (pRev + i) ) ) );
+                __m128i cShifted = _mm_or_si128 (_mm_and_si128 (cRev, _mm_loadu_si128 ( (const __m128i*) (pRevShift + i) ) ),
+                                                 _mm_and_si128 (cWord, _mm_loadu_si128 ( (const __m128i*) (pShift + i) ) ) );
+                _mm_storeu_si128 ( (__m128i*) (pWords + i), _mm_or_si128 (cOut, _mm_srli_epi32 (cShifted, 20) ) );
+            }
+
+            return i + decode_scalar (pWords + i, pNWords - i, pKeep + i, pRev + i, pRevShift + i, pShift + i);
+        }
+
+        __attribute__ ( (target ("avx2") ) )
+        inline __m256i reverse_words_avx2 ( __m256i v )
+        {
+            const __m256i cLut = _mm256_setr_epi8 (0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
+                                                   0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+            const __m256i cNibble = _mm256_set1_epi8 (0x0F);
+            const __m256i cByteSwap = _mm256_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            __m256i cLo = _mm256_shuffle_epi8 (cLut, _mm256_and_si256 (v, cNibble) );
+            __m256i cHi = _mm256_shuffle_epi8 (cLut, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), cNibble) );
+            return _mm256_shuffle_epi8 (_mm256_or_si256 (_mm256_slli_epi16 (cLo, 4), cHi), cByteSwap);
+        }
+
+        __attribute__ ( (target ("avx2") ) )
+        uint32_t decode_avx2 ( uint32_t* pWords, uint32_t pNWords, const uint32_t* pKeep, const uint32_t* pRev, const uint32_t* pRevShift, const uint32_t* pShift )
+        {
+            uint32_t i = 0;
+
+            for ( ; i + 8 <= pNWords; i += 8 )
+            {
+                __m256i cWord = _mm256_loadu_si256 ( (const __m256i*) (pWords + i) );
+                __m256i cRev = reverse_words_avx2 (cWord);
+                __m256i cOut = _mm256_or_si256 (_mm256_and_si256 (cWord, _mm256_loadu_si256 ( (const __m256i*) (pKeep + i) ) ),
+                                                _mm256_and_si256 (cRev, _mm256_loadu_si256 ( (const __m256i*) (pRev + i) ) ) );
+                __m256i cShifted = _mm256_or_si256 (_mm256_and_si256 (cRev, _mm256_loadu_si256 ( (const __m256i*) (pRevShift + i) ) ),
+                                                    _mm256_and_si256 (cWord, _mm256_loadu_si256 ( (const __m256i*) (pShift + i) ) ) );
+                _mm256_storeu_si256 ( (__m256i*) (pWords + i), _mm256_or_si256 (cOut, _mm256_srli_epi32 (cShifted, 20) ) );
+            }
+
+            return i + decode_scalar (pWords + i, pNWords - i, pKeep + i, pRev + i, pRevShift + i, pShift + i);
+        }
+#endif
+
+        struct NamedKernel
+        {
+            const char* fName;
+            DecodeKernel fKernel;
+        };
+
+        // the kernels the CPU supports, widest first
+        std::vector<NamedKernel> supported_kernels()
+        {
+            std::vector<NamedKernel> cKernels;
+#ifdef DATA_X86_SIMD
+            __builtin_cpu_init();
+
+            if ( __builtin_cpu_supports ("avx2") ) cKernels.push_back ( {"avx2", decode_avx2} );
+
+            if ( __builtin_cpu_supports ("ssse3") ) cKernels.push_back ( {"ssse3", decode_ssse3} );
+
+#endif
+            cKernels.push_back ( {"scalar", decode_scalar} );
+            return cKernels;
+        }
+
+        // the widest kernel by default, Data::SetDecodeKernel() can pick another one
+        DecodeKernel decode_kernel = supported_kernels().front().fKernel;
+    }
     //Data Class
 
+    std::vector<std::string> Data::GetDecodeKernels()
+    {
+        std::vector<std::string> cNames;
+
+        for ( auto& cKernel : supported_kernels() )
+            cNames.push_back ( cKernel.fName );
+
+        return cNames;
+    }
+
+    bool Data::SetDecodeKernel ( const std::string& pName )
+    {
+        for ( auto& cKernel : supported_kernels() )
+        {
+            if ( pName == cKernel.fName )
+            {
+                decode_kernel = cKernel.fKernel;
+                return true;
+            }
+        }
+
+        LOG (ERROR) << "Data: the decode kernel " << pName << " is not supported on this CPU" ;
+        return false;
+    }
+
     // copy constructor
     Data::Data ( const Data& pD ) :
 
@@ -22,7 +170,8 @@ namespace Ph2_HwInterface {
         fNevents ( pD.fNevents ),
         fCurrentEvent ( pD.fCurrentEvent ),
         fNCbc ( pD.fNCbc ),
-        fEventSize ( pD.fEventSize )
+        fEventSize ( pD.fEventSize ),
+        fMaskEventSize ( 0 )
     {
     }
 
@@ -35,75 +184,67 @@ namespace Ph2_HwInterface {
         fEventSize = static_cast<uint32_t> ( (pData.size() ) / fNevents );
         fNCbc = ( fEventSize - ( EVENT_HEADER_TDC_SIZE_32 ) ) / ( CBC_EVENT_SIZE_32 );
 
-        //use a SwapIndex to decide wether to swap a word or not
-        //use a WordIndex to pick events apart
-        uint32_t cWordIndex = 0;
-        uint32_t cSwapIndex = 0;
+        // the packet is decoded in place in one contiguous buffer, the Events are only views into it
+        // the buffers keep their capacity across Reset() so a steady readout does not allocate
+        fBuffer.assign ( pData.begin(), pData.begin() + fNevents * fEventSize );
+
+        decode ( pBoard, swapBits, swapBytes );
+    }
+
+    void Data::Set ( const BeBoard* pBoard, std::vector<uint32_t>&& pData, uint32_t pNevents, bool swapBits, bool swapBytes )
+    {
+        Reset();
+
+        fNevents = static_cast<uint32_t> ( pNevents );
+        fEventSize = static_cast<uint32_t> ( (pData.size() ) / fNevents );
+        fNCbc = ( fEventSize - ( EVENT_HEADER_TDC_SIZE_32 ) ) / ( CBC_EVENT_SIZE_32 );
+
+        // take over the packet and give the old (cleared) storage back to the caller
+        fBuffer.swap ( pData );
+        fBuffer.resize ( fNevents * fEventSize );
+
+        decode ( pBoard, swapBits, swapBytes );
+    }
 
-        // to Fill fEventList
-        std::vector<uint32_t> lvec;
+    void Data::decode ( const BeBoard* pBoard, bool swapBits, bool swapBytes )
+    {
+        fIndex.Set ( pBoard, fEventSize );
 
-        for ( auto word : pData )
+        if (swapBits)
         {
-            //if the SwapIndex is greater than 0 and a multiple of the event size in 32 bit words, reset SwapIndex to 0
-            if (cSwapIndex > 0 && cSwapIndex % fEventSize == 0) cSwapIndex = 0;
+            computeMasks();
 
-            // old version
-            //if (swapBits && is_channel_data (cSwapIndex, fNCbc) ) word = reverse_bits (word);
-            //new version
-            if (swapBits)
-            {
-                if (is_channel_first_row (cSwapIndex) )
-                {
-                    // here I need to shift out the Error bits and PipelineAddress
-                    //uint8_t cErrors = word & 0x00000003;
-                    uint8_t cPipeAddress = (word & 0x000003FC) >> 2;
-                    //next I need to reverse the bit order and mask out the corresponding bits for errors & pipe address
-                    word = reverse_bits (word) & 0xC03FFFFF;;
-                    //now just need to shift the Errors & Pipe address back in
-                    word |=  cPipeAddress << 22;
-                }
-
-                if (is_channel_last_row (cSwapIndex) )
-                {
-                    //OLD METHOD
-                    // here i need to shift out the GlibFlags which are supposed to be 0 and the Stub word
-                    uint16_t cStubWord = (word & 0xFFF00000) >> 20;
-                    //uint16_t cGlibFlag = (word & 0x000FFF00) >> 8;
-                    //reverse the bit order and mask stuff out
-                    //word = reverse_bits (word) & 0xFF000000;
-                    word = reverse_bits (word) & 0xFFFFF000;
-                    //now shift the GlibFlag and the StubWord back in
-                    //word |= ( ( (cGlibFlag & 0x0FFF ) << 12) | (cStubWord & 0x0FFF) );
-                    word |= (cStubWord & 0x0FFF);
-                }
-                //is_channel_data will also be true for first and last word but since it's an else if, it should be ok
-                else if ( is_channel_data (cSwapIndex) ) word = reverse_bits (word);
-            }
-            else if (swapBytes)
-                word = swap_bytes (word);
+            // the masks repeat with every event, so the kernel runs once per event over the whole event
+            for ( uint32_t cEvent = 0; cEvent < fNevents; cEvent++ )
+                decode_kernel ( fBuffer.data() + cEvent * fEventSize, fEventSize, fMaskKeep.data(), fMaskRev.data(), fMaskRevShift.data(), fMaskShift.data() );
+        }
+        else if (swapBytes)
+        {
+            for ( auto& cWord : fBuffer )
+                cWord = swap_bytes (cWord);
+        }
 
 #ifdef __CBCDAQ_DEV__
-            LOG (DEBUG) << std::setw (3) << "Original " << cWordIndex << " ### " << std::bitset<32> (pData.at (cWordIndex) );
-            LOG (DEBUG) << std::setw (3) << "Treated  " << cWordIndex << " ### " << std::bitset<32> (word);
+
+        for ( uint32_t cWordIndex = 0; cWordIndex < fBuffer.size(); cWordIndex++ )
+        {
+            LOG (DEBUG) << std::setw (3) << "Treated  " << cWordIndex << " ### " << std::bitset<32> (fBuffer.at (cWordIndex) );
 
             if ( (cWordIndex + 1) % fEventSize == 0 && cWordIndex > 0 ) LOG (DEBUG) << std::endl << std::endl;
+        }
 
 #endif
 
-            lvec.push_back ( word );
+        // fEvents is fully built before taking addresses so the pointers in fEventList stay valid
+        fEvents.reserve ( fNevents );
 
-            if ( cWordIndex > 0 &&  (cWordIndex + 1) % fEventSize == 0 )
-            {
-                fEventList.push_back ( new Event ( pBoard, fNCbc, lvec ) );
-                lvec.clear();
+        for ( uint32_t cEvent = 0; cEvent < fNevents; cEvent++ )
+            fEvents.emplace_back ( &fIndex, fBuffer.data() + cEvent * fEventSize, fEventSize );
 
-                if (fEventList.size() >= fNevents) break;
-            }
+        fEventList.reserve ( fNevents );
 
-            cWordIndex++;
-            cSwapIndex++;
-        }
+        for ( auto& cEvent : fEvents )
+            fEventList.push_back ( &cEvent );
 
         //#ifdef __CBCDAQ_DEV__
         //std::cout << "Initializing list with " << pData.size() << " 32 bit words
@@ -113,12 +254,46 @@ namespace Ph2_HwInterface {
         //#endif
     }
 
-    void Data::Reset()
+    void Data::computeMasks()
     {
-        for ( auto& pevt : fEventList )
-            delete pevt;
+        if ( fMaskEventSize == fEventSize ) return;
+
+        fMaskEventSize = fEventSize;
+        // by default a word is kept as it is
+        fMaskKeep.assign ( fEventSize, 0xFFFFFFFF );
+        fMaskRev.assign ( fEventSize, 0 );
+        fMaskRevShift.assign ( fEventSize, 0 );
+        fMaskShift.assign ( fEventSize, 0 );
 
+        for ( uint32_t cIndex = 0; cIndex < fEventSize; cIndex++ )
+        {
+            if (is_channel_first_row (cIndex) )
+            {
+                // the channel data is reversed, the Error bits are kept and the bit order of the PipelineAddress is reversed in place
+                // (this is what reversing, masking with 0xC03FFFFF, shifting the PipelineAddress to bit 22 and reversing again as channel data gives)
+                fMaskKeep[cIndex] = 0xFFFFFC03;
+                fMaskRevShift[cIndex] = 0x3FC00000;
+            }
+            else if (is_channel_last_row (cIndex) )
+            {
+                // the channel data is reversed and the Stub word is shifted back in the 12 LSBs
+                fMaskKeep[cIndex] = 0;
+                fMaskRev[cIndex] = 0xFFFFF000;
+                fMaskShift[cIndex] = 0xFFF00000;
+            }
+            else if ( is_channel_data (cIndex) )
+            {
+                fMaskKeep[cIndex] = 0;
+                fMaskRev[cIndex] = 0xFFFFFFFF;
+            }
+        }
+    }
+
+    void Data::Reset()
+    {
         fEventList.clear();
+        fEvents.clear();
+        fBuffer.clear();
         fCurrentEvent = 0;
     }
 }
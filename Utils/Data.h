@@ -41,6 +41,17 @@ namespace Ph2_HwInterface {
         const std::set<uint32_t> fChannelFirstRows {5, 14, 23, 32, 41, 50, 59, 68};
         const std::set<uint32_t> fChannelLastRows {13, 22, 31, 40, 49, 58, 67, 76};
 
+        // per-word masks of the Imperial FW bit reversal for one event, recomputed only when fEventSize changes
+        // decoded = (w & keep) | (rev(w) & rev) | ( ( (rev(w) & revshift) | (w & shift) ) >> 20 )
+        uint32_t fMaskEventSize;        /*! Event size the masks were computed for <*/
+        std::vector<uint32_t> fMaskKeep;
+        std::vector<uint32_t> fMaskRev;
+        std::vector<uint32_t> fMaskRevShift;
+        std::vector<uint32_t> fMaskShift;
+
+        std::vector<uint32_t> fBuffer;  /*! Decoded words of the whole packet, contiguous <*/
+        EventIndex fIndex;              /*! (FE, CBC) -> offset table shared by all Events <*/
+        std::vector<Event> fEvents;     /*! Event views into fBuffer <*/
         std::vector<Event*> fEventList;
 
       private:
@@ -79,27 +90,33 @@ namespace Ph2_HwInterface {
             return fChannelLastRows.find (pIndex) != std::end (fChannelLastRows);
         }
 
+        // fill the per-word masks from the first/last row and channel data layout of one event
+        void computeMasks();
+
+        // decode fBuffer in place and build the Event views on it
+        void decode ( const BeBoard* pBoard, bool swapBits, bool swapBytes );
+
       public:
         /*!
          * \brief Constructor of the Data class
          * \param pNbCbc
          */
-        Data( ) :  fCurrentEvent ( 0 ), fEventSize ( 0 )
+        Data( ) :  fCurrentEvent ( 0 ), fEventSize ( 0 ), fMaskEventSize ( 0 )
         {
         }
         /*!
          * \brief Copy Constructor of the Data class
          */
         Data ( const Data& pData );
+        /*!
+         * \brief No assignment: the Events are views into fBuffer and would point into the storage of the source
+         */
+        Data& operator= ( const Data& ) = delete;
         /*!
          * \brief Destructor of the Data class
          */
         ~Data()
         {
-            for ( auto pevt : fEventList )
-                delete pevt;
-
-            fEventList.clear();
         }
         /*!
          * \brief Set the data in the data map
@@ -108,6 +125,13 @@ namespace Ph2_HwInterface {
          * \param pNevents : The number of events in this acquisiton
          */
         void Set ( const BeBoard* pBoard, const std::vector<uint32_t>& pData, uint32_t pNevents, bool swapBits = false, bool swapBytes = false );
+        /*!
+         * \brief Adopt a packet buffer and decode it in place, without copying
+         * \param *pBoard : pointer to Board
+         * \param pData : packet buffer; on return it holds the previous storage of this object so the caller can reuse its capacity
+         * \param pNevents : The number of events in this acquisiton
+         */
+        void Set ( const BeBoard* pBoard, std::vector<uint32_t>&& pData, uint32_t pNevents, bool swapBits = false, bool swapBytes = false );
         /*!
          * \brief Reset the data structure
          */
@@ -130,6 +154,23 @@ namespace Ph2_HwInterface {
         {
             return fEventList;
         }
+        /*!
+         * \brief Get the decoded words of the whole packet, fEventSize words per Event
+         */
+        const std::vector<uint32_t>& GetBuffer() const
+        {
+            return fBuffer;
+        }
+        /*!
+         * \brief Get the names of the bit reversal kernels the CPU supports, the widest first: it is the default one
+         */
+        static std::vector<std::string> GetDecodeKernels();
+        /*!
+         * \brief Select the bit reversal kernel of all Data objects, to be called before any packet is decoded
+         * \param pName : one of the names given by GetDecodeKernels()
+         * \return false if the kernel is not supported, the current one is then kept
+         */
+        static bool SetDecodeKernel ( const std::string& pName );
     };
 
 }
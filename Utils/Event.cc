@@ -16,10 +16,52 @@ using namespace Ph2_HwDescription;
 
 namespace Ph2_HwInterface {
 
+    // EventIndex implementation
+    void EventIndex::Set ( const BeBoard* pBoard, uint32_t pEventSize )
+    {
+        fKeys.clear();
+        fNFe = static_cast<uint32_t> ( pBoard->getNFe() );
+        fNCbcMax = 0;
+
+        // if the NCbcDataSize in the FW Version node of the BeBoard is set, the DataSize is assumed fixed:
+        // if 1 module is defined, the number of CBCs is the datasize given in the xml
+        // if more than one module is defined, the number of CBCs for each FE is the datasize divided by the nFe
+        // if there is no FWVersion node in the xml, the CBCs will be counted for each module according to the xml file
+        std::vector<uint32_t> cNCbc ( fNFe, 0 );
+
+        for ( uint8_t cFeId = 0; cFeId < fNFe; cFeId++ )
+        {
+            if ( pBoard->getNCbcDataSize() )
+            {
+                if ( fNFe == 1 ) cNCbc[cFeId] = static_cast<uint32_t> ( pBoard->getNCbcDataSize() );
+                else cNCbc[cFeId] = static_cast<uint32_t> ( pBoard->getNCbcDataSize() / fNFe );
+            }
+            else cNCbc[cFeId] = static_cast<uint32_t> ( pBoard->getModule ( cFeId )->getNCbc() );
+
+            fNCbcMax = std::max ( fNCbcMax, cNCbc[cFeId] );
+        }
+
+        fOffsets.assign ( fNFe * fNCbcMax, -1 );
+
+        for ( uint8_t cFeId = 0; cFeId < fNFe; cFeId++ )
+        {
+            for ( uint8_t cCbcId = 0; cCbcId < cNCbc[cFeId]; cCbcId++ )
+            {
+                uint32_t cBegin = EVENT_HEADER_SIZE_32 + cFeId * CBC_EVENT_SIZE_32 * cNCbc[cFeId] + cCbcId * CBC_EVENT_SIZE_32;
+
+                // CBCs that do not fit in the event are not in the data
+                if ( cBegin + CBC_EVENT_SIZE_32 > pEventSize ) continue;
+
+                fOffsets[cFeId * fNCbcMax + cCbcId] = static_cast<int32_t> ( cBegin );
+                fKeys.push_back ( cFeId << 8 | cCbcId );
+            }
+        }
+    }
+
     // Event implementation
-    Event::Event ( const BeBoard* pBoard,  uint32_t pNbCbc, const std::vector<uint32_t>& list )
+    Event::Event ( const EventIndex* pIndex, const uint32_t* pEventData, uint32_t pEventSize )
     {
-        SetEvent ( pBoard, pNbCbc, list );
+        SetEvent ( pIndex, pEventData, pEventSize );
     }
 
 
@@ -30,114 +72,85 @@ namespace Ph2_HwInterface {
         fEventCount ( pEvent.fEventCount ),
         fEventCountCBC ( pEvent.fEventCountCBC ),
         fTDC ( pEvent.fTDC ),
-        fEventSize (pEvent.fEventSize),
-        fEventDataMap ( pEvent.fEventDataMap )
+        fEventData ( pEvent.fEventData ),
+        fIndex ( pEvent.fIndex ),
+        fEventSize (pEvent.fEventSize)
     {
 
     }
 
     bool Event::operator== (const Event& pEvent) const
     {
-        return fEventDataMap == pEvent.fEventDataMap;
-    }
-
-    int Event::SetEvent ( const BeBoard* pBoard, uint32_t pNbCbc, const std::vector<uint32_t>& list )
-    {
-        fEventSize = pNbCbc *  CBC_EVENT_SIZE_32  + EVENT_HEADER_TDC_SIZE_32;
+        if ( GetCbcKeys() != pEvent.GetCbcKeys() ) return false;
 
-        //now decode the header info
-        fBunch = 0x00FFFFFF & list.at (0);
-        fOrbit = 0x00FFFFFF & list.at (1);
-        fLumi = 0x00FFFFFF & list.at (2);
-        fEventCount = 0x00FFFFFF &  list.at (3);
-        fEventCountCBC = 0x00FFFFFF & list.at (4);
-        fTDC = 0x000000FF & list.back();
-
-
-        //now decode FEEvents
-        uint8_t cBeId = pBoard->getBeId();
-        uint32_t cNFe = static_cast<uint32_t> ( pBoard->getNFe() );
-
-        for ( uint8_t cFeId = 0; cFeId < cNFe; cFeId++ )
+        for ( auto cKey : GetCbcKeys() )
         {
-            uint32_t cNCbc;
+            int32_t cOffset = fIndex->GetOffset ( (cKey >> 8) & 0xFF, cKey & 0xFF );
+            int32_t cOtherOffset = pEvent.fIndex->GetOffset ( (cKey >> 8) & 0xFF, cKey & 0xFF );
 
-            // if the NCbcDataSize in the FW Version node of the BeBoard is set, the DataSize is assumed fixed:
-            // if 1 module is defined, the number of CBCs is the datasize given in the xml
-            // if more than one module is defined, the number of CBCs for each FE is the datasize divided by the nFe
-            if ( pBoard->getNCbcDataSize() )
-            {
-                if ( cNFe == 1 ) cNCbc = static_cast<uint32_t> ( pBoard->getNCbcDataSize() );
-                else cNCbc = static_cast<uint32_t> ( pBoard->getNCbcDataSize() / cNFe );
-            }
-            // if there is no FWVersion node in the xml, the CBCs will be counted for each module according to the xml file
-            else cNCbc = static_cast<uint32_t> ( pBoard->getModule ( cFeId )->getNCbc() );
-
-            //now loop the CBCs and encode the IDs in key
-            for ( uint8_t cCbcId = 0; cCbcId < cNCbc; cCbcId++ )
-            {
-                uint16_t cKey = encodeId (cFeId, cCbcId);
+            if ( !std::equal ( fEventData + cOffset, fEventData + cOffset + CBC_EVENT_SIZE_32, pEvent.fEventData + cOtherOffset ) )
+                return false;
+        }
 
-                uint32_t begin = EVENT_HEADER_SIZE_32 + cFeId * CBC_EVENT_SIZE_32 * cNCbc + cCbcId * CBC_EVENT_SIZE_32;
-                uint32_t end = begin + CBC_EVENT_SIZE_32;
+        return true;
+    }
 
-                std::vector<uint32_t> cCbcData (std::next (std::begin (list), begin), std::next (std::begin (list), end) );
+    void Event::SetEvent ( const EventIndex* pIndex, const uint32_t* pEventData, uint32_t pEventSize )
+    {
+        fIndex = pIndex;
+        fEventData = pEventData;
+        fEventSize = pEventSize;
 
-                fEventDataMap[cKey] = cCbcData;
-            }
-        }
+        //now decode the header info
+        fBunch = 0x00FFFFFF & fEventData[0];
+        fOrbit = 0x00FFFFFF & fEventData[1];
+        fLumi = 0x00FFFFFF & fEventData[2];
+        fEventCount = 0x00FFFFFF &  fEventData[3];
+        fEventCountCBC = 0x00FFFFFF & fEventData[4];
+        fTDC = 0x000000FF & fEventData[fEventSize - 1];
     }
 
     void Event::GetCbcEvent ( const uint8_t& pFeId, const uint8_t& pCbcId, std::vector< uint32_t >& cbcData )  const
     {
         cbcData.clear();
 
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
-        {
-            cbcData.reserve (cData->second.size() );
-            cbcData.assign (cData->second.begin(), cData->second.end() );
-        }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
+        if ( cData != nullptr )
+            cbcData.assign ( cData, cData + CBC_EVENT_SIZE_32 );
     }
 
     void Event::GetCbcEvent ( const uint8_t& pFeId, const uint8_t& pCbcId, std::vector< uint8_t >& cbcData )  const
     {
         cbcData.clear();
 
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
+        if ( cData != nullptr )
         {
-            for (const auto& cWord : cData->second)
+            cbcData.reserve ( 4 * CBC_EVENT_SIZE_32 );
+
+            for ( uint32_t cWord = 0; cWord < CBC_EVENT_SIZE_32; cWord++ )
             {
-                cbcData.push_back ( (cWord >> 24) & 0xFF);
-                cbcData.push_back ( (cWord >> 16) & 0xFF);
-                cbcData.push_back ( (cWord >> 8) & 0xFF);
-                cbcData.push_back ( (cWord ) & 0xFF);
+                cbcData.push_back ( (cData[cWord] >> 24) & 0xFF);
+                cbcData.push_back ( (cData[cWord] >> 16) & 0xFF);
+                cbcData.push_back ( (cData[cWord] >> 8) & 0xFF);
+                cbcData.push_back ( (cData[cWord] ) & 0xFF);
             }
         }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found.";
     }
 
     std::string Event::HexString() const
     {
-        //std::stringbuf tmp;
-        //std::ostream os ( &tmp );
-
-        //os << std::hex;
+        std::stringbuf tmp;
+        std::ostream os ( &tmp );
 
-        //for ( uint32_t i = 0; i < fEventSize; i++ )
-        //os << std::uppercase << std::setw ( 2 ) << std::setfill ( '0' ) << ( fEventData.at (i) & 0xFF000000 ) << " " << ( fEventData.at (i) & 0x00FF0000 ) << " " << ( fEventData.at (i) & 0x0000FF00 ) << " " << ( fEventData.at (i) & 0x000000FF );
+        os << std::hex << std::uppercase << std::setfill ( '0' );
 
-        ////os << std::endl;
+        for ( uint32_t i = 0; i < fEventSize; i++ )
+            os << std::setw ( 8 ) << fEventData[i] << " ";
 
-        //return tmp.str();
+        return tmp.str();
     }
 
 
@@ -146,20 +159,11 @@ namespace Ph2_HwInterface {
         uint32_t cWordP = pPosition / 32;
         uint32_t cBitP = pPosition % 32;
 
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
-        {
-            if (cWordP >= cData->second.size() ) return false;
+        if ( cData == nullptr || cWordP >= CBC_EVENT_SIZE_32 ) return false;
 
-            return ( (cData->second.at (cWordP) >> (31 - cBitP) ) & 0x1);
-        }
-        else
-        {
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
-            return false;
-        }
+        return ( (cData[cWordP] >> (31 - cBitP) ) & 0x1);
     }
 
 
@@ -170,30 +174,16 @@ namespace Ph2_HwInterface {
 
     uint32_t Event::Error ( uint8_t pFeId, uint8_t pCbcId ) const
     {
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
-            return ( (cData->second.at (0) >> 30) & 0x00000003);
-        else
-        {
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
-            return 0;
-        }
+        return ( cData != nullptr ) ? ( (cData[0] >> 30) & 0x00000003) : 0;
     }
 
     uint32_t Event::PipelineAddress ( uint8_t pFeId, uint8_t pCbcId ) const
     {
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
-            return ( (cData->second.at (0) >> 22) & 0x000000FF);
-        else
-        {
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
-            return 0;
-        }
+        return ( cData != nullptr ) ? ( (cData[0] >> 22) & 0x000000FF) : 0;
     }
 
     bool Event::DataBit ( uint8_t pFeId, uint8_t pCbcId, uint32_t i ) const
@@ -207,44 +197,35 @@ namespace Ph2_HwInterface {
 
     std::string Event::BitString ( uint8_t pFeId, uint8_t pCbcId, uint32_t pOffset, uint32_t pWidth ) const
     {
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
-
-        if (cData != std::end (fEventDataMap) )
-        {
-            std::ostringstream os;
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-            for ( uint32_t i = 0; i < pWidth; ++i )
-            {
-                uint32_t pos = i + pOffset;
-                uint32_t cWordP = pos / 32;
-                uint32_t cBitP = pos % 32;
+        if ( cData == nullptr ) return "";
 
-                if ( cWordP >= cData->second.size() ) break;
+        std::string cBits;
+        cBits.reserve ( pWidth );
 
-                //os << ((cbcData[cByteP] & ( 1 << ( 7 - cBitP ) ))?"1":"0");
-                os << ( ( cData->second[cWordP] >> ( 31 - cBitP ) ) & 0x1 );
-            }
+        for ( uint32_t i = 0; i < pWidth; ++i )
+        {
+            uint32_t pos = i + pOffset;
+            uint32_t cWordP = pos / 32;
+            uint32_t cBitP = pos % 32;
 
-            return os.str();
+            if ( cWordP >= CBC_EVENT_SIZE_32 ) break;
 
+            cBits.push_back ( ( ( cData[cWordP] >> ( 31 - cBitP ) ) & 0x1 ) ? '1' : '0' );
         }
-        else
-        {
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
-            return "";
-        }
+
+        return cBits;
     }
 
     std::vector<bool> Event::BitVector ( uint8_t pFeId, uint8_t pCbcId, uint32_t pOffset, uint32_t pWidth ) const
     {
         std::vector<bool> blist;
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
+        if ( cData != nullptr )
         {
-            std::ostringstream os;
+            blist.reserve ( pWidth );
 
             for ( uint32_t i = 0; i < pWidth; ++i )
             {
@@ -252,13 +233,11 @@ namespace Ph2_HwInterface {
                 uint32_t cWordP = pos / 32;
                 uint32_t cBitP = pos % 32;
 
-                if ( cWordP >= cData->second.size() ) break;
+                if ( cWordP >= CBC_EVENT_SIZE_32 ) break;
 
-                blist.push_back ( ( cData->second[cWordP] >> ( 31 - cBitP ) ) & 0x1 );
+                blist.push_back ( ( cData[cWordP] >> ( 31 - cBitP ) ) & 0x1 );
             }
         }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
 
         return blist;
     }
@@ -271,17 +250,26 @@ namespace Ph2_HwInterface {
 
     std::vector<bool> Event::DataBitVector ( uint8_t pFeId, uint8_t pCbcId ) const
     {
-        return BitVector ( pFeId, pCbcId, OFFSET_CBCDATA, WIDTH_CBCDATA );
+        std::vector<bool> blist;
+
+        if ( fIndex->GetOffset ( pFeId, pCbcId ) < 0 ) return blist;
+
+        const CbcChannelMask cMask = ChannelMask ( pFeId, pCbcId );
+        blist.resize ( NCHANNELS );
+        ForEachHit ( cMask, [&blist] ( uint32_t cChannel )
+        {
+            blist[cChannel] = true;
+        } );
+
+        return blist;
     }
 
     std::vector<bool> Event::DataBitVector ( uint8_t pFeId, uint8_t pCbcId, const std::vector<uint8_t>& channelList ) const
     {
         std::vector<bool> blist;
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
-
-        if (cData != std::end (fEventDataMap) )
+        if ( cData != nullptr )
         {
             for ( auto i :  channelList )
             {
@@ -289,13 +277,11 @@ namespace Ph2_HwInterface {
                 uint32_t cWordP = pos / 32;
                 uint32_t cBitP = pos % 32;
 
-                if ( cWordP >= cData->second.size() ) break;
+                if ( cWordP >= CBC_EVENT_SIZE_32 ) break;
 
-                blist.push_back ( ( cData->second[cWordP] >> ( 31 - cBitP ) ) & 0x1 );
+                blist.push_back ( ( cData[cWordP] >> ( 31 - cBitP ) ) & 0x1 );
             }
         }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
 
         return blist;
     }
@@ -397,21 +383,17 @@ namespace Ph2_HwInterface {
     uint32_t Event::GetNHits (uint8_t pFeId, uint8_t pCbcId) const
     {
         uint32_t cNHits = 0;
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
-
+        const uint32_t* cData = getCbcData ( pFeId, pCbcId );
 
-        if (cData != std::end (fEventDataMap) )
+        if ( cData != nullptr )
         {
-            cNHits += __builtin_popcount (cData->second.front() & 0x003FFFFF);
+            cNHits += __builtin_popcount (cData[0] & 0x003FFFFF);
 
-            for (auto cWord = cData->second.begin() + 1; cWord != cData->second.end() - 1;  cWord++)
-                cNHits += __builtin_popcount (*cWord);
+            for ( uint32_t cWord = 1; cWord < CBC_EVENT_SIZE_32 - 1; cWord++ )
+                cNHits += __builtin_popcount (cData[cWord]);
 
-            cNHits += __builtin_popcount (cData->second.back() & 0xFF000000);
+            cNHits += __builtin_popcount (cData[CBC_EVENT_SIZE_32 - 1] & 0xFF000000);
         }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
 
         return cNHits;
     }
@@ -420,28 +402,12 @@ namespace Ph2_HwInterface {
     std::vector<uint32_t> Event::GetHits (uint8_t pFeId, uint8_t pCbcId) const
     {
         std::vector<uint32_t> cHits;
-        uint16_t cKey = encodeId (pFeId, pCbcId);
-        EventDataMap::const_iterator cData = fEventDataMap.find (cKey);
-
-        if (cData != std::end (fEventDataMap) )
+        ForEachHit ( pFeId, pCbcId, [&cHits] ( uint32_t cChannel )
         {
-            uint8_t cIndex = 0;
-
-            for ( uint32_t i = 0; i < WIDTH_CBCDATA; ++i )
-            {
-                uint32_t pos = i + OFFSET_CBCDATA;
-                uint32_t cWordP = pos / 32;
-                uint32_t cBitP = pos % 32;
-
-                if ( cWordP >= cData->second.size() ) break;
-
-                if ( ( cData->second[cWordP] >> ( 31 - cBitP ) ) & 0x1) cHits.push_back (cIndex);
+            cHits.push_back ( cChannel );
+        } );
 
-                cIndex++;
-            }
-        }
-        else
-            LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
+        return cHits;
     }
 
     std::ostream& operator<< ( std::ostream& os, const Event& ev )
@@ -459,11 +425,11 @@ namespace Ph2_HwInterface {
         const int LINE_WIDTH = 32;
         const int LAST_LINE_WIDTH = 8;
 
-        for (auto const& cKey : ev.fEventDataMap)
+        for (auto const& cKey : ev.GetCbcKeys() )
         {
             uint8_t cFeId;
             uint8_t cCbcId;
-            ev.decodeId (cKey.first, cFeId, cCbcId);
+            ev.decodeId (cKey, cFeId, cCbcId);
 
             //for (auto& cWord : cKey.second)
             //std::cout << std::bitset<32> (cWord) << std::endl;
@@ -13,6 +13,9 @@
 #define __EVENT_H__
 
 #include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
 #include <bitset>
 #include <sstream>
 #include <cstring>
@@ -29,7 +32,51 @@ namespace Ph2_HwInterface {
 
     //using FeEventMap = std::map<uint32_t, std::pair<uint32_t, uint32_t>>; [>!< Event Map of Cbc <]
     //using EventMap = std::map<uint32_t, FeEventMap>;                      [>!< Event Map of FE <]
-    using EventDataMap = std::map<uint16_t, std::vector<uint32_t>>;
+
+    /*!
+     * \brief Hit mask of the NCHANNELS channels of one CBC
+     * Channel i is bit (31 - i % 32) of word i / 32, MSB first like the raw data stream; unused bits are 0
+     */
+    using CbcChannelMask = std::array<uint32_t, ( NCHANNELS + 31 ) / 32>;
+
+    /*!
+     * \class EventIndex
+     * \brief Fixed-stride (FE, CBC) -> word offset table, computed once per packet and shared by all Events of that packet
+     */
+    class EventIndex
+    {
+      private:
+        uint32_t fNFe;                  /*!< Number of FEs in the index */
+        uint32_t fNCbcMax;              /*!< Stride of the offset table (max CBCs on any FE) */
+        std::vector<int32_t> fOffsets;  /*!< word offset of each CBC block inside one event, -1 if absent */
+        std::vector<uint16_t> fKeys;    /*!< encoded FeId<<8|CbcId of all CBCs in data stream order */
+
+      public:
+        EventIndex() : fNFe ( 0 ), fNCbcMax ( 0 )
+        {
+        }
+        /*!
+         * \brief Build the index from the board description
+         * \param pBoard : Board the data comes from
+         * \param pEventSize : size of 1 event in 32 bit words, blocks beyond it are not indexed
+         */
+        void Set ( const BeBoard* pBoard, uint32_t pEventSize );
+        /*!
+         * \brief Get the word offset of a CBC block inside an event
+         * \return offset or -1 if the CBC is not in the data
+         */
+        int32_t GetOffset ( uint8_t pFeId, uint8_t pCbcId ) const
+        {
+            return ( pFeId < fNFe && pCbcId < fNCbcMax ) ? fOffsets[pFeId * fNCbcMax + pCbcId] : -1;
+        }
+        /*!
+         * \brief Get the keys (FeId<<8|CbcId) of all CBCs in the data, in data stream order
+         */
+        const std::vector<uint16_t>& GetKeys() const
+        {
+            return fKeys;
+        }
+    };
 
     /*!
      * \class Cluster
@@ -47,7 +94,8 @@ namespace Ph2_HwInterface {
 
     /*!
      * \class Event
-     * \brief Event container to manipulate event flux from the Cbc
+     * \brief Lightweight view on one event inside the contiguous packet buffer of a Data object
+     * The Event is only valid as long as the Data object it was obtained from is neither Reset nor Set again.
      */
     class Event
     {
@@ -65,9 +113,8 @@ namespace Ph2_HwInterface {
         uint32_t fEventCountCBC;        /*!< Cbc Event Counter */
         uint32_t fTDC;                  /*!< TDC value*/
 
-        //std::vector<uint8_t> fEventData;
-        //std::vector<uint32_t> fEventData;
-        EventDataMap fEventDataMap;
+        const uint32_t* fEventData;     /*!< first word of this event in the packet buffer */
+        const EventIndex* fIndex;       /*!< CBC layout shared by all events of the packet */
 
       public:
         // size of an event
@@ -86,14 +133,28 @@ namespace Ph2_HwInterface {
             pCbcId = pKey & 0xFF;
         }
 
+        // pointer to the CBC_EVENT_SIZE_32 words of a CBC or nullptr if it is not in the data
+        const uint32_t* getCbcData ( uint8_t pFeId, uint8_t pCbcId ) const
+        {
+            int32_t cOffset = fIndex->GetOffset ( pFeId, pCbcId );
+
+            if ( cOffset < 0 )
+            {
+                LOG (INFO) << "Event: FE " << +pFeId << " CBC " << +pCbcId << " is not found." ;
+                return nullptr;
+            }
+
+            return fEventData + cOffset;
+        }
+
       public:
         /*!
          * \brief Constructor of the Event Class
-         * \param pBoard : Board to work with
-         * \param pNbCbc
-         * \param pEventBuf : the pointer to the raw Event buffer of this Event
+         * \param pIndex : CBC layout of the packet
+         * \param pEventData : pointer to the first word of this Event in the packet buffer
+         * \param pEventSize : size of the Event in 32 bit words
          */
-        Event ( const BeBoard* pBoard, uint32_t pNbCbc, const std::vector<uint32_t>& list );
+        Event ( const EventIndex* pIndex, const uint32_t* pEventData, uint32_t pEventSize );
         /*!
          * \brief Copy Constructor of the Event Class
          */
@@ -105,18 +166,12 @@ namespace Ph2_HwInterface {
         {
         }
         /*!
-         * \brief Clear the Event Map
-         */
-        void Clear()
-        {
-            fEventDataMap.clear();
-        }
-        /*!
-         * \brief Set an Event to the Event map
-         * \param pEvent : Event to set
-         * \return Aknowledgement of the Event setting (1/0)
+         * \brief Point the Event to a new position in a packet buffer and decode the header
+         * \param pIndex : CBC layout of the packet
+         * \param pEventData : pointer to the first word of this Event in the packet buffer
+         * \param pEventSize : size of the Event in 32 bit words
          */
-        int SetEvent ( const BeBoard* pBoard, uint32_t pNbCbc, const std::vector<uint32_t>& list );
+        void SetEvent ( const EventIndex* pIndex, const uint32_t* pEventData, uint32_t pEventSize );
 
         /*! \brief Get raw data */
         //const std::vector<uint32_t>& GetEventData() const
@@ -297,6 +352,68 @@ namespace Ph2_HwInterface {
         */
         bool StubBit ( uint8_t pFeId, uint8_t pCbcId ) const;
 
+        /*!
+        * \brief Function to get the hit mask of all channels of a CBC, one word per 32 channels
+        * \param pFeId : FE Id
+        * \param pCbcId : Cbc Id
+        * \return channel mask, all 0 if the CBC is not in the data
+        */
+        CbcChannelMask ChannelMask ( uint8_t pFeId, uint8_t pCbcId ) const
+        {
+            CbcChannelMask cMask {};
+            const uint32_t* cData = getCbcData ( pFeId, pCbcId );
+
+            if ( cData == nullptr ) return cMask;
+
+            // shift the CBC block left so that channel 0 becomes the MSB of word 0
+            const uint32_t cShift = OFFSET_CBCDATA;
+
+            for ( uint32_t cWord = 0; cWord < cMask.size(); cWord++ )
+                cMask[cWord] = ( cData[cWord] << cShift ) | ( cData[cWord + 1] >> ( 32 - cShift ) );
+
+            // the last word ends with the first GLIB flag bits
+            cMask.back() &= 0xFFFFFFFF << ( 32 * cMask.size() - NCHANNELS );
+            return cMask;
+        }
+        /*!
+        * \brief Function to call pFunc ( uint32_t pChannel ) for every hit channel of a channel mask, in increasing order
+        * \param pMask : channel mask
+        * \param pFunc : callable taking the channel number
+        */
+        template<typename Func>
+        static void ForEachHit ( const CbcChannelMask& pMask, Func&& pFunc )
+        {
+            for ( uint32_t cWord = 0; cWord < pMask.size(); cWord++ )
+            {
+                for ( uint32_t cBits = pMask[cWord]; cBits != 0; )
+                {
+                    uint32_t cBit = __builtin_clz ( cBits );
+                    pFunc ( 32 * cWord + cBit );
+                    cBits &= ~ ( 0x80000000 >> cBit );
+                }
+            }
+        }
+        /*!
+        * \brief Function to call pFunc ( uint32_t pChannel ) for every hit channel of a CBC in this event, in increasing order
+        * \param pFeId : FE Id
+        * \param pCbcId : Cbc Id
+        * \param pFunc : callable taking the channel number
+        */
+        template<typename Func>
+        void ForEachHit ( uint8_t pFeId, uint8_t pCbcId, Func&& pFunc ) const
+        {
+            ForEachHit ( ChannelMask ( pFeId, pCbcId ), std::forward<Func> ( pFunc ) );
+        }
+        /*!
+        * \brief Function to get the hit of one channel from a channel mask
+        * \param pMask : channel mask
+        * \param pChannel : channel number
+        * \return true if the channel is hit
+        */
+        static bool IsHit ( const CbcChannelMask& pMask, uint32_t pChannel )
+        {
+            return pChannel < NCHANNELS && ( ( pMask[pChannel / 32] >> ( 31 - pChannel % 32 ) ) & 0x1 );
+        }
         /*!
         * \brief Function to count the Hits in this event
         * \param pFeId : FE Id
@@ -321,9 +438,12 @@ namespace Ph2_HwInterface {
          */
         unsigned char Char ( uint8_t pFeId, uint8_t pCbcId, uint32_t pBytePosition );
 
-        const EventDataMap& GetEventDataMap() const
+        /*!
+         * \brief Get the keys (FeId<<8|CbcId) of all CBCs in this Event, in data stream order
+         */
+        const std::vector<uint16_t>& GetCbcKeys() const
         {
-            return fEventDataMap;
+            return fIndex->GetKeys();
         }
 
         bool operator== (const Event& pEvent) const;
@@ -0,0 +1,496 @@
+#include "EventRing.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "easylogging++.h"
+
+namespace {
+
+    const uint32_t cRingMagic = 0x52494e47;     // "RING"
+    const uint32_t cRingVersion = 2;
+    const size_t cMaxConsumers = 16;
+    const size_t cNameSize = 32;
+    const uint32_t cSlotClaimed = 0xffffffff;   // the consumer owning the slot is still setting it up, the producer ignores it
+
+    // the producer finished or is gone
+    const uint32_t cProducerRunning = 1;
+    const uint32_t cProducerFinished = 2;
+
+    const uint32_t cFlagSwapBits = 1;
+    const uint32_t cFlagPadding = 2;            // fills the end of the ring when the next packet does not fit there
+
+    // in front of every packet, all records are multiples of its size so that a padding always has room for one
+    struct Record
+    {
+        uint64_t fSeq;
+        uint64_t fFirstEvent;
+        uint32_t fSize;                         // bytes of the record including this header
+        uint32_t fNWords32;
+        uint32_t fNevents;
+        uint32_t fFlags;
+    };
+
+    static_assert ( sizeof ( Record ) == 32, "the ring records are aligned to the size of their header" );
+    static_assert ( ATOMIC_LLONG_LOCK_FREE == 2, "the ring needs address free 64 bit atomics to share them between processes" );
+
+    uint64_t recordSize ( size_t pNWords32 )
+    {
+        uint64_t cBytes = sizeof ( Record ) + pNWords32 * sizeof ( uint32_t );
+        return ( cBytes + sizeof ( Record ) - 1 ) / sizeof ( Record ) * sizeof ( Record );
+    }
+
+    std::string shmName ( const std::string& pName )
+    {
+        return ( !pName.empty() && pName[0] == '/' ) ? pName : "/" + pName;
+    }
+
+    bool processAlive ( int32_t pPid )
+    {
+        if ( pPid <= 0 || ( kill ( pPid, 0 ) != 0 && errno != EPERM ) ) return false;
+
+        // a consumer that exited but was not reaped yet, e.g. a child of the producer, still has its pid
+        std::ifstream cStat ( "/proc/" + std::to_string ( pPid ) + "/stat" );
+        std::string cLine;
+
+        if ( !std::getline ( cStat, cLine ) ) return true;
+
+        size_t cPos = cLine.rfind ( ')' );
+        return cPos == std::string::npos || cPos + 2 >= cLine.size() || cLine[cPos + 2] != 'Z';
+    }
+}
+
+// cursor of one consumer, each on its own cache line as every consumer updates its own all the time
+struct alignas ( 64 ) EventRingSlot
+{
+    std::atomic<uint32_t> fMode;                // 0 if unused, else cSlotClaimed or an EventRingMode
+    std::atomic<int32_t> fPid;                  // owner of the slot, the slot is free if this process is not alive
+    std::atomic<uint64_t> fCursor;              // everything below was read
+    std::atomic<uint64_t> fNRead;
+    std::atomic<uint64_t> fNDropped;
+    char fName[cNameSize];
+};
+
+// start of the shared memory, the ring data follows it
+// Positions are byte counts since the creation of the ring, the data at position p is at p % fCapacity.
+struct EventRingControl
+{
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint64_t fCapacity;
+    std::atomic<uint32_t> fProducerState;
+    std::atomic<int32_t> fProducerPid;
+    alignas ( 64 ) std::atomic<uint64_t> fHead;  // end of the last published packet
+    std::atomic<uint64_t> fSeq;                 // number of the last published packet, stored before fHead
+    std::atomic<uint64_t> fTail;                // oldest packet still intact, moved before its space is overwritten
+    EventRingSlot fSlots[cMaxConsumers];
+};
+
+EventRingWriter::EventRingWriter ( const std::string& pName, size_t pCapacity ) :
+    fName ( shmName ( pName ) ),
+    fControl ( nullptr ),
+    fMapSize ( 0 ),
+    fData ( nullptr ),
+    fCapacity ( ( pCapacity + sizeof ( Record ) - 1 ) / sizeof ( Record ) * sizeof ( Record ) ),
+    fHead ( 0 ),
+    fNPackets ( 0 ),
+    fNEvents ( 0 ),
+    fNRejected ( 0 )
+{
+    // a ring left behind by a producer that crashed; its consumers keep their mapping of it
+    shm_unlink ( fName.c_str() );
+
+    int cFd = shm_open ( fName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666 );
+    fMapSize = sizeof ( EventRingControl ) + fCapacity;
+
+    if ( cFd < 0 || ftruncate ( cFd, fMapSize ) != 0 )
+    {
+        LOG (ERROR) << "EventRingWriter: Error, can not create " << fName << ": " << std::strerror ( errno ) ;
+
+        if ( cFd >= 0 )
+        {
+            ::close ( cFd );
+            shm_unlink ( fName.c_str() );
+        }
+
+        return;
+    }
+
+    void* cMap = mmap ( nullptr, fMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, cFd, 0 );
+    ::close ( cFd );
+
+    if ( cMap == MAP_FAILED )
+    {
+        LOG (ERROR) << "EventRingWriter: Error, can not map " << fName << ": " << std::strerror ( errno ) ;
+        shm_unlink ( fName.c_str() );
+        return;
+    }
+
+    // zero is a free slot for every consumer
+    fControl = new ( cMap ) EventRingControl();
+    fControl->fCapacity = fCapacity;
+    fControl->fVersion = cRingVersion;
+    fControl->fHead.store ( 0 );
+    fControl->fSeq.store ( 0 );
+    fControl->fTail.store ( 0 );
+    fControl->fProducerPid.store ( getpid() );
+    fControl->fProducerState.store ( cProducerRunning );
+    fData = reinterpret_cast<char*> ( fControl + 1 );
+
+    // written last, a reader only trusts the rest of the control block once it sees the magic
+    std::atomic_thread_fence ( std::memory_order_release );
+    fControl->fMagic = cRingMagic;
+}
+
+EventRingWriter::~EventRingWriter()
+{
+    if ( fControl == nullptr ) return;
+
+    Finish();
+    munmap ( fControl, fMapSize );
+    shm_unlink ( fName.c_str() );
+}
+
+bool EventRingWriter::Fits ( size_t pNWords32 ) const
+{
+    return recordSize ( pNWords32 ) <= fCapacity / 2;
+}
+
+bool EventRingWriter::Push ( const uint32_t* pWords, size_t pNWords32, uint32_t pNevents, bool pSwapBits, uint32_t pTimeoutMs )
+{
+    if ( fControl == nullptr ) return false;
+
+    if ( !Fits ( pNWords32 ) )
+    {
+        LOG (ERROR) << "EventRingWriter: a packet of " << pNWords32 << " words does not fit into " << fName ;
+        fNRejected++;
+        return false;
+    }
+
+    uint64_t cSize = recordSize ( pNWords32 );
+    uint64_t cRoom = fCapacity - fHead % fCapacity;
+    uint64_t cPadding = ( cRoom < cSize ) ? cRoom : 0;
+    uint64_t cEnd = fHead + cPadding + cSize;
+
+    if ( cEnd > fCapacity && !makeRoom ( cEnd - fCapacity, pTimeoutMs ) )
+    {
+        fNRejected++;
+        return false;
+    }
+
+    if ( cPadding > 0 )
+    {
+        Record* cPad = reinterpret_cast<Record*> ( fData + fHead % fCapacity );
+        std::memset ( cPad, 0, sizeof ( Record ) );
+        cPad->fSize = cPadding;
+        cPad->fFlags = cFlagPadding;
+    }
+
+    Record* cRecord = reinterpret_cast<Record*> ( fData + ( fHead + cPadding ) % fCapacity );
+    cRecord->fSeq = ++fNPackets;
+    cRecord->fFirstEvent = fNEvents;
+    cRecord->fSize = cSize;
+    cRecord->fNWords32 = pNWords32;
+    cRecord->fNevents = pNevents;
+    cRecord->fFlags = pSwapBits ? cFlagSwapBits : 0;
+    std::memcpy ( cRecord + 1, pWords, pNWords32 * sizeof ( uint32_t ) );
+
+    fNEvents += pNevents;
+    fHead = cEnd;
+    fControl->fSeq.store ( fNPackets, std::memory_order_relaxed );
+    fControl->fHead.store ( fHead, std::memory_order_release );
+    return true;
+}
+
+bool EventRingWriter::makeRoom ( uint64_t pLimit, uint32_t pTimeoutMs )
+{
+    auto cDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds ( pTimeoutMs );
+
+    while ( true )
+    {
+        bool cBlocked = false;
+
+        for ( auto& cSlot : fControl->fSlots )
+        {
+            if ( cSlot.fMode.load ( std::memory_order_acquire ) != static_cast<uint32_t> ( EventRingMode::Lossless ) ) continue;
+
+            if ( cSlot.fCursor.load ( std::memory_order_acquire ) >= pLimit ) continue;
+
+            // a lossless consumer that crashed would stop the readout for good; its slot is left to the next
+            // consumer, which takes it over through the pid, so that the producer never writes a slot it does not own
+            int32_t cPid = cSlot.fPid.load();
+
+            if ( !processAlive ( cPid ) )
+            {
+                if ( cPid != 0 && cSlot.fPid.compare_exchange_strong ( cPid, 0 ) )
+                    LOG (WARNING) << "EventRingWriter: consumer " << cSlot.fName << " of " << fName << " is gone, releasing it" ;
+
+                continue;
+            }
+
+            cBlocked = true;
+        }
+
+        if ( !cBlocked ) break;
+
+        if ( std::chrono::steady_clock::now() >= cDeadline ) return false;
+
+        std::this_thread::sleep_for ( std::chrono::microseconds ( 100 ) );
+    }
+
+    // the packets below pLimit are given up: the tail moves past them before their space is written, so that a
+    // consumer looking at one of them sees the tail beyond it once it is done, see EventRingReader::Release
+    uint64_t cTail = fControl->fTail.load ( std::memory_order_relaxed );
+
+    while ( cTail < pLimit )
+        cTail += reinterpret_cast<const Record*> ( fData + cTail % fCapacity )->fSize;
+
+    fControl->fTail.store ( cTail, std::memory_order_relaxed );
+    std::atomic_thread_fence ( std::memory_order_release );
+    return true;
+}
+
+void EventRingWriter::Finish()
+{
+    if ( fControl ) fControl->fProducerState.store ( cProducerFinished, std::memory_order_release );
+}
+
+std::string EventRingWriter::ConsumerStatus() const
+{
+    std::ostringstream cStream;
+
+    if ( fControl == nullptr ) return "";
+
+    for ( auto& cSlot : fControl->fSlots )
+    {
+        uint32_t cMode = cSlot.fMode.load ( std::memory_order_acquire );
+
+        if ( cMode == 0 || cMode == cSlotClaimed || cSlot.fPid.load() == 0 ) continue;
+
+        uint64_t cCursor = cSlot.fCursor.load ( std::memory_order_relaxed );
+
+        cStream << "\n    " << cSlot.fName << " (pid " << cSlot.fPid.load() << ", "
+                << ( cMode == static_cast<uint32_t> ( EventRingMode::Lossless ) ? "lossless" : "drop oldest" ) << "): "
+                << cSlot.fNRead.load ( std::memory_order_relaxed ) << " packets read, "
+                << cSlot.fNDropped.load ( std::memory_order_relaxed ) << " dropped, "
+                << ( ( fHead > cCursor ) ? fHead - cCursor : 0 ) / 1024 << " kB behind";
+    }
+
+    return cStream.str();
+}
+
+EventRingReader::EventRingReader ( const std::string& pName, EventRingMode pMode, const std::string& pConsumerName ) :
+    fName ( shmName ( pName ) ),
+    fControl ( nullptr ),
+    fMapSize ( 0 ),
+    fData ( nullptr ),
+    fCapacity ( 0 ),
+    fSlot ( -1 ),
+    fCursor ( 0 ),
+    fHeldSize ( 0 ),
+    fNextSeq ( 0 ),
+    fNRead ( 0 ),
+    fNDropped ( 0 ),
+    fEndOfStream ( false )
+{
+    // read-write, the cursor of this consumer lives in the ring
+    int cFd = shm_open ( fName.c_str(), O_RDWR, 0 );
+    struct stat cStat;
+
+    if ( cFd < 0 || fstat ( cFd, &cStat ) != 0 || size_t ( cStat.st_size ) < sizeof ( EventRingControl ) )
+    {
+        LOG (ERROR) << "EventRingReader: Error, can not open " << fName << ": " << std::strerror ( errno ) ;
+
+        if ( cFd >= 0 ) ::close ( cFd );
+
+        return;
+    }
+
+    fMapSize = cStat.st_size;
+    void* cMap = mmap ( nullptr, fMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, cFd, 0 );
+    ::close ( cFd );
+
+    if ( cMap == MAP_FAILED )
+    {
+        LOG (ERROR) << "EventRingReader: Error, can not map " << fName << ": " << std::strerror ( errno ) ;
+        return;
+    }
+
+    fControl = static_cast<EventRingControl*> ( cMap );
+    uint32_t cMagic = fControl->fMagic;
+    std::atomic_thread_fence ( std::memory_order_acquire );
+
+    if ( cMagic != cRingMagic || fControl->fVersion != cRingVersion || sizeof ( EventRingControl ) + fControl->fCapacity != fMapSize )
+    {
+        LOG (ERROR) << "EventRingReader: Error, " << fName << " is not an event ring of version " << cRingVersion ;
+        munmap ( fControl, fMapSize );
+        fControl = nullptr;
+        return;
+    }
+
+    fCapacity = fControl->fCapacity;
+    fData = reinterpret_cast<const char*> ( fControl + 1 );
+
+    for ( size_t cIndex = 0; cIndex < cMaxConsumers && fSlot < 0; cIndex++ )
+    {
+        EventRingSlot& cSlot = fControl->fSlots[cIndex];
+        int32_t cPid = cSlot.fPid.load();
+
+        // the pid claims the slot, so the one of a consumer that crashed is taken over even if it crashed while
+        // setting it up
+        if ( processAlive ( cPid ) ) continue;
+
+        if ( cSlot.fPid.compare_exchange_strong ( cPid, getpid() ) ) fSlot = cIndex;
+    }
+
+    if ( fSlot < 0 )
+    {
+        LOG (ERROR) << "EventRingReader: Error, " << fName << " has no free consumer slot" ;
+        munmap ( fControl, fMapSize );
+        fControl = nullptr;
+        return;
+    }
+
+    EventRingSlot& cSlot = fControl->fSlots[fSlot];
+    cSlot.fMode.store ( cSlotClaimed );
+    std::strncpy ( cSlot.fName, pConsumerName.c_str(), cNameSize - 1 );
+    cSlot.fName[cNameSize - 1] = '\0';
+    cSlot.fNRead.store ( 0 );
+    cSlot.fNDropped.store ( 0 );
+
+    // start with the next packet; a packet published meanwhile is read as well, or detected as overwritten
+    // The number is read after the position, it is the one of the packet there or a later one, so that only
+    // packets lost after the attach are counted as dropped.
+    fCursor = fControl->fHead.load ( std::memory_order_acquire );
+    fNextSeq = fControl->fSeq.load ( std::memory_order_relaxed ) + 1;
+    cSlot.fCursor.store ( fCursor );
+    cSlot.fMode.store ( static_cast<uint32_t> ( pMode ) );
+}
+
+EventRingReader::~EventRingReader()
+{
+    if ( fControl == nullptr ) return;
+
+    // the mode first, a slot without mode but with a live pid is left alone by the other consumers
+    fControl->fSlots[fSlot].fMode.store ( 0, std::memory_order_release );
+    fControl->fSlots[fSlot].fPid.store ( 0, std::memory_order_release );
+    munmap ( fControl, fMapSize );
+}
+
+bool EventRingReader::Next ( EventRingPacket& pPacket, uint32_t pTimeoutMs )
+{
+    if ( fControl == nullptr ) return false;
+
+    if ( fHeldSize > 0 ) Release();
+
+    auto cDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds ( pTimeoutMs );
+
+    while ( true )
+    {
+        if ( fCursor == fControl->fHead.load ( std::memory_order_acquire ) )
+        {
+            bool cTimeout = std::chrono::steady_clock::now() >= cDeadline;
+
+            // a producer that crashed never finishes, it is looked for only when the wait is over
+            if ( fControl->fProducerState.load ( std::memory_order_acquire ) == cProducerFinished
+                    || ( cTimeout && !processAlive ( fControl->fProducerPid.load() ) ) )
+            {
+                // the last packet may have been published right before the end was marked
+                if ( fCursor == fControl->fHead.load ( std::memory_order_acquire ) )
+                {
+                    fEndOfStream = true;
+                    return false;
+                }
+
+                continue;
+            }
+
+            if ( cTimeout ) return false;
+
+            std::this_thread::sleep_for ( std::chrono::microseconds ( 100 ) );
+            continue;
+        }
+
+        // fell behind a producer that does not wait, continue at the oldest packet still there
+        uint64_t cTail = fControl->fTail.load ( std::memory_order_acquire );
+
+        if ( fCursor < cTail ) fCursor = cTail;
+
+        Record cRecord = *reinterpret_cast<const Record*> ( fData + fCursor % fCapacity );
+        std::atomic_thread_fence ( std::memory_order_acquire );
+
+        // the header may be torn if it was overwritten while it was copied
+        if ( fControl->fTail.load ( std::memory_order_relaxed ) > fCursor ) continue;
+
+        if ( cRecord.fFlags & cFlagPadding )
+        {
+            fCursor += cRecord.fSize;
+            publishCursor();
+            continue;
+        }
+
+        if ( cRecord.fSeq > fNextSeq ) fNDropped += cRecord.fSeq - fNextSeq;
+
+        fNextSeq = cRecord.fSeq + 1;
+        fHeldSize = cRecord.fSize;
+
+        pPacket.fWords = reinterpret_cast<const uint32_t*> ( fData + fCursor % fCapacity + sizeof ( Record ) );
+        pPacket.fNWords32 = cRecord.fNWords32;
+        pPacket.fNevents = cRecord.fNevents;
+        pPacket.fSwapBits = cRecord.fFlags & cFlagSwapBits;
+        pPacket.fFirstEvent = cRecord.fFirstEvent;
+        pPacket.fSeq = cRecord.fSeq;
+        return true;
+    }
+}
+
+bool EventRingReader::Release()
+{
+    if ( fHeldSize == 0 ) return false;
+
+    // everything read from the packet is ordered before this check of the tail
+    std::atomic_thread_fence ( std::memory_order_acquire );
+    bool cValid = fControl->fTail.load ( std::memory_order_relaxed ) <= fCursor;
+
+    fCursor += fHeldSize;
+    fHeldSize = 0;
+
+    if ( cValid ) fNRead++;
+    else fNDropped++;
+
+    publishCursor();
+    return cValid;
+}
+
+bool EventRingReader::Read ( std::vector<uint32_t>& pBuffer, EventRingPacket& pPacket, uint32_t pTimeoutMs )
+{
+    while ( Next ( pPacket, pTimeoutMs ) )
+    {
+        pBuffer.assign ( pPacket.fWords, pPacket.fWords + pPacket.fNWords32 );
+
+        if ( Release() )
+        {
+            pPacket.fWords = pBuffer.data();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void EventRingReader::publishCursor()
+{
+    EventRingSlot& cSlot = fControl->fSlots[fSlot];
+    cSlot.fNRead.store ( fNRead, std::memory_order_relaxed );
+    cSlot.fNDropped.store ( fNDropped, std::memory_order_relaxed );
+    cSlot.fCursor.store ( fCursor, std::memory_order_release );
+}
@@ -0,0 +1,199 @@
+/*!
+
+        \file                   EventRing.h
+        \brief                  Ring of raw packets in POSIX shared memory, written by the readout and read by other processes
+        \version                1.0
+
+ */
+
+#ifndef __EVENTRING_H__
+#define __EVENTRING_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct EventRingControl;
+
+/*!
+ * \brief How a consumer keeps up with the producer
+ */
+enum class EventRingMode : uint32_t
+{
+    Lossless = 1,       /*!< the producer waits for this consumer before it overwrites a packet it has not read, e.g. a file writer */
+    DropOldest = 2      /*!< the producer never waits, a consumer that falls behind loses the oldest packets, e.g. a DQM */
+};
+
+/*!
+ * \struct EventRingPacket
+ * \brief One packet of the ring, fWords points into the shared memory or into the buffer given to EventRingReader::Read
+ */
+struct EventRingPacket
+{
+    const uint32_t* fWords = nullptr;
+    size_t fNWords32 = 0;
+    uint32_t fNevents = 0;
+    bool fSwapBits = false;         /*!< the CBC data needs the Imperial FW bit reversal, see Data::Set */
+    uint64_t fFirstEvent = 0;       /*!< index of the first event of the packet since the ring was created */
+    uint64_t fSeq = 0;              /*!< number of the packet since the ring was created, from 1 */
+};
+
+/*!
+ * \class EventRingWriter
+ * \brief Creates the ring /pName and publishes packets into it, one producer per ring
+ * The packets are stored back to back with a small header and never split at the end of the ring, so that a
+ * consumer always sees a packet as contiguous words. Each consumer has its own read cursor in the shared memory.
+ */
+class EventRingWriter
+{
+  public:
+    /*!
+     * \brief create the ring, a stale one of the same name is replaced; check isOpen() afterwards
+     * \param pName : name of the shared memory object, "/" is prepended if missing
+     * \param pCapacity : bytes of packet data the ring holds, a packet can take at most half of it
+     */
+    EventRingWriter ( const std::string& pName, size_t pCapacity );
+    /*!
+     * \brief mark the end of the stream and remove the name, the consumers still attached keep their mapping
+     */
+    ~EventRingWriter();
+
+    EventRingWriter ( const EventRingWriter& ) = delete;
+    EventRingWriter& operator= ( const EventRingWriter& ) = delete;
+
+    bool isOpen() const
+    {
+        return fControl != nullptr;
+    }
+    const std::string& getName() const
+    {
+        return fName;
+    }
+    /*!
+     * \brief can a packet of pNWords32 words ever be published?
+     */
+    bool Fits ( size_t pNWords32 ) const;
+    /*!
+     * \brief publish a copy of a packet
+     * \param pTimeoutMs : maximum time to wait for the lossless consumers to make room
+     * \return false if the packet does not fit or a lossless consumer did not make room in time, nothing is published then
+     */
+    bool Push ( const uint32_t* pWords, size_t pNWords32, uint32_t pNevents, bool pSwapBits, uint32_t pTimeoutMs );
+    /*!
+     * \brief end of the stream, the consumers stop once they have read the packets still in the ring
+     */
+    void Finish();
+
+    uint64_t GetNPackets() const
+    {
+        return fNPackets;
+    }
+    /*!
+     * \brief calls of Push that published nothing, a retried packet is counted once per attempt
+     */
+    uint64_t GetNRejected() const
+    {
+        return fNRejected;
+    }
+    /*!
+     * \brief One line per attached consumer with its packets read and dropped and how far it is behind, for the log
+     */
+    std::string ConsumerStatus() const;
+
+  private:
+    std::string fName;
+    EventRingControl* fControl;     /*!< start of the mapping */
+    size_t fMapSize;
+    char* fData;                    /*!< first byte of the ring */
+    uint64_t fCapacity;
+    uint64_t fHead;                 /*!< copy of the published write position, only this process writes it */
+    uint64_t fNPackets;
+    uint64_t fNEvents;
+    uint64_t fNRejected;
+
+    /*!
+     * \brief wait until no lossless consumer needs the data below pLimit, then move the tail past it
+     */
+    bool makeRoom ( uint64_t pLimit, uint32_t pTimeoutMs );
+};
+
+/*!
+ * \class EventRingReader
+ * \brief Attaches to the ring /pName as one consumer, starting at the next packet published
+ * Next gives a view into the shared memory without copying; with DropOldest the producer may overwrite the packet
+ * while it is looked at, which Release reports, so a consumer only trusts what it computed once Release returned true.
+ */
+class EventRingReader
+{
+  public:
+    /*!
+     * \brief attach to the ring; check isOpen() afterwards
+     * \param pName : name of the shared memory object, "/" is prepended if missing
+     * \param pConsumerName : shown to the producer side in the status of the consumers
+     */
+    EventRingReader ( const std::string& pName, EventRingMode pMode, const std::string& pConsumerName = "" );
+    /*!
+     * \brief detach, a lossless consumer no longer holds the producer back
+     */
+    ~EventRingReader();
+
+    EventRingReader ( const EventRingReader& ) = delete;
+    EventRingReader& operator= ( const EventRingReader& ) = delete;
+
+    bool isOpen() const
+    {
+        return fSlot >= 0;
+    }
+    /*!
+     * \brief view the next packet, it stays in place until Release
+     * \param pTimeoutMs : maximum time to wait for a packet
+     * \return false if no packet arrived in time or the stream ended, see EndOfStream
+     */
+    bool Next ( EventRingPacket& pPacket, uint32_t pTimeoutMs );
+    /*!
+     * \brief done with the packet of Next, its space may be reused
+     * \return false if the packet was overwritten while it was looked at, its content can not be trusted then
+     */
+    bool Release();
+    /*!
+     * \brief copy the next packet into pBuffer, packets overwritten during the copy are skipped
+     */
+    bool Read ( std::vector<uint32_t>& pBuffer, EventRingPacket& pPacket, uint32_t pTimeoutMs );
+    /*!
+     * \brief the producer finished or died and all its packets were read
+     */
+    bool EndOfStream() const
+    {
+        return fEndOfStream;
+    }
+    uint64_t GetNRead() const
+    {
+        return fNRead;
+    }
+    /*!
+     * \brief packets lost because the producer overwrote them, always 0 for a lossless consumer
+     */
+    uint64_t GetNDropped() const
+    {
+        return fNDropped;
+    }
+
+  private:
+    std::string fName;
+    EventRingControl* fControl;
+    size_t fMapSize;
+    const char* fData;
+    uint64_t fCapacity;
+    int fSlot;                      /*!< index of the consumer slot, -1 if not attached */
+    uint64_t fCursor;               /*!< position of the next packet, or of the one held */
+    uint32_t fHeldSize;             /*!< bytes of the packet held since Next, 0 if none */
+    uint64_t fNextSeq;              /*!< number of the packet expected next, the ones skipped are dropped */
+    uint64_t fNRead;
+    uint64_t fNDropped;
+    bool fEndOfStream;
+
+    void publishCursor();
+};
+
+#endif
@@ -1,19 +1,32 @@
 #include "FileHandler.h"
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 //Constructor
 FileHandler::FileHandler ( const std::string& pBinaryFileName, char pOption ) :
     fBinaryFileName ( pBinaryFileName ),
     fOption ( pOption ),
     fFileIsOpened ( false ) ,
-    is_set ( false )
+    is_set ( false ),
+    fFd ( -1 ),
+    fDirectIORequested ( false ),
+    fDirectIO ( false ),
+    fFileOffset ( 0 ),
+    fSyncPolicy ( SyncPolicy::OnClose ),
+    fMaxQueuedBytes ( 256 << 20 ),
+    fWriteBuffer ( nullptr ),
+    fWriteBufferFill ( 0 ),
+    fWriteError ( false ),
+    fQueuedBytes ( 0 ),
+    fStopWriter ( false ),
+    fIndexSorted ( true )
 {
     openFile();
-
-    if ( fOption == 'w' )
-    {
-        fThread = std::thread ( &FileHandler::writeFile, this );
-        fThread.detach();
-    }
 }
 
 FileHandler::FileHandler ( const std::string& pBinaryFileName, char pOption, FileHeader pHeader ) :
@@ -21,35 +34,236 @@ FileHandler::FileHandler ( const std::string& pBinaryFileName, char pOption, Fil
     fOption ( pOption ),
     fFileIsOpened ( false ) ,
     is_set ( false ),
-    fHeader ( pHeader )
+    fHeader ( pHeader ),
+    fFd ( -1 ),
+    fDirectIORequested ( false ),
+    fDirectIO ( false ),
+    fFileOffset ( 0 ),
+    fSyncPolicy ( SyncPolicy::OnClose ),
+    fMaxQueuedBytes ( 256 << 20 ),
+    fWriteBuffer ( nullptr ),
+    fWriteBufferFill ( 0 ),
+    fWriteError ( false ),
+    fQueuedBytes ( 0 ),
+    fStopWriter ( false ),
+    fIndexSorted ( true )
 {
     openFile();
-
-    if ( fOption == 'w' )
-    {
-        fThread = std::thread ( &FileHandler::writeFile, this );
-        fThread.detach();
-    }
 }
 
 //destructor
 FileHandler::~FileHandler()
 {
-    if (fOption == 'w' && fThread.joinable() )
-        fThread.join();
-
     closeFile();
 }
 
-void FileHandler::set ( std::vector<uint32_t> pVector )
+void FileHandler::set ( const std::vector<uint32_t>& pVector )
 {
-    fMutex.lock();
-    fData.clear();
-    fData = pVector;
+    fData.assign ( pVector.begin(), pVector.end() );
     is_set = true;
+}
 
+void FileHandler::writeFile()
+{
     if ( is_set )
-        fMutex.unlock();
+    {
+        write ( std::move ( fData ) );
+        fData = takeFreeBuffer();
+        is_set = false;
+    }
+}
+
+void FileHandler::write ( const std::vector<uint32_t>& pData )
+{
+    std::vector<uint32_t> cCopy = takeFreeBuffer();
+    cCopy.assign ( pData.begin(), pData.end() );
+    write ( std::move ( cCopy ) );
+}
+
+void FileHandler::write ( std::vector<uint32_t>&& pData )
+{
+    if ( fOption != 'w' || !file_open() || pData.empty() ) return;
+
+    size_t cBytes = pData.size() * sizeof ( uint32_t );
+    std::unique_lock<std::mutex> cLock ( fQueueMutex );
+
+    // back-pressure: only wait if the disk fell behind by more than fMaxQueuedBytes, a single large packet always gets through
+    if ( !fQueue.empty() && fQueuedBytes + cBytes > fMaxQueuedBytes )
+    {
+        fStatistics.fNBackpressureWaits++;
+        fQueueNotFull.wait ( cLock, [&]
+        {
+            return fQueue.empty() || fQueuedBytes + cBytes <= fMaxQueuedBytes;
+        } );
+    }
+
+    fQueue.push_back ( std::move ( pData ) );
+    fQueuedBytes += cBytes;
+    fStatistics.fNPackets++;
+    fStatistics.fBytesQueued += cBytes;
+    cLock.unlock();
+    fQueueNotEmpty.notify_one();
+}
+
+std::vector<uint32_t> FileHandler::takeFreeBuffer()
+{
+    std::vector<uint32_t> cBuffer;
+    std::lock_guard<std::mutex> cLock ( fQueueMutex );
+
+    if ( !fFreeBuffers.empty() )
+    {
+        cBuffer.swap ( fFreeBuffers.back() );
+        fFreeBuffers.pop_back();
+    }
+
+    return cBuffer;
+}
+
+void FileHandler::applyDirectIO ( bool pDirectIO )
+{
+    int cFlags = fcntl ( fFd, F_GETFL );
+
+    if ( cFlags < 0 || fcntl ( fFd, F_SETFL, pDirectIO ? ( cFlags | O_DIRECT ) : ( cFlags & ~O_DIRECT ) ) < 0 )
+    {
+        LOG (INFO) << "FileHandler: Warning - O_DIRECT not supported for " << fBinaryFileName << ", writing through the page cache" ;
+        fDirectIORequested = false;
+        fDirectIO = false;
+    }
+    else fDirectIO = pDirectIO;
+}
+
+FileWriterStatistics FileHandler::getWriterStatistics()
+{
+    std::lock_guard<std::mutex> cLock ( fQueueMutex );
+    return fStatistics;
+}
+
+void FileHandler::writerLoop()
+{
+    std::vector<uint32_t> cPacket;
+
+    while ( true )
+    {
+        {
+            std::unique_lock<std::mutex> cLock ( fQueueMutex );
+
+            // keep the last storage for reuse by the producer, bounded so a burst does not pin memory
+            if ( cPacket.capacity() > 0 && fFreeBuffers.size() < 8 )
+            {
+                cPacket.clear();
+                fFreeBuffers.push_back ( std::move ( cPacket ) );
+            }
+
+            cPacket = std::vector<uint32_t>();
+
+            // a slow run should still reach the file regularly, for the DQM reading its tail
+            while ( fQueue.empty() && !fStopWriter )
+            {
+                if ( fQueueNotEmpty.wait_for ( cLock, std::chrono::milliseconds ( 500 ) ) == std::cv_status::timeout && fQueue.empty() && fWriteBufferFill > 0 )
+                {
+                    cLock.unlock();
+                    flushBuffer ( false );
+                    cLock.lock();
+                }
+            }
+
+            if ( fQueue.empty() ) break;
+
+            cPacket.swap ( fQueue.front() );
+            fQueue.pop_front();
+            fQueuedBytes -= cPacket.size() * sizeof ( uint32_t );
+        }
+
+        fQueueNotFull.notify_all();
+        appendToBuffer ( reinterpret_cast<const char*> ( cPacket.data() ), cPacket.size() * sizeof ( uint32_t ) );
+    }
+
+    flushBuffer ( true );
+
+    if ( fSyncPolicy != SyncPolicy::None && fFd >= 0 )
+        fdatasync ( fFd );
+}
+
+void FileHandler::appendToBuffer ( const char* pData, size_t pBytes )
+{
+    while ( pBytes > 0 )
+    {
+        size_t cFree = fWriteBufferSize - fWriteBufferFill;
+        size_t cChunk = ( pBytes < cFree ) ? pBytes : cFree;
+        std::memcpy ( fWriteBuffer + fWriteBufferFill, pData, cChunk );
+        fWriteBufferFill += cChunk;
+        pData += cChunk;
+        pBytes -= cChunk;
+
+        if ( fWriteBufferFill == fWriteBufferSize ) flushBuffer ( false );
+    }
+}
+
+void FileHandler::flushBuffer ( bool pFinal )
+{
+    size_t cAlignment = fWriteAlignment;
+
+    // O_DIRECT only accepts whole aligned blocks at aligned offsets, the tail of the file is written without it
+    bool cDirectIO = fDirectIORequested && !pFinal;
+
+    if ( cDirectIO != fDirectIO && ( !cDirectIO || fFileOffset % cAlignment == 0 ) ) applyDirectIO ( cDirectIO );
+
+    size_t cBytes = fDirectIO ? fWriteBufferFill - fWriteBufferFill % cAlignment : fWriteBufferFill;
+
+    if ( cBytes == 0 ) return;
+
+    auto cStart = std::chrono::steady_clock::now();
+    size_t cWritten = 0;
+    uint64_t cNWrites = 0;
+
+    while ( cWritten < cBytes && !fWriteError )
+    {
+        ssize_t cResult = ::write ( fFd, fWriteBuffer + cWritten, cBytes - cWritten );
+        cNWrites++;
+
+        if ( cResult < 0 )
+        {
+            if ( errno == EINTR ) continue;
+
+            LOG (ERROR) << "FileHandler: Error writing to " << fBinaryFileName << ": " << std::strerror ( errno ) << " - further data is dropped!" ;
+            fWriteError = true;
+        }
+        else cWritten += cResult;
+    }
+
+    fFileOffset += cWritten;
+
+    if ( fSyncPolicy == SyncPolicy::EveryBuffer && !fWriteError ) fdatasync ( fFd );
+
+    double cSeconds = std::chrono::duration<double> ( std::chrono::steady_clock::now() - cStart ).count();
+
+    // a failed write drops the whole buffer, otherwise keep the unaligned remainder for the next write
+    size_t cConsumed = fWriteError ? fWriteBufferFill : cBytes;
+    std::memmove ( fWriteBuffer, fWriteBuffer + cConsumed, fWriteBufferFill - cConsumed );
+    fWriteBufferFill -= cConsumed;
+
+    std::lock_guard<std::mutex> cLock ( fQueueMutex );
+    fStatistics.fBytesWritten += cWritten;
+    fStatistics.fNWrites += cNWrites;
+    fStatistics.fWriteSeconds += cSeconds;
+}
+
+void FileHandler::stopWriter()
+{
+    if ( !fThread.joinable() ) return;
+
+    {
+        std::lock_guard<std::mutex> cLock ( fQueueMutex );
+        fStopWriter = true;
+    }
+
+    fQueueNotEmpty.notify_one();
+    fThread.join();
+    fStopWriter = false;
+
+    FileWriterStatistics cStat = getWriterStatistics();
+    LOG (INFO) << "FileHandler: wrote " << cStat.fBytesWritten / 1e6 << " MB in " << cStat.fNPackets << " packets to " << fBinaryFileName
+               << " (" << cStat.WriteMBps() << " MB/s, " << cStat.fNWrites << " writes, " << cStat.fNBackpressureWaits << " back-pressure waits)" ;
 }
 
 bool FileHandler::openFile( )
@@ -61,7 +275,31 @@ bool FileHandler::openFile( )
 
         if ( fOption == 'w' )
         {
-            fBinaryFile.open ( ( getFilename() ).c_str(), std::fstream::trunc | std::fstream::out | std::fstream::binary );
+            fFd = ::open ( getFilename().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+            if ( fFd < 0 )
+            {
+                LOG (ERROR) << "FileHandler: Error, can not open " << fBinaryFileName << " for writing: " << std::strerror ( errno ) ;
+                fMutex.unlock();
+                return false;
+            }
+
+            void* cBuffer = nullptr;
+
+            if ( posix_memalign ( &cBuffer, fWriteAlignment, fWriteBufferSize ) != 0 )
+            {
+                LOG (ERROR) << "FileHandler: Error, can not allocate the write buffer for " << fBinaryFileName ;
+                ::close ( fFd );
+                fFd = -1;
+                fMutex.unlock();
+                return false;
+            }
+
+            fWriteBuffer = static_cast<char*> ( cBuffer );
+            fWriteBufferFill = 0;
+            fWriteError = false;
+            fDirectIO = false;
+            fFileOffset = 0;
 
             // if the header is null or not valid, continue without and delete the header
             if ( fHeader.fValid == false )
@@ -70,10 +308,10 @@ bool FileHandler::openFile( )
             else if ( fHeader.fValid)
             {
                 std::vector<uint32_t> cHeaderVec = fHeader.encodeHeader();
-                uint32_t cBuffer[cHeaderVec.size()];
-                std::copy ( cHeaderVec.begin(), cHeaderVec.end(), cBuffer );
-                fBinaryFile.write ( ( char* ) &cBuffer, sizeof ( cBuffer ) );
+                appendToBuffer ( reinterpret_cast<const char*> ( cHeaderVec.data() ), cHeaderVec.size() * sizeof ( uint32_t ) );
             }
+
+            fThread = std::thread ( &FileHandler::writerLoop, this );
         }
 
         else if ( fOption == 'r' )
@@ -85,7 +323,7 @@ bool FileHandler::openFile( )
             // if yes, everything cool
 
             //now I can try to decode the header and check if it is valid
-            fHeader.decodeHeader ( this->readFileChunks (fHeader.fHeaderSize32) );
+            fHeader.decodeHeader ( this->readWords (fHeader.fHeaderSize32) );
 
             // if the header is not valid, return to the beginning of the fiel
             // and treat it as normal data
@@ -112,27 +350,27 @@ void FileHandler::closeFile()
 
     if (fFileIsOpened)
     {
-        fBinaryFile.close();
+        if ( fOption == 'w' )
+        {
+            // everything queued so far still goes to the file
+            stopWriter();
+            ::close ( fFd );
+            fFd = -1;
+            free ( fWriteBuffer );
+            fWriteBuffer = nullptr;
+        }
+        else fBinaryFile.close();
+
         fFileIsOpened = false;
     }
 
     fMutex.unlock();
 }
 
-//read from raw file to vector
+//read the remaining words of the raw file into a vector with a single read
 std::vector<uint32_t> FileHandler::readFile( )
 {
-    std::vector<uint32_t> cVector;
-
-    //open file for reading
-    while ( !fBinaryFile.eof() )
-    {
-        char buffer[4];
-        fBinaryFile.read ( buffer, 4 );
-        uint32_t word;
-        std::memcpy ( &word, buffer, 4 );
-        cVector.push_back ( word );
-    }
+    std::vector<uint32_t> cVector = readWords ( remainingWords() );
 
     closeFile();
     return cVector;
@@ -141,75 +379,177 @@ std::vector<uint32_t> FileHandler::readFile( )
 //read from raw file to vector in chunks of pNWords32 32-bit words
 std::vector<uint32_t> FileHandler::readFileChunks ( uint32_t pNWords32 )
 {
-    std::vector<uint32_t> cVector;
-    uint32_t cWordCounter = 0;
-
-    //open file for reading
-    while (!fBinaryFile.eof() && cWordCounter < pNWords32)
-    {
-        char buffer[4];
-        fBinaryFile.read ( buffer, 4 );
-        uint32_t word;
-        std::memcpy ( &word, buffer, 4 );
-        cVector.push_back ( word );
-        cWordCounter++;
-    }
+    std::vector<uint32_t> cVector = readWords ( pNWords32 );
 
     if (fBinaryFile.eof() )
         closeFile();
 
-    if (cWordCounter < pNWords32) LOG (INFO) << "FileHandler: Attention, input file " << fBinaryFileName << " ended before reading " << pNWords32 << " 32-bit words!" ;
+    if (cVector.size() < pNWords32) LOG (INFO) << "FileHandler: Attention, input file " << fBinaryFileName << " ended before reading " << pNWords32 << " 32-bit words!" ;
 
     return cVector;
 }
 
 std::vector<uint32_t> FileHandler::readFileTail ( long pNbytes )
 {
-    // if pNbytes > -1 read only the last pNbytes words
+    // if pNbytes > -1 read only the last pNbytes bytes
     if (pNbytes > -1)
     {
-        fBinaryFile.seekp (0, std::ios::end); // go to the end of the file
-        fBinaryFile.seekp (-pNbytes, std::ios::cur); // back up n bytes
+        fBinaryFile.clear();
+        fBinaryFile.seekg (0, std::ios::end); // go to the end of the file
+        long cFileSize = fBinaryFile.tellg();
+        fBinaryFile.seekg ( ( pNbytes < cFileSize ) ? cFileSize - pNbytes : 0, std::ios::beg ); // back up n bytes
     }
 
-    std::vector<uint32_t> cVector;
-
-    //open file for reading
-    while ( !fBinaryFile.eof() )
-    {
-        char buffer[4];
-        fBinaryFile.read ( buffer, 4 );
-        uint32_t word;
-        std::memcpy ( &word, buffer, 4 );
-        cVector.push_back ( word );
-    }
+    std::vector<uint32_t> cVector = readWords ( remainingWords() );
 
     closeFile();
     return cVector;
 }
 
-void FileHandler::writeFile()
+std::vector<uint32_t> FileHandler::readWords ( size_t pNWords32 )
 {
-    //while ( true ) {
-    if ( is_set )
+    std::vector<uint32_t> cVector ( pNWords32 );
+
+    fBinaryFile.read ( reinterpret_cast<char*> ( cVector.data() ), pNWords32 * sizeof ( uint32_t ) );
+    cVector.resize ( fBinaryFile.gcount() / sizeof ( uint32_t ) );
+
+    return cVector;
+}
+
+size_t FileHandler::remainingWords()
+{
+    std::streampos cPos = fBinaryFile.tellg();
+
+    if ( cPos < 0 ) return 0;
+
+    fBinaryFile.seekg ( 0, std::ios::end );
+    std::streampos cEnd = fBinaryFile.tellg();
+    fBinaryFile.seekg ( cPos );
+
+    // ask for one word more, so that the read runs into the end of the file like the chunked reads do
+    return ( cEnd - cPos ) / sizeof ( uint32_t ) + 1;
+}
+
+uint64_t FileHandler::eventCount()
+{
+    struct stat cStat;
+
+    if ( fHeader.fEventSize32 == 0 || stat ( fBinaryFileName.c_str(), &cStat ) != 0 || uint64_t ( cStat.st_size ) < dataOffset() )
+        return 0;
+
+    return ( cStat.st_size - dataOffset() ) / ( fHeader.fEventSize32 * sizeof ( uint32_t ) );
+}
+
+bool FileHandler::seekEvent ( uint64_t pEvent )
+{
+    if ( fOption != 'r' ) return false;
+
+    // a previous read may have hit the end of the file and closed it
+    if ( !file_open() ) openFile();
+
+    if ( pEvent > eventCount() ) return false;
+
+    fBinaryFile.clear();
+    fBinaryFile.seekg ( dataOffset() + pEvent * fHeader.fEventSize32 * sizeof ( uint32_t ), std::ios::beg );
+    return fBinaryFile.good();
+}
+
+std::vector<uint32_t> FileHandler::readEvents ( uint64_t pFirst, uint32_t pCount )
+{
+    uint64_t cNEvents = eventCount();
+
+    if ( pFirst >= cNEvents || !seekEvent ( pFirst ) ) return std::vector<uint32_t>();
+
+    uint64_t cCount = std::min<uint64_t> ( pCount, cNEvents - pFirst );
+    return readWords ( cCount * fHeader.fEventSize32 );
+}
+
+bool FileHandler::buildIndex ( bool pUseSidecar )
+{
+    // word 3 of the event header holds the L1A counter, see Event::SetEvent
+    const uint32_t cL1AWord = 3;
+    const uint32_t cChunkEvents = 10000;
+
+    uint64_t cNEvents = eventCount();
+
+    if ( cNEvents == 0 && fHeader.fEventSize32 == 0 )
     {
-        fMutex.lock();
-        uint32_t cBuffer[fData.size()];
-        std::copy ( fData.begin(), fData.end(), cBuffer );
-        fBinaryFile.write ( ( char* ) &cBuffer, sizeof ( cBuffer ) );
-        fBinaryFile.flush();
-        fData.clear();
-        is_set = false;
-        fMutex.unlock();
-        //continue;
+        LOG (INFO) << "FileHandler: Error, can not index " << fBinaryFileName << " without the event size" ;
+        return false;
     }
 
-    else
+    std::string cSidecarName = fBinaryFileName + ".idx";
+
+    // indexing must not disturb a sequential reader of this handler
+    if ( !file_open() ) openFile();
+
+    fBinaryFile.clear();
+    std::streampos cReadPos = fBinaryFile.tellg();
+
+    if ( pUseSidecar && fL1AIndex.empty() )
     {
-        fMutex.lock();
-        fMutex.unlock();
-        //continue;
+        std::ifstream cSidecar ( cSidecarName, std::ios::binary | std::ios::ate );
+
+        if ( cSidecar.good() )
+        {
+            uint64_t cNEntries = std::min<uint64_t> ( uint64_t ( cSidecar.tellg() ) / sizeof ( uint32_t ), cNEvents );
+            fL1AIndex.resize ( cNEntries );
+            cSidecar.seekg ( 0, std::ios::beg );
+            cSidecar.read ( reinterpret_cast<char*> ( fL1AIndex.data() ), cNEntries * sizeof ( uint32_t ) );
+
+            // a sidecar of an older file with the same name does not match the data, start over
+            std::vector<uint32_t> cLast = cNEntries ? readEvents ( cNEntries - 1, 1 ) : std::vector<uint32_t>();
+
+            if ( !cLast.empty() && ( cLast.at ( cL1AWord ) & 0x00FFFFFF ) != fL1AIndex.back() )
+                fL1AIndex.clear();
+
+            // only the part that matched is kept, new entries are appended after it
+            if ( truncate ( cSidecarName.c_str(), fL1AIndex.size() * sizeof ( uint32_t ) ) != 0 && !fL1AIndex.empty() )
+                fL1AIndex.clear();
+
+            fIndexSorted = std::is_sorted ( fL1AIndex.begin(), fL1AIndex.end() );
+        }
+    }
+
+    uint64_t cFirstNew = fL1AIndex.size();
+
+    for ( uint64_t cEvent = cFirstNew; cEvent < cNEvents; cEvent += cChunkEvents )
+    {
+        std::vector<uint32_t> cChunk = readEvents ( cEvent, cChunkEvents );
+
+        for ( size_t cOffset = 0; cOffset + fHeader.fEventSize32 <= cChunk.size(); cOffset += fHeader.fEventSize32 )
+        {
+            uint32_t cL1A = 0x00FFFFFF & cChunk[cOffset + cL1AWord];
+
+            if ( !fL1AIndex.empty() && cL1A < fL1AIndex.back() ) fIndexSorted = false;
+
+            fL1AIndex.push_back ( cL1A );
+        }
+    }
+
+    if ( pUseSidecar && fL1AIndex.size() > cFirstNew )
+    {
+        std::ofstream cSidecar ( cSidecarName, std::ios::binary | std::ios::app );
+        cSidecar.write ( reinterpret_cast<const char*> ( fL1AIndex.data() + cFirstNew ), ( fL1AIndex.size() - cFirstNew ) * sizeof ( uint32_t ) );
+    }
+
+    fBinaryFile.clear();
+    fBinaryFile.seekg ( cReadPos );
+
+    return true;
+}
+
+int64_t FileHandler::findEvent ( uint32_t pL1ACounter ) const
+{
+    std::vector<uint32_t>::const_iterator cIt;
+
+    if ( fIndexSorted )
+    {
+        cIt = std::lower_bound ( fL1AIndex.begin(), fL1AIndex.end(), pL1ACounter );
+
+        if ( cIt != fL1AIndex.end() && *cIt != pL1ACounter ) cIt = fL1AIndex.end();
     }
+    else cIt = std::find ( fL1AIndex.begin(), fL1AIndex.end(), pL1ACounter );
 
-    //}
+    return ( cIt == fL1AIndex.end() ) ? -1 : cIt - fL1AIndex.begin();
 }
@@ -6,14 +6,38 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <deque>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include "FileHeader.h"
 #include "../Utils/easylogging++.h"
 
+/*!
+ * \struct FileWriterStatistics
+ * \brief Throughput counters of the writer thread of a FileHandler
+ */
+struct FileWriterStatistics
+{
+    uint64_t fNPackets = 0;             /*!< packets handed to the writer */
+    uint64_t fBytesQueued = 0;          /*!< bytes handed to the writer */
+    uint64_t fBytesWritten = 0;         /*!< bytes that reached the file */
+    uint64_t fNWrites = 0;              /*!< write system calls */
+    uint64_t fNBackpressureWaits = 0;   /*!< times a producer waited because the queue was full */
+    double fWriteSeconds = 0;           /*!< time spent in write and sync calls */
+
+    double WriteMBps() const
+    {
+        return ( fWriteSeconds > 0 ) ? fBytesWritten / fWriteSeconds / 1e6 : 0;
+    }
+};
+
 /*!
  * \class FileHandler
  * \brief Class to write Data objects in binary file using multithreading
+ * In write mode a writer thread drains a queue of packets into large aligned buffers, so the readout never waits for the disk
+ * unless more than the maximum queued size is pending.
 */
 
 
@@ -24,14 +48,44 @@ class FileHandler
     FileHeader fHeader;
     char fOption;/*!< option for read or write */
 
+    /*!
+     * \brief When the writer thread forces the data to the disk
+     */
+    enum class SyncPolicy {None, EveryBuffer, OnClose};
+
+    static const size_t fWriteBufferSize = 4 << 20;  /*!< bytes collected before a write call */
+    static const size_t fWriteAlignment = 4096;      /*!< alignment of the write buffer, as needed by O_DIRECT */
+
   private:
 
     std::string fBinaryFileName;
-    std::thread fThread;/*!< a thread for the multitrading */
+    std::thread fThread;/*!< the writer thread */
     std::mutex fMutex;/*!< Mutex */
     bool fFileIsOpened ;/*!< to check if the file is opened */
     bool is_set;/*!< check if fdata is set */
 
+    int fFd;                                        /*!< descriptor of the file in write mode */
+    std::atomic<bool> fDirectIORequested;           /*!< write with O_DIRECT, bypassing the page cache */
+    bool fDirectIO;                                 /*!< O_DIRECT is set on fFd, only touched by the writer thread */
+    uint64_t fFileOffset;                           /*!< bytes written to fFd */
+    SyncPolicy fSyncPolicy;
+    size_t fMaxQueuedBytes;                         /*!< producers wait above this amount of pending data */
+    char* fWriteBuffer;                             /*!< aligned buffer filled by the writer thread */
+    size_t fWriteBufferFill;                        /*!< bytes in fWriteBuffer */
+    bool fWriteError;                               /*!< a write failed, further data is dropped */
+
+    std::mutex fQueueMutex;                         /*!< protects the queue, the free buffers and the statistics */
+    std::condition_variable fQueueNotEmpty;
+    std::condition_variable fQueueNotFull;
+    std::deque<std::vector<uint32_t>> fQueue;       /*!< packets waiting for the writer thread */
+    std::vector<std::vector<uint32_t>> fFreeBuffers;/*!< written packet storage, reused by write() */
+    size_t fQueuedBytes;
+    bool fStopWriter;
+    FileWriterStatistics fStatistics;
+
+    std::vector<uint32_t> fL1AIndex;                /*!< L1A counter of each event, filled by buildIndex */
+    bool fIndexSorted;                              /*!< fL1AIndex never decreases, findEvent can bisect */
+
 
   public:
 
@@ -65,9 +119,39 @@ class FileHandler
         fHeader = pHeader;
     }
     /*!
-    * \brief set fData to pVector
+    * \brief set fData to pVector, writeFile() then queues it
+    */
+    void set ( const std::vector<uint32_t>& pVector );
+    /*!
+    * \brief queue a copy of pData for the writer thread, the copy goes into recycled storage
+    */
+    void write ( const std::vector<uint32_t>& pData );
+    /*!
+    * \brief queue pData for the writer thread without copying it
+    */
+    void write ( std::vector<uint32_t>&& pData );
+    /*!
+    * \brief write with O_DIRECT, the writer thread switches at the next block aligned file offset
+    */
+    void setDirectIO ( bool pDirectIO )
+    {
+        fDirectIORequested = pDirectIO;
+    }
+    void setSyncPolicy ( SyncPolicy pPolicy )
+    {
+        fSyncPolicy = pPolicy;
+    }
+    /*!
+    * \brief amount of queued data above which write() waits for the writer thread
+    */
+    void setMaxQueuedBytes ( size_t pBytes )
+    {
+        fMaxQueuedBytes = pBytes;
+    }
+    /*!
+    * \brief copy of the writer counters
     */
-    void set ( std::vector<uint32_t> pVector );
+    FileWriterStatistics getWriterStatistics();
 
 
     /*!
@@ -111,17 +195,97 @@ class FileHandler
     }
 
     /*!
-     * \brief read from raw file
+     * \brief read the rest of the raw file with one bulk read and close it
      * \return a vector with the data read from file
      */
     std::vector<uint32_t> readFile( );
+    /*!
+     * \brief read the next pNWords32 words with one bulk read, the file is closed when its end is reached
+     */
     std::vector<uint32_t> readFileChunks ( uint32_t pNWords32 );
+    /*!
+     * \brief read the last pNbytes bytes of the raw file (the rest of the file if -1) and close it
+     */
     std::vector<uint32_t> readFileTail ( long pNbytes );
 
     /*!
-    * \brief Write data to file
+    * \brief Queue the data given to set() for writing
     */
     void writeFile() ;
+
+    /*!
+    * \brief number of complete events in the file, from its size and fHeader.fEventSize32
+    * Set fHeader.fEventSize32 by hand for files without header. The size is taken at each call, so this follows a file being written.
+    */
+    uint64_t eventCount();
+    /*!
+    * \brief move the read position to the first word of event pEvent
+    * \return false if the file has fewer events
+    */
+    bool seekEvent ( uint64_t pEvent );
+    /*!
+    * \brief read pCount events starting at event pFirst, fewer if the file ends before; the file stays open
+    * The read position is shared with readFileChunks; for parallel processing of event ranges use one FileHandler per thread or a MappedRawFile.
+    */
+    std::vector<uint32_t> readEvents ( uint64_t pFirst, uint32_t pCount );
+    /*!
+    * \brief index the L1A counter of every event, reusing and extending the sidecar file <filename>.idx
+    * \param pUseSidecar : load the sidecar and write the new entries to it
+    * \return false if the event size is unknown
+    */
+    bool buildIndex ( bool pUseSidecar = true );
+    /*!
+    * \brief event number of the first event with L1A counter pL1ACounter, -1 if it is not in the index
+    */
+    int64_t findEvent ( uint32_t pL1ACounter ) const;
+    /*!
+    * \brief number of events in the L1A index
+    */
+    uint64_t indexedEventCount() const
+    {
+        return fL1AIndex.size();
+    }
+
+  private:
+    /*!
+    * \brief read up to pNWords32 words at the current position, fewer at the end of the file
+    */
+    std::vector<uint32_t> readWords ( size_t pNWords32 );
+    /*!
+    * \brief number of words between the read position and the end of the file, plus one to hit the end
+    */
+    size_t remainingWords();
+    /*!
+    * \brief byte offset of the first event, after the header if there is one
+    */
+    uint64_t dataOffset() const
+    {
+        return fHeader.fValid ? fHeader.fHeaderSize32 * sizeof ( uint32_t ) : 0;
+    }
+    /*!
+    * \brief body of the writer thread: drain the queue into the write buffer until closeFile
+    */
+    void writerLoop();
+    /*!
+    * \brief stop the writer thread after it wrote everything queued
+    */
+    void stopWriter();
+    /*!
+    * \brief copy pBytes into the write buffer, writing it out each time it is full
+    */
+    void appendToBuffer ( const char* pData, size_t pBytes );
+    /*!
+    * \brief write out the write buffer, with O_DIRECT only its aligned part unless pFinal
+    */
+    void flushBuffer ( bool pFinal );
+    /*!
+    * \brief set or clear O_DIRECT on the file descriptor
+    */
+    void applyDirectIO ( bool pDirectIO );
+    /*!
+    * \brief get storage for a packet copy, recycled if possible
+    */
+    std::vector<uint32_t> takeFreeBuffer();
 };
 
 #endif
@@ -0,0 +1,68 @@
+#include "MappedRawFile.h"
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedRawFile::MappedRawFile ( const std::string& pFilename ) :
+    fFilename ( pFilename ),
+    fMap ( nullptr ),
+    fMapSize ( 0 ),
+    fData ( nullptr ),
+    fNWords32 ( 0 )
+{
+    int cFd = ::open ( pFilename.c_str(), O_RDONLY );
+    struct stat cStat;
+
+    if ( cFd < 0 || fstat ( cFd, &cStat ) != 0 )
+    {
+        LOG (ERROR) << "MappedRawFile: Error, can not open " << pFilename << ": " << std::strerror ( errno ) ;
+
+        if ( cFd >= 0 ) ::close ( cFd );
+
+        return;
+    }
+
+    fMapSize = cStat.st_size;
+
+    if ( fMapSize > 0 )
+    {
+        void* cMap = mmap ( nullptr, fMapSize, PROT_READ, MAP_PRIVATE, cFd, 0 );
+
+        if ( cMap == MAP_FAILED )
+            LOG (ERROR) << "MappedRawFile: Error, can not map " << pFilename << ": " << std::strerror ( errno ) ;
+        else
+        {
+            fMap = cMap;
+            // the typical consumer walks the file once from the start
+            madvise ( fMap, fMapSize, MADV_SEQUENTIAL );
+        }
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close ( cFd );
+
+    if ( fMap == nullptr ) return;
+
+    const uint32_t* cWords = static_cast<const uint32_t*> ( fMap );
+    size_t cNWords32 = fMapSize / sizeof ( uint32_t );
+
+    if ( cNWords32 >= FileHeader::fHeaderSize32 )
+        fHeader.decodeHeader ( std::vector<uint32_t> ( cWords, cWords + FileHeader::fHeaderSize32 ) );
+
+    // without a valid header the whole file is data, as in FileHandler
+    size_t cOffset = 0;
+
+    if ( fHeader.fValid ) cOffset = FileHeader::fHeaderSize32;
+
+    fData = cWords + cOffset;
+    fNWords32 = cNWords32 - cOffset;
+}
+
+MappedRawFile::~MappedRawFile()
+{
+    if ( fMap != nullptr ) munmap ( fMap, fMapSize );
+}
@@ -0,0 +1,138 @@
+/*!
+
+        \file                   MappedRawFile.h
+        \brief                  Read-only memory mapped view of a raw data file written by FileHandler
+        \version                1.0
+
+ */
+
+#ifndef __MAPPEDRAWFILE_H__
+#define __MAPPEDRAWFILE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "FileHeader.h"
+
+/*!
+ * \class MappedRawFile
+ * \brief Maps a raw file into memory and exposes the data after the FileHeader as 32 bit words, without copying them
+ * With a valid header the data can be walked event by event, each event being fEventSize32 words.
+ */
+class MappedRawFile
+{
+  public:
+    /*!
+     * \class EventIterator
+     * \brief Steps through the mapped data one event at a time, dereferences to the first word of the event
+     */
+    class EventIterator
+    {
+      public:
+        EventIterator ( const uint32_t* pWord, uint32_t pEventSize32 ) :
+            fWord ( pWord ),
+            fEventSize32 ( pEventSize32 )
+        {
+        }
+        const uint32_t* operator* () const
+        {
+            return fWord;
+        }
+        EventIterator& operator++()
+        {
+            fWord += fEventSize32;
+            return *this;
+        }
+        EventIterator operator+ ( ptrdiff_t pN ) const
+        {
+            return EventIterator ( fWord + pN * fEventSize32, fEventSize32 );
+        }
+        ptrdiff_t operator- ( const EventIterator& pOther ) const
+        {
+            return ( fWord - pOther.fWord ) / fEventSize32;
+        }
+        bool operator== ( const EventIterator& pOther ) const
+        {
+            return fWord == pOther.fWord;
+        }
+        bool operator!= ( const EventIterator& pOther ) const
+        {
+            return fWord != pOther.fWord;
+        }
+
+      private:
+        const uint32_t* fWord;
+        uint32_t fEventSize32;
+    };
+
+    /*!
+     * \brief map pFilename read-only, check isOpen() afterwards
+     */
+    MappedRawFile ( const std::string& pFilename );
+    ~MappedRawFile();
+
+    MappedRawFile ( const MappedRawFile& ) = delete;
+    MappedRawFile& operator= ( const MappedRawFile& ) = delete;
+
+    bool isOpen() const
+    {
+        return fMap != nullptr;
+    }
+    const FileHeader& getHeader() const
+    {
+        return fHeader;
+    }
+    /*!
+     * \brief first data word, right after the header if the file has a valid one
+     */
+    const uint32_t* getData() const
+    {
+        return fData;
+    }
+    /*!
+     * \brief number of data words, without the header
+     */
+    size_t getNWords32() const
+    {
+        return fNWords32;
+    }
+    /*!
+     * \brief event size from the header, 0 if the file has no valid header
+     */
+    uint32_t getEventSize32() const
+    {
+        return fHeader.fValid ? fHeader.fEventSize32 : 0;
+    }
+    /*!
+     * \brief number of complete events in the file, a truncated last event is not counted
+     */
+    size_t getNEvents() const
+    {
+        return getEventSize32() ? fNWords32 / getEventSize32() : 0;
+    }
+    /*!
+     * \brief first word of event pIndex, no bounds check
+     */
+    const uint32_t* getEvent ( size_t pIndex ) const
+    {
+        return fData + pIndex * getEventSize32();
+    }
+    EventIterator begin() const
+    {
+        return EventIterator ( fData, getEventSize32() );
+    }
+    EventIterator end() const
+    {
+        return EventIterator ( fData + getNEvents() * getEventSize32(), getEventSize32() );
+    }
+
+  private:
+    std::string fFilename;
+    FileHeader fHeader;
+    void* fMap;                 /*!< start of the mapping */
+    size_t fMapSize;            /*!< length of the mapping in bytes */
+    const uint32_t* fData;
+    size_t fNWords32;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*!
+
+        \file                   SpscQueue.h
+        \brief                  Bounded lock-free queue for one producer and one consumer thread
+        \version                1.0
+
+ */
+
+#ifndef __SPSCQUEUE_H__
+#define __SPSCQUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/*!
+ * \class SpscQueue
+ * \brief Ring buffer of fixed capacity, safe for exactly one thread calling Push and one thread calling Pop
+ * Elements are moved in and out, so a queue of std::vector hands buffers over without copying them.
+ */
+template<typename T>
+class SpscQueue
+{
+  private:
+    std::vector<T> fSlots;              /*!< one slot more than the capacity to tell full from empty */
+    std::atomic<size_t> fHead;          /*!< next slot to pop, written by the consumer */
+    std::atomic<size_t> fTail;          /*!< next slot to push, written by the producer */
+
+    size_t next ( size_t pIndex ) const
+    {
+        return ( pIndex + 1 == fSlots.size() ) ? 0 : pIndex + 1;
+    }
+
+  public:
+    /*!
+     * \brief Constructor of the SpscQueue class
+     * \param pCapacity : maximum number of elements in the queue
+     */
+    explicit SpscQueue ( size_t pCapacity ) : fSlots ( pCapacity + 1 ), fHead ( 0 ), fTail ( 0 )
+    {
+    }
+    SpscQueue ( const SpscQueue& ) = delete;
+    SpscQueue& operator= ( const SpscQueue& ) = delete;
+
+    /*!
+     * \brief Move an element in, producer thread only
+     * \return false if the queue is full, pItem is left untouched in that case
+     */
+    bool Push ( T&& pItem )
+    {
+        size_t cTail = fTail.load ( std::memory_order_relaxed );
+        size_t cNext = next ( cTail );
+
+        if ( cNext == fHead.load ( std::memory_order_acquire ) ) return false;
+
+        fSlots[cTail] = std::move ( pItem );
+        fTail.store ( cNext, std::memory_order_release );
+        return true;
+    }
+    /*!
+     * \brief Move the oldest element out, consumer thread only
+     * \return false if the queue is empty
+     */
+    bool Pop ( T& pItem )
+    {
+        size_t cHead = fHead.load ( std::memory_order_relaxed );
+
+        if ( cHead == fTail.load ( std::memory_order_acquire ) ) return false;
+
+        pItem = std::move ( fSlots[cHead] );
+        fHead.store ( next ( cHead ), std::memory_order_release );
+        return true;
+    }
+    /*!
+     * \brief Number of elements in the queue, only a snapshot while the other thread is active
+     */
+    size_t Size() const
+    {
+        size_t cHead = fHead.load ( std::memory_order_acquire );
+        size_t cTail = fTail.load ( std::memory_order_acquire );
+        return ( cTail >= cHead ) ? cTail - cHead : cTail + fSlots.size() - cHead;
+    }
+    bool Empty() const
+    {
+        return Size() == 0;
+    }
+    size_t Capacity() const
+    {
+        return fSlots.size() - 1;
+    }
+};
+
+#endif
@@ -19,6 +19,7 @@
 #include "TPaveStats.h"
 #include "TStyle.h"
 #include "TIterator.h"
+#include "TList.h"
 #include "../Utils/Event.h"
 
 #include "DQMHistogrammer.h"
@@ -27,7 +28,10 @@ DQMHistogrammer::DQMHistogrammer (bool addTree, int ncol, bool eventFilter, bool
     addTree_ (addTree),
     nColumn_ (ncol),
     filterEvent_ (eventFilter),
-    skipDebugHist_ (skipHist)
+    skipDebugHist_ (skipHist),
+    histoDir_ (nullptr),
+    tree_ (nullptr),
+    cbcTableStride_ (0)
 {
     dataBuffer_        = 42;         // (32 bit words line)
     pCounter_          = 1976;       // (get rid of first 47 events)
@@ -40,6 +44,13 @@ DQMHistogrammer::DQMHistogrammer (bool addTree, int ncol, bool eventFilter, bool
 
 DQMHistogrammer::~DQMHistogrammer()
 {
+    // a worker set goes away with its directory
+    if (histoDir_)
+    {
+        delete histoDir_;
+        return;
+    }
+
     TIter next (gROOT->GetList() );
     TObject* obj;
 
@@ -48,7 +59,7 @@ DQMHistogrammer::~DQMHistogrammer()
         if (obj->InheritsFrom ("TH1") || obj->InheritsFrom ("TTree") ) delete obj;
     }
 }
-void DQMHistogrammer::bookHistos (const Ph2_HwInterface::EventDataMap& evmap)
+void DQMHistogrammer::bookHistos (const std::vector<uint16_t>& cbcKeys)
 {
     sensCorrH_ = new TH1I ( "sensorHitcorr", "Sensor Hit Correlation", 4, 0.5, 4.5 );
     sensCorrH_->GetXaxis()->SetBinLabel (1, "No hits");
@@ -62,9 +73,8 @@ void DQMHistogrammer::bookHistos (const Ph2_HwInterface::EventDataMap& evmap)
     uint16_t nCbc = 0;
     int evtsize = 500000;
 
-    for ( auto const& it : evmap )
+    for ( auto const& cKey : cbcKeys )
     {
-        uint16_t cKey = it.first;
         uint8_t feId = (cKey >> 8) & 0xFF;
         uint8_t cbcId = cKey & 0xFF;
 
@@ -92,6 +102,44 @@ void DQMHistogrammer::bookHistos (const Ph2_HwInterface::EventDataMap& evmap)
         cbcHMap_.insert ({key, cbc_h});
     }
 
+    // dense (FE, CBC) table of the histogram bundles, so that the fill path does not need the names
+    uint32_t maxFe = 0;
+
+    for ( auto const& cKey : cbcKeys )
+    {
+        maxFe = std::max<uint32_t> (maxFe, (cKey >> 8) & 0xFF);
+        cbcTableStride_ = std::max<uint32_t> (cbcTableStride_, (cKey & 0xFF) + 1);
+    }
+
+    cbcHTable_.assign ( (maxFe + 1) * cbcTableStride_, nullptr);
+
+    for ( auto const& cKey : cbcKeys )
+    {
+        std::stringstream ss;
+        ss << "fed" << + ( (cKey >> 8) & 0xFF) << "cbc" << + (cKey & 0xFF);
+        auto iCBCH = cbcHMap_.find (ss.str() );
+
+        if (iCBCH != cbcHMap_.end() ) cbcHTable_[ ( (cKey >> 8) & 0xFF) * cbcTableStride_ + (cKey & 0xFF)] = &iCBCH->second;
+    }
+
+    // strip and column of every channel of every possible CBC Id: CBCs 0-7 make column 0, 8-15 column 1 in reverse order
+    geometry_.resize (256);
+
+    for (uint32_t cbcId = 0; cbcId < geometry_.size(); cbcId++)
+    {
+        for (uint32_t ch = 0; ch < NCHANNELS; ch++)
+        {
+            uint32_t ichan = ch / 2 + 1;
+            HitPosition& pos = geometry_[cbcId][ch];
+            pos.x = (cbcId <= 7) ? 127 * cbcId + ichan : 2033 - (127 * cbcId + ichan);
+            pos.column = (cbcId <= 7) ? 0 : 1;
+            pos.odd = ch % 2;
+        }
+    }
+
+    evenHits_.reserve (cbcKeys.size() * NCHANNELS / 2);
+    oddHits_.reserve (cbcKeys.size() * NCHANNELS / 2);
+
     if (nColumn_ == 1 && nCbc == 4) nCbc = 2;
 
     int16_t nbin = nCbc * 127;
@@ -135,7 +183,7 @@ void DQMHistogrammer::bookHistos (const Ph2_HwInterface::EventDataMap& evmap)
         dut0C0HitProfH_ = new TH1I ( "evenSensor_hitprofile_col0", "Even Sensor Hitmap(col 0)", nbin, 0.5, nbin + 0.5);
         dut1C0HitProfH_ = new TH1I ( "oddSensor_hitprofile_col0", "Odd Sensor Hitmap(col 0)",   nbin, 0.5, nbin + 0.5);
         dut0C1HitProfH_ = nullptr;
-        dut0C1HitProfH_ = nullptr;
+        dut1C1HitProfH_ = nullptr;
     }
 
     totalNumberHitsH_ = new TH1I ("tot_hits", "Total Number of Hits", 101, -0.5, 100.5);
@@ -184,6 +232,90 @@ void DQMHistogrammer::bookHistos (const Ph2_HwInterface::EventDataMap& evmap)
         tree_->Branch ("dut1Ch1data", "std::vector<unsigned int>", &dut1C1chData_);
     }
 }
+DQMHistogrammer* DQMHistogrammer::makeWorker (const std::vector<uint16_t>& cbcKeys, int iworker) const
+{
+    DQMHistogrammer* worker = new DQMHistogrammer (addTree_, nColumn_, filterEvent_, skipDebugHist_);
+    worker->bookWorkerHistos (cbcKeys, iworker);
+    return worker;
+}
+void DQMHistogrammer::bookWorkerHistos (const std::vector<uint16_t>& cbcKeys, int iworker)
+{
+    histoDir_ = new TDirectory (Form ("dqmWorker%d", iworker), Form ("DQM histograms of worker %d", iworker) );
+    TDirectory::TContext cContext (gDirectory, histoDir_);
+    bookHistos (cbcKeys);
+}
+void DQMHistogrammer::mergeHistos (const DQMHistogrammer& worker)
+{
+    // TH1::Merge, unlike TH1::Add, copes with the event trend histograms having been extended differently
+    auto merge = [] (TH1 * target, TH1 * source)
+    {
+        if (!target || !source) return;
+
+        TList list;
+        list.Add (source);
+        target->Merge (&list);
+    };
+
+    for ( auto& imap : cbcHMap_ )
+    {
+        auto iworker = worker.cbcHMap_.find (imap.first);
+
+        if (iworker == worker.cbcHMap_.end() ) continue;
+
+        CBCHistos& cbc_h = imap.second;
+        const CBCHistos& wcbc_h = iworker->second;
+        merge (cbc_h.errBitH, wcbc_h.errBitH);
+        merge (cbc_h.errBitVsEvtH, wcbc_h.errBitVsEvtH);
+        merge (cbc_h.plAddH, wcbc_h.plAddH);
+        merge (cbc_h.plAddVsEvtH, wcbc_h.plAddVsEvtH);
+        merge (cbc_h.nStubsH, wcbc_h.nStubsH);
+        merge (cbc_h.evenChnOccuH, wcbc_h.evenChnOccuH);
+        merge (cbc_h.oddChnOccuH, wcbc_h.oddChnOccuH);
+        merge (cbc_h.tdcVsEvenChnOccuH, wcbc_h.tdcVsEvenChnOccuH);
+        merge (cbc_h.tdcVsOddChnOccuH, wcbc_h.tdcVsOddChnOccuH);
+    }
+
+    merge (hitCorrC0H_, worker.hitCorrC0H_);
+    merge (hitCorrC1H_, worker.hitCorrC1H_);
+    merge (hitDelCorrC0H, worker.hitDelCorrC0H);
+    merge (hitDelCorrC1H, worker.hitDelCorrC1H);
+    merge (dut0HitProfH_, worker.dut0HitProfH_);
+    merge (dut1HitProfH_, worker.dut1HitProfH_);
+    merge (dut0HitProfUnfoldedH_, worker.dut0HitProfUnfoldedH_);
+    merge (dut1HitProfUnfoldedH_, worker.dut1HitProfUnfoldedH_);
+    merge (dut0C0HitProfH_, worker.dut0C0HitProfH_);
+    merge (dut0C1HitProfH_, worker.dut0C1HitProfH_);
+    merge (dut1C0HitProfH_, worker.dut1C0HitProfH_);
+    merge (dut1C1HitProfH_, worker.dut1C1HitProfH_);
+    merge (sensCorrH_, worker.sensCorrH_);
+    merge (l1AcceptH_, worker.l1AcceptH_);
+    merge (tdcCounterH_, worker.tdcCounterH_);
+    merge (totalNumberHitsH_, worker.totalNumberHitsH_);
+    merge (totalNumberStubsH_, worker.totalNumberStubsH_);
+    merge (plAddPhaseDiffH_, worker.plAddPhaseDiffH_);
+    merge (plAddPhaseCorrH_, worker.plAddPhaseCorrH_);
+    merge (cbcErrorCorrH_, worker.cbcErrorCorrH_);
+    merge (plAddPhaseDiffVsEvtH_, worker.plAddPhaseDiffVsEvtH_);
+
+    if (!skipDebugHist_)
+    {
+        merge (bunchCounterVsEvtH_, worker.bunchCounterVsEvtH_);
+        merge (orbitCounterVsEvtH_, worker.orbitCounterVsEvtH_);
+        merge (lumiCounterVsEvtH_, worker.lumiCounterVsEvtH_);
+        merge (l1AcceptVsEvtH_, worker.l1AcceptVsEvtH_);
+        merge (cbcCounterVsEvtH_, worker.cbcCounterVsEvtH_);
+        merge (tdcCounterVsEvtH_, worker.tdcCounterVsEvtH_);
+        merge (periodicityFlagVsEvtH_, worker.periodicityFlagVsEvtH_);
+    }
+
+    // the entries are appended, so merging the workers in the order of their event ranges keeps the tree in event order
+    if (addTree_ && tree_ && worker.tree_)
+    {
+        TList list;
+        list.Add (worker.tree_);
+        tree_->Merge (&list);
+    }
+}
 void DQMHistogrammer::fillHistos (const std::vector<Event*>& event_list, int nevtp, const int data_size)
 {
     unsigned long ival = nevtp; // as the files is read in chunks
@@ -216,14 +348,12 @@ void DQMHistogrammer::fillHistos (const std::vector<Event*>& event_list, int nev
         // initialize Tree parameters
         cbcErrorVal_->clear();
         cbcPLAddressVal_->clear();
-        int ncbc = 0;
-        const EventDataMap& evmap = ev->GetEventDataMap();
-        std::vector<int> oddChVec;
-        std::vector<int> evenChVec;
+        evenHits_.clear();
+        oddHits_.clear();
+        unsigned int ncbc = 0;
 
-        for ( auto const& it : evmap )
+        for ( auto const& cKey : ev->GetCbcKeys() )
         {
-            uint16_t cKey = it.first;
             uint8_t feId = (cKey >> 8) & 0xFF;
             uint8_t cbcId = cKey & 0xFF;
 
@@ -233,69 +363,52 @@ void DQMHistogrammer::fillHistos (const std::vector<Event*>& event_list, int nev
 
             uint32_t error_cbc     = ev->Error (feId, cbcId);
             uint32_t pladdress_cbc = ev->PipelineAddress (feId, cbcId);
-            int nstub_cbc          = std::stoi ( ev->StubBitString ( feId, cbcId ), nullptr, 10);
-            std::stringstream ss;
-            ss << "fed" << +feId << "cbc" << +cbcId;
-            std::string key_cbc = ss.str();
+            // the stub field of the CBC2 data is its single stub bit
+            int nstub_cbc          = ev->StubBit (feId, cbcId) ? 1 : 0;
 
             totalStubs_ += nstub_cbc;
 
             cbcErrorVal_->push_back (error_cbc);
             cbcPLAddressVal_->push_back (pladdress_cbc);
 
-            const std::vector<bool>& dataVec = ev->DataBitVector ( feId, cbcId );
+            const CbcChannelMask hits = ev->ChannelMask (feId, cbcId);
+            const std::array<HitPosition, NCHANNELS>& geometry = geometry_[cbcId];
             uint32_t nhits_cbc = 0;
 
-            std::vector<uint32_t> fired_channels;
-
-            for ( uint32_t ch = 0; ch < dataVec.size(); ++ch )
+            Event::ForEachHit (hits, [&] (uint32_t ch)
             {
-                int hitposX = -1;
-                int hitposY = -1;
+                const HitPosition& pos = geometry[ch];
+                nhits_cbc++;
 
-                if ( dataVec[ch] )
+                if (!pos.odd)
                 {
-                    nhits_cbc++;
-                    fired_channels.push_back (ch);
-                    uint32_t ichan = ch / 2 + 1;
-
-                    if (cbcId <= 7)
-                    {
-                        hitposX = 127 * cbcId + ichan;
-                        hitposY = 0;
-                    }
-                    else
-                    {
-                        hitposX = 2033 - (127 * cbcId + ichan);
-                        hitposY = 1;
-                    }
-
-                    if ( ch % 2 == 0 )
-                    {
-                        evenChVec.push_back (hitposX);
-
-                        if (hitposY == 0) dut0C0chData_->push_back (hitposX);
-                        else if (hitposY == 1) dut0C1chData_->push_back (hitposX);
-                    }
-                    else
-                    {
-                        oddChVec.push_back (hitposX);
-
-                        if (hitposY == 0) dut1C0chData_->push_back (hitposX);
-                        else if (hitposY == 1) dut1C1chData_->push_back (hitposX);
-                    }
+                    evenHits_.push_back (pos);
+
+                    if (pos.column == 0) dut0C0chData_->push_back (pos.x);
+                    else dut0C1chData_->push_back (pos.x);
                 }
-            }
+                else
+                {
+                    oddHits_.push_back (pos);
+
+                    if (pos.column == 0) dut1C0chData_->push_back (pos.x);
+                    else dut1C1chData_->push_back (pos.x);
+                }
+            } );
 
             if (eventFlag_)
-                fillCBCHistos (ival, key_cbc, error_cbc, pladdress_cbc, nstub_cbc, fired_channels);
+            {
+                CBCHistos* cbc_h = getCBCHistos (feId, cbcId);
+
+                if (cbc_h) fillCBCHistos (ival, *cbc_h, error_cbc, pladdress_cbc, nstub_cbc, hits);
+            }
 
             totalHits_ += nhits_cbc;
         }
 
         if (eventFlag_)
         {
-            fillSensorHistos (cbcHMap_.size(), evenChVec, oddChVec);
+            fillSensorHistos (evenHits_, oddHits_);
 
             if (cbcPLAddressVal_->size() == 2 && cbcErrorVal_->size() == 2 && nColumn_ == 1 )
             {
@@ -330,80 +443,66 @@ void DQMHistogrammer::fillHistos (const std::vector<Event*>& event_list, int nev
         }
     }
 }
-void DQMHistogrammer::fillCBCHistos (unsigned long ievt, std::string cbc_hid, uint32_t error, uint32_t address,
-                                     int nstub, const std::vector<uint32_t>& channels)
+void DQMHistogrammer::fillCBCHistos (unsigned long ievt, CBCHistos& cbc_h, uint32_t error, uint32_t address,
+                                     int nstub, const CbcChannelMask& hits)
 {
+    cbc_h.errBitH->Fill ( error);
+    fillEventTrendHisto (cbc_h.errBitVsEvtH, ievt, error);
+    cbc_h.plAddH->Fill (address);
+    fillEventTrendHisto (cbc_h.plAddVsEvtH, ievt, address);
+    cbc_h.nStubsH->Fill (nstub);
 
-    std::map<std::string, CBCHistos>::iterator iCBCH = cbcHMap_.find (cbc_hid);
-
-    if (iCBCH != cbcHMap_.end() )
+    Event::ForEachHit (hits, [&cbc_h] (uint32_t ch)
     {
-        CBCHistos& cbc_h = iCBCH->second;
-        cbc_h.errBitH->Fill ( error);
-        fillEventTrendHisto (cbc_h.errBitVsEvtH, ievt, error);
-        cbc_h.plAddH->Fill (address);
-        fillEventTrendHisto (cbc_h.plAddVsEvtH, ievt, address);
-        cbc_h.nStubsH->Fill (nstub);
-
-        for (auto ch : channels)
-        {
-            uint32_t ichan = ch / 2 + 1;
+        uint32_t ichan = ch / 2 + 1;
 
-            if ( (ch % 2) == 0) cbc_h.evenChnOccuH->Fill (ichan);
-            else cbc_h.oddChnOccuH->Fill (ichan );
-        }
-    }
+        if ( (ch % 2) == 0) cbc_h.evenChnOccuH->Fill (ichan);
+        else cbc_h.oddChnOccuH->Fill (ichan );
+    } );
 }
-void DQMHistogrammer::fillSensorHistos (int ncbc, const std::vector<int>& even_values, const std::vector<int>& odd_values)
+void DQMHistogrammer::fillSensorHistos (const std::vector<HitPosition>& even_hits, const std::vector<HitPosition>& odd_hits)
 {
-    int xmax = (nColumn_ == 1) ? ncbc * 127 : ncbc / 2 * 127;
-    int yval;
-
-    for (auto xval : even_values)
+    for (auto const& pos : even_hits)
     {
-        if (xval <= xmax) yval = 0;
+        dut0HitProfH_->Fill (pos.x, pos.column);
 
-        dut0HitProfH_->Fill (xval, yval);
+        if (pos.column == 0) dut0C0HitProfH_->Fill (pos.x);
+        else if (dut0C1HitProfH_) dut0C1HitProfH_->Fill (pos.x);
 
-        if (yval == 0) dut0C0HitProfH_->Fill (xval);
-        else if (yval == 1) dut0C1HitProfH_->Fill (xval);
-
-        if (dut0HitProfUnfoldedH_) dut0HitProfUnfoldedH_->Fill (yval * 127 * 8 + xval);
+        if (dut0HitProfUnfoldedH_) dut0HitProfUnfoldedH_->Fill (pos.column * 127 * 8 + pos.x);
     }
 
-    for (auto xval : odd_values)
+    for (auto const& pos : odd_hits)
     {
-        if (xval <= xmax) yval = 0;
-
-        dut1HitProfH_->Fill (xval, yval);
+        dut1HitProfH_->Fill (pos.x, pos.column);
 
-        if (yval == 0)  dut1C0HitProfH_->Fill (xval);
-        else if (yval == 1) dut1C1HitProfH_->Fill (xval);
+        if (pos.column == 0)  dut1C0HitProfH_->Fill (pos.x);
+        else if (dut1C1HitProfH_) dut1C1HitProfH_->Fill (pos.x);
 
-        if (dut1HitProfUnfoldedH_) dut1HitProfUnfoldedH_->Fill (yval * 127 * 8 + xval);
+        if (dut1HitProfUnfoldedH_) dut1HitProfUnfoldedH_->Fill (pos.column * 127 * 8 + pos.x);
     }
 
-    if (even_values.size() == odd_values.size() )
+    if (even_hits.size() == odd_hits.size() )
     {
-        for (unsigned int k = 0; k < even_values.size(); k++)
+        for (unsigned int k = 0; k < even_hits.size(); k++)
         {
-            if (even_values[k] <= xmax)
+            if (even_hits[k].column == 0)
             {
-                hitCorrC0H_->Fill (even_values[k], odd_values[k]);
-                hitDelCorrC0H->Fill (even_values[k] - odd_values[k]);
+                hitCorrC0H_->Fill (even_hits[k].x, odd_hits[k].x);
+                hitDelCorrC0H->Fill (even_hits[k].x - odd_hits[k].x);
             }
-            else
+            else if (hitCorrC1H_)
             {
-                hitCorrC1H_->Fill (even_values[k], odd_values[k]);
-                hitDelCorrC1H->Fill (even_values[k] - odd_values[k]);
+                hitCorrC1H_->Fill (even_hits[k].x, odd_hits[k].x);
+                hitDelCorrC1H->Fill (even_hits[k].x - odd_hits[k].x);
             }
         }
     }
 
-    if (!even_values.size() && !odd_values.size() ) sensCorrH_->Fill (1);
-    else if (!even_values.size() && odd_values.size() ) sensCorrH_->Fill (2);
-    else if (even_values.size() && !odd_values.size() ) sensCorrH_->Fill (3);
-    else if (even_values.size() && odd_values.size() ) sensCorrH_->Fill (4);
+    if (even_hits.empty() && odd_hits.empty() ) sensCorrH_->Fill (1);
+    else if (even_hits.empty() && !odd_hits.empty() ) sensCorrH_->Fill (2);
+    else if (!even_hits.empty() && odd_hits.empty() ) sensCorrH_->Fill (3);
+    else sensCorrH_->Fill (4);
 }
 void DQMHistogrammer::saveHistos (const std::string& out_file)
 {
@@ -505,7 +604,9 @@ void DQMHistogrammer::saveHistos (const std::string& out_file)
 }
 bool DQMHistogrammer::getEventFlag (const unsigned long& ievt, const int data_size)
 {
-    if ( (ievt % eventBlock_) == 0) lineOffset_ +=  eventBlock_ * data_size;
+    // the offset grows by a block every eventBlock_ events; it is derived from ievt instead of being
+    // accumulated, so that the workers of the parallel mode can start anywhere in the file
+    long offset = lineOffset_ + (ievt / eventBlock_) * eventBlock_ * data_size;
 
     bool flag = true;
 
@@ -513,7 +614,7 @@ bool DQMHistogrammer::getEventFlag (const unsigned long& ievt, const int data_si
     {
         long line = (ievt - 1) * data_size + i;
 
-        if ( (line - lineOffset_) % periodicity_ == 0)
+        if ( (line - offset) % periodicity_ == 0)
         {
             flag = false;
             break;
@@ -524,7 +625,7 @@ bool DQMHistogrammer::getEventFlag (const unsigned long& ievt, const int data_si
 }
 void DQMHistogrammer::resetHistos()
 {
-    TIter next (gROOT->GetList() );
+    TIter next (histoDir_ ? histoDir_->GetList() : gROOT->GetList() );
     TObject* obj;
 
     while ( (obj = next() ) )
@@ -13,7 +13,9 @@
 
 #include "../tools/Tool.h"
 #include "../Utils/easylogging++.h"
+#include "../Utils/Event.h"
 
+#include <array>
 #include <vector>
 #include <string>
 #include <map>
@@ -23,6 +25,7 @@ class TH1D;
 class TH2I;
 class TProfile;
 class TTree;
+class TDirectory;
 /*!
  * \class DQMHistogrammer
  * \brief Class to create and fill monitoring histograms
@@ -43,7 +46,16 @@ class DQMHistogrammer : public Tool
     /*!
      * Book histograms
      */
-    void bookHistos (const Ph2_HwInterface::EventDataMap& evmap);
+    void bookHistos (const std::vector<uint16_t>& cbcKeys);
+    /*!
+     * Create a histogrammer with the same options and a private histogram set, for worker thread iworker of the
+     * parallel mode; its set lives in a directory of its own, so that the names do not clash with this one
+     */
+    DQMHistogrammer* makeWorker (const std::vector<uint16_t>& cbcKeys, int iworker) const;
+    /*!
+     * Add the histograms and the tree entries of a worker created by makeWorker
+     */
+    void mergeHistos (const DQMHistogrammer& worker);
     void bookEventTrendHisto (TH1I*& th, const TString& name, const TString& title, int size);
 
     /*!
@@ -52,14 +64,30 @@ class DQMHistogrammer : public Tool
     void fillHistos (const std::vector<Event*>& event_list, int nevtp, const int data_size);
     void saveHistos (const std::string& out_file);
     void resetHistos();
-    void fillSensorHistos (int ncbc, const std::vector<int>& even_values, const std::vector<int>& odd_values);
-    void fillCBCHistos (unsigned long ievt, std::string cbc_hid, uint32_t error, uint32_t address, int nstub,
-                        const std::vector<uint32_t>& channles);
     void fillEventTrendHisto (TH1I* th, unsigned long ival, unsigned int val);
     bool getEventFlag (const unsigned long& ievt, const int data_size);
 
   private:
 
+    // position of a channel on the sensors: strip, column and whether it is on the odd sensor
+    struct HitPosition
+    {
+        int16_t x;
+        int8_t column;
+        bool odd;
+    };
+    struct CBCHistos;
+
+    void bookWorkerHistos (const std::vector<uint16_t>& cbcKeys, int iworker);
+    void fillSensorHistos (const std::vector<HitPosition>& even_hits, const std::vector<HitPosition>& odd_hits);
+    void fillCBCHistos (unsigned long ievt, CBCHistos& cbc_h, uint32_t error, uint32_t address, int nstub,
+                        const CbcChannelMask& hits);
+    CBCHistos* getCBCHistos (uint8_t feId, uint8_t cbcId) const
+    {
+        uint32_t index = feId * cbcTableStride_ + cbcId;
+        return (cbcId < cbcTableStride_ && index < cbcHTable_.size() ) ? cbcHTable_[index] : nullptr;
+    }
+
     bool addTree_;
     int nColumn_;
     bool filterEvent_;
@@ -71,7 +99,9 @@ class DQMHistogrammer : public Tool
     uint32_t periodicityOffset_;
     uint32_t eventBlock_;
     uint32_t skipEvents_;
-    long lineOffset_;
+    long lineOffset_;            // at the first event, see getEventFlag
+
+    TDirectory* histoDir_;       // directory of a worker set, nullptr for the master set
 
     TTree* tree_;
     // Following same convention as HitProfile histo naming
@@ -101,6 +131,11 @@ class DQMHistogrammer : public Tool
         TProfile* tdcVsOddChnOccuH;
     };
     std::map< std::string, CBCHistos > cbcHMap_;
+    std::vector<CBCHistos*> cbcHTable_;     // by FE * cbcTableStride_ + CBC, resolved in bookHistos, nullptr for CBCs without histograms
+    uint32_t cbcTableStride_;
+    std::vector<std::array<HitPosition, NCHANNELS>> geometry_;  // by CBC Id
+    std::vector<HitPosition> evenHits_;     // hits of the current event, kept to reuse their storage
+    std::vector<HitPosition> oddHits_;
 
     TH2I* hitCorrC0H_;
     TH2I* hitCorrC1H_;
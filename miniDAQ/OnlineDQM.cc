@@ -0,0 +1,155 @@
+/*
+
+        FileName :                    OnlineDQM.cc
+        Content :                     DQM of a running acquisition, fed with prescaled copies of the packets read from the board
+        Version :                     1.0
+
+ */
+
+#include "OnlineDQM.h"
+#include "publisher.h"
+
+#include "TROOT.h"
+#include "RVersion.h"
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+#include "TThread.h"
+#endif
+
+using namespace Ph2_HwDescription;
+using namespace Ph2_HwInterface;
+
+OnlineDQM::OnlineDQM ( BeBoardFWInterface* pBoardFW, const BeBoard* pBoard, const std::string& pRunLabel, const std::string& pDirectory,
+                       int pNColumn ) :
+    fBoardFW ( pBoardFW ),
+    fBoard ( pBoard ),
+    fRunLabel ( pRunLabel ),
+    fDirectory ( pDirectory ),
+    fRootFile ( pRunLabel + "_dqm.root" ),
+    fNColumn ( pNColumn ),
+    fStop ( false ),
+    fNEvents ( 0 ),
+    fNEventsPublished ( 0 ),
+    fRefreshInterval ( 30 )
+{
+    if ( !fDirectory.empty() && fDirectory.back() != '/' ) fDirectory += "/";
+}
+
+OnlineDQM::~OnlineDQM()
+{
+    if ( fThread.joinable() )
+    {
+        fStop = true;
+        fThread.join();
+    }
+}
+
+void OnlineDQM::Start ( uint32_t pPrescale, uint32_t pQueueSize )
+{
+    if ( fThread.joinable() )
+    {
+        LOG (INFO) << "Online DQM already running" ;
+        return;
+    }
+
+    // the histograms are booked and filled in the DQM thread while the main thread may still use ROOT
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+    gROOT->SetBatch ( true );
+
+    // the event filter of the histogrammer follows the layout of a raw file, it does not apply to a sampled stream
+    fHistogrammer.reset ( new DQMHistogrammer ( false, fNColumn, false, false ) );
+    fNEvents = 0;
+    fNEventsPublished = 0;
+    fStop = false;
+
+    fBoardFW->AttachMonitor ( pPrescale, pQueueSize );
+    fThread = std::thread ( &OnlineDQM::loop, this );
+
+    LOG (INFO) << "Online DQM of one packet out of " << pPrescale << ", published to " << fDirectory << " every " << fRefreshInterval.count() << " s" ;
+}
+
+void OnlineDQM::Stop()
+{
+    if ( !fThread.joinable() ) return;
+
+    fStop = true;
+    fThread.join();
+    fBoardFW->DetachMonitor();
+
+    LOG (INFO) << "Online DQM: " << fNEvents.load() << " events filled, " << fBoardFW->GetMonitorDropped() << " packets dropped" ;
+}
+
+void OnlineDQM::loop()
+{
+    auto cNextRefresh = std::chrono::steady_clock::now() + fRefreshInterval;
+
+    try
+    {
+        while ( !fStop )
+        {
+            if ( !processPacket() )
+                std::this_thread::sleep_for ( std::chrono::milliseconds ( 10 ) );
+
+            if ( fRefreshInterval.count() > 0 && std::chrono::steady_clock::now() >= cNextRefresh )
+            {
+                if ( fNEvents > fNEventsPublished ) publish();
+
+                cNextRefresh = std::chrono::steady_clock::now() + fRefreshInterval;
+            }
+        }
+
+        // the copies of the last packets of the run are still queued
+        while ( processPacket() );
+
+        if ( fNEvents > fNEventsPublished ) publish();
+    }
+    catch ( std::exception& e )
+    {
+        // the readout goes on, the monitor queue just stays full and the further copies are dropped
+        LOG (ERROR) << "Online DQM stopped: " << e.what() ;
+    }
+}
+
+bool OnlineDQM::processPacket()
+{
+    RawPacket cPacket;
+
+    if ( !fBoardFW->PopMonitorPacket ( cPacket ) ) return false;
+
+    // an empty packet has no event size, give its buffer back and go on with the next one
+    if ( cPacket.fNevents == 0 )
+    {
+        fBoardFW->RecycleMonitorBuffer ( std::move ( cPacket.fWords ) );
+        return true;
+    }
+
+    uint32_t cEventSize = cPacket.fWords.size() / cPacket.fNevents;
+    uint64_t cFirstEvent = cPacket.fFirstEvent;
+    uint32_t cNevents = cPacket.fNevents;
+
+    fData.Set ( fBoard, std::move ( cPacket.fWords ), cPacket.fNevents, cPacket.fSwapBits );
+    fBoardFW->RecycleMonitorBuffer ( std::move ( cPacket.fWords ) );
+
+    const std::vector<Event*>& cEvents = fData.GetEvents ( fBoard );
+
+    if ( cEvents.empty() ) return true;
+
+    if ( fNEvents == 0 ) fHistogrammer->bookHistos ( cEvents.at ( 0 )->GetCbcKeys() );
+
+    // the trend histograms are filled at the position of the events in the run, not in the sample
+    fHistogrammer->fillHistos ( cEvents, cFirstEvent, cEventSize );
+    fNEvents += cNevents;
+    return true;
+}
+
+void OnlineDQM::publish()
+{
+    fHistogrammer->saveHistos ( fRootFile );
+    RootWeb::makeDQMmonitor ( fRootFile, fDirectory, fRunLabel );
+    fNEventsPublished = fNEvents;
+
+    LOG (INFO) << "Online DQM: " << fNEvents.load() << " events published to " << fDirectory ;
+}
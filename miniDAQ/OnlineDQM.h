@@ -0,0 +1,103 @@
+/*!
+
+        \file                   OnlineDQM.h
+        \brief                  DQM of a running acquisition, fed with prescaled copies of the packets read from the board
+        \version                1.0
+
+ */
+
+#ifndef __ONLINEDQM_H__
+#define __ONLINEDQM_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include "../HWInterface/BeBoardFWInterface.h"
+#include "../HWDescription/BeBoard.h"
+#include "../Utils/Data.h"
+#include "DQMHistogrammer.h"
+
+/*!
+ * \class OnlineDQM
+ * \brief Fills a DQMHistogrammer in a thread of its own while the run is taken and publishes it periodically
+ * The packets come from the monitor of the board FW interface, which copies every prescale-th packet and drops the
+ * copy rather than wait when this thread is behind: the readout is never slowed down by the DQM.
+ * Every refresh interval the histograms are written to <run>_dqm.root and the RootWeb page is rebuilt from it.
+ */
+class OnlineDQM
+{
+  public:
+    /*!
+     * \brief Constructor of the OnlineDQM class
+     * \param pBoardFW : FW interface of the board taking the run
+     * \param pBoard : description of that board, to decode its events
+     * \param pRunLabel : label of the run, names the ROOT file and the page
+     * \param pDirectory : directory of the DQM page
+     * \param pNColumn : number of sensor columns, see DQMHistogrammer
+     */
+    OnlineDQM ( Ph2_HwInterface::BeBoardFWInterface* pBoardFW, const Ph2_HwDescription::BeBoard* pBoard, const std::string& pRunLabel,
+                const std::string& pDirectory, int pNColumn = 2 );
+    /*!
+     * \brief Destructor of the OnlineDQM class, stops the thread if Stop was not called
+     */
+    ~OnlineDQM();
+
+    OnlineDQM ( const OnlineDQM& ) = delete;
+    OnlineDQM& operator= ( const OnlineDQM& ) = delete;
+
+    /*!
+     * \brief Seconds between two refreshes of the ROOT file and the page, 0 to publish only at the end
+     */
+    void SetRefreshInterval ( uint32_t pSeconds )
+    {
+        fRefreshInterval = std::chrono::seconds ( pSeconds );
+    }
+    /*!
+     * \brief Attach to the board and start the DQM thread, before the DAQ or the acquisition thread is started
+     * \param pPrescale : process one packet out of pPrescale
+     * \param pQueueSize : number of packet copies that can wait for the DQM thread
+     */
+    void Start ( uint32_t pPrescale, uint32_t pQueueSize = 16 );
+    /*!
+     * \brief Process the packets still queued, publish the final histograms and detach, after the acquisition thread is stopped
+     */
+    void Stop();
+
+    uint64_t GetNEvents() const
+    {
+        return fNEvents;
+    }
+
+  private:
+    Ph2_HwInterface::BeBoardFWInterface* fBoardFW;
+    const Ph2_HwDescription::BeBoard* fBoard;
+    std::string fRunLabel;
+    std::string fDirectory;
+    std::string fRootFile;
+    int fNColumn;
+
+    std::unique_ptr<DQMHistogrammer> fHistogrammer;     /*!< booked with the CBCs of the first event */
+    Ph2_HwInterface::Data fData;                        /*!< decodes the packets, its storage is cycled with the monitor buffers */
+
+    std::thread fThread;
+    std::atomic<bool> fStop;
+    std::atomic<uint64_t> fNEvents;                     /*!< events filled */
+    uint64_t fNEventsPublished;                         /*!< events filled at the last refresh */
+    std::chrono::seconds fRefreshInterval;
+
+    void loop();
+    /*!
+     * \brief Decode and fill the next monitor packet
+     * \return false if no packet was waiting
+     */
+    bool processPacket();
+    /*!
+     * \brief Write the histograms to the ROOT file and rebuild the page
+     */
+    void publish();
+};
+
+#endif
@@ -15,6 +15,7 @@
 #include "../System/SystemController.h"
 #include "TString.h"
 #include <sys/stat.h>
+#include "OnlineDQM.h"
 
 
 using namespace Ph2_HwDescription;
@@ -113,12 +114,25 @@ int main ( int argc, char* argv[] )
     cmd.defineOption ( "events", "Number of Events . Default value: 10", ArgvParser::OptionRequiresValue /*| ArgvParser::OptionRequired*/ );
     cmd.defineOptionAlternative ( "events", "e" );
 
-    //cmd.defineOption( "parallel", "Acquisition running in parallel in a separate thread" );
-    //cmd.defineOptionAlternative( "parallel", "p" );
+    cmd.defineOption ( "parallel", "Acquisition running in parallel in a separate thread" );
+    cmd.defineOptionAlternative ( "parallel", "p" );
 
     cmd.defineOption ( "dqm", "Print every i-th event.  ", ArgvParser::OptionRequiresValue );
     cmd.defineOptionAlternative ( "dqm", "d" );
 
+    cmd.defineOption ( "onlinedqm", "Fill the DQM histograms during the run with one packet out of N, without slowing the readout", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "onlinedqm", "m" );
+
+    cmd.defineOption ( "refresh", "Seconds between two updates of the online DQM page. Default value: 30", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "refresh", "r" );
+
+    cmd.defineOption ( "output", "Output Directory for the online DQM page. Default value: Results", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "output", "o" );
+
+    cmd.defineOption ( "ring", "Publish the raw packets in the shared memory ring of this name for other processes, see ringreader", ArgvParser::OptionRequiresValue );
+
+    cmd.defineOption ( "ringsize", "Size of the shared memory ring in MB. Default value: 64", ArgvParser::OptionRequiresValue );
+
     int result = cmd.parse ( argc, argv );
 
     if ( result != ArgvParser::NoParserError )
@@ -149,33 +163,69 @@ int main ( int argc, char* argv[] )
 
     BeBoard* pBoard = cSystemController.fBoardVector.at ( 0 );
 
-    //if ( cmd.foundOption ( "parallel" ) )
-    //{
-    //uint32_t nbPacket = pBoard->getReg ( "pc_commands.CBC_DATA_PACKET_NUMBER" ), nbAcq = pEventsperVcth / ( nbPacket + 1 ) + ( pEventsperVcth % ( nbPacket + 1 ) != 0 ? 1 : 0 );
-    //std::cout << "Packet number=" << nbPacket << ", Nb events=" << pEventsperVcth << " -> Nb acquisition iterations=" << nbAcq << std::endl;
-
-    //AcqVisitor visitor;
-    //std::cout << "Press Enter to start the acquisition, press Enter again to stop i" << std::endl;
-    //std::cin.ignore();
-    //cSystemController.fBeBoardInterface->StartThread ( pBoard, nbAcq, &visitor );
-    //std::cin.ignore();
-    //cSystemController.fBeBoardInterface->StopThread ( pBoard );
-    //}
-    //else
-    //{
+    // in parallel mode the board is read out in its own thread while this one decodes and prints the previous packet
+    bool cParallel = cmd.foundOption ( "parallel" );
+
+    // the ring is filled by the readout, it is set up before and removed after the acquisition
+    std::unique_ptr<EventRingWriter> cRing;
+
+    if ( cmd.foundOption ( "ring" ) )
+    {
+        uint32_t cRingSizeMB = ( cmd.foundOption ( "ringsize" ) ) ? convertAnyInt ( cmd.optionValue ( "ringsize" ).c_str() ) : 64;
+        cRing.reset ( new EventRingWriter ( cmd.optionValue ( "ring" ), size_t ( cRingSizeMB ) << 20 ) );
+
+        if ( cRing->isOpen() )
+        {
+            cSystemController.fBeBoardFWMap[pBoard->getBeBoardIdentifier()]->SetEventRing ( cRing.get() );
+            LOG (INFO) << "Publishing the packets in the shared memory ring " << cRing->getName() ;
+        }
+        else cRing.reset();
+    }
+
+    // the online DQM samples the packets in its own thread, it attaches before the readout starts
+    std::unique_ptr<OnlineDQM> cOnlineDQM;
+
+    if ( cmd.foundOption ( "onlinedqm" ) )
+    {
+        std::string cRunLabel = cOutputFile.substr ( cOutputFile.find_last_of ( '/' ) + 1 );
+        cRunLabel = cRunLabel.substr ( 0, cRunLabel.find_last_of ( '.' ) );
+        std::string cDirBasePath = ( cmd.foundOption ( "output" ) ) ? cmd.optionValue ( "output" ) : "Results";
+
+        cOnlineDQM.reset ( new OnlineDQM ( cSystemController.fBeBoardFWMap[pBoard->getBeBoardIdentifier()], pBoard, cRunLabel, cDirBasePath ) );
+        cOnlineDQM->SetRefreshInterval ( ( cmd.foundOption ( "refresh" ) ) ? convertAnyInt ( cmd.optionValue ( "refresh" ).c_str() ) : 30 );
+        cOnlineDQM->Start ( convertAnyInt ( cmd.optionValue ( "onlinedqm" ).c_str() ) );
+    }
+
     // make event counter start at 1 as does the L1A counter
     uint32_t cN = 1;
     uint32_t cNthAcq = 0;
     uint32_t count = 0;
 
-    cSystemController.fBeBoardInterface->Start ( pBoard );
+    if ( cParallel ) cSystemController.fBeBoardInterface->StartAcquisitionThread ( pBoard );
+    else cSystemController.fBeBoardInterface->Start ( pBoard );
 
     while ( cN <= pEventsperVcth )
     {
-        uint32_t cPacketSize = cSystemController.fBeBoardInterface->ReadData ( pBoard, false );
+        uint32_t cPacketSize;
+
+        if ( cParallel )
+        {
+            cPacketSize = cSystemController.fBeBoardInterface->ReadPacket ( pBoard );
+
+            if ( cPacketSize == 0 )
+            {
+                if ( !cSystemController.fBeBoardInterface->IsAcquisitionThreadRunning ( pBoard ) ) break;
+
+                continue;
+            }
+        }
+        else
+        {
+            cPacketSize = cSystemController.fBeBoardInterface->ReadData ( pBoard, false );
 
-        if ( cN + cPacketSize >= pEventsperVcth )
-            cSystemController.fBeBoardInterface->Stop ( pBoard );
+            if ( cN + cPacketSize >= pEventsperVcth )
+                cSystemController.fBeBoardInterface->Stop ( pBoard );
+        }
 
         const std::vector<Event*>& events = cSystemController.GetEvents ( pBoard );
 
@@ -202,6 +252,15 @@ int main ( int argc, char* argv[] )
         cNthAcq++;
     }
 
-    //}
+    if ( cParallel ) cSystemController.fBeBoardInterface->StopAcquisitionThread ( pBoard );
+
+    if ( cOnlineDQM ) cOnlineDQM->Stop();
+
+    if ( cRing )
+    {
+        cSystemController.fBeBoardFWMap[pBoard->getBeBoardIdentifier()]->SetEventRing ( nullptr );
+        LOG (INFO) << "Shared memory ring: " << cRing->GetNPackets() << " packets published" << cRing->ConsumerStatus() ;
+    }
+
     cSystemController.Destroy();
 }
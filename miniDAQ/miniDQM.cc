@@ -6,6 +6,8 @@
 #include <map>
 #include <sstream>
 #include <inttypes.h>
+#include <thread>
+#include <exception>
 
 #include "../Utils/Utilities.h"
 #include "../Utils/Data.h"
@@ -13,9 +15,14 @@
 #include "../Utils/Timer.h"
 #include "../Utils/argvparser.h"
 #include "../Utils/ConsoleColor.h"
+#include "../Utils/MappedRawFile.h"
 #include "../System/SystemController.h"
 
 #include "TROOT.h"
+#include "RVersion.h"
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+#include "TThread.h"
+#endif
 #include "publisher.h"
 #include "DQMHistogrammer.h"
 
@@ -58,6 +65,83 @@ void dumpEvents ( const std::vector<Event*>& elist, size_t evt_limit )
     }
 }
 
+// fill the histograms of dqmh with nthreads workers, each decoding and filling a contiguous range of events of the
+// memory mapped file into a histogram set of its own; the sets are merged in file order at the end
+long fillParallel ( DQMHistogrammer* dqmh, const BeBoard* pBoard, const std::vector<uint16_t>& cbcKeys, const std::string& rawFilename,
+                    int eventSize, long lastevt, int maxevt, int nthreads, bool cReverse, bool cSwap )
+{
+    MappedRawFile cMap ( rawFilename );
+
+    if ( !cMap.isOpen() )
+    {
+        LOG (ERROR) << "Error!! could not map " << rawFilename << ", exiting!";
+        exit ( 5 );
+    }
+
+    // the event size given by the CBC type wins over the header, as in the serial mode
+    uint64_t cNEventsInFile = cMap.getNWords32() / eventSize;
+    uint64_t cFirstEvent = ( lastevt > 0 && cNEventsInFile > uint64_t ( lastevt ) ) ? cNEventsInFile - lastevt : 0;
+    uint64_t cNEvents = cNEventsInFile - cFirstEvent;
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+    ROOT::EnableThreadSafety();
+#else
+    TThread::Initialize();
+#endif
+
+    // the worker sets are booked here, ROOT object creation is kept out of the threads
+    std::vector<DQMHistogrammer*> workers;
+
+    for ( int i = 0; i < nthreads; i++ )
+        workers.push_back ( dqmh->makeWorker ( cbcKeys, i ) );
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors ( nthreads );
+
+    for ( int i = 0; i < nthreads; i++ )
+    {
+        uint64_t cBegin = cFirstEvent + cNEvents * i / nthreads;
+        uint64_t cEnd = cFirstEvent + cNEvents * ( i + 1 ) / nthreads;
+
+        threads.emplace_back ( [&, i, cBegin, cEnd]
+        {
+            try
+            {
+                for ( uint64_t cEvent = cBegin; cEvent < cEnd; cEvent += maxevt )
+                {
+                    uint32_t nEvents = std::min<uint64_t> ( maxevt, cEnd - cEvent );
+                    const uint32_t* cWords = cMap.getData() + cEvent * eventSize;
+                    Data d;
+                    d.Set ( pBoard, std::vector<uint32_t> ( cWords, cWords + nEvents * eventSize ), nEvents, cReverse, cSwap );
+                    // the event numbering of the histograms counts from the first processed event, as in the serial mode
+                    workers[i]->fillHistos ( d.GetEvents ( pBoard ), cEvent - cFirstEvent, eventSize );
+                }
+            }
+            catch ( ... )
+            {
+                errors[i] = std::current_exception();
+            }
+        } );
+    }
+
+    for ( auto& cThread : threads )
+        cThread.join();
+
+    for ( auto& cError : errors )
+    {
+        if ( cError ) std::rethrow_exception ( cError );
+    }
+
+    for ( auto worker : workers )
+    {
+        dqmh->mergeHistos ( *worker );
+        delete worker;
+    }
+
+    LOG (INFO) << "eventSize = "  << eventSize << ", totalEventsRead = " << cNEvents << " with " << nthreads << " threads";
+    return cNEvents;
+}
+
 int main ( int argc, char* argv[] )
 {
     //configure the logger
@@ -103,9 +187,15 @@ int main ( int argc, char* argv[] )
     cmd.defineOption ( "nevt", "Specify number of events to be read from file at a time", ArgvParser::OptionRequiresValue /*| ArgvParser::OptionRequired*/ );
     cmd.defineOptionAlternative ( "nevt", "n" );
 
+    cmd.defineOption ( "threads", "Decode and fill the DQM histograms with N threads, each working on its own part of the file. Default = 1", ArgvParser::OptionRequiresValue /*| ArgvParser::OptionRequired*/ );
+    cmd.defineOptionAlternative ( "threads", "j" );
+
     cmd.defineOption ( "skipDebugHist", "Switch off debug histograms. Default = false", ArgvParser::NoOptionAttribute /*| ArgvParser::OptionRequired*/ );
     cmd.defineOptionAlternative ( "skipDebugHist", "g" );
 
+    cmd.defineOption ( "last", "Only process the last N events of the file with --dqm, e.g. the tail of a run still being taken", ArgvParser::OptionRequiresValue /*| ArgvParser::OptionRequired*/ );
+    cmd.defineOptionAlternative ( "last", "t" );
+
     std::map<std::string, pair<int, std::string>>  cbcTypeEvtSizeMap;
     cbcTypeEvtSizeMap["2"] = { 2, XML_DESCRIPTION_FILE_2CBC };
     cbcTypeEvtSizeMap["4"] = { 4, XML_DESCRIPTION_FILE_4CBC };
@@ -151,6 +241,8 @@ int main ( int argc, char* argv[] )
     bool evtFilter = ( cmd.foundOption ( "filter" ) ) ? true : false;
     int maxevt     = ( cmd.foundOption ( "nevt" ) ) ? stoi (cmd.optionValue ( "nevt" ) ) : 100000;
     bool skipHist  = ( cmd.foundOption ( "skipDebugHist" ) ) ? true : false;
+    long lastevt   = ( cmd.foundOption ( "last" ) ) ? stol (cmd.optionValue ( "last" ) ) : 0;
+    int nthreads   = ( cmd.foundOption ( "threads" ) ) ? stoi (cmd.optionValue ( "threads" ) ) : 1;
 
     // Create the Histogrammer object
     DQMHistogrammer* dqmh = new DQMHistogrammer (addTree, ncol, evtFilter, skipHist);
@@ -185,29 +277,44 @@ int main ( int argc, char* argv[] )
     if ( cDQMPage )
     {
         gROOT->SetBatch ( true );
-        dqmh->bookHistos (elist.at (0)->GetEventDataMap() );
-
-        // now read the whole file in chunks of maxevt
-        dqmh->getFileHandler()->rewind();
-        long ntotevt = 0;
+        dqmh->bookHistos (elist.at (0)->GetCbcKeys() );
 
-        while ( 1 )
+        if ( nthreads > 1 ) fillParallel ( dqmh, pBoard, elist.at (0)->GetCbcKeys(), rawFilename, eventSize, lastevt, maxevt, nthreads, cReverse, cSwap );
+        else
         {
-            dataVec.clear();
-            dqmh->readFile (dataVec, maxevt * eventSize);
-            nEvents = dataVec.size() / eventSize;
-
-            if (!nEvents) break;
-
-            d.Set ( pBoard, dataVec, nEvents, cReverse, cSwap );
-            const std::vector<Event*>& evlist = d.GetEvents ( pBoard );
-            dqmh->fillHistos (evlist, ntotevt, eventSize);
-            ntotevt += nEvents;
-            LOG (INFO) << "eventSize = "  << eventSize
-                       << ", eventsRead = " << nEvents
-                       << ", totalEventsRead = " << ntotevt;
-
-            if ( !dqmh->getFileHandler()->file_open() ) break;
+            // now read the whole file (or only its last events) in chunks of maxevt
+            FileHandler* cHandler = dqmh->getFileHandler();
+
+            if ( lastevt > 0 )
+            {
+                // files without header do not know their event size
+                if ( cHandler->fHeader.fEventSize32 == 0 ) cHandler->fHeader.fEventSize32 = eventSize;
+
+                uint64_t cNEventsInFile = cHandler->eventCount();
+                cHandler->seekEvent ( ( cNEventsInFile > uint64_t ( lastevt ) ) ? cNEventsInFile - lastevt : 0 );
+            }
+            else cHandler->rewind();
+
+            long ntotevt = 0;
+
+            while ( 1 )
+            {
+                dataVec.clear();
+                dqmh->readFile (dataVec, maxevt * eventSize);
+                nEvents = dataVec.size() / eventSize;
+
+                if (!nEvents) break;
+
+                d.Set ( pBoard, dataVec, nEvents, cReverse, cSwap );
+                const std::vector<Event*>& evlist = d.GetEvents ( pBoard );
+                dqmh->fillHistos (evlist, ntotevt, eventSize);
+                ntotevt += nEvents;
+                LOG (INFO) << "eventSize = "  << eventSize
+                           << ", eventsRead = " << nEvents
+                           << ", totalEventsRead = " << ntotevt;
+
+                if ( !dqmh->getFileHandler()->file_open() ) break;
+            }
         }
 
         // Create the DQM plots and generate the root file
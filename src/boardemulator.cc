@@ -0,0 +1,93 @@
+#include <atomic>
+#include <csignal>
+#include "../Utils/Utilities.h"
+#include "../Utils/argvparser.h"
+#include "../Utils/ConsoleColor.h"
+#include "../Utils/easylogging++.h"
+#include "../Emulator/IPbusServer.h"
+
+using namespace Ph2_Emulator;
+using namespace CommandLineProcessing;
+
+INITIALIZE_EASYLOGGINGPP
+
+std::atomic<bool> gStop ( false );
+
+void stopServer ( int pSignal )
+{
+    gStop = true;
+}
+
+int main ( int argc, char* argv[] )
+{
+    //configure the logger
+    el::Configurations conf ("settings/logger.conf");
+    el::Loggers::reconfigureAllLoggers (conf);
+
+    ArgvParser cmd;
+
+    // init
+    cmd.setIntroductoryDescription ( "CMS Ph2_ACF  Emulator of a board running the IC firmware with CBC2s, served over IPbus 2.0 UDP. Point the connection of the HW description file to ipbusudp-2.0://127.0.0.1:<port>, see settings/ICEmulator.xml" );
+    // error codes
+    cmd.addErrorCode ( 0, "Success" );
+    cmd.addErrorCode ( 1, "Error" );
+    // options
+    cmd.setHelpOption ( "h", "help", "Print this help page" );
+
+    cmd.defineOption ( "port", "UDP port to listen on. Default value: 50001", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "port", "p" );
+
+    cmd.defineOption ( "table", "uHAL address table of the IC firmware. Default value: settings/IC_address_table.xml", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "table", "t" );
+
+    cmd.defineOption ( "ncbc", "Number of CBCs on FMC 1. Default value: 2", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "ncbc", "n" );
+
+    cmd.defineOption ( "rate", "Trigger rate in Hz while the DAQ runs, 0 to have a full packet at every poll. Default value: 100000", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "rate", "r" );
+
+    cmd.defineOption ( "noise", "Noise of the CBC channels in VCth units. Default value: 2", ArgvParser::OptionRequiresValue );
+
+    cmd.defineOption ( "occupancy", "Extra hit probability of the unmasked channels. Default value: 0", ArgvParser::OptionRequiresValue );
+
+    cmd.defineOption ( "cbcfile", "CBC register file loaded at a hard reset. Default value: settings/Cbc_default_hole.txt", ArgvParser::OptionRequiresValue );
+
+    cmd.defineOption ( "seed", "Seed of the random numbers. Default value: 1", ArgvParser::OptionRequiresValue );
+
+    int result = cmd.parse ( argc, argv );
+
+    if ( result != ArgvParser::NoParserError )
+    {
+        LOG (INFO) << cmd.parseErrorDescription ( result );
+        exit ( 1 );
+    }
+
+    EmulatorSettings cSettings;
+    uint16_t cPort = ( cmd.foundOption ( "port" ) ) ? convertAnyInt ( cmd.optionValue ( "port" ).c_str() ) : 50001;
+    std::string cTableFile = ( cmd.foundOption ( "table" ) ) ? cmd.optionValue ( "table" ) : "settings/IC_address_table.xml";
+
+    if ( cmd.foundOption ( "ncbc" ) ) cSettings.fNCbc = convertAnyInt ( cmd.optionValue ( "ncbc" ).c_str() );
+
+    if ( cmd.foundOption ( "rate" ) ) cSettings.fTriggerRate = atof ( cmd.optionValue ( "rate" ).c_str() );
+
+    if ( cmd.foundOption ( "noise" ) ) cSettings.fNoise = atof ( cmd.optionValue ( "noise" ).c_str() );
+
+    if ( cmd.foundOption ( "occupancy" ) ) cSettings.fOccupancy = atof ( cmd.optionValue ( "occupancy" ).c_str() );
+
+    if ( cmd.foundOption ( "cbcfile" ) ) cSettings.fCbcFile = cmd.optionValue ( "cbcfile" );
+
+    if ( cmd.foundOption ( "seed" ) ) cSettings.fSeed = convertAnyInt ( cmd.optionValue ( "seed" ).c_str() );
+
+    AddressTable cTable ( cTableFile );
+    ICBoardEmulator cBoard ( cTable, cSettings );
+    IPbusServer cServer ( cBoard, cPort );
+
+    signal ( SIGINT, stopServer );
+    signal ( SIGTERM, stopServer );
+
+    LOG (INFO) << BOLDGREEN << "Emulating an IC firmware board with " << cSettings.fNCbc << " CBCs at ipbusudp-2.0://127.0.0.1:" << cPort << RESET << ", Ctrl-C to stop" ;
+    cServer.Run ( gStop );
+    LOG (INFO) << "Served " << cServer.getNPackets() << " packets with " << cServer.getNTransactions() << " transactions, " << cBoard.getNTriggers() << " triggers" ;
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <cstring>
+#include "../Utils/Utilities.h"
+#include <set>
+#include <vector>
+#include <inttypes.h>
+#include "../Utils/Data.h"
+#include "../Utils/MappedRawFile.h"
+#include "../Utils/Timer.h"
+#include "../Utils/argvparser.h"
+#include "../Utils/ConsoleColor.h"
+#include "../HWDescription/BeBoard.h"
+#include "../HWDescription/Definition.h"
+
+using namespace Ph2_HwDescription;
+using namespace Ph2_HwInterface;
+using namespace CommandLineProcessing;
+
+INITIALIZE_EASYLOGGINGPP
+
+// the word by word decode Data::Set used before the batch kernels, kept as the reference
+uint32_t reverse_bits ( uint32_t n )
+{
+    n = ( (n >> 1) & 0x55555555) | ( (n << 1) & 0xaaaaaaaa) ;
+    n = ( (n >> 2) & 0x33333333) | ( (n << 2) & 0xcccccccc) ;
+    n = ( (n >> 4) & 0x0f0f0f0f) | ( (n << 4) & 0xf0f0f0f0) ;
+    n = ( (n >> 8) & 0x00ff00ff) | ( (n << 8) & 0xff00ff00) ;
+    n = ( (n >> 16) & 0x0000ffff) | ( (n << 16) & 0xffff0000) ;
+    return n;
+}
+
+void referenceDecode ( std::vector<uint32_t>& pData, uint32_t pEventSize )
+{
+    const std::set<uint32_t> cChannelFirstRows {5, 14, 23, 32, 41, 50, 59, 68};
+    const std::set<uint32_t> cChannelLastRows {13, 22, 31, 40, 49, 58, 67, 76};
+    uint32_t cNCbc = ( pEventSize - ( EVENT_HEADER_TDC_SIZE_32 ) ) / ( CBC_EVENT_SIZE_32 );
+
+    for ( uint32_t cWordIndex = 0; cWordIndex < pData.size(); cWordIndex++ )
+    {
+        uint32_t cSwapIndex = cWordIndex % pEventSize;
+        uint32_t& word = pData[cWordIndex];
+
+        if ( cChannelFirstRows.count ( cSwapIndex ) && cSwapIndex < pEventSize - 1 )
+        {
+            uint8_t cPipeAddress = (word & 0x000003FC) >> 2;
+            word = reverse_bits (word) & 0xC03FFFFF;
+            word |=  cPipeAddress << 22;
+        }
+
+        if ( cChannelLastRows.count ( cSwapIndex ) )
+        {
+            uint16_t cStubWord = (word & 0xFFF00000) >> 20;
+            word = reverse_bits (word) & 0xFFFFF000;
+            word |= (cStubWord & 0x0FFF);
+        }
+        else if ( cSwapIndex > 4 && cSwapIndex < (EVENT_HEADER_SIZE_32 + CBC_EVENT_SIZE_32 * cNCbc) ) word = reverse_bits (word);
+    }
+}
+
+int main ( int argc, char* argv[] )
+{
+    //configure the logger
+    el::Configurations conf ("settings/logger.conf");
+    el::Loggers::reconfigureAllLoggers (conf);
+
+    ArgvParser cmd;
+
+    // init
+    cmd.setIntroductoryDescription ( "CMS Ph2_ACF  Check of the batch decode kernels of the Imperial FW bit reversal against the word by word reference" );
+    // error codes
+    cmd.addErrorCode ( 0, "Success" );
+    cmd.addErrorCode ( 1, "Error" );
+    // options
+    cmd.setHelpOption ( "h", "help", "Print this help page" );
+
+    cmd.defineOption ( "file", "Raw file to decode", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "file", "f" );
+
+    cmd.defineOption ( "eventsize", "Event size in 32 bit words, only needed for files without header", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "eventsize", "s" );
+
+    cmd.defineOption ( "events", "Number of events per packet. Default value: 100", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "events", "e" );
+
+    int result = cmd.parse ( argc, argv );
+
+    if ( result != ArgvParser::NoParserError )
+    {
+        LOG (INFO) << cmd.parseErrorDescription ( result );
+        exit ( 1 );
+    }
+
+    if ( !cmd.foundOption ( "file" ) )
+    {
+        LOG (ERROR) << "No raw file given, use -f" ;
+        exit ( 1 );
+    }
+
+    std::string cFilename = cmd.optionValue ( "file" );
+    uint32_t cPacketEvents = ( cmd.foundOption ( "events" ) ) ? convertAnyInt ( cmd.optionValue ( "events" ).c_str() ) : 100;
+
+    MappedRawFile cMap ( cFilename );
+
+    if ( !cMap.isOpen() ) exit ( 1 );
+
+    uint32_t cEventSize32 = ( cmd.foundOption ( "eventsize" ) ) ? convertAnyInt ( cmd.optionValue ( "eventsize" ).c_str() ) : cMap.getEventSize32();
+
+    if ( cEventSize32 <= EVENT_HEADER_TDC_SIZE_32 || cPacketEvents == 0 )
+    {
+        LOG (ERROR) << "The event size is unknown or too small, give it with -s" ;
+        exit ( 1 );
+    }
+
+    uint64_t cNEvents = cMap.getNWords32() / cEventSize32;
+    LOG (INFO) << "Decoding " << cNEvents << " events of " << cEventSize32 << " words from " << cFilename ;
+
+    // the bit reversal does not look at the CBC layout, an empty board is enough
+    BeBoard cBoard ( 0 );
+    Data cData;
+    uint64_t cNMismatches = 0;
+
+    for ( auto& cKernel : Data::GetDecodeKernels() )
+    {
+        Data::SetDecodeKernel ( cKernel );
+        uint64_t cKernelMismatches = 0;
+        double cReferenceTime = 0, cKernelTime = 0;
+        Timer t;
+
+        for ( uint64_t cEvent = 0; cEvent < cNEvents; cEvent += cPacketEvents )
+        {
+            uint32_t cNPacketEvents = std::min<uint64_t> ( cPacketEvents, cNEvents - cEvent );
+            const uint32_t* cBegin = cMap.getEvent ( cEvent );
+            std::vector<uint32_t> cPacket ( cBegin, cBegin + cNPacketEvents * cEventSize32 );
+
+            t.start();
+            cData.Set ( &cBoard, cPacket, cNPacketEvents, true );
+            t.stop();
+            cKernelTime += t.getElapsedTime();
+
+            t.start();
+            referenceDecode ( cPacket, cEventSize32 );
+            t.stop();
+            cReferenceTime += t.getElapsedTime();
+
+            const std::vector<uint32_t>& cDecoded = cData.GetBuffer();
+
+            for ( uint32_t cWord = 0; cWord < cPacket.size(); cWord++ )
+            {
+                if ( cDecoded[cWord] == cPacket[cWord] ) continue;
+
+                // only the first few are worth printing
+                if ( cKernelMismatches < 10 )
+                    LOG (ERROR) << RED << cKernel << ": event " << cEvent + cWord / cEventSize32 << " word " << cWord % cEventSize32 << " decoded 0x" << std::hex << cDecoded[cWord] << " instead of 0x" << cPacket[cWord] << std::dec << RESET ;
+
+                cKernelMismatches++;
+            }
+        }
+
+        if ( cKernelMismatches ) LOG (ERROR) << BOLDRED << cKernel << ": " << cKernelMismatches << " words differ from the reference" << RESET ;
+        else LOG (INFO) << BOLDGREEN << cKernel << ": all words match the reference" << RESET << " (" << cKernelTime << " s, reference " << cReferenceTime << " s)" ;
+
+        cNMismatches += cKernelMismatches;
+    }
+
+    return ( cNMismatches ) ? 1 : 0;
+}
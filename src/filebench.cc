@@ -0,0 +1,187 @@
+#include <cstring>
+#include "../Utils/Utilities.h"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <inttypes.h>
+#include "../Utils/FileHandler.h"
+#include "../Utils/MappedRawFile.h"
+#include "../Utils/Timer.h"
+#include "../Utils/argvparser.h"
+#include "../Utils/ConsoleColor.h"
+#include "../HWDescription/Definition.h"
+
+using namespace CommandLineProcessing;
+
+INITIALIZE_EASYLOGGINGPP
+
+// the read loop FileHandler::readFileChunks used before the bulk reads, kept as the reference
+std::vector<uint32_t> readChunkWordByWord ( std::fstream& pFile, uint32_t pNWords32 )
+{
+    std::vector<uint32_t> cVector;
+    uint32_t cWordCounter = 0;
+
+    while (!pFile.eof() && cWordCounter < pNWords32)
+    {
+        char buffer[4];
+        pFile.read ( buffer, 4 );
+        uint32_t word;
+        std::memcpy ( &word, buffer, 4 );
+        cVector.push_back ( word );
+        cWordCounter++;
+    }
+
+    return cVector;
+}
+
+// sum of the words of all complete events, so that every method has to touch the same data
+uint64_t checksum ( const uint32_t* pWords, size_t pNWords32, uint32_t pEventSize32 )
+{
+    uint64_t cSum = 0;
+    size_t cNWords32 = pNWords32 - pNWords32 % pEventSize32;
+
+    for ( size_t cIndex = 0; cIndex < cNWords32; cIndex++ )
+        cSum += pWords[cIndex];
+
+    return cSum;
+}
+
+void report ( const std::string& pMethod, double pSeconds, uint64_t pBytes, uint64_t pSum )
+{
+    LOG (INFO) << BOLDBLUE << pMethod << RESET << ": " << pSeconds << " s, " << pBytes / pSeconds / 1e6 << " MB/s, checksum " << pSum ;
+}
+
+int main ( int argc, char* argv[] )
+{
+    //configure the logger
+    el::Configurations conf ("settings/logger.conf");
+    el::Loggers::reconfigureAllLoggers (conf);
+
+    ArgvParser cmd;
+
+    // init
+    cmd.setIntroductoryDescription ( "CMS Ph2_ACF  Benchmark of the raw file read paths: word by word, bulk reads and memory mapped" );
+    // error codes
+    cmd.addErrorCode ( 0, "Success" );
+    cmd.addErrorCode ( 1, "Error" );
+    // options
+    cmd.setHelpOption ( "h", "help", "Print this help page" );
+
+    cmd.defineOption ( "file", "Raw file to benchmark, it is created with synthetic events if it does not exist. Default value: /tmp/filebench.raw", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "file", "f" );
+
+    cmd.defineOption ( "size", "Size of the synthetic file in MB. Default value: 2048", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "size", "s" );
+
+    cmd.defineOption ( "events", "Number of events per chunk for the chunked reads. Default value: 1000", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "events", "e" );
+
+    cmd.defineOption ( "keep", "Do not delete the synthetic file at the end" );
+    cmd.defineOptionAlternative ( "keep", "k" );
+
+    int result = cmd.parse ( argc, argv );
+
+    if ( result != ArgvParser::NoParserError )
+    {
+        LOG (INFO) << cmd.parseErrorDescription ( result );
+        exit ( 1 );
+    }
+
+    std::string cFilename = ( cmd.foundOption ( "file" ) ) ? cmd.optionValue ( "file" ) : "/tmp/filebench.raw";
+    uint64_t cSizeMB = ( cmd.foundOption ( "size" ) ) ? convertAnyInt ( cmd.optionValue ( "size" ).c_str() ) : 2048;
+    uint32_t cChunkEvents = ( cmd.foundOption ( "events" ) ) ? convertAnyInt ( cmd.optionValue ( "events" ).c_str() ) : 1000;
+
+    // a 2 CBC board event, as written by miniDAQ
+    const uint32_t cEventSize32 = EVENT_HEADER_TDC_SIZE_32 + 2 * CBC_EVENT_SIZE_32;
+    bool cCreated = false;
+
+    if ( !std::ifstream ( cFilename ).good() )
+    {
+        LOG (INFO) << "Writing " << cSizeMB << " MB of synthetic events to " << cFilename ;
+        FileHeader cHeader ( "CBC2", 1, 0, 0, 2, cEventSize32 );
+        FileHandler cWriter ( cFilename, 'w', cHeader );
+
+        uint64_t cNEvents = ( cSizeMB << 20 ) / ( cEventSize32 * sizeof ( uint32_t ) );
+        std::vector<uint32_t> cPacket;
+        uint32_t cWord = 0;
+
+        for ( uint64_t cEvent = 0; cEvent < cNEvents; cEvent += cChunkEvents )
+        {
+            cPacket.resize ( std::min<uint64_t> ( cChunkEvents, cNEvents - cEvent ) * cEventSize32 );
+
+            for ( auto& cData : cPacket )
+                cData = cWord++ * 2654435761u;
+
+            cWriter.write ( cPacket );
+        }
+
+        cWriter.closeFile();
+        cCreated = true;
+    }
+
+    uint32_t cChunkWords = cChunkEvents * cEventSize32;
+    Timer t;
+
+    // 1) the former FileHandler reads: 4 bytes per fstream::read and a push_back per word
+    {
+        t.start();
+        std::fstream cFile ( cFilename, std::fstream::in | std::fstream::binary );
+        readChunkWordByWord ( cFile, FileHeader::fHeaderSize32 );
+        uint64_t cSum = 0, cBytes = 0;
+
+        while ( true )
+        {
+            std::vector<uint32_t> cChunk = readChunkWordByWord ( cFile, cChunkWords );
+
+            // the word by word loop appends one stale word when it runs into the end of the file
+            if ( cFile.eof() && !cChunk.empty() ) cChunk.pop_back();
+
+            if ( cChunk.empty() ) break;
+
+            cSum += checksum ( cChunk.data(), cChunk.size(), cEventSize32 );
+            cBytes += cChunk.size() * sizeof ( uint32_t );
+
+            if ( cFile.eof() ) break;
+        }
+
+        t.stop();
+        report ( "word by word", t.getElapsedTime(), cBytes, cSum );
+    }
+
+    // 2) FileHandler with one bulk read per chunk
+    {
+        t.start();
+        FileHandler cReader ( cFilename, 'r' );
+        uint64_t cSum = 0, cBytes = 0;
+
+        while ( cReader.file_open() )
+        {
+            std::vector<uint32_t> cChunk = cReader.readFileChunks ( cChunkWords );
+
+            if ( cChunk.empty() ) break;
+
+            cSum += checksum ( cChunk.data(), cChunk.size(), cEventSize32 );
+            cBytes += cChunk.size() * sizeof ( uint32_t );
+        }
+
+        t.stop();
+        report ( "bulk reads", t.getElapsedTime(), cBytes, cSum );
+    }
+
+    // 3) memory mapped, walking the file event by event without any copy
+    {
+        t.start();
+        MappedRawFile cMap ( cFilename );
+        uint64_t cSum = 0;
+
+        for ( const uint32_t* cEvent : cMap )
+            cSum += checksum ( cEvent, cEventSize32, cEventSize32 );
+
+        t.stop();
+        report ( "memory mapped", t.getElapsedTime(), cMap.getNEvents() * cEventSize32 * sizeof ( uint32_t ), cSum );
+    }
+
+    if ( cCreated && !cmd.foundOption ( "keep" ) ) std::remove ( cFilename.c_str() );
+
+    return 0;
+}
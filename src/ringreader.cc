@@ -0,0 +1,124 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include "../Utils/Utilities.h"
+#include "../Utils/argvparser.h"
+#include "../Utils/ConsoleColor.h"
+#include "../Utils/EventRing.h"
+#include "../Utils/FileHandler.h"
+#include "../Utils/easylogging++.h"
+
+using namespace CommandLineProcessing;
+
+INITIALIZE_EASYLOGGINGPP
+
+std::atomic<bool> gStop ( false );
+
+void stopReader ( int pSignal )
+{
+    gStop = true;
+}
+
+int main ( int argc, char* argv[] )
+{
+    //configure the logger
+    el::Configurations conf ("settings/logger.conf");
+    el::Loggers::reconfigureAllLoggers (conf);
+
+    ArgvParser cmd;
+
+    // init
+    cmd.setIntroductoryDescription ( "CMS Ph2_ACF  Consumer of the shared memory ring of a running miniDAQ --ring: counts the packets and optionally writes them to a raw file" );
+    // error codes
+    cmd.addErrorCode ( 0, "Success" );
+    cmd.addErrorCode ( 1, "Error" );
+    // options
+    cmd.setHelpOption ( "h", "help", "Print this help page" );
+
+    cmd.defineOption ( "ring", "Name of the shared memory ring", ArgvParser::OptionRequiresValue | ArgvParser::OptionRequired );
+    cmd.defineOptionAlternative ( "ring", "r" );
+
+    cmd.defineOption ( "lossless", "Hold the readout back rather than lose packets, by default the oldest packets are dropped when this reader is behind" );
+    cmd.defineOptionAlternative ( "lossless", "l" );
+
+    cmd.defineOption ( "save", "Write the packets read to this raw file, without file header", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "save", "s" );
+
+    cmd.defineOption ( "events", "Stop after this number of events. Default value: until the end of the run", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "events", "e" );
+
+    cmd.defineOption ( "name", "Name of this reader in the consumer status of the producer. Default value: ringreader", ArgvParser::OptionRequiresValue );
+    cmd.defineOptionAlternative ( "name", "n" );
+
+    int result = cmd.parse ( argc, argv );
+
+    if ( result != ArgvParser::NoParserError )
+    {
+        LOG (INFO) << cmd.parseErrorDescription ( result );
+        exit ( 1 );
+    }
+
+    EventRingMode cMode = ( cmd.foundOption ( "lossless" ) ) ? EventRingMode::Lossless : EventRingMode::DropOldest;
+    uint64_t cMaxEvents = ( cmd.foundOption ( "events" ) ) ? convertAnyInt ( cmd.optionValue ( "events" ).c_str() ) : 0;
+    std::string cName = ( cmd.foundOption ( "name" ) ) ? cmd.optionValue ( "name" ) : "ringreader";
+
+    EventRingReader cReader ( cmd.optionValue ( "ring" ), cMode, cName );
+
+    if ( !cReader.isOpen() ) exit ( 1 );
+
+    FileHandler* cFile = nullptr;
+
+    if ( cmd.foundOption ( "save" ) )
+    {
+        if ( cMode != EventRingMode::Lossless ) LOG (WARNING) << "The file will miss the packets dropped, use --lossless for a complete copy of the run" ;
+
+        cFile = new FileHandler ( cmd.optionValue ( "save" ), 'w' );
+    }
+
+    signal ( SIGINT, stopReader );
+    signal ( SIGTERM, stopReader );
+
+    EventRingPacket cPacket;
+    std::vector<uint32_t> cBuffer;
+    uint64_t cNEvents = 0, cNWords = 0, cLastNWords = 0;
+    auto cStart = std::chrono::steady_clock::now();
+    auto cLastReport = cStart;
+
+    while ( !gStop && ( cMaxEvents == 0 || cNEvents < cMaxEvents ) )
+    {
+        // the file writer needs its own copy, counting can look at the packet in place
+        bool cGot = ( cFile ) ? cReader.Read ( cBuffer, cPacket, 1000 ) : cReader.Next ( cPacket, 1000 ) && cReader.Release();
+
+        if ( cGot )
+        {
+            cNEvents += cPacket.fNevents;
+            cNWords += cPacket.fNWords32;
+
+            if ( cFile ) cFile->write ( std::move ( cBuffer ) );
+        }
+        else if ( cReader.EndOfStream() ) break;
+
+        auto cNow = std::chrono::steady_clock::now();
+        double cSeconds = std::chrono::duration<double> ( cNow - cLastReport ).count();
+
+        if ( cSeconds >= 5 )
+        {
+            LOG (INFO) << BOLDBLUE << cName << RESET << ": " << cReader.GetNRead() << " packets, " << cNEvents << " events read, "
+                       << cReader.GetNDropped() << " packets dropped, " << 4e-6 * ( cNWords - cLastNWords ) / cSeconds << " MB/s" ;
+            cLastReport = cNow;
+            cLastNWords = cNWords;
+        }
+    }
+
+    double cSeconds = std::chrono::duration<double> ( std::chrono::steady_clock::now() - cStart ).count();
+    LOG (INFO) << BOLDBLUE << cName << RESET << ": " << cReader.GetNRead() << " packets, " << cNEvents << " events read in " << cSeconds
+               << " s, " << cReader.GetNDropped() << " packets dropped" << ( cReader.EndOfStream() ? ", end of the run" : "" ) ;
+
+    if ( cFile )
+    {
+        cFile->closeFile();
+        delete cFile;
+    }
+
+    return 0;
+}
@@ -195,6 +195,9 @@ void CMTester::ScanNoiseChannels()
     LOG (INFO) << "Scanning for noisy channels! " ;
     uint32_t cTotalEvents = 500;
 
+    // all boards take their data at the same time
+    ReadNEventsAllBoards ( cTotalEvents );
+
     for ( BeBoard* pBoard : fBoardVector )
     {
         uint32_t cN = 1;
@@ -204,7 +207,6 @@ void CMTester::ScanNoiseChannels()
 
         //while ( cN <=  cTotalEvents )
         //{
-        fBeBoardInterface->ReadNEvents ( pBoard, cTotalEvents );
         const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
         // Loop over Events from this Acquisition
@@ -281,17 +283,18 @@ void CMTester::TakeData()
     CbcRegReader cReader ( fCbcInterface, "VCth" );
     // accept( cReader );
 
+    // all boards take their data at the same time
+    StartAllBoards();
+    ReadNEventsAllBoards ( fNevents );
+
     for ( BeBoard* pBoard : fBoardVector )
     {
         uint32_t cN = 0;
         uint32_t cNthAcq = 0;
 
-        fBeBoardInterface->Start ( pBoard );
-
         //while ( cN <=  fNevents )
         //{
         // Run( pBoard, cNthAcq );
-        fBeBoardInterface->ReadNEvents ( pBoard, fNevents );
         const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
         // Loop over Events from this Acquisition
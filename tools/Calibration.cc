@@ -323,26 +323,26 @@ void Calibration::bitwiseOffset ( int pTGroup )
 
 void Calibration::measureOccupancy ( uint32_t pNEvents, int pTGroup )
 {
+    // all boards take their data at the same time, the histograms are filled afterwards
+    ReadNEventsAllBoards ( pNEvents );
+
     for ( BeBoard* pBoard : fBoardVector )
     {
 
         uint32_t cN = 0;
         uint32_t cNthAcq = 0;
 
-        fBeBoardInterface->ReadNEvents (pBoard, pNEvents);
-        std::vector<Event*> events = fBeBoardInterface->GetEvents ( pBoard );
+        const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-        // if this is for channelwise offset tuning, iterate the events and fill the occupancy histogram
+        // if this is for channelwise offset tuning, count the hits of all events and fill the occupancy histogram once
+        fOccupancyAccumulator.Reset();
+        fOccupancyAccumulator.Fill ( pBoard, events );
+        cN += events.size();
 
-        for ( auto& cEvent : events )
+        for ( auto cFe : pBoard->fModuleVector )
         {
-            for ( auto cFe : pBoard->fModuleVector )
-            {
-                for ( auto cCbc : cFe->fCbcVector )
-                    fillOccupancyHist ( cCbc, pTGroup, cEvent );
-            }
-
-            cN++;
+            for ( auto cCbc : cFe->fCbcVector )
+                fillOccupancyHist ( cCbc, pTGroup );
         }
 
         cNthAcq++;
@@ -358,22 +358,12 @@ float Calibration::findCbcOccupancy ( Cbc* pCbc, int pTGroup, int pEventsPerPoin
     return cOccupancy / ( static_cast<float> ( fTestGroupChannelMap[pTGroup].size() * pEventsPerPoint ) );
 }
 
-void Calibration::fillOccupancyHist ( Cbc* pCbc, int pTGroup, const Event* pEvent )
+void Calibration::fillOccupancyHist ( Cbc* pCbc, int pTGroup )
 {
     // Find the Occupancy histogram for the current Cbc
     TH1F* cOccHist = static_cast<TH1F*> ( getHist ( pCbc, "Occupancy" ) );
-    // iterate the channels in current group
-    int cHits = 0;
-
-    for ( auto& cChanId : fTestGroupChannelMap[pTGroup] )
-    {
-        // I am filling the occupancy profile for each CBC for the current test group
-        if ( pEvent->DataBit ( pCbc->getFeId(), pCbc->getCbcId(), cChanId ) )
-        {
-            cOccHist->Fill ( cChanId );
-            cHits++;
-        }
-    }
+    // I am filling the occupancy profile for each CBC for the current test group
+    fOccupancyAccumulator.Flush ( pCbc, cOccHist, fTestGroupChannelMap[pTGroup] );
 }
 
 void Calibration::clearOccupancyHists ( Cbc* pCbc )
@@ -397,6 +387,8 @@ void Calibration::clearVPlusMap()
 void Calibration::setOffset ( uint8_t pOffset, int  pGroup, bool pVPlus )
 {
     // LOG(INFO) << "Setting offsets of Test Group " << pGroup << " to 0x" << std::hex << +pOffset << std::dec ;
+    // the offsets of all CBCs are staged and the changed ones written in one transaction per board
+
     for ( auto cBoard : fBoardVector )
     {
         for ( auto cFe : cBoard->fModuleVector )
@@ -410,25 +402,24 @@ void Calibration::setOffset ( uint8_t pOffset, int  pGroup, bool pVPlus )
                 // first, find the offset Histogram for this CBC
                 TH1F* cOffsetHist = static_cast<TH1F*> ( getHist ( cCbc, "Offsets" ) );
 
-                RegisterVector cRegVec;   // vector of pairs for the write operation
-
                 // loop the channels of the current group and toggle bit i in the global map
                 for ( auto& cChannel : fTestGroupChannelMap[pGroup] )
                 {
-                    TString cRegName = Form ( "Channel%03d", cChannel + 1 );
-                    cRegVec.push_back ( {cRegName.Data(), pOffset} );
+                    cCbc->setReg ( CbcReg::ChannelReg ( cChannel + 1 ), pOffset );
 
                     if ( pVPlus ) cOffsetHist->SetBinContent ( cChannel, pOffset );
                 }
-
-                fCbcInterface->WriteCbcMultReg ( cCbc, cRegVec );
             }
         }
     }
+
+    fCbcInterface->Flush ( fBoardVector );
 }
 
 void Calibration::toggleOffset ( uint8_t pGroup, uint8_t pBit, bool pBegin )
 {
+    // the offsets of all CBCs are staged and the changed ones written in one transaction per board
+
     for ( auto cBoard : fBoardVector )
     {
         for ( auto cFe : cBoard->fModuleVector )
@@ -444,12 +435,11 @@ void Calibration::toggleOffset ( uint8_t pGroup, uint8_t pBit, bool pBegin )
                 // find the TProfile for occupancy measurment of current channel
                 TH1F* cOccHist = static_cast<TH1F*> ( getHist ( cCbc, "Occupancy" ) );
                 // cOccHist->Scale( 1 / double( fEventsPerPoint ) );
-                RegisterVector cRegVec;   // vector of pairs for the write operation
 
                 // loop the channels of the current group and toggle bit i in the global map
                 for ( auto& cChannel : fTestGroupChannelMap[pGroup] )
                 {
-                    TString cRegName = Form ( "Channel%03d", cChannel + 1 );
+                    uint16_t cRegId = CbcReg::ChannelReg ( cChannel + 1 );
 
                     if ( pBegin )
                     {
@@ -462,8 +452,8 @@ void Calibration::toggleOffset ( uint8_t pGroup, uint8_t pBit, bool pBegin )
                         // modify the histogram
                         cOffsetHist->SetBinContent ( cChannel, cOffset );
 
-                        // push in a vector for CBC write transaction
-                        cRegVec.push_back ( {cRegName.Data(), cOffset} );
+                        // stage it for the write
+                        cCbc->setReg ( cRegId, cOffset );
                     }
                     else  //here it is interesting since now I will check if the occupancy is smaller or larger 50% and decide wether to toggle or not to toggle
                     {
@@ -480,18 +470,18 @@ void Calibration::toggleOffset ( uint8_t pGroup, uint8_t pBit, bool pBegin )
                         {
                             toggleRegBit ( cOffset, pBit ); // toggle the bit back that was previously flipped
                             cOffsetHist->SetBinContent ( cChannel, cOffset );
-                            cRegVec.push_back ( {cRegName.Data(), cOffset} );
+                            cCbc->setReg ( cRegId, cOffset );
                         }
 
                         // since I extracted the info from the occupancy profile for this bit (this iteration), i need to clear the corresponding bins
                         cOccHist->SetBinContent ( iBin, 0 );
                     }
                 }
-
-                fCbcInterface->WriteCbcMultReg ( cCbc, cRegVec );
             }
         }
     }
+
+    fCbcInterface->Flush ( fBoardVector );
 }
 
 void Calibration::updateHists ( std::string pHistname )
@@ -555,7 +545,7 @@ void Calibration::setRegValues()
                 for ( int iChan = 0; iChan < NCHANNELS; iChan++ )
                 {
                     uint8_t cOffset = cOffsetHist->GetBinContent ( iChan );
-                    cCbc->setReg ( Form ( "Channel%03d", iChan + 1 ), cOffset );
+                    cCbc->setReg ( CbcReg::ChannelReg ( iChan + 1 ), cOffset );
                     //LOG(INFO) << GREEN << "Offset for CBC " << cCbcId << " Channel " << iChan << " : 0x" << std::hex << +cOffset << std::dec << RESET ;
                 }
 
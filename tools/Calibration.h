@@ -75,7 +75,7 @@ class Calibration : public Tool
 
 	float findCbcOccupancy( Cbc* pCbc, int pTGroup, int pEventsPerPoint );
 
-	void fillOccupancyHist( Cbc* pCbc, int pTGroup, const Event* pEvent );
+	void fillOccupancyHist( Cbc* pCbc, int pTGroup );
 
 	void clearOccupancyHists( Cbc* pCbc );
 
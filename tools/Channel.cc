@@ -1,5 +1,7 @@
 #include "Channel.h"
+#include "OccupancyAccumulator.h"
 #include "TMath.h"
+#include <algorithm>
 #include <cmath>
 
 
@@ -8,7 +10,9 @@ Channel::Channel ( uint8_t pBeId, uint8_t pFeId, uint8_t pCbcId, uint8_t pChanne
     fBeId ( pBeId ),
     fFeId ( pFeId ),
     fCbcId ( pCbcId ),
-    fChannelId ( pChannelId )
+    fChannelId ( pChannelId ),
+    fPedestal ( -1 ),
+    fNoise ( -1 )
 {
 }
 
@@ -19,37 +23,12 @@ Channel::~Channel()
 
 double Channel::getPedestal() const
 {
-    if ( fFitted )
-    {
-        if ( fFit != nullptr )
-            return fabs ( fFit->GetParameter ( 0 ) );
-        else return -1;
-    }
-    else
-    {
-        if ( fDerivative != nullptr )
-            return fabs ( fDerivative->GetMean() );
-        else return -1;
-    }
+    return fPedestal;
 }
 
 double Channel::getNoise() const
 {
-
-    if ( fFitted )
-    {
-        if ( fFit != nullptr )
-            return fabs ( fFit->GetParameter ( 1 ) );
-        else
-            return -1;
-    }
-    else
-    {
-        if ( fDerivative != nullptr )
-            return fabs ( fDerivative->GetRMS() );
-        else
-            return -1;
-    }
+    return fNoise;
 }
 
 void Channel::setOffset ( uint8_t pOffset )
@@ -123,9 +102,29 @@ void Channel::fillHist ( uint8_t pVcth )
     fScurve->Fill ( float ( pVcth ) );
 }
 
+void Channel::fillHist ( uint8_t pVcth, uint32_t pCount )
+{
+    OccupancyAccumulator::AddCounts ( fScurve, float ( pVcth ), pCount );
+    fScurve->ResetStats();
+}
+
 void Channel::fitHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TString pParameter, TFile* pResultfile )
 {
-    fFitted = true;
+    analyzeSCurves ( std::vector<Channel*> { this }, pEventsperVcth, pHole, true, pValue, pParameter, pResultfile );
+}
+
+
+void Channel::differentiateHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TString pParameter, TFile* pResultfile )
+{
+    analyzeSCurves ( std::vector<Channel*> { this }, pEventsperVcth, pHole, false, pValue, pParameter, pResultfile );
+}
+
+
+void Channel::storeSCurve ( const SCurveResult& pResult, uint32_t pEventsperVcth, bool pHole, bool pFit, uint8_t pValue, TString pParameter, TFile* pResultfile, SCurveResult* pReference )
+{
+    fFitted = pFit;
+    fPedestal = pResult.fPedestal;
+    fNoise = pResult.fNoise;
 
     if ( fScurve != nullptr && fFit != nullptr )
     {
@@ -134,58 +133,91 @@ void Channel::fitHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TSt
         // fScurve->Sumw2();
         fScurve->Scale ( 1 / double_t ( pEventsperVcth ) );
 
-        // Get first non 0 and first 1
-        double cFirstNon0 ( 0 );
-        double cFirst1 ( 0 );
-
-        // Not Hole Mode
-        if ( !pHole )
+        if ( pFit )
         {
-            for ( Int_t cBin = 1; cBin <= fScurve->GetNbinsX(); cBin++ )
-            {
-                double cContent = fScurve->GetBinContent ( cBin );
+            // a falling SCurve has a negative width in MyErf
+            double cWidth = ( pHole ) ? -fNoise : fNoise;
+            fFit->SetParameter ( 0, fPedestal );
+            fFit->SetParameter ( 1, cWidth );
 
-                if ( !cFirstNon0 )
-                {
-                    if ( cContent ) cFirstNon0 = fScurve->GetBinCenter ( cBin );
-                }
-                else if ( cContent > 0.85 )
-                {
-                    cFirst1 = fScurve->GetBinCenter ( cBin );
-                    break;
-                }
+            if ( pReference != nullptr )
+            {
+                fScurve->Fit ( fFit, "RNQ+" );
+                pReference->fPedestal = fabs ( fFit->GetParameter ( 0 ) );
+                pReference->fNoise = fabs ( fFit->GetParameter ( 1 ) );
+                pReference->fValid = true;
+
+                // the Fit object shows the result that is used
+                fFit->SetParameter ( 0, fPedestal );
+                fFit->SetParameter ( 1, cWidth );
             }
         }
-        // Hole mode
         else
         {
-            for ( Int_t cBin = fScurve->GetNbinsX(); cBin >= 1; cBin-- )
+            // Histogram of Differences
+
+            // double_t cPrev = fScurve->GetBinContent( fScurve->GetBin( -0.5 ) );
+            double_t cDiff;
+            double_t cCurrent;
+            double_t cPrev;
+            bool cActive; // indicates existence of data points
+            int cStep = 1;
+            int cDiffCounter = 0;
+
+            double cBin = 0;
+
+            if ( pHole )
             {
-                double cContent = fScurve->GetBinContent ( cBin );
+                cPrev = fScurve->GetBinContent ( fScurve->GetBin ( -0.5 ) );
+                cActive = false;
 
-                if ( !cFirstNon0 )
+                for ( cBin = 0; cBin <= 255; cBin++ )
                 {
-                    if ( cContent ) cFirstNon0 = fScurve->GetBinCenter ( cBin );
-                }
-                else if ( cContent > 0.85 )
-                {
-                    cFirst1 = fScurve->GetBinCenter ( cBin );
-                    break;
+                    cCurrent = fScurve->GetBinContent ( fScurve->GetBin ( cBin ) );
+                    cDiff = cPrev - cCurrent;
+
+                    if ( cPrev > 0.75 ) cActive = true; // sampling begins
+
+                    if ( cActive ) fDerivative->SetBinContent ( fDerivative->GetBin ( cBin - 0.5 ),  cDiff  );
+
+                    if ( cActive && cDiff == 0 && cCurrent == 0 ) cDiffCounter++;
+
+                    if ( cDiffCounter == 8 ) break;
+
+                    cPrev = cCurrent;
                 }
             }
-        }
+            else
+            {
+                cPrev = fScurve->GetBinContent ( fScurve->GetBin ( 255.5 ) );
+                cActive = false;
 
-        // Get rough midpoint & width
-        double cMid = ( cFirst1 + cFirstNon0 ) * 0.5;
-        double cWidth = ( cFirst1 - cFirstNon0 ) * 0.5;
+                for ( cBin = 255; cBin >= 0; cBin-- )
+                {
+                    cCurrent = fScurve->GetBinContent ( fScurve->GetBin ( cBin ) );
+                    cDiff = cCurrent - cPrev;
+
+                    if ( cPrev > 0.75 ) cActive = true; // sampling begins
+
+                    // the difference of bins cBin and cBin + 1 sits at the upper edge of bin cBin, in the middle of bin cBin of fDerivative
+                    if ( cActive ) fDerivative->SetBinContent ( fDerivative->GetBin ( cBin ),   cDiff  );
 
-        fFit->SetParameter ( 0, cMid );
-        fFit->SetParameter ( 1, cWidth );
+                    if ( cActive && cDiff == 0 && cCurrent == 0 ) cDiffCounter++;
+
+                    if ( cDiffCounter == 8 ) break;
+
+                    cPrev = cCurrent;
+                }
+            }
 
-        // Fit
-        fScurve->Fit ( fFit, "RNQ+" );
+            if ( pReference != nullptr )
+            {
+                pReference->fPedestal = fabs ( fDerivative->GetMean() );
+                pReference->fNoise = fabs ( fDerivative->GetRMS() );
+                pReference->fValid = true;
+            }
+        }
 
-        // Eventually add TFitResultPointer
         // create a Directory in the file for the current Offset and save the channel Data
         TString cDirName;
         cDirName = pParameter + Form ( "%d", pValue );
@@ -196,104 +228,58 @@ void Channel::fitHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TSt
         pResultfile->cd ( cDirName );
 
         fScurve->SetDirectory ( cDir );
-        // fFit->SetDirectory( cDir );
-        fFit->Write ( fFit->GetName(), TObject::kOverwrite );
-        // pResultfile->Flush();
+
+        if ( pFit ) fFit->Write ( fFit->GetName(), TObject::kOverwrite );
+        else fDerivative->SetDirectory ( cDir );
 
         pResultfile->cd();
     }
     else LOG (INFO) << "Historgram Empty for Fe " << fFeId << " Cbc " << fCbcId << " Channel " << fChannelId ;
-
-
 }
 
 
-void Channel::differentiateHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TString pParameter, TFile* pResultfile )
+void analyzeSCurves ( const std::vector<Channel*>& pChannels, uint32_t pEventsperVcth, bool pHole, bool pFit, uint8_t pValue, TString pParameter, TFile* pResultfile, bool pValidate )
 {
-    fFitted = false;
+    // the raw counts are read in place before the histograms are normalized, bin 0 of the ROOT array is the underflow
+    std::vector<const float*> cCounts;
+    uint32_t cNBins = 0;
 
-    if ( fScurve != nullptr && fFit != nullptr )
+    for ( auto cChannel : pChannels )
     {
-
-        // Normalize first
-        // fScurve->Sumw2();
-        fScurve->Scale ( 1 / double_t ( pEventsperVcth ) );
-
-        // Histogram of Differences
-
-        // double_t cPrev = fScurve->GetBinContent( fScurve->GetBin( -0.5 ) );
-        double_t cDiff;
-        double_t cCurrent;
-        double_t cPrev;
-        bool cActive; // indicates existence of data points
-        int cStep = 1;
-        int cDiffCounter = 0;
-
-        double cBin = 0;
-
-        if ( pHole )
+        if ( cChannel->fScurve != nullptr )
         {
-            cPrev = fScurve->GetBinContent ( fScurve->GetBin ( -0.5 ) );
-            cActive = false;
-
-            for ( cBin = 0; cBin <= 255; cBin++ )
-            {
-                cCurrent = fScurve->GetBinContent ( fScurve->GetBin ( cBin ) );
-                cDiff = cPrev - cCurrent;
-
-                if ( cPrev > 0.75 ) cActive = true; // sampling begins
-
-                if ( cActive ) fDerivative->SetBinContent ( fDerivative->GetBin ( cBin - 0.5 ),  cDiff  );
-
-                if ( cActive && cDiff == 0 && cCurrent == 0 ) cDiffCounter++;
-
-                if ( cDiffCounter == 8 ) break;
-
-                cPrev = cCurrent;
-            }
+            cCounts.push_back ( cChannel->fScurve->GetArray() + 1 );
+            cNBins = cChannel->fScurve->GetNbinsX();
         }
-        else
-        {
-            cPrev = fScurve->GetBinContent ( fScurve->GetBin ( 255.5 ) );
-            cActive = false;
-
-            for ( cBin = 255; cBin >= 0; cBin-- )
-            {
-                cCurrent = fScurve->GetBinContent ( fScurve->GetBin ( cBin ) );
-                cDiff = cCurrent - cPrev;
-
-                if ( cPrev > 0.75 ) cActive = true; // sampling begins
+        else cCounts.push_back ( nullptr );
+    }
 
-                if ( cActive ) fDerivative->SetBinContent ( fDerivative->GetBin ( cBin - 0.5 ),   cDiff  );
+    SCurveFitter cFitter ( pHole, ( pFit ) ? SCurveMethod::ErfFit : SCurveMethod::Derivative );
+    std::vector<SCurveResult> cResults;
+    cFitter.Analyze ( cCounts, cNBins, pEventsperVcth, cResults );
 
-                if ( cActive && cDiff == 0 && cCurrent == 0 ) cDiffCounter++;
+    // the ROOT side stays serial
+    uint32_t cNFailed = 0;
+    double cMaxPedestalDiff = 0;
+    double cMaxNoiseDiff = 0;
 
-                if ( cDiffCounter == 8 ) break;
+    for ( size_t cIndex = 0; cIndex < pChannels.size(); cIndex++ )
+    {
+        SCurveResult cReference;
+        pChannels[cIndex]->storeSCurve ( cResults[cIndex], pEventsperVcth, pHole, pFit, pValue, pParameter, pResultfile, ( pValidate ) ? &cReference : nullptr );
 
-                cPrev = cCurrent;
-            }
+        if ( !cResults[cIndex].fValid ) cNFailed++;
+        else if ( cReference.fValid )
+        {
+            cMaxPedestalDiff = std::max ( cMaxPedestalDiff, fabs ( cResults[cIndex].fPedestal - cReference.fPedestal ) );
+            cMaxNoiseDiff = std::max ( cMaxNoiseDiff, fabs ( cResults[cIndex].fNoise - cReference.fNoise ) );
         }
-
-        // Eventually add TDerivativeResultPointer
-        // create a Directory in the file for the current Offset and save the channel Data
-        TString cDirName;
-        cDirName = pParameter + Form ( "%d", pValue );
-        TDirectory* cDir = dynamic_cast< TDirectory* > ( gROOT->FindObject ( cDirName ) );
-
-        if ( !cDir ) cDir = pResultfile->mkdir ( cDirName );
-
-        pResultfile->cd ( cDirName );
-
-        fScurve->SetDirectory ( cDir );
-        fDerivative->SetDirectory ( cDir );
-        // fDerivative->Write( fDerivative->GetName(), TObject::kOverwrite );
-        // pResultfile->Flush();
-
-        pResultfile->cd();
     }
-    else LOG (INFO) << "Historgram Empty for Fe " << fFeId << " Cbc " << fCbcId << " Channel " << fChannelId ;
 
+    if ( cNFailed ) LOG (INFO) << RED << cNFailed << " of " << pChannels.size() << " SCurves could not be " << ( ( pFit ) ? "fitted" : "differentiated" ) << RESET ;
 
+    if ( pValidate ) LOG (INFO) << "SCurves compared to " << ( ( pFit ) ? "the ROOT fit" : "the Derivative histograms" ) << ": largest difference of the pedestal "
+                                    << cMaxPedestalDiff << ", of the noise " << cMaxNoiseDiff ;
 }
 
 
@@ -22,6 +22,7 @@
 #include "TString.h"
 #include "TROOT.h"
 #include "TCanvas.h"
+#include "SCurveFitter.h"
 #include "../Utils/ConsoleColor.h"
 #include "../Utils/Utilities.h"
 #include "../Utils/easylogging++.h"
@@ -53,15 +54,17 @@ struct Channel
     TF1*  fFit;  /*!< Fit for the SCurve */
     TH1F* fDerivative; /*!< Histogram to hold the derivative of the Scurve*/
     TGraph* fPulse; /*!< Graph to store the curve for pulseshape measurements*/
+    double fPedestal; /*!< midpoint of the SCurve found by the last fitHist, differentiateHist or analyzeSCurves */
+    double fNoise; /*!< width of the SCurve found by the last fitHist, differentiateHist or analyzeSCurves */
     // Methods
     /*!
     * \brief get the SCurve midpoint affter fitting
-    * \return the midpoint of the SCurve; the so-called pedestal
+    * \return the midpoint of the SCurve; the so-called pedestal, -1 if the SCurve was not analyzed
     */
     double getPedestal() const;
     /*!
     * \brief get the SCurve width affter fitting
-    * \return the width of the SCurve; the so-called noise
+    * \return the width of the SCurve; the so-called noise, -1 if the SCurve was not analyzed
     */double getNoise() const;
     /*!
     * \brief get the current channel offset
@@ -101,9 +104,15 @@ struct Channel
     * \param pVcth: the bin at which to fill the histogram (normally Vcth value)
     */
     void fillHist ( uint8_t pVcth );
+    /*!
+    * \brief fill the histogram with several entries at once
+    * \param pVcth: the bin at which to fill the histogram (normally Vcth value)
+    * \param pCount: the number of entries
+    */
+    void fillHist ( uint8_t pVcth, uint32_t pCount );
 
     /*!
-    * \brief fit the SCurve Histogram with the Fit object
+    * \brief fit the SCurve Histogram with SCurveFitter, the Fit object is set to the result
     * \param pEventsperVcth: the number of Events taken for each Vcth setting, used to normalize SCurve
     * \param pHole: the CBC mode: electron or hole
     * \param pParameter: the current parameter that is being varied for storing in file
@@ -113,7 +122,7 @@ struct Channel
     void fitHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TString pParameter, TFile* pResultfile );
 
     /*!
-    * \brief differentiate the SCurve Histogram with the Derivative object
+    * \brief differentiate the SCurve Histogram with SCurveFitter and fill the Derivative object
     * \param pEventsperVcth: the number of Events taken for each Vcth setting, used to normalize SCurve
     * \param pHole: the CBC mode: electron or hole
     * \param pParameter: the current parameter that is being varied for storing in file
@@ -122,12 +131,27 @@ struct Channel
     */
     void differentiateHist ( uint32_t pEventsperVcth, bool pHole, uint8_t pValue, TString pParameter, TFile* pResultfile );
 
+    /*!
+    * \brief keep the result of SCurveFitter, normalize the SCurve, fill the Fit or Derivative object and store them in the file
+    * \param pResult: pedestal and noise found from the raw SCurve
+    * \param pReference: if not nullptr, set to the ROOT fit of the SCurve or to the moments of the Derivative object
+    */
+    void storeSCurve ( const SCurveResult& pResult, uint32_t pEventsperVcth, bool pHole, bool pFit, uint8_t pValue, TString pParameter, TFile* pResultfile, SCurveResult* pReference = nullptr );
+
     /*!
     * \brief reset the Histogram and Fit objects
     */
     void resetHist();
 };
 
+/*!
+* \brief fit or differentiate the SCurves of many channels at once: pedestal and noise are found by SCurveFitter, in
+* parallel and without ROOT, then every channel is stored as by fitHist or differentiateHist
+* \param pFit: fit MyErf rather than differentiate
+* \param pValidate: also fit with ROOT, or take the moments of the Derivative histogram, and log the largest differences
+*/
+void analyzeSCurves ( const std::vector<Channel*>& pChannels, uint32_t pEventsperVcth, bool pHole, bool pFit, uint8_t pValue, TString pParameter, TFile* pResultfile, bool pValidate = false );
+
 struct TestGroup
 {
     TestGroup ( uint8_t pBeId, uint8_t pFeId, uint8_t pCbcId, uint8_t pGroupId );
@@ -12,23 +12,17 @@ struct HistogramFiller  : public HwDescriptionVisitor
 
     void visit ( Cbc& pCbc )
     {
-        std::vector<bool> cDataBitVector = fEvent->DataBitVector ( pCbc.getFeId(), pCbc.getCbcId() );
-
-        for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
+        fEvent->ForEachHit ( pCbc.getFeId(), pCbc.getCbcId(), [&] ( uint32_t cId )
         {
-            if ( cDataBitVector.at ( cId ) )
-            {
-                uint32_t globalChannel = ( pCbc.getCbcId() * 254 ) + cId;
-
-                //              LOG(INFO) << "Channel " << globalChannel << " VCth " << int(pCbc.getReg( "VCth" )) ;
-                // find out why histograms are not filling!
-                if ( globalChannel % 2 == 0 )
-                    fBotHist->Fill ( globalChannel / 2 );
-                else
-                    fTopHist->Fill ( ( globalChannel - 1 ) / 2 );
+            uint32_t globalChannel = ( pCbc.getCbcId() * 254 ) + cId;
 
-            }
-        }
+            //              LOG(INFO) << "Channel " << globalChannel << " VCth " << int(pCbc.getReg( "VCth" )) ;
+            // find out why histograms are not filling!
+            if ( globalChannel % 2 == 0 )
+                fBotHist->Fill ( globalChannel / 2 );
+            else
+                fTopHist->Fill ( ( globalChannel - 1 ) / 2 );
+        } );
     }
 };
 
@@ -74,9 +68,12 @@ void HybridTester::ReconfigureCBCRegisters(std::string pDirectoryName )
     			
     			pRegFile = buffer;
                 cCbc->loadfRegMap(pRegFile);
-                fCbcInterface->ConfigureCbc ( cCbc );
-                LOG (INFO) << GREEN << "\t\t Successfully reconfigured CBC" << int ( cCbc->getCbcId() ) << "'s regsiters from " << pRegFile << " ." << RESET ;
+                LOG (INFO) << GREEN << "\t\t Loaded CBC" << int ( cCbc->getCbcId() ) << "'s regsiters from " << pRegFile << " ." << RESET ;
             }
+
+            //all CBCs of the module in one batch of I2C words
+            if ( fCbcInterface->ConfigureModule ( cFe ) )
+                LOG (INFO) << GREEN << "\t\t Successfully reconfigured the CBCs of FE" << int ( cFe->getFeId() ) << RESET ;
         }
 
         //CbcFastReset as per recommendation of Mark Raymond
@@ -251,14 +248,66 @@ uint32_t HybridTester::fillSCurves ( BeBoard* pBoard,  const Event* pEvent, uint
             if ( cScurve == fSCurveMap.end() ) LOG (INFO) << "Error: could not find an Scurve object for Cbc " << int ( cCbc->getCbcId() ) ;
             else
             {
-                for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
-                {
-                    if ( pEvent->DataBit ( cCbc->getFeId(), cCbc->getCbcId(), cId ) )
-                    {
-                        cScurve->second->Fill ( pValue );
-                        cHitCounter++;
-                    }
-                }
+                uint32_t cNHits = pEvent->GetNHits ( cCbc->getFeId(), cCbc->getCbcId() );
+
+                // all hits of the CBC go into the same bin
+                for ( uint32_t cHit = 0; cHit < cNHits; cHit++ )
+                    cScurve->second->Fill ( pValue );
+
+                cHitCounter += cNHits;
+            }
+        }
+    }
+
+    return cHitCounter;
+}
+
+void HybridTester::fillOccupancyHists ( BeBoard* pBoard )
+{
+    for ( auto cFe : pBoard->fModuleVector )
+    {
+        for ( auto cCbc : cFe->fCbcVector )
+        {
+            const OccupancyAccumulator::ChannelCounts& cCounts = fOccupancyAccumulator.GetCounts ( cCbc );
+
+            for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
+            {
+                uint32_t globalChannel = ( cCbc->getCbcId() * 254 ) + cId;
+
+                if ( globalChannel % 2 == 0 )
+                    OccupancyAccumulator::AddCounts ( fHistBottom, globalChannel / 2, cCounts[cId] );
+                else
+                    OccupancyAccumulator::AddCounts ( fHistTop, ( globalChannel - 1 ) / 2, cCounts[cId] );
+            }
+        }
+    }
+
+    fHistBottom->ResetStats();
+    fHistTop->ResetStats();
+}
+
+uint32_t HybridTester::fillSCurves ( BeBoard* pBoard, uint8_t pValue )
+{
+    uint32_t cHitCounter = 0;
+
+    for ( auto cFe : pBoard->fModuleVector )
+    {
+        for ( auto cCbc : cFe->fCbcVector )
+        {
+            auto cScurve = fSCurveMap.find ( cCbc );
+
+            if ( cScurve == fSCurveMap.end() ) LOG (INFO) << "Error: could not find an Scurve object for Cbc " << int ( cCbc->getCbcId() ) ;
+            else
+            {
+                const OccupancyAccumulator::ChannelCounts& cCounts = fOccupancyAccumulator.GetCounts ( cCbc );
+                uint32_t cNHits = 0;
+
+                for ( auto cCount : cCounts )
+                    cNHits += cCount;
+
+                OccupancyAccumulator::AddCounts ( cScurve->second, pValue, cNHits );
+                cScurve->second->ResetStats();
+                cHitCounter += cNHits;
             }
         }
     }
@@ -288,40 +337,20 @@ void HybridTester::ScanThresholds()
         fHistTop->GetYaxis()->SetRangeUser ( 0, fTotalEvents );
         fHistBottom->GetYaxis()->SetRangeUser ( 0, fTotalEvents );
 
+        // all boards take their data at the same time
+        ReadNEventsAllBoards ( fTotalEvents );
+
         for ( BeBoard* pBoard : fBoardVector )
         {
-            uint32_t cN = 1;
-            uint32_t cNthAcq = 0;
-
-            fBeBoardInterface->Start ( pBoard );
-
-            while ( cN <=  fTotalEvents )
-            {
-                // Run( pBoard, cNthAcq );
-                fBeBoardInterface->ReadData ( pBoard, false );
-                const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
-
-                // Loop over Events from this Acquisition
-                for ( auto& cEvent : events )
-                {
-                    HistogramFiller cFiller ( fHistBottom, fHistTop, cEvent );
-                    pBoard->accept ( cFiller );
-
-                    fillSCurves ( pBoard,  cEvent , cVcth );
-
-                    if ( cN % 100 == 0 )
-                    {
-                        updateSCurveCanvas ( pBoard );
-                        UpdateHists();
-                    }
-
-                    cN++;
-                }
+            const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-                cNthAcq++;
-            }
+            // count the hits of the Events from this Acquisition, the histograms are filled once per Vcth
+            fOccupancyAccumulator.Reset();
+            fOccupancyAccumulator.Fill ( pBoard, events );
 
-            fBeBoardInterface->Stop ( pBoard);
+            fillOccupancyHists ( pBoard );
+            fillSCurves ( pBoard, cVcth );
+            updateSCurveCanvas ( pBoard );
         }
 
         fHistTop->Scale ( 100 / double_t ( fTotalEvents ) );
@@ -403,71 +432,65 @@ void HybridTester::ScanThreshold()
         // maybe restrict to pBoard? instead of looping?
         if ( cAllOne ) break;
 
+        // all boards take their data at the same time
+        ReadNEventsAllBoards ( cEventsperVcth );
+
         for ( BeBoard* pBoard : fBoardVector )
         {
-            fBeBoardInterface->Start ( pBoard );
+            const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-            while ( cN <=  cEventsperVcth )
+            // Loop over Events from this Acquisition
+            for ( auto& cEvent : events )
             {
-                // Run( pBoard, cNthAcq );
-                fBeBoardInterface->ReadData ( pBoard, false );
-                const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
-
-                // Loop over Events from this Acquisition
-                for ( auto& cEvent : events )
-                {
-                    // loop over Modules & Cbcs and count hits separately
-                    cHitCounter += fillSCurves ( pBoard,  cEvent, cVcth );
-                    cN++;
-                }
-
-                cNthAcq++;
+                // loop over Modules & Cbcs and count hits separately
+                cHitCounter += fillSCurves ( pBoard,  cEvent, cVcth );
+                cN++;
             }
 
-            fBeBoardInterface->Stop ( pBoard);
+            cNthAcq++;
             // LOG(INFO) << +cVcth << " " << cHitCounter ;
             // Draw the thing after each point
             updateSCurveCanvas ( pBoard );
+        }
 
-            // check if the hitcounter is all ones
+        // check if the hitcounter is all ones
 
-            if ( cNonZero == false && cHitCounter != 0 )
-            {
-                cDoubleVcth = cVcth;
-                cNonZero = true;
-                cVcth -= 2 * cStep;
-                cStep /= 10;
-                continue;
-            }
+        if ( cNonZero == false && cHitCounter != 0 )
+        {
+            cDoubleVcth = cVcth;
+            cNonZero = true;
+            cVcth -= 2 * cStep;
+            cStep /= 10;
+            continue;
+        }
 
-            if ( cNonZero && cHitCounter != 0 )
-            {
-                // check if all Cbcs have reached full occupancy
-                if ( cHitCounter > 0.95 * cEventsperVcth * fNCbc * NCHANNELS ) cAllOneCounter++;
+        if ( cNonZero && cHitCounter != 0 )
+        {
+            // check if all Cbcs have reached full occupancy
+            if ( cHitCounter > 0.95 * cEventsperVcth * fNCbc * NCHANNELS ) cAllOneCounter++;
 
-                // add a second check if the global SCurve slope is 0 for 10 consecutive Vcth values
-                // if ( fabs( cHitCounter - cOldHitCounter ) < 10 && cHitCounter != 0 ) cSlopeZeroCounter++;
-            }
+            // add a second check if the global SCurve slope is 0 for 10 consecutive Vcth values
+            // if ( fabs( cHitCounter - cOldHitCounter ) < 10 && cHitCounter != 0 ) cSlopeZeroCounter++;
+        }
 
-            if ( cAllOneCounter >= 10 ) cAllOne = true;
+        if ( cAllOneCounter >= 10 ) cAllOne = true;
 
-            // if ( cSlopeZeroCounter >= 10 ) cSlopeZero = true;
+        // if ( cSlopeZeroCounter >= 10 ) cSlopeZero = true;
 
-            if ( cAllOne )
-            {
-                LOG (INFO) << "All strips firing -- ending the scan at VCth " << +cVcth ;
-                break;
-            }
+        if ( cAllOne )
+        {
+            LOG (INFO) << "All strips firing -- ending the scan at VCth " << +cVcth ;
+            break;
+        }
 
-            // else if ( cSlopeZero )
-            // {
-            //   LOG(INFO) << "Slope of SCurve 0 -- ending the scan at VCth " << +cVcth ;
-            //  break;
-            // }
+        // else if ( cSlopeZero )
+        // {
+        //   LOG(INFO) << "Slope of SCurve 0 -- ending the scan at VCth " << +cVcth ;
+        //  break;
+        // }
 
-            cOldHitCounter = cHitCounter;
-            cVcth += cStep;
-        }
+        cOldHitCounter = cHitCounter;
+        cVcth += cStep;
     }
 
     // Fit and save the SCurve & Fit - extract the right threshold
@@ -1021,36 +1044,25 @@ void HybridTester::Measure()
 
 
 
+    // all boards take their data at the same time
+    ReadNEventsAllBoards ( fTotalEvents );
+
     for ( BeBoard* pBoard : fBoardVector )
     {
         uint32_t cN = 1;
-        uint32_t cNthAcq = 0;
-
-        fBeBoardInterface->Start ( pBoard );
+        const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-        while ( cN <=  fTotalEvents )
+        // Loop over Events from this Acquisition
+        for ( auto& cEvent : events )
         {
-            //Run( pBoard, cNthAcq );
-            fBeBoardInterface->ReadData ( pBoard, false );
-            //fBeBoardInterface->ReadNEvents ( pBoard, cNthAcq );
-            const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
-
-            // Loop over Events from this Acquisition
-            for ( auto& cEvent : events )
-            {
-                HistogramFiller cFiller ( fHistBottom, fHistTop, cEvent );
-                pBoard->accept ( cFiller );
-
-                if ( cN % 100 == 0 )
-                    UpdateHists();
+            HistogramFiller cFiller ( fHistBottom, fHistTop, cEvent );
+            pBoard->accept ( cFiller );
 
-                cN++;
-            }
+            if ( cN % 100 == 0 )
+                UpdateHists();
 
-            cNthAcq++;
+            cN++;
         }
-
-        fBeBoardInterface->Stop ( pBoard);
     }
 	for( int i = 1 ; i < ( fNCbc/2 * 254 ) ; i++ )
 	{
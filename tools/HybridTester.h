@@ -213,6 +213,9 @@ class HybridTester : public Tool
 
     // To measure the occupancy per Cbc
     uint32_t fillSCurves ( BeBoard* pBoard,  const Event* pEvent, uint8_t pValue );
+    // To fill the occupancy per Cbc and per strip from fOccupancyAccumulator
+    uint32_t fillSCurves ( BeBoard* pBoard, uint8_t pValue );
+    void fillOccupancyHists ( BeBoard* pBoard );
     void updateSCurveCanvas ( BeBoard* pBoard );
     void processSCurves ( uint32_t pEventsperVcth );
 
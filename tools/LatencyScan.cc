@@ -83,11 +83,12 @@ std::map<Module*, uint8_t> LatencyScan::ScanLatency ( uint8_t pStartLatency, uin
         this->accept ( cWriter );
 
 
-        // Take Data for all Modules
+        // Take Data for all Modules, the boards are read out concurrently
+        ReadNEventsAllBoards ( fNevents );
+
         for ( BeBoard* pBoard : fBoardVector )
         {
             // I need this to normalize the TDC values I get from the Strasbourg FW
-            fBeBoardInterface->ReadNEvents ( pBoard, fNevents );
             const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
             // Loop over Events from this Acquisition
@@ -241,11 +242,7 @@ int LatencyScan::countHitsLat ( BeBoard* pBoard,  const std::vector<Event*> pEve
                 for ( auto cCbc : cFe->fCbcVector )
                 {
                     //now loop the channels for this particular event and increment a counter
-                    for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
-                    {
-                        if ( cEvent->DataBit ( cCbc->getFeId(), cCbc->getCbcId(), cId ) )
-                            cHitCounter++;
-                    }
+                    cHitCounter += cEvent->GetNHits ( cCbc->getFeId(), cCbc->getCbcId() );
                 }
 
                 //now I have the number of hits in this particular event for all CBCs and the TDC value
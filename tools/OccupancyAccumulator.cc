@@ -0,0 +1,84 @@
+#include "OccupancyAccumulator.h"
+
+void OccupancyAccumulator::Reset()
+{
+    for ( auto& cCbc : fCounts )
+        cCbc.second.fill ( 0 );
+
+    fNEvents = 0;
+}
+
+void OccupancyAccumulator::Fill ( BeBoard* pBoard, const std::vector<Event*>& pEvents )
+{
+    for ( auto cFe : pBoard->fModuleVector )
+    {
+        for ( auto cCbc : cFe->fCbcVector )
+        {
+            auto cCounts = fCounts.find ( cCbc );
+
+            if ( cCounts == std::end ( fCounts ) )
+                cCounts = fCounts.emplace ( cCbc, fZero ).first;
+
+            ChannelCounts& cChannelCounts = cCounts->second;
+
+            for ( auto& cEvent : pEvents )
+            {
+                cEvent->ForEachHit ( cCbc->getFeId(), cCbc->getCbcId(), [&cChannelCounts] ( uint32_t cId )
+                {
+                    cChannelCounts[cId]++;
+                } );
+            }
+        }
+    }
+
+    fNEvents += pEvents.size();
+}
+
+const OccupancyAccumulator::ChannelCounts& OccupancyAccumulator::GetCounts ( Cbc* pCbc ) const
+{
+    auto cCounts = fCounts.find ( pCbc );
+
+    return ( cCounts != std::end ( fCounts ) ) ? cCounts->second : fZero;
+}
+
+uint32_t OccupancyAccumulator::GetNHits ( Cbc* pCbc, const std::vector<uint8_t>& pChannels ) const
+{
+    const ChannelCounts& cCounts = GetCounts ( pCbc );
+    uint32_t cNHits = 0;
+
+    for ( auto cId : pChannels )
+        cNHits += cCounts.at ( cId );
+
+    return cNHits;
+}
+
+void OccupancyAccumulator::Flush ( Cbc* pCbc, TH1* pHist ) const
+{
+    const ChannelCounts& cCounts = GetCounts ( pCbc );
+
+    for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
+        AddCounts ( pHist, cId, cCounts[cId] );
+
+    pHist->ResetStats();
+}
+
+void OccupancyAccumulator::Flush ( Cbc* pCbc, TH1* pHist, const std::vector<uint8_t>& pChannels ) const
+{
+    const ChannelCounts& cCounts = GetCounts ( pCbc );
+
+    for ( auto cId : pChannels )
+        AddCounts ( pHist, cId, cCounts.at ( cId ) );
+
+    pHist->ResetStats();
+}
+
+void OccupancyAccumulator::AddCounts ( TH1* pHist, double pX, uint32_t pCount )
+{
+    if ( pCount == 0 ) return;
+
+    Int_t cBin = pHist->FindBin ( pX );
+    pHist->AddBinContent ( cBin, pCount );
+
+    // unit weights: the sum of squares grows like the content
+    if ( pHist->GetSumw2N() ) pHist->GetSumw2()->AddAt ( pHist->GetSumw2()->At ( cBin ) + pCount, cBin );
+}
@@ -0,0 +1,83 @@
+/*!
+
+        \file                   OccupancyAccumulator.h
+        \brief                  per-channel hit counters that are filled from a whole readout and flushed into histograms once
+        \version                1.0
+
+ */
+
+#ifndef __OCCUPANCYACCUMULATOR_H__
+#define __OCCUPANCYACCUMULATOR_H__
+
+#include <array>
+#include <map>
+#include <vector>
+#include "TH1.h"
+#include "../HWDescription/BeBoard.h"
+#include "../HWDescription/Definition.h"
+#include "../Utils/Event.h"
+
+using namespace Ph2_HwDescription;
+using namespace Ph2_HwInterface;
+
+/*!
+ * \class OccupancyAccumulator
+ * \brief Counts the hits of every channel of every CBC over many events in plain arrays
+ * Filling touches only the hit channels of each event (Event::ForEachHit); the ROOT histograms are
+ * updated once per flush with one AddBinContent per channel instead of one TH1::Fill per hit.
+ */
+class OccupancyAccumulator
+{
+  public:
+    using ChannelCounts = std::array<uint32_t, NCHANNELS>;
+
+  private:
+    std::map<Cbc*, ChannelCounts> fCounts;  /*!< hit counts per channel of each CBC */
+    uint32_t fNEvents;                      /*!< number of events accumulated since the last Reset */
+    ChannelCounts fZero;                    /*!< returned for CBCs that were never filled */
+
+  public:
+    OccupancyAccumulator() : fNEvents ( 0 )
+    {
+        fZero.fill ( 0 );
+    }
+    /*!
+     * \brief Set all counters to 0, the CBC slots are kept so the next fill does not allocate
+     */
+    void Reset();
+    /*!
+     * \brief Add the hits of all CBCs of a board for a set of events
+     * \param pBoard : board the events were read from
+     * \param pEvents : events, e.g. the result of BeBoardInterface::GetEvents
+     */
+    void Fill ( BeBoard* pBoard, const std::vector<Event*>& pEvents );
+    /*!
+     * \brief Get the hit counts of all channels of a CBC
+     */
+    const ChannelCounts& GetCounts ( Cbc* pCbc ) const;
+    /*!
+     * \brief Get the number of events accumulated since the last Reset
+     */
+    uint32_t GetNEvents() const
+    {
+        return fNEvents;
+    }
+    /*!
+     * \brief Get the sum of the hit counts of a list of channels of a CBC
+     */
+    uint32_t GetNHits ( Cbc* pCbc, const std::vector<uint8_t>& pChannels ) const;
+    /*!
+     * \brief Add the counts of all channels of a CBC to a histogram with the channel number on the x axis
+     */
+    void Flush ( Cbc* pCbc, TH1* pHist ) const;
+    /*!
+     * \brief Add the counts of a list of channels of a CBC to a histogram with the channel number on the x axis
+     */
+    void Flush ( Cbc* pCbc, TH1* pHist, const std::vector<uint8_t>& pChannels ) const;
+    /*!
+     * \brief Add pCount entries at pX to a histogram without updating its statistics, call TH1::ResetStats() once done
+     */
+    static void AddCounts ( TH1* pHist, double pX, uint32_t pCount );
+};
+
+#endif
@@ -119,6 +119,8 @@ void PedeNoise::Initialise()
     fEventsPerPoint = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 10;
     cSetting = fSettingsMap.find ( "FitSCurves" );
     fFitted = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 0;
+    cSetting = fSettingsMap.find ( "ValidateSCurves" );
+    fValidateSCurves = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 0;
     cSetting = fSettingsMap.find ( "TestPulseAmplitude" );
     fTestPulseAmplitude = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 0;
 
@@ -130,6 +132,7 @@ void PedeNoise::Initialise()
     LOG (INFO) << "	Hole Mode = " << fHoleMode ;
     LOG (INFO) << "	Nevents = " << fEventsPerPoint ;
     LOG (INFO) << "	FitSCurves = " << int ( fFitted ) ;
+    LOG (INFO) << "	ValidateSCurves = " << int ( fValidateSCurves ) ;
     LOG (INFO) << "	TestPulseAmplitude = " << int ( fTestPulseAmplitude ) ;
 }
 
@@ -246,15 +249,16 @@ void PedeNoise::Validate ( uint32_t pNoiseStripThreshold )
 {
     LOG (INFO) << "Validation: Taking Data with " << fEventsPerPoint * 200 << " random triggers!" ;
 
+    //increase threshold to supress noise
     for ( auto cBoard : fBoardVector )
-    {
-        uint32_t cBoardId = cBoard->getBeId();
-
-        //increase threshold to supress noise
         setThresholdtoNSigma (cBoard, 5);
 
-        //take data
-        fBeBoardInterface->ReadNEvents (cBoard, fEventsPerPoint * 200);
+    //take data, all boards at the same time
+    ReadNEventsAllBoards ( fEventsPerPoint * 200 );
+
+    for ( auto cBoard : fBoardVector )
+    {
+        uint32_t cBoardId = cBoard->getBeId();
 
         //analyze
         const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( cBoard );
@@ -280,27 +284,25 @@ void PedeNoise::Validate ( uint32_t pNoiseStripThreshold )
                 fNoiseCanvas->Modified();
                 fNoiseCanvas->Update();
 
-                RegisterVector cRegVec;
-
                 for (uint32_t iChan = 0; iChan < NCHANNELS; iChan++)
                 {
                     if (cHist->GetBinContent (iChan) > double ( pNoiseStripThreshold * 0.001 ) ) // consider it noisy
                     {
-                        TString cRegName = Form ( "Channel%03d", iChan + 1 );
                         uint8_t cValue = fHoleMode ? 0x00 : 0xFF;
-                        cRegVec.push_back ({cRegName.Data(), cValue });
+                        cCbc->setReg ( CbcReg::ChannelReg ( iChan + 1 ), cValue );
                         LOG (INFO) << RED << "Found a noisy channel on CBC " << +cCbc->getCbcId() << " Channel " << iChan + 1 << " with an occupancy of " << cHist->GetBinContent (iChan) << "; setting offset to " << +cValue << RESET ;
                     }
 
                 }
-
-                //Write the changes
-                fCbcInterface->WriteCbcMultReg (cCbc, cRegVec);
             }
         }
+    }
 
+    //Write the changes
+    fCbcInterface->Flush ( fBoardVector );
+
+    for ( auto cBoard : fBoardVector )
         setThresholdtoNSigma (cBoard, 0);
-    }
 }
 
 
@@ -325,8 +327,6 @@ void PedeNoise::enableTestGroupforNoise ( int  pTGrpId )
 
                 TH1F* cOffsets = dynamic_cast<TH1F*> ( getHist ( cCbc, "Cbc_Offsets" ) );
 
-                RegisterVector cRegVec;
-
                 // iterate the groups (first is ID, second is vec<uint8_t>)
                 for ( auto& cGrp : fTestGroupChannelMap )
                 {
@@ -339,8 +339,7 @@ void PedeNoise::enableTestGroupforNoise ( int  pTGrpId )
                         // iterate the channels and push back 0 or FF
                         for ( auto& cChan : cGrp.second )
                         {
-                            TString cRegName = Form ( "Channel%03d", cChan + 1 );
-                            cRegVec.push_back ( { cRegName.Data(), cOffset } );
+                            cCbc->setReg ( CbcReg::ChannelReg ( cChan + 1 ), cOffset );
                             //LOG(INFO) << "DEBUG CBC " << cCbcId << " Channel " << +cChan << " group " << cGrp.first << " offset " << +cOffset ;
                         }
                     }
@@ -352,20 +351,20 @@ void PedeNoise::enableTestGroupforNoise ( int  pTGrpId )
                         {
 
                             uint8_t cEnableOffset = cOffsets->GetBinContent ( cChan );
-                            TString cRegName = Form ( "Channel%03d", cChan + 1 );
-                            cRegVec.push_back ( { cRegName.Data(), cEnableOffset } );
+                            cCbc->setReg ( CbcReg::ChannelReg ( cChan + 1 ), cEnableOffset );
                             // LOG(INFO) << GREEN << "DEBUG CBC " << cCbcId << " Channel " << +cChan << " group " << cGrp.first << " offset " << std::hex << "0x" << +cEnableOffset << std::dec << RESET ;
                         }
                     }
                 }
 
                 // now I should have 0 or FF as offset for all channels except the one in my test group
-                // this now needs to be written to the CBCs
-                fCbcInterface->WriteCbcMultReg ( cCbc, cRegVec );
             }
         }
     }
 
+    // this now needs to be written to the CBCs, only the offsets that changed since the last group
+    fCbcInterface->Flush ( fBoardVector );
+
     LOG (INFO) << "Disabling all TGroups except " << pTGrpId << " ! " ;
 }
 
@@ -373,7 +372,9 @@ void PedeNoise::enableTestGroupforNoise ( int  pTGrpId )
 void PedeNoise::processSCurvesNoise ( TString pParameter, uint8_t pValue, bool pDraw, int  pTGrpId )
 {
 
-    // First fitHits for every Channel, then extract the midpoint and noise and fill it in fVplusVcthGraphMap
+    // First fit or differentiate every Channel at once, then extract the midpoint and noise and fill it in the histograms
+    processSCurves ( pParameter, pValue, pTGrpId );
+
     for ( auto& cCbc : fCbcChannelMap )
     {
 
@@ -392,15 +393,10 @@ void PedeNoise::processSCurvesNoise ( TString pParameter, uint8_t pValue, bool p
         for ( auto& cChanId : cTestGrpChannelVec )
         {
             //for ( auto& cChan : cCbc.second )
-            Channel cChan = cCbc.second.at ( cChanId );
-
-            // Fit or Differentiate
-            if ( fFitted ) cChan.fitHist ( fEventsPerPoint, fHoleMode, pValue, pParameter, fResultFile );
-            else cChan.differentiateHist ( fEventsPerPoint, fHoleMode, pValue, pParameter, fResultFile );
-
+            const Channel& cChan = cCbc.second.at ( cChanId );
 
             // instead of the code below, use a histogram to histogram the noise
-            if ( cChan.getNoise() == 0 || cChan.getNoise() > 255 ) LOG (INFO) << RED << "Error, SCurve Fit for Fe " << int ( cCbc.first->getFeId() ) << " Cbc " << int ( cCbc.first->getCbcId() ) << " Channel " << int ( cChan.fChannelId ) << " did not work correctly! Noise " << cChan.getNoise() << RESET ;
+            if ( cChan.getNoise() <= 0 || cChan.getNoise() > 255 ) LOG (INFO) << RED << "Error, SCurve Fit for Fe " << int ( cCbc.first->getFeId() ) << " Cbc " << int ( cCbc.first->getCbcId() ) << " Channel " << int ( cChan.fChannelId ) << " did not work correctly! Noise " << cChan.getNoise() << RESET ;
 
             cNoiseHist->Fill ( cChan.getNoise() );
             cPedeHist->Fill ( cChan.getPedestal() );
@@ -470,8 +466,7 @@ void PedeNoise::saveInitialOffsets()
 
                 for ( uint8_t cChan = 0; cChan < NCHANNELS; cChan++ )
                 {
-                    TString cRegName = Form ( "Channel%03d", cChan + 1 );
-                    uint8_t cOffset = cCbc->getReg ( cRegName.Data() );
+                    uint8_t cOffset = cCbc->getReg ( CbcReg::ChannelReg ( cChan + 1 ) );
                     cOffsetHist->SetBinContent ( cChan, cOffset );
                     // cCbcOffsetMap[cChan] = cOffset;
                     // LOG(INFO) << "DEBUG Original Offset for CBC " << cCbcId << " channel " << +cChan << " " << +cOffset ;
@@ -487,6 +482,8 @@ void PedeNoise::setInitialOffsets()
 {
     LOG (INFO) << "Re-applying the original offsets for all CBCs" ;
 
+    // only the offsets that differ from the ones in the chips are written
+
     for ( auto cBoard : fBoardVector )
     {
         for ( auto cFe : cBoard->fModuleVector )
@@ -500,21 +497,19 @@ void PedeNoise::setInitialOffsets()
                 // first, find the offset Histogram for this CBC
                 TH1F* cOffsetHist = static_cast<TH1F*> ( getHist ( cCbc, "Cbc_Offsets" ) );
 
-                //also write to CBCs
-                RegisterVector cRegVec;
-
                 for ( int iChan = 0; iChan < NCHANNELS; iChan++ )
                 {
                     uint8_t cOffset = cOffsetHist->GetBinContent ( iChan );
-                    cCbc->setReg ( Form ( "Channel%03d", iChan + 1 ), cOffset );
-                    cRegVec.push_back ({ Form ( "Channel%03d", iChan + 1 ), cOffset } );
+                    cCbc->setReg ( CbcReg::ChannelReg ( iChan + 1 ), cOffset );
+
                     //LOG(INFO) << GREEN << "Offset for CBC " << cCbcId << " Channel " << iChan << " : 0x" << std::hex << +cOffset << std::dec << RESET ;
                 }
-
-                fCbcInterface->WriteCbcMultReg (cCbc, cRegVec);
             }
         }
     }
+
+    //also write to CBCs, one batch per board
+    fCbcInterface->Flush ( fBoardVector );
 }
 
 void PedeNoise::setThresholdtoNSigma (BeBoard* pBoard, uint32_t pNSigma)
@@ -544,21 +539,16 @@ void PedeNoise::setThresholdtoNSigma (BeBoard* pBoard, uint32_t pNSigma)
 
 void PedeNoise::fillOccupancyHist (BeBoard* pBoard, const std::vector<Event*>& pEvents)
 {
+    fOccupancyAccumulator.Reset();
+    fOccupancyAccumulator.Fill ( pBoard, pEvents );
+
     for ( auto cFe : pBoard->fModuleVector )
     {
         for ( auto cCbc : cFe->fCbcVector )
         {
             //get the histogram for the occupancy
             TH1F* cHist = dynamic_cast<TH1F*> ( getHist ( cCbc, "Cbc_occupancy" ) );
-
-            for (auto& cEvent : pEvents)
-            {
-                for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
-                {
-                    if ( cEvent->DataBit ( cCbc->getFeId(), cCbc->getCbcId(), cId ) )
-                        cHist->Fill (cId);
-                }
-            }
+            fOccupancyAccumulator.Flush ( cCbc, cHist );
         }
     }
 
@@ -120,72 +120,78 @@ void PulseShape::ScanVcth ( uint32_t pDelay )
         uint32_t cNthAcq = 0;
         int cNHits = 0;
 
-        // Take Data for all Modules
-        for ( BeBoard* pBoard : fBoardVector )
+        // set the threshold and take the data of all boards at the same time
+        uint32_t cNEvents = fNevents;
+
+        RunOnBoards ( [cVcth, cNEvents] ( BeBoard * cBoard, BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
         {
-            for (Module* cFe : pBoard->fModuleVector)
-                fCbcInterface->WriteBroadcast (cFe, "VCth", cVcth);
+            for (Module* cFe : cBoard->fModuleVector)
+                cCbcInterface->WriteBroadcast (cFe, "VCth", cVcth);
 
-            //fBeBoardInterface->Start( pBoard );
-            //while ( cN <= fNevents )
-            //{
-            fBeBoardInterface->ReadNEvents ( pBoard, fNevents );
+            cBeBoardInterface->ReadNEvents ( cBoard, cNEvents );
+        } );
+
+        for ( BeBoard* pBoard : fBoardVector )
+        {
             const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
             for ( auto& cEvent : events )
                 cNHits += fillVcthHist ( pBoard, cEvent, cVcth );
 
             cNthAcq++;
+        }
 
-            //}
-            //fBeBoardInterface->Stop( pBoard );
-            if ( !cNonZero && cNHits != 0 )
-            {
-                cNonZero = true;
-                cDoubleVcth = cVcth;
-                int cBackStep = 2 * cStep;
+        if ( !cNonZero && cNHits != 0 )
+        {
+            cNonZero = true;
+            cDoubleVcth = cVcth;
+            int cBackStep = 2 * cStep;
 
-                if ( int ( cVcth ) - cBackStep > 255 ) cVcth = 255;
-                else if ( int ( cVcth ) - cBackStep < 0 ) cVcth = 0;
-                else cVcth -= cBackStep;
+            if ( int ( cVcth ) - cBackStep > 255 ) cVcth = 255;
+            else if ( int ( cVcth ) - cBackStep < 0 ) cVcth = 0;
+            else cVcth -= cBackStep;
 
-                cStep /= 10;
-                continue;
-            }
+            cStep /= 10;
+            continue;
+        }
 
-            if ( cNHits > 0.95 * fNCbc * fNevents * findChannelsInTestGroup ( fTestGroup ).size() )
-                cAllOneCounter++;
+        if ( cNHits > 0.95 * fNCbc * fNevents * findChannelsInTestGroup ( fTestGroup ).size() )
+            cAllOneCounter++;
 
-            if ( cAllOneCounter > 6 ) cAllOne = true;
+        if ( cAllOneCounter > 6 ) cAllOne = true;
 
-            if ( cAllOne )
+        if ( cAllOne )
 
-                break;
+            break;
 
-            cVcth += cStep;
-            updateHists ( "", false );
+        cVcth += cStep;
+        updateHists ( "", false );
 
-            if ( fHoleMode && cVcth >= 0xFE && cNHits != 0 )
-            {
-                cSaturate = true;
-                break;
-            }
+        if ( fHoleMode && cVcth >= 0xFE && cNHits != 0 )
+        {
+            cSaturate = true;
+            break;
+        }
 
-            if ( !fHoleMode && cVcth <= 0x01 && cNHits != 0 )
-            {
-                cSaturate = true;
-                break;
-            }
+        if ( !fHoleMode && cVcth <= 0x01 && cNHits != 0 )
+        {
+            cSaturate = true;
+            break;
         }
     }
 
+    // fit or differentiate the channels of all CBCs at once
+    std::vector<Channel*> cChannels;
+
+    for ( auto& cChannelVector : fChannelMap )
+        cChannels.insert ( cChannels.end(), cChannelVector.second.begin(), cChannelVector.second.end() );
+
+    analyzeSCurves ( cChannels, fNevents, fHoleMode, fFitHist, pDelay, "Delay", fResultFile, fValidateSCurves );
+
     for ( auto& cChannelVector : fChannelMap )
     {
         for ( auto& cChannel : cChannelVector.second )
         {
-            if ( fFitHist ) cChannel->fitHist ( fNevents, fHoleMode, pDelay, "Delay", fResultFile );
-            else cChannel->differentiateHist ( fNevents, fHoleMode, pDelay, "Delay", fResultFile );
-
             if ( !cSaturate ) cChannel->setPulsePoint ( pDelay, cChannel->getPedestal() );
             else cChannel->setPulsePoint ( pDelay, 255 );
         }
@@ -272,23 +278,24 @@ std::vector<uint32_t> PulseShape::findChannelsInTestGroup ( uint32_t pTestGroup
 
 void PulseShape::toggleTestGroup (bool pEnable )
 {
-    std::vector<std::pair<std::string, uint8_t> > cRegVec;
     uint8_t cDisableValue = fHoleMode ? 0x00 : 0xFF;
     uint8_t cValue = pEnable ? fOffset : cDisableValue;
 
-    for ( auto& cChannel : fChannelVector )
-    {
-        TString cRegName = Form ( "Channel%03d", cChannel );
-        cRegVec.push_back ( std::make_pair ( cRegName.Data(), cValue ) );
-    }
-
     //CbcMultiRegWriter cWriter ( fCbcInterface, cRegVec );
     //this->accept ( cWriter );
     for (BeBoard* cBoard : fBoardVector)
     {
         for (Module* cFe : cBoard->fModuleVector)
-            fCbcInterface->WriteBroadcastMultReg (cFe, cRegVec);
+        {
+            for (Cbc* cCbc : cFe->fCbcVector)
+            {
+                for ( auto& cChannel : fChannelVector )
+                    cCbc->setReg ( CbcReg::ChannelReg ( cChannel ), cValue );
+            }
+        }
     }
+
+    fCbcInterface->Flush ( fBoardVector );
 }
 
 void PulseShape::setDelayAndTesGroup ( uint32_t pDelay )
@@ -382,6 +389,9 @@ void PulseShape::parseSettings()
     cSetting = fSettingsMap.find ( "FitSCurves" );
     fFitHist = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 0;
 
+    cSetting = fSettingsMap.find ( "ValidateSCurves" );
+    fValidateSCurves = ( cSetting != std::end ( fSettingsMap ) ) ? cSetting->second : 0;
+
     LOG (INFO) << "Parsed the following settings:" ;
     LOG (INFO) << "	Nevents = " << fNevents ;
     LOG (INFO) << "	HoleMode = " << int ( fHoleMode ) ;
@@ -390,6 +400,7 @@ void PulseShape::parseSettings()
     LOG (INFO) << "	ChOffset = " << int ( fOffset ) ;
     LOG (INFO) << "	StepSize = " << int ( fStepSize ) ;
     LOG (INFO) << "	FitSCurves = " << int ( fFitHist ) ;
+    LOG (INFO) << "	ValidateSCurves = " << int ( fValidateSCurves ) ;
     LOG (INFO) << "	TestGroup = " << int ( fTestGroup ) ;
 }
 
@@ -130,6 +130,7 @@ private:
 
     ChannelMap fChannelMap;/*!< Map Cbc vs chennels number */
     bool fFitHist;
+    bool fValidateSCurves; /*!< compare the SCurve results with a ROOT fit */
     uint32_t fNevents; /*!< Number of events */
     uint32_t fHoleMode;/*!< Check if is in hole mode */
     uint32_t fNCbc;/*!< Number of CBCs */
@@ -41,29 +41,20 @@ void SCurve::MakeTestGroups ( bool pAllChan )
 void SCurve::setOffset ( uint8_t pOffset, int  pGroup )
 {
     // LOG(INFO) << "Setting offsets of Test Group " << pGroup << " to 0x" << std::hex << +pOffset << std::dec ;
+    // the offsets are staged on every CBC, Flush broadcasts them where the firmware allows it
     for ( auto cBoard : fBoardVector )
     {
         for ( auto cFe : cBoard->fModuleVector )
         {
-            //uint32_t cFeId = cFe->getFeId();
-
-            //for ( auto cCbc : cFe->fCbcVector )
-            //{
-            //uint32_t cCbcId = cCbc->getCbcId();
-
-            RegisterVector cRegVec;   // vector of pairs for the write operation
-
-            // loop the channels of the current group and toggle bit i in the global map
-            for ( auto& cChannel : fTestGroupChannelMap[pGroup] )
+            for ( auto cCbc : cFe->fCbcVector )
             {
-                TString cRegName = Form ( "Channel%03d", cChannel + 1 );
-                cRegVec.push_back ( {cRegName.Data(), pOffset} );
+                for ( auto& cChannel : fTestGroupChannelMap[pGroup] )
+                    cCbc->setReg ( CbcReg::ChannelReg ( cChannel + 1 ), pOffset );
             }
-
-            fCbcInterface->WriteBroadcastMultReg ( cFe, cRegVec );
-            //}
         }
     }
+
+    fCbcInterface->Flush ( fBoardVector );
 }
 
 
@@ -123,58 +114,61 @@ void SCurve::measureSCurves ( int  pTGrpId )
         // DEBUG
         if ( cAllOne ) break;
 
-        for ( BeBoard* pBoard : fBoardVector )
+        // set the threshold and take the data of all boards at the same time
+        uint32_t cNEvents = fEventsPerPoint;
+
+        RunOnBoards ( [cValue, cNEvents] ( BeBoard * cBoard, BeBoardInterface * cBeBoardInterface, CbcInterface * cCbcInterface )
         {
-            for (Module* cFe : pBoard->fModuleVector)
-                fCbcInterface->WriteBroadcast (cFe, "VCth", cValue);
+            for (Module* cFe : cBoard->fModuleVector)
+                cCbcInterface->WriteBroadcast (cFe, "VCth", cValue);
 
-            fBeBoardInterface->ReadNEvents ( pBoard, fEventsPerPoint );
+            cBeBoardInterface->ReadNEvents ( cBoard, cNEvents );
+        } );
 
+        for ( BeBoard* pBoard : fBoardVector )
+        {
             const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-            // Loop over Events from this Acquisition
-            for ( auto& ev : events )
-            {
-                cHitCounter += fillSCurves ( pBoard, ev, cValue, pTGrpId ); //pass test group here
-                cN++;
-            }
+            // count the hits of all Events from this Acquisition, then fill the SCurves once
+            fOccupancyAccumulator.Reset();
+            fOccupancyAccumulator.Fill ( pBoard, events );
+            cHitCounter += fillSCurves ( pBoard, cValue, pTGrpId ); //pass test group here
+            cN += events.size();
 
             cNthAcq++;
-            //Counter cCounter;
-            //pBoard->accept ( cCounter );
-
-            //LOG(INFO) << "DEBUG Vcth " << int ( cValue ) << " Hits " << cHitCounter << " and should be " <<  0.95 * fEventsPerPoint*   cCounter.getNCbc() * fTestGroupChannelMap[pTGrpId].size() ;
+        }
 
-            // check if the hitcounter is all ones
-            if ( cNonZero == false && cHitCounter != 0 )
-            {
-                cDoubleValue = cValue;
-                cNonZero = true;
+        //LOG(INFO) << "DEBUG Vcth " << int ( cValue ) << " Hits " << cHitCounter << " and should be " <<  0.95 * fEventsPerPoint*   fNCbc * fTestGroupChannelMap[pTGrpId].size() ;
 
-                if ( cValue == 255 ) cValue = 255;
-                else if ( cValue == 0 ) cValue = 0;
-                else cValue -= cStep;
+        cIterationCount++;
 
-                cStep /= 10;
-                LOG (INFO) << GREEN << "Found > 0 Hits!, Falling back to " << +cValue  <<  RESET ;
-                continue;
-            }
+        // check if the hitcounter is all ones
+        if ( cNonZero == false && cHitCounter != 0 )
+        {
+            cDoubleValue = cValue;
+            cNonZero = true;
 
-            // the above counter counted the CBC objects connected to pBoard
-            if ( cHitCounter > 0.95 * fEventsPerPoint  * fNCbc * fTestGroupChannelMap[pTGrpId].size() ) cAllOneCounter++;
+            if ( cValue == 255 ) cValue = 255;
+            else if ( cValue == 0 ) cValue = 0;
+            else cValue -= cStep;
 
-            if ( cAllOneCounter >= 10 )
-            {
-                cAllOne = true;
-                LOG (INFO) << RED << "Found maximum occupancy 10 times, SCurves finished! " << RESET ;
-            }
+            cStep /= 10;
+            LOG (INFO) << GREEN << "Found > 0 Hits!, Falling back to " << +cValue  <<  RESET ;
+            continue;
+        }
 
-            if ( cAllOne ) break;
+        // the hits of all boards are compared to the CBCs of all boards
+        if ( cHitCounter > 0.95 * fEventsPerPoint  * fNCbc * fTestGroupChannelMap[pTGrpId].size() ) cAllOneCounter++;
 
-            cValue += cStep;
+        if ( cAllOneCounter >= 10 )
+        {
+            cAllOne = true;
+            LOG (INFO) << RED << "Found maximum occupancy 10 times, SCurves finished! " << RESET ;
         }
 
-        cIterationCount++;
+        if ( cAllOne ) break;
+
+        cValue += cStep;
     }
 } // end of VCth loop
 
@@ -225,53 +219,51 @@ void SCurve::measureSCurvesOffset ( int  pTGrpId )
         // DEBUG
         if ( cAllOne ) break;
 
+        // all boards take their data at the same time
+        ReadNEventsAllBoards ( fEventsPerPoint );
+
         for ( BeBoard* pBoard : fBoardVector )
         {
-            //Counter cCounter;
-            //pBoard->accept ( cCounter );
-
-            fBeBoardInterface->ReadNEvents ( pBoard, fEventsPerPoint );
             const std::vector<Event*>& events = fBeBoardInterface->GetEvents ( pBoard );
 
-            // Loop over Events from this Acquisition
-            for ( auto& ev : events )
-            {
-                cHitCounter += fillSCurves ( pBoard, ev, cValue, pTGrpId ); //pass test group here
-                cN++;
-            }
+            // count the hits of all Events from this Acquisition, then fill the SCurves once
+            fOccupancyAccumulator.Reset();
+            fOccupancyAccumulator.Fill ( pBoard, events );
+            cHitCounter += fillSCurves ( pBoard, cValue, pTGrpId ); //pass test group here
+            cN += events.size();
 
             cNthAcq++;
+        }
 
-            // LOG(INFO) << "DEBUG Vcth " << int( cValue ) << " Hits " << cHitCounter << " and should be " <<  0.95 * fEventsPerPoint*   cCounter.getNCbc() * fTestGroupChannelMap[pTGrpId].size() ;
+        // LOG(INFO) << "DEBUG Vcth " << int( cValue ) << " Hits " << cHitCounter << " and should be " <<  0.95 * fEventsPerPoint*   fNCbc * fTestGroupChannelMap[pTGrpId].size() ;
 
-            // check if the hitcounter is all ones
-            if ( cNonZero == false && cHitCounter != 0 )
-            {
-                cDoubleValue = cValue;
-                cNonZero = true;
+        // check if the hitcounter is all ones
+        if ( cNonZero == false && cHitCounter != 0 )
+        {
+            cDoubleValue = cValue;
+            cNonZero = true;
 
-                if ( cValue == 255 ) cValue = 255;
-                else if ( cValue == 0 ) cValue = 0;
-                else cValue -= 1.5 * cStep;
+            if ( cValue == 255 ) cValue = 255;
+            else if ( cValue == 0 ) cValue = 0;
+            else cValue -= 1.5 * cStep;
 
-                cStep /= 10;
-                LOG (INFO) << GREEN << "Found > 0 Hits!, Falling back to " << +cValue  <<  RESET ;
-                continue;
-            }
+            cStep /= 10;
+            LOG (INFO) << GREEN << "Found > 0 Hits!, Falling back to " << +cValue  <<  RESET ;
+            continue;
+        }
 
-            // the above counter counted the CBC objects connected to pBoard
-            if ( cHitCounter > 0.95 * fEventsPerPoint  * fNCbc * fTestGroupChannelMap[pTGrpId].size() ) cAllOneCounter++;
+        // the hits of all boards are compared to the CBCs of all boards
+        if ( cHitCounter > 0.95 * fEventsPerPoint  * fNCbc * fTestGroupChannelMap[pTGrpId].size() ) cAllOneCounter++;
 
-            if ( cAllOneCounter >= 10 )
-            {
-                cAllOne = true;
-                LOG (INFO) << RED << "Found maximum occupancy 10 times, SCurves finished! " << RESET ;
-            }
+        if ( cAllOneCounter >= 10 )
+        {
+            cAllOne = true;
+            LOG (INFO) << RED << "Found maximum occupancy 10 times, SCurves finished! " << RESET ;
+        }
 
-            if ( cAllOne ) break;
+        if ( cAllOne ) break;
 
-            cValue += cStep;
-        }
+        cValue += cStep;
     } // end of VCth loop
 
     setOffset ( cStartValue, pTGrpId );
@@ -291,9 +283,23 @@ void SCurve::initializeSCurves ( TString pParameter, uint8_t pValue, int  pTGrpI
     LOG (INFO) << "SCurve Histograms for " << pParameter << " =  " << int ( pValue ) << " initialized!" ;
 }
 
-uint32_t SCurve::fillSCurves ( BeBoard* pBoard,  const Event* pEvent, uint8_t pValue, int  pTGrpId, bool pDraw )
+void SCurve::processSCurves ( TString pParameter, uint8_t pValue, int  pTGrpId )
+{
+    // the channels of all CBCs are analyzed together, so that they are spread over all the threads of SCurveFitter
+    std::vector<Channel*> cChannels;
+
+    for ( auto& cCbc : fCbcChannelMap )
+    {
+        for ( auto& cChanId : fTestGroupChannelMap[pTGrpId] )
+            cChannels.push_back ( &cCbc.second.at ( cChanId ) );
+    }
+
+    analyzeSCurves ( cChannels, fEventsPerPoint, fHoleMode, fFitted, pValue, pParameter, fResultFile, fValidateSCurves );
+}
+
+uint32_t SCurve::fillSCurves ( BeBoard* pBoard, uint8_t pValue, int  pTGrpId, bool pDraw )
 {
-    // loop over all FEs on board, check if channels are hit and if so , fill pValue in the histogram of Channel
+    // loop over all FEs on board, take the hit counts of each channel from fOccupancyAccumulator and fill them at pValue in the histogram of Channel
     uint32_t cHitCounter = 0;
 
     for ( auto cFe : pBoard->fModuleVector )
@@ -307,15 +313,18 @@ uint32_t SCurve::fillSCurves ( BeBoard* pBoard,  const Event* pEvent, uint8_t pV
             if ( cChanVec != fCbcChannelMap.end() )
             {
                 const std::vector<uint8_t>& cTestGrpChannelVec = fTestGroupChannelMap[pTGrpId];
+                const OccupancyAccumulator::ChannelCounts& cCounts = fOccupancyAccumulator.GetCounts ( cCbc );
 
                 for ( auto& cChanId : cTestGrpChannelVec )
                 {
-                    if ( pEvent->DataBit ( cFe->getFeId(), cCbc->getCbcId(), cChanVec->second.at ( cChanId ).fChannelId ) )
+                    Channel& cChannel = cChanVec->second.at ( cChanId );
+                    uint32_t cCount = cCounts.at ( cChannel.fChannelId );
+
+                    if ( cCount )
                     {
-                        cChanVec->second.at ( cChanId ).fillHist ( pValue );
-                        cHitCounter++;
+                        cChannel.fillHist ( pValue, cCount );
+                        cHitCounter += cCount;
                     }
-
                 }
             }
             else LOG (INFO) << RED << "Error: could not find the channels for CBC " << int ( cCbc->getCbcId() ) << RESET ;
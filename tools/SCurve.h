@@ -45,7 +45,7 @@ Key=0-7 for the 8 Test Groups
 class SCurve : public Tool
 {
   public:
-    SCurve() {}
+    SCurve() : fValidateSCurves ( false ) {}
 
     // D'tor
     ~SCurve() {}
@@ -67,6 +67,7 @@ class SCurve : public Tool
     uint8_t fTestPulseAmplitude;
     uint32_t fEventsPerPoint;
     bool fFitted;
+    bool fValidateSCurves;
 
 
 
@@ -77,8 +78,12 @@ class SCurve : public Tool
     // SCurve related
     void measureSCurves ( int  pTGrpId );
     void measureSCurvesOffset ( int  pTGrpId );
-    uint32_t fillSCurves ( BeBoard* pBoard,  const Event* pEvent, uint8_t pValue, int  pTGrpId, bool pDraw = false );
+    uint32_t fillSCurves ( BeBoard* pBoard, uint8_t pValue, int  pTGrpId, bool pDraw = false );
     void initializeSCurves ( TString pParameter, uint8_t pValue, int  pTGrpId );
+    /*!
+    * \brief fit or differentiate the SCurves of a test group of all CBCs at once, see analyzeSCurves
+    */
+    void processSCurves ( TString pParameter, uint8_t pValue, int  pTGrpId );
 
     // general stuff
     void setSystemTestPulse ( uint8_t pTPAmplitude, uint8_t pTestGroup );
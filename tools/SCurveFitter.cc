@@ -0,0 +1,221 @@
+#include "SCurveFitter.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    const uint32_t kMargin = 5;                 // measured empty bins taken in front of the first hit, the loops step by 1 there
+    const uint32_t kMinCurvesPerThread = 16;
+    const uint32_t kMaxIterations = 100;
+    const double kMinWidth = 1e-2;
+    const double kInvSqrtPi = 0.56418958354775628695;
+}
+
+SCurveFitter::SCurveFitter ( bool pHoleMode, SCurveMethod pMethod, uint32_t pNThreads ) :
+    fHoleMode ( pHoleMode ),
+    fMethod ( pMethod ),
+    fNThreads ( pNThreads )
+{
+    if ( fNThreads == 0 ) fNThreads = std::max ( 1u, std::thread::hardware_concurrency() );
+}
+
+void SCurveFitter::Analyze ( const std::vector<const float*>& pCounts, uint32_t pNBins, uint32_t pNEvents, std::vector<SCurveResult>& pResults ) const
+{
+    size_t cNCurves = pCounts.size();
+    pResults.assign ( cNCurves, SCurveResult() );
+
+    uint32_t cNThreads = std::min<size_t> ( fNThreads, std::max<size_t> ( 1, cNCurves / kMinCurvesPerThread ) );
+
+    auto cAnalyzeRange = [&] ( size_t pBegin, size_t pEnd )
+    {
+        for ( size_t cCurve = pBegin; cCurve < pEnd; cCurve++ )
+            pResults[cCurve] = Analyze ( pCounts[cCurve], pNBins, pNEvents );
+    };
+
+    if ( cNThreads <= 1 )
+    {
+        cAnalyzeRange ( 0, cNCurves );
+        return;
+    }
+
+    // every thread writes its own range of pResults, nothing else is shared
+    std::vector<std::thread> cThreads;
+
+    for ( uint32_t cThread = 0; cThread < cNThreads; cThread++ )
+        cThreads.emplace_back ( cAnalyzeRange, cNCurves * cThread / cNThreads, cNCurves * ( cThread + 1 ) / cNThreads );
+
+    for ( auto& cThread : cThreads )
+        cThread.join();
+}
+
+SCurveResult SCurveFitter::Analyze ( const float* pCounts, uint32_t pNBins, uint32_t pNEvents ) const
+{
+    if ( pCounts == nullptr || pNBins < 2 || pNEvents == 0 ) return SCurveResult();
+
+    std::vector<double> cOccupancy ( pNBins );
+
+    for ( uint32_t cBin = 0; cBin < pNBins; cBin++ )
+        cOccupancy[cBin] = pCounts[cBin] / double ( pNEvents );
+
+    if ( fMethod == SCurveMethod::ErfFit ) return fitErf ( cOccupancy );
+    else return derivative ( cOccupancy );
+}
+
+SCurveResult SCurveFitter::derivative ( const std::vector<double>& pOccupancy ) const
+{
+    // walk from the full occupancy side towards the empty one: sampling starts once the previous point is above
+    // 0.75 and ends after 8 empty points, the difference of two points sits halfway between them
+    double cSumW = 0, cSumWX = 0, cSumWX2 = 0;
+    bool cActive = false;
+    int cZeroCounter = 0;
+    int cNBins = pOccupancy.size();
+    int cStep = ( fHoleMode ) ? 1 : -1;
+    int cBin = ( fHoleMode ) ? 0 : cNBins - 1;
+    double cPrev = pOccupancy[cBin];
+
+    for ( cBin += cStep; cBin >= 0 && cBin < cNBins; cBin += cStep )
+    {
+        double cCurrent = pOccupancy[cBin];
+        double cDiff = cPrev - cCurrent;
+
+        if ( cPrev > 0.75 ) cActive = true;
+
+        if ( cActive )
+        {
+            double cX = cBin - 0.5 * cStep;
+            cSumW += cDiff;
+            cSumWX += cDiff * cX;
+            cSumWX2 += cDiff * cX * cX;
+
+            if ( cDiff == 0 && cCurrent == 0 ) cZeroCounter++;
+
+            if ( cZeroCounter == 8 ) break;
+        }
+
+        cPrev = cCurrent;
+    }
+
+    SCurveResult cResult;
+
+    if ( cSumW == 0 ) return cResult;
+
+    double cMean = cSumWX / cSumW;
+    cResult.fPedestal = fabs ( cMean );
+    cResult.fNoise = sqrt ( fabs ( cSumWX2 / cSumW - cMean * cMean ) );
+    cResult.fValid = true;
+    return cResult;
+}
+
+SCurveResult SCurveFitter::fitErf ( const std::vector<double>& pOccupancy ) const
+{
+    SCurveResult cResult;
+    int cNBins = pOccupancy.size();
+
+    // the fit range is the span of the hits plus the empty bins measured in front of the first one
+    int cFirst = 0;
+    int cLast = cNBins - 1;
+
+    while ( cFirst < cNBins && pOccupancy[cFirst] == 0 ) cFirst++;
+
+    while ( cLast >= 0 && pOccupancy[cLast] == 0 ) cLast--;
+
+    if ( cFirst > cLast ) return cResult;
+
+    if ( fHoleMode ) cLast = std::min<int> ( cLast + kMargin, cNBins - 1 );
+    else cFirst = std::max<int> ( cFirst - kMargin, 0 );
+
+    int cNPoints = cLast - cFirst + 1;
+
+    if ( cNPoints < 3 ) return cResult;
+
+    // seed with the moments, the width of MyErf being sqrt(2) times the RMS of its derivative; a falling curve has a
+    // negative width as in the ROOT fit
+    double cSign = ( fHoleMode ) ? -1 : 1;
+    SCurveResult cSeed = derivative ( pOccupancy );
+    double cX0 = ( cSeed.fValid ) ? cSeed.fPedestal : 0.5 * ( cFirst + cLast );
+    double cWidth = ( cSeed.fValid ) ? M_SQRT2 * cSeed.fNoise : 0.25 * cNPoints;
+    cWidth = cSign * std::max ( cWidth, 0.5 );
+
+    // chi2 and the normal equations of the occupancy residuals at ( cX0, cWidth )
+    auto cEvaluate = [&] ( double pX0, double pWidth, double* pAlpha, double* pBeta )
+    {
+        double cChi2 = 0;
+
+        if ( pAlpha )
+        {
+            pAlpha[0] = pAlpha[1] = pAlpha[2] = 0;
+            pBeta[0] = pBeta[1] = 0;
+        }
+
+        for ( int cBin = cFirst; cBin <= cLast; cBin++ )
+        {
+            double cU = ( cBin - pX0 ) / pWidth;
+            double cResidual = pOccupancy[cBin] - 0.5 * erfc ( -cU );
+            cChi2 += cResidual * cResidual;
+
+            if ( pAlpha )
+            {
+                double cGauss = kInvSqrtPi * exp ( -cU * cU ) / pWidth;
+                double cDX0 = -cGauss;
+                double cDWidth = -cGauss * cU;
+                pAlpha[0] += cDX0 * cDX0;
+                pAlpha[1] += cDX0 * cDWidth;
+                pAlpha[2] += cDWidth * cDWidth;
+                pBeta[0] += cDX0 * cResidual;
+                pBeta[1] += cDWidth * cResidual;
+            }
+        }
+
+        return cChi2;
+    };
+
+    double cAlpha[3], cBeta[2];
+    double cLambda = 1e-3;
+    double cChi2 = cEvaluate ( cX0, cWidth, cAlpha, cBeta );
+    bool cConverged = false;
+    uint32_t cIteration = 0;
+
+    while ( !cConverged && cIteration < kMaxIterations )
+    {
+        cIteration++;
+
+        // damped 2x2 system, solved directly
+        double cA00 = cAlpha[0] * ( 1 + cLambda );
+        double cA11 = cAlpha[2] * ( 1 + cLambda );
+        double cDet = cA00 * cA11 - cAlpha[1] * cAlpha[1];
+
+        if ( cDet <= 0 || !std::isfinite ( cDet ) ) break;
+
+        double cDX0 = ( cA11 * cBeta[0] - cAlpha[1] * cBeta[1] ) / cDet;
+        double cDWidth = ( cA00 * cBeta[1] - cAlpha[1] * cBeta[0] ) / cDet;
+        double cNewX0 = cX0 + cDX0;
+        double cNewWidth = cWidth + cDWidth;
+
+        if ( fabs ( cNewWidth ) < kMinWidth ) cNewWidth = ( cNewWidth < 0 ) ? -kMinWidth : kMinWidth;
+
+        double cNewChi2 = cEvaluate ( cNewX0, cNewWidth, nullptr, nullptr );
+
+        if ( cNewChi2 <= cChi2 )
+        {
+            cConverged = fabs ( cDX0 ) < 1e-6 * ( 1 + fabs ( cX0 ) ) && fabs ( cDWidth ) < 1e-6 * ( 1 + fabs ( cWidth ) );
+            cX0 = cNewX0;
+            cWidth = cNewWidth;
+            cLambda = std::max ( cLambda * 0.1, 1e-12 );
+            cChi2 = cEvaluate ( cX0, cWidth, cAlpha, cBeta );
+        }
+        else
+        {
+            // no step downhill is left at any damping: this is the minimum
+            cLambda *= 10;
+            cConverged = cLambda > 1e10;
+        }
+    }
+
+    cResult.fPedestal = fabs ( cX0 );
+    cResult.fNoise = fabs ( cWidth );
+    cResult.fChi2 = cChi2 / ( cNPoints - 2 );
+    cResult.fNIterations = cIteration;
+    cResult.fValid = cConverged && std::isfinite ( cX0 ) && std::isfinite ( cWidth ) && cX0 > -cNBins && cX0 < 2 * cNBins;
+    return cResult;
+}
@@ -0,0 +1,79 @@
+/*!
+
+        \file                   SCurveFitter.h
+        \brief                  pedestal and noise of many SCurves at once from their raw counts, without ROOT
+        \version                1.0
+
+ */
+
+#ifndef __SCURVEFITTER_H__
+#define __SCURVEFITTER_H__
+
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Algorithm used to extract pedestal and noise from an SCurve
+ */
+enum class SCurveMethod
+{
+    Derivative,     /*!< mean and RMS of the bin to bin differences, as Channel::differentiateHist */
+    ErfFit          /*!< least squares fit of MyErf with Levenberg-Marquardt, as Channel::fitHist */
+};
+
+/*!
+ * \struct SCurveResult
+ * \brief Pedestal and noise of one SCurve, in the conventions of Channel::getPedestal and Channel::getNoise
+ * The noise of ErfFit is the width of MyErf, which is sqrt(2) times the RMS given by Derivative.
+ */
+struct SCurveResult
+{
+    double fPedestal = -1;
+    double fNoise = -1;
+    double fChi2 = 0;               /*!< sum of the squared residuals of the occupancy per degree of freedom, ErfFit only */
+    uint32_t fNIterations = 0;      /*!< iterations of the fit, 0 for Derivative */
+    bool fValid = false;            /*!< false if the curve was empty or the fit did not converge */
+};
+
+/*!
+ * \class SCurveFitter
+ * \brief Analyzes the SCurves of all channels in parallel, on the counts filled per threshold value
+ * The counts of a curve are an array of pNBins values, index i being the number of hits at threshold i. Only the
+ * bins around the measured transition are used: the adaptive threshold loops leave the bins they skipped at 0.
+ */
+class SCurveFitter
+{
+  public:
+    /*!
+     * \param pHoleMode : the occupancy falls with the threshold instead of rising
+     * \param pMethod : algorithm to use
+     * \param pNThreads : number of threads, 0 for one per core
+     */
+    SCurveFitter ( bool pHoleMode, SCurveMethod pMethod, uint32_t pNThreads = 0 );
+
+    /*!
+     * \brief Analyze a set of curves, each thread takes a contiguous range of them
+     * \param pCounts : counts of each curve, a nullptr gives an invalid result
+     * \param pNBins : number of threshold values of each curve
+     * \param pNEvents : events taken per threshold value, to normalize the counts to an occupancy
+     * \param pResults : resized to the number of curves
+     */
+    void Analyze ( const std::vector<const float*>& pCounts, uint32_t pNBins, uint32_t pNEvents, std::vector<SCurveResult>& pResults ) const;
+    /*!
+     * \brief Analyze a single curve in the calling thread
+     */
+    SCurveResult Analyze ( const float* pCounts, uint32_t pNBins, uint32_t pNEvents ) const;
+
+  private:
+    bool fHoleMode;
+    SCurveMethod fMethod;
+    uint32_t fNThreads;
+
+    SCurveResult derivative ( const std::vector<double>& pOccupancy ) const;
+    /*!
+     * \brief Levenberg-Marquardt fit of 0.5 * ( 1 + erf ( ( x - x0 ) / w ) ), seeded with the result of derivative
+     */
+    SCurveResult fitErf ( const std::vector<double>& pOccupancy ) const;
+};
+
+#endif
@@ -100,14 +100,12 @@ void SignalScan::ScanSignal (int pSignalScanLength)
                         for ( auto cCbc : cFe->fCbcVector )
                         {
                             //now loop the channels for this particular event and increment a counter
-                            for ( uint32_t cId = 0; cId < NCHANNELS; cId++ )
+                            uint8_t cVcth = cCbc->getReg ("VCth");
+                            cEvent->ForEachHit ( cCbc->getFeId(), cCbc->getCbcId(), [&] ( uint32_t cId )
                             {
-                                if ( cEvent->DataBit ( cCbc->getFeId(), cCbc->getCbcId(), cId ) )
-                                {
-                                    cSignalHist->Fill (cCbc->getCbcId() *NCHANNELS + cId, cCbc->getReg ("VCth") );
-                                    cEventHits++;
-                                }
-                            }
+                                cSignalHist->Fill (cCbc->getCbcId() *NCHANNELS + cId, cVcth );
+                                cEventHits++;
+                            } );
 
                             //append HexDataString to cDataString
                             cDataString += cEvent->DataHexString (cCbc->getFeId(), cCbc->getCbcId() );
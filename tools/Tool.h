@@ -14,6 +14,7 @@
 #define __TOOL_H__
 
 #include "../System/SystemController.h"
+#include "OccupancyAccumulator.h"
 #include "TROOT.h"
 #include "TFile.h"
 #include "TObject.h"
@@ -71,6 +72,7 @@ class Tool : public SystemController
     CanvasMap fCanvasMap;
     CbcHistogramMap fCbcHistMap;
     ModuleHistogramMap fModuleHistMap;
+    OccupancyAccumulator fOccupancyAccumulator;  /*< per-channel hit counts of the current scan point, scratch space for the Tool subclasses */
 
 
     /*!
@@ -89,6 +91,7 @@ class Tool : public SystemController
         fBeBoardFWMap = pTool->fBeBoardFWMap;
         fSettingsMap = pTool->fSettingsMap;
         fFileHandler = pTool->fFileHandler;
+        fBoardWorkers = pTool->fBoardWorkers;
         fDirectoryName = pTool->fDirectoryName;
         fResultFile = pTool->fResultFile;
 #ifdef __HTTP__